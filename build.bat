@@ -43,7 +43,7 @@ rem cl %COMMON_CL_FLAGS% %COMMON_FLAGS% %BUILD_SETTINGS% /Femain ../src/win32_ma
 
 REM Tests
 rem SET ASAN_TESTS=/fsanitize=address
-rem cl %COMMON_CL_FLAGS% %WARNINGS% %COMMON_FLAGS% /EHsc /Fetests ../tests/main.cpp /I../common /DASUKA_OS_WINDOWS=1 /D_CRT_SECURE_NO_WARNINGS /DUNITY_BUILD=1
+rem cl %COMMON_CL_FLAGS% %WARNINGS% %COMMON_FLAGS% /EHsc /Fetests ../tests/main.cpp /I../common /I../src /DASUKA_OS_WINDOWS=1 /D_CRT_SECURE_NO_WARNINGS /DUNITY_BUILD=1
 
 
 REM XAudio2
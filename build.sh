@@ -10,4 +10,4 @@ UI_EDITOR=1
 
 BUILD_SETTING="-DASUKA_DEBUG=$DEBUG_BUILD -DUNITY_BUILD=$UNITY_BUILD -DASUKA_DLL_BUILD=$DLL_BUILD -DIN_CODE_TEXTURES=$INCLUDE_TEXTURES -DUI_EDITOR_ENABLED=$UI_EDITOR -std=c++$CXX_STANDARD"
 
-g++ src/linux_main.cpp -o build/main -g3 $BUILD_SETTING -DASUKA_OS_LINUX -Icommon -Isrc -lX11 -lasound
+g++ src/linux_main.cpp -o build/main -g3 $BUILD_SETTING -DASUKA_OS_LINUX -Icommon -Isrc -lX11 -lasound -pthread
@@ -6,6 +6,7 @@
 #include <os/file.hpp>
 #include <allocator.hpp>
 #include <tprint.hpp>
+#include <acf/acf_types.hpp>
 
 #include <initializer_list>
 
@@ -61,39 +62,6 @@
 
 GLOBAL memory::mallocator acf_mallocator = { "acf_alloc" };
 
-enum class acf_type_t
-{
-    null = 0,
-    boolean,
-    integer,
-    floating,
-    string,
-    object,
-    array,
-    custom,
-    type,
-};
-
-INTERNAL
-char const *get_acf_type_string(acf_type_t type)
-{
-    switch (type)
-    {
-        case acf_type_t::null: return "null";
-        case acf_type_t::boolean: return "bool";
-        case acf_type_t::integer: return "int";
-        case acf_type_t::floating: return "float";
-        case acf_type_t::string: return "string";
-        case acf_type_t::object: return "object";
-        case acf_type_t::array: return "array";
-        case acf_type_t::custom: return "custom";
-        case acf_type_t::type: return "type";
-    }
-
-    return "<none>";
-}
-
-
 struct acf
 {
     using acf_allocator_t = memory::mallocator;
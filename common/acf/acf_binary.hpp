@@ -0,0 +1,720 @@
+#ifndef ACF_BINARY_HPP
+#define ACF_BINARY_HPP
+
+#include <defines.hpp>
+#include <acf/acf_document.hpp>
+
+
+/*
+    ACF Binary
+
+    Binary encoding of the ACF document, which is read in place: the reader
+    works straight on the memory mapped file and returns views into it, so
+    loading the config costs only the page faults on the parts which are
+    actually read.
+
+    Every value is a record of 32-bit words, referenced by its offset from
+    the beginning of the blob. The first word is the tag (acf_type_t) in the
+    low byte, small values are kept in the upper bytes:
+
+        null      [ tag ]
+        boolean   [ tag | value << 8 ]
+        type      [ tag | type << 8 ]
+        integer   [ tag ][ 0 ][ int64   ]            aligned to 8
+        floating  [ tag ][ 0 ][ float64 ]            aligned to 8
+        string    [ tag ][ size ][ chars ... 0 ]
+        array     [ tag ][ count ][ value offsets ... ]
+        custom    [ tag | newtype << 8 ][ count ][ value offsets ... ]
+        object    [ tag ][ count ][ { key offset, value offset } ... ][ hash index ]
+
+        key       [ hash ][ size ][ chars ... 0 ]
+
+    Keys keep their hash from the document, and objects with
+    ACF_OBJECT_INDEX_THRESHOLD keys or more keep the same hash index as in the
+    document (see acf_document.hpp), so lookups by ACF_KEY work the same way.
+    Strings and keys are zero-terminated, but the terminator is not counted
+    in the size.
+
+    The blob starts with the header, followed by the newtype table, and the
+    newtype declarations are kept, so custom values round-trip exactly:
+
+     ┌────────┬───────────────────┬──────────────────────────────────────┐
+     │ header │ newtypes          │ records ...                          │
+     └────────┴───────────────────┴──────────────────────────────────────┘
+
+    All numbers are little-endian. Records are aligned, so blobs have to be
+    loaded at 8-byte aligned addresses (mapped files always are).
+
+    open_acf_binary checks only the header, because reading through offsets
+    is what makes it zero-copy. Blobs which come from untrusted sources
+    should be checked with verify_acf_binary first, which walks all records.
+
+    Usage:
+
+        usize size = write_acf_binary(&document, NULL, 0); // Measure.
+        void *buffer = malloc(size);
+        write_acf_binary(&document, buffer, size);
+
+        os::mapped_file file = os::map_file("config.acfb");
+
+        acf_binary binary;
+        if (open_acf_binary(&binary, file.data, file.size))
+        {
+            int64 width = binary.root["window"]["width"].get_int();
+        }
+*/
+
+
+#define ACF_BINARY_MAGIC     0x42464341 // "ACFB"
+#define ACF_BINARY_VERSION   1
+#define ACF_BINARY_MAX_DEPTH 256
+
+
+struct acf_binary_header
+{
+    u32 magic;
+    u32 version;
+    u32 size;
+    u32 root;
+    u32 newtype_count;
+    u32 newtypes;
+};
+
+
+struct acf_binary_newtype
+{
+    u32 name; // @note: Offset of the string record.
+    u32 argument_count;
+    u8 arguments[ACF_MAX_NEWTYPE_ARGUMENTS];
+};
+
+
+struct acf_binary_entry
+{
+    u32 key;
+    u32 value;
+};
+
+
+// @note: View of one record. Default value (base is NULL) is the null value, which is
+// returned for missing keys and out of bounds indices, so lookups can be chained.
+struct acf_binary_value
+{
+    memory::byte const *base;
+    u32 offset;
+
+    u32 word(u32 index) const { return ((u32 const *) (base + offset))[index]; }
+
+    acf_type_t type() const { return base ? (acf_type_t) (word(0) & 0xFF) : acf_type_t::null; }
+
+    bool is_null() const noexcept { return (type() == acf_type_t::null); }
+    bool is_boolean() const noexcept { return (type() == acf_type_t::boolean); }
+    bool is_integer() const noexcept { return (type() == acf_type_t::integer); }
+    bool is_floating() const noexcept { return (type() == acf_type_t::floating); }
+    bool is_string() const noexcept { return (type() == acf_type_t::string); }
+    bool is_array() const noexcept { return (type() == acf_type_t::array); }
+    bool is_object() const noexcept { return (type() == acf_type_t::object); }
+    bool is_custom() const noexcept { return (type() == acf_type_t::custom); }
+    bool is_type() const noexcept { return (type() == acf_type_t::type); }
+
+    bool get_bool() const { ASSERT(is_boolean()); return (word(0) >> 8) != 0; }
+    int64 get_int() const { ASSERT(is_integer()); return *(int64 const *) (base + offset + 8); }
+    float64 get_float() const { ASSERT(is_floating()); return *(float64 const *) (base + offset + 8); }
+    acf_type_t get_type() const { ASSERT(is_type()); return (acf_type_t) (word(0) >> 8); }
+    acf_string_view get_string() const { ASSERT(is_string()); return { (char const *) (base + offset + 8), word(1) }; }
+    acf_string_view get_custom_type_name() const;
+
+    int64 get_int_or(int64 fallback) const { return is_integer() ? get_int() : fallback; }
+    float64 get_float_or(float64 fallback) const { return is_floating() ? get_float() : (is_integer() ? (float64) get_int() : fallback); }
+
+    u32 size() const
+    {
+        u32 result = (is_array() || is_object() || is_custom()) ? word(1) : 0;
+        return result;
+    }
+
+    acf_key get_key(u32 index) const;
+
+    acf_binary_value operator [] (int32 index) const;
+    acf_binary_value operator [] (char const *key) const;
+    acf_binary_value operator [] (acf_key key) const;
+};
+
+
+struct acf_binary
+{
+    memory::byte const *data;
+    usize size;
+
+    acf_binary_header const *header;
+    acf_binary_value root;
+};
+
+
+INLINE
+acf_key get_acf_binary_key(memory::byte const *base, u32 offset)
+{
+    u32 const *record = (u32 const *) (base + offset);
+
+    acf_key result = { (char const *) (record + 2), record[1], record[0] };
+    return result;
+}
+
+
+INLINE
+acf_string_view acf_binary_value::get_custom_type_name() const
+{
+    ASSERT(is_custom());
+
+    acf_binary_header const *header = (acf_binary_header const *) base;
+    acf_binary_newtype const *newtypes = (acf_binary_newtype const *) (base + header->newtypes);
+
+    acf_binary_value name = { base, newtypes[word(0) >> 8].name };
+    return name.get_string();
+}
+
+
+INLINE
+acf_key acf_binary_value::get_key(u32 index) const
+{
+    ASSERT(is_object() && index < word(1));
+
+    acf_binary_entry const *entries = (acf_binary_entry const *) (base + offset + 8);
+    return get_acf_binary_key(base, entries[index].key);
+}
+
+
+INLINE
+acf_binary_value acf_binary_value::operator [] (int32 index) const
+{
+    acf_binary_value result = {};
+    if ((is_array() || is_custom()) && ((u32) index < word(1)))
+    {
+        result = { base, word(2 + index) };
+    }
+    return result;
+}
+
+
+INLINE
+acf_binary_value acf_binary_value::operator [] (acf_key key) const
+{
+    acf_binary_value result = {};
+    if (is_object())
+    {
+        u32 count = word(1);
+        acf_binary_entry const *entries = (acf_binary_entry const *) (base + offset + 8);
+
+        u32 index_capacity = get_acf_object_index_capacity(count);
+        if (index_capacity)
+        {
+            u32 const *index = (u32 const *) (entries + count);
+            u32 mask = index_capacity - 1;
+            for (u32 slot = key.hash & mask; index[slot]; slot = (slot + 1) & mask)
+            {
+                acf_binary_entry entry = entries[index[slot] - 1];
+                if (get_acf_binary_key(base, entry.key) == key)
+                {
+                    result = { base, entry.value };
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for (u32 i = 0; i < count; i++)
+            {
+                if (get_acf_binary_key(base, entries[i].key) == key)
+                {
+                    result = { base, entries[i].value };
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+
+INLINE
+acf_binary_value acf_binary_value::operator [] (char const *key) const
+{
+    u32 key_size = 0;
+    while (key[key_size]) key_size += 1;
+
+    return (*this)[make_acf_key(key, key_size)];
+}
+
+
+// @note: Returns the size of the blob. If it is bigger than the capacity, the contents of the
+// buffer are not usable, so the buffer can be measured with write_acf_binary(document, NULL, 0).
+usize write_acf_binary(acf_document const *document, void *buffer, usize capacity);
+
+bool open_acf_binary(acf_binary *binary, void const *data, usize size);
+bool verify_acf_binary(void const *data, usize size);
+
+// @note: Builds the document from the blob. Strings, keys and newtype names point into
+// the blob, so it has to outlive the document; keys and newtype names are in the string
+// table instead, if the document has one.
+bool load_acf_binary_document(acf_document *document, acf_binary const *binary);
+
+
+#ifdef ACF_LIB_IMPLEMENTATION
+
+
+struct acf_binary_writer
+{
+    acf_document const *document;
+
+    memory::byte *buffer; // @note: NULL when only measuring.
+    usize capacity;
+    usize size;
+};
+
+
+// @note: Reserves zeroed space for the record, and returns its offset.
+INTERNAL
+u32 acf_binary_reserve(acf_binary_writer *writer, usize size, usize alignment)
+{
+    usize offset = (writer->size + alignment - 1) & ~(alignment - 1);
+    if (writer->buffer && (offset + size <= writer->capacity))
+    {
+        memory::set(writer->buffer + writer->size, 0, offset + size - writer->size);
+    }
+
+    writer->size = offset + size;
+    return (u32) offset;
+}
+
+
+INTERNAL
+void acf_binary_put(acf_binary_writer *writer, usize offset, void const *data, usize size)
+{
+    if (writer->buffer && (offset + size <= writer->capacity))
+    {
+        memory::copy(writer->buffer + offset, data, size);
+    }
+}
+
+
+INTERNAL
+void acf_binary_put_u32(acf_binary_writer *writer, usize offset, u32 value)
+{
+    acf_binary_put(writer, offset, &value, sizeof(value));
+}
+
+
+INTERNAL
+u32 acf_binary_write_string(acf_binary_writer *writer, u32 first_word, char const *data, u32 size)
+{
+    u32 offset = acf_binary_reserve(writer, 8 + size + 1, 4);
+    acf_binary_put_u32(writer, offset, first_word);
+    acf_binary_put_u32(writer, offset + 4, size);
+    acf_binary_put(writer, offset + 8, data, size);
+    return offset;
+}
+
+
+INTERNAL
+u32 find_acf_binary_newtype_index(acf_document const *document, acf_string_view *name)
+{
+    for (u32 newtype_index = 0; newtype_index < document->newtype_count; newtype_index++)
+    {
+        if ((document->newtypes[newtype_index].name == name) || (*document->newtypes[newtype_index].name == *name))
+        {
+            return newtype_index;
+        }
+    }
+
+    ASSERT_FAIL("Custom value of the newtype which is not declared in the document.");
+    return 0;
+}
+
+
+INTERNAL
+u32 acf_binary_write_value(acf_binary_writer *writer, acf_node const& node)
+{
+    u32 tag = (u32) node.type;
+    u32 offset = 0;
+
+    switch (node.type)
+    {
+        case acf_type_t::null:
+        {
+            offset = acf_binary_reserve(writer, 4, 4);
+            acf_binary_put_u32(writer, offset, tag);
+        }
+        break;
+
+        case acf_type_t::boolean:
+        {
+            offset = acf_binary_reserve(writer, 4, 4);
+            acf_binary_put_u32(writer, offset, tag | ((u32) node.boolean_value << 8));
+        }
+        break;
+
+        case acf_type_t::type:
+        {
+            offset = acf_binary_reserve(writer, 4, 4);
+            acf_binary_put_u32(writer, offset, tag | ((u32) node.type_value << 8));
+        }
+        break;
+
+        case acf_type_t::integer:
+        case acf_type_t::floating:
+        {
+            offset = acf_binary_reserve(writer, 16, 8);
+            acf_binary_put_u32(writer, offset, tag);
+            acf_binary_put(writer, offset + 8, &node.integer_value, 8); // @note: Same bytes for both members of the union.
+        }
+        break;
+
+        case acf_type_t::string:
+        {
+            offset = acf_binary_write_string(writer, tag, node.string_value, node.count);
+        }
+        break;
+
+        case acf_type_t::array:
+        case acf_type_t::custom:
+        {
+            if (node.is_custom())
+            {
+                tag |= find_acf_binary_newtype_index(writer->document, node.newtype_name) << 8;
+            }
+
+            offset = acf_binary_reserve(writer, 8 + node.count * sizeof(u32), 4);
+            acf_binary_put_u32(writer, offset, tag);
+            acf_binary_put_u32(writer, offset + 4, node.count);
+
+            for (u32 i = 0; i < node.count; i++)
+            {
+                u32 child = acf_binary_write_value(writer, node.children[i]);
+                acf_binary_put_u32(writer, offset + 8 + i * sizeof(u32), child);
+            }
+        }
+        break;
+
+        case acf_type_t::object:
+        {
+            u32 index_capacity = get_acf_object_index_capacity(node.count);
+            usize entries_size = node.count * sizeof(acf_binary_entry);
+
+            offset = acf_binary_reserve(writer, 8 + entries_size + index_capacity * sizeof(u32), 4);
+            acf_binary_put_u32(writer, offset, tag);
+            acf_binary_put_u32(writer, offset + 4, node.count);
+
+            // @note: Positions of keys are the same as in the document, so its index is copied as is.
+            if (index_capacity)
+            {
+                acf_binary_put(writer, offset + 8 + entries_size, node.keys + node.count, index_capacity * sizeof(u32));
+            }
+
+            for (u32 i = 0; i < node.count; i++)
+            {
+                acf_key key = node.keys[i];
+
+                acf_binary_entry entry;
+                entry.key = acf_binary_write_string(writer, key.hash, key.data, key.size);
+                entry.value = acf_binary_write_value(writer, node.children[i]);
+                acf_binary_put(writer, offset + 8 + i * sizeof(acf_binary_entry), &entry, sizeof(entry));
+            }
+        }
+        break;
+    }
+
+    return offset;
+}
+
+
+usize write_acf_binary(acf_document const *document, void *buffer, usize capacity)
+{
+    acf_binary_writer writer = {};
+    writer.document = document;
+    writer.buffer = (memory::byte *) buffer;
+    writer.capacity = capacity;
+
+    acf_binary_header header = {};
+    header.magic = ACF_BINARY_MAGIC;
+    header.version = ACF_BINARY_VERSION;
+    header.newtype_count = document->newtype_count;
+
+    acf_binary_reserve(&writer, sizeof(acf_binary_header), 8);
+    header.newtypes = acf_binary_reserve(&writer, document->newtype_count * sizeof(acf_binary_newtype), 4);
+
+    for (u32 newtype_index = 0; newtype_index < document->newtype_count; newtype_index++)
+    {
+        acf_newtype const *newtype = document->newtypes + newtype_index;
+
+        acf_binary_newtype entry = {};
+        entry.name = acf_binary_write_string(&writer, (u32) acf_type_t::string, newtype->name->data, newtype->name->size);
+        entry.argument_count = newtype->argument_count;
+        for (u32 i = 0; i < newtype->argument_count; i++)
+        {
+            entry.arguments[i] = (u8) newtype->arguments[i];
+        }
+
+        acf_binary_put(&writer, header.newtypes + newtype_index * sizeof(acf_binary_newtype), &entry, sizeof(entry));
+    }
+
+    header.root = acf_binary_write_value(&writer, document->root);
+
+    // @note: Size is rounded up, so blobs can be placed one after another.
+    acf_binary_reserve(&writer, 0, 8);
+    header.size = (u32) writer.size;
+    acf_binary_put(&writer, 0, &header, sizeof(header));
+
+    ASSERT_MSG(writer.size <= UINT32_MAX, "ACF binary is limited to 4 GB, because offsets are 32-bit.");
+    return writer.size;
+}
+
+
+bool open_acf_binary(acf_binary *binary, void const *data, usize size)
+{
+    *binary = {};
+
+    acf_binary_header const *header = (acf_binary_header const *) data;
+    if ((data == NULL) || (size < sizeof(acf_binary_header)) || ((usize) data & 7)) return false;
+    if ((header->magic != ACF_BINARY_MAGIC) || (header->version != ACF_BINARY_VERSION)) return false;
+    if ((header->size > size) || ((usize) header->root + 4 > header->size)) return false;
+    if ((header->newtype_count > ACF_MAX_NEWTYPES) || (header->newtypes & 3) || (header->newtypes < sizeof(acf_binary_header))) return false;
+    if ((usize) header->newtypes + (usize) header->newtype_count * sizeof(acf_binary_newtype) > header->size) return false;
+
+    binary->data = (memory::byte const *) data;
+    binary->size = header->size;
+    binary->header = header;
+    binary->root = { binary->data, header->root };
+    return true;
+}
+
+
+// @note: Records are checked in the order they are written, every one has to start after the
+// previous one ends. So records can not be shared or form cycles, and the check is linear.
+INTERNAL
+bool verify_acf_binary_string(acf_binary const *binary, u32 offset, usize *cursor)
+{
+    if ((offset < *cursor) || (offset & 3) || ((usize) offset + 8 > binary->size)) return false;
+
+    u32 const *record = (u32 const *) (binary->data + offset);
+    usize end = (usize) offset + 8 + record[1] + 1;
+    if ((end > binary->size) || (binary->data[end - 1] != 0)) return false;
+
+    *cursor = end;
+    return true;
+}
+
+
+INTERNAL
+bool verify_acf_binary_value(acf_binary const *binary, u32 offset, u32 depth, usize *cursor)
+{
+    if ((depth > ACF_BINARY_MAX_DEPTH) || (offset < *cursor) || (offset & 3) || ((usize) offset + 4 > binary->size)) return false;
+
+    acf_binary_value value = { binary->data, offset };
+    u32 data = value.word(0) >> 8;
+    *cursor = (usize) offset + 4;
+
+    switch (value.type())
+    {
+        case acf_type_t::null:     return (data == 0);
+        case acf_type_t::boolean:  return (data <= 1);
+        case acf_type_t::type:     return (data <= (u32) acf_type_t::type);
+
+        case acf_type_t::string:
+        {
+            *cursor = offset; // @note: The string check covers the whole record.
+            return (data == 0) && verify_acf_binary_string(binary, offset, cursor);
+        }
+
+        case acf_type_t::integer:
+        case acf_type_t::floating:
+        {
+            *cursor = (usize) offset + 16;
+            return (data == 0) && ((offset & 7) == 0) && (*cursor <= binary->size);
+        }
+
+        case acf_type_t::array:
+        case acf_type_t::custom:
+        {
+            if (value.is_array() ? (data != 0) : (data >= binary->header->newtype_count)) return false;
+            if ((usize) offset + 8 > binary->size) return false;
+
+            u32 count = value.word(1);
+            *cursor = (usize) offset + 8 + (usize) count * sizeof(u32);
+            if (*cursor > binary->size) return false;
+
+            for (u32 i = 0; i < count; i++)
+            {
+                if (!verify_acf_binary_value(binary, value.word(2 + i), depth + 1, cursor)) return false;
+            }
+        }
+        return true;
+
+        case acf_type_t::object:
+        {
+            if ((data != 0) || ((usize) offset + 8 > binary->size)) return false;
+
+            u32 count = value.word(1);
+            u32 index_capacity = get_acf_object_index_capacity(count);
+            *cursor = (usize) offset + 8 + (usize) count * sizeof(acf_binary_entry) + (usize) index_capacity * sizeof(u32);
+            if (*cursor > binary->size) return false;
+
+            // @note: Lookups stop at the empty slot, so the index must have one.
+            acf_binary_entry const *entries = (acf_binary_entry const *) (binary->data + offset + 8);
+            u32 const *index = (u32 const *) (entries + count);
+            bool has_empty_slot = (index_capacity == 0);
+            for (u32 slot = 0; slot < index_capacity; slot++)
+            {
+                if (index[slot] > count) return false;
+                if (index[slot] == 0) has_empty_slot = true;
+            }
+            if (!has_empty_slot) return false;
+
+            for (u32 i = 0; i < count; i++)
+            {
+                if (!verify_acf_binary_string(binary, entries[i].key, cursor)) return false;
+                if (!verify_acf_binary_value(binary, entries[i].value, depth + 1, cursor)) return false;
+            }
+        }
+        return true;
+
+        default: return false;
+    }
+}
+
+
+bool verify_acf_binary(void const *data, usize size)
+{
+    acf_binary binary;
+    if (!open_acf_binary(&binary, data, size)) return false;
+
+    usize cursor = binary.header->newtypes + binary.header->newtype_count * sizeof(acf_binary_newtype);
+
+    acf_binary_newtype const *newtypes = (acf_binary_newtype const *) (binary.data + binary.header->newtypes);
+    for (u32 newtype_index = 0; newtype_index < binary.header->newtype_count; newtype_index++)
+    {
+        if (!verify_acf_binary_string(&binary, newtypes[newtype_index].name, &cursor)) return false;
+        if (newtypes[newtype_index].argument_count > ACF_MAX_NEWTYPE_ARGUMENTS) return false;
+        if (binary.data[newtypes[newtype_index].name] != (memory::byte) acf_type_t::string) return false;
+    }
+
+    return verify_acf_binary_value(&binary, binary.header->root, 0, &cursor);
+}
+
+
+INTERNAL
+bool load_acf_binary_value(acf_document *document, acf_binary_value value, acf_node *result)
+{
+    memory::arena_allocator *arena = &document->arena;
+
+    *result = {};
+    result->type = value.type();
+
+    switch (result->type)
+    {
+        case acf_type_t::null:     break;
+        case acf_type_t::boolean:  result->boolean_value = value.get_bool(); break;
+        case acf_type_t::integer:  result->integer_value = value.get_int(); break;
+        case acf_type_t::floating: result->floating_value = value.get_float(); break;
+        case acf_type_t::type:     result->type_value = value.get_type(); break;
+
+        case acf_type_t::string:
+        {
+            acf_string_view string = value.get_string();
+            result->string_value = string.data;
+            result->count = string.size;
+        }
+        break;
+
+        case acf_type_t::array:
+        case acf_type_t::object:
+        case acf_type_t::custom:
+        {
+            result->count = value.size();
+            if (result->is_custom())
+            {
+                result->newtype_name = document->newtypes[value.word(0) >> 8].name;
+            }
+
+            if (result->count == 0) break;
+
+            result->children = ALLOCATE_BUFFER_(arena, acf_node, result->count);
+            if (result->children == NULL) return false;
+
+            if (result->is_object())
+            {
+                u32 index_capacity = get_acf_object_index_capacity(result->count);
+                usize size = result->count * sizeof(acf_key) + index_capacity * sizeof(u32);
+
+                result->keys = (acf_key *) ALLOCATE_(arena, size, alignof(acf_key));
+                if (result->keys == NULL) return false;
+
+                acf_binary_entry const *entries = (acf_binary_entry const *) (value.base + value.offset + 8);
+                for (u32 i = 0; i < result->count; i++)
+                {
+                    result->keys[i] = get_acf_binary_key(value.base, entries[i].key);
+                    if (!intern_acf_document_string(document, &result->keys[i].data, result->keys[i].size, result->keys[i].hash)) return false;
+                    if (!load_acf_binary_value(document, { value.base, entries[i].value }, result->children + i)) return false;
+                }
+
+                if (index_capacity)
+                {
+                    memory::copy(result->keys + result->count, entries + result->count, index_capacity * sizeof(u32));
+                }
+            }
+            else
+            {
+                for (u32 i = 0; i < result->count; i++)
+                {
+                    if (!load_acf_binary_value(document, value[i], result->children + i)) return false;
+                }
+            }
+        }
+        break;
+    }
+
+    return true;
+}
+
+
+bool load_acf_binary_document(acf_document *document, acf_binary const *binary)
+{
+    document->source = (char const *) binary->data;
+    document->source_size = binary->size;
+    document->root = {};
+    truncate_acf_document_newtypes(document, 0);
+    document->has_error = false;
+    document->error_buffer[0] = 0;
+
+    acf_binary_newtype const *newtypes = (acf_binary_newtype const *) (binary->data + binary->header->newtypes);
+    for (u32 newtype_index = 0; newtype_index < binary->header->newtype_count; newtype_index++)
+    {
+        acf_binary_newtype entry = newtypes[newtype_index];
+
+        acf_string_view *name = ALLOCATE_STRUCT_(&document->arena, acf_string_view);
+        if (name == NULL) return false;
+        *name = acf_binary_value{ binary->data, entry.name }.get_string();
+
+        if (!intern_acf_document_string(document, &name->data, name->size, hash_acf_key(name->data, name->size))) return false;
+
+        acf_newtype *newtype = add_acf_document_newtype(document, name);
+        newtype->argument_count = entry.argument_count;
+        for (u32 i = 0; i < entry.argument_count; i++)
+        {
+            newtype->arguments[i] = (acf_type_t) entry.arguments[i];
+        }
+    }
+
+    if (!load_acf_binary_value(document, binary->root, &document->root))
+    {
+        document->root = {};
+        document->has_error = true;
+        snprintf(document->error_buffer, sizeof(document->error_buffer), "Document arena is out of memory (%llu bytes).", (unsigned long long) document->arena.size);
+        return false;
+    }
+
+    return true;
+}
+
+
+#endif // ACF_LIB_IMPLEMENTATION
+#endif // ACF_BINARY_HPP
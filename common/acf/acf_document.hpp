@@ -0,0 +1,1981 @@
+#ifndef ACF_DOCUMENT_HPP
+#define ACF_DOCUMENT_HPP
+
+#include <defines.hpp>
+#include <allocator.hpp>
+#include <acf/acf_types.hpp>
+
+// Standard headers
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    ACF Document
+
+    Arena-backed version of the ACF tree. The whole document, its nodes, key
+    lists and newtype names, lives in one arena allocator, so:
+
+        - parsing does not call malloc for nodes or strings;
+        - children of an array, object or constructor call lie contiguously;
+        - strings and keys are views into the source buffer (no escapes are
+          supported by the format yet, so there is nothing to unescape);
+        - freeing the document is O(1) - the arena is just reset.
+
+    The source buffer has to outlive the document.
+
+    Containers are collected on the scratch stack while they are parsed, and
+    copied into the arena in one piece when their closing bracket is met, so
+    nothing is ever reallocated inside the arena. The scratch stack grows down
+    from the end of the same arena memory, so parsing does not touch any
+    memory besides the document's:
+
+     ┌───────────────────────────┬──────────────────────┬──────────────────┐
+     │ committed nodes and keys  │ free                 │ <── scratch      │
+     └───────────────────────────┴──────────────────────┴──────────────────┘
+      memory                      memory + used          scratch top        memory + size
+
+      acf_node (object)            keys                 children
+     ┌────────┬───────┬──────┐    ┌──────┬──────┬─    ┌────────┬────────┬─
+     │ object │ count │ ptrs ├───>│ "a"  │ "b"  │ ... │ node a │ node b │ ...
+     └────────┴───────┴──────┘    └──────┴──────┴─    └────────┴────────┴─
+
+    Objects with ACF_OBJECT_INDEX_THRESHOLD keys or more get a small hash
+    index, which is placed right after their keys. Every key stores its hash,
+    computed once at parse time, and the index maps hashes to key positions,
+    so the keys and children keep the order they had in the source:
+
+      keys                                      index (capacity = pow2 >= 2 * count)
+     ┌────────────┬────────────┬─    ┬─────┐   ┌───┬───┬───┬───┬───┬───┬───┬───┬─
+     │ "a", hash  │ "b", hash  │ ... │     │   │ 0 │ 2 │ 0 │ 1 │ 0 │ 0 │ 3 │...│   0 = empty, i + 1 = keys[i]
+     └────────────┴────────────┴─    ┴─────┘   └───┴───┴───┴───┴───┴───┴───┴───┴─
+
+    Hot code can hash known keys at compile time with ACF_KEY("name").
+
+    Usage:
+
+        acf_document document;
+        initialize_acf_document(&document, memory, size);
+
+        if (parse_acf_document(&document, source, source_size))
+        {
+            int64 width = document.root["window"]["width"].get_int();
+        }
+        else
+        {
+            osOutputDebugString("%s\n", document.error_buffer);
+        }
+
+        reset_acf_document(&document); // Frees everything at once.
+*/
+
+
+#define ACF_MAX_NEWTYPES          32
+#define ACF_MAX_NEWTYPE_ARGUMENTS 4
+
+// @note: Root object, objects, arrays and constructor calls take one level each. Same limit
+// for parse_acf_document and the stream (see acf_stream.hpp), so both take the same sources.
+#ifndef ACF_MAX_DEPTH
+#define ACF_MAX_DEPTH 64
+#endif
+
+
+struct acf_string_view
+{
+    char const *data;
+    u32 size;
+
+    bool operator == (char const *s) const
+    {
+        for (u32 i = 0; i < size; i++)
+        {
+            if (s[i] != data[i]) return false; // @note: Covers s[i] == 0 too.
+        }
+        return s[size] == 0;
+    }
+
+    bool operator != (char const *s) const { return !(*this == s); }
+};
+
+INLINE
+bool operator == (acf_string_view a, acf_string_view b)
+{
+    if (a.size != b.size) return false;
+    if (a.data == b.data) return true; // @note: Interned strings are compared by pointer.
+    for (u32 i = 0; i < a.size; i++)
+    {
+        if (a.data[i] != b.data[i]) return false;
+    }
+    return true;
+}
+
+
+#define ACF_OBJECT_INDEX_THRESHOLD 8
+#define ACF_SHAPE_CACHE_SIZE       64
+
+
+// @note: Little-endian load of up to 8 bytes, written so it is constexpr; compilers merge it into one load.
+constexpr u64 load_acf_key_word(char const *data, u32 size)
+{
+    u64 result = 0;
+    for (u32 i = 0; i < size; i++)
+    {
+        result |= (u64) (u8) data[i] << (8 * i);
+    }
+    return result;
+}
+
+
+// @note: Hashes the key 8 bytes at a time (byte-at-a-time FNV was the most expensive part of
+// parsing wide objects). Constexpr, so keys known at compile time are hashed by the compiler.
+constexpr u32 hash_acf_key(char const *data, u32 size)
+{
+    u64 result = 0x9e3779b97f4a7c15ull ^ size;
+
+    u32 i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        result = (result ^ load_acf_key_word(data + i, 8)) * 0xff51afd7ed558ccdull;
+        result ^= result >> 32;
+    }
+    if (i < size)
+    {
+        result = (result ^ load_acf_key_word(data + i, size - i)) * 0xff51afd7ed558ccdull;
+        result ^= result >> 32;
+    }
+
+    result *= 0xc4ceb9fe1a85ec53ull;
+    result ^= result >> 29;
+    return (u32) result;
+}
+
+
+struct acf_key
+{
+    char const *data;
+    u32 size;
+    u32 hash;
+
+    acf_string_view name() const { return { data, size }; }
+};
+
+
+template <usize N>
+constexpr acf_key make_acf_key(char const (&name)[N])
+{
+    return acf_key{ name, (u32) (N - 1), hash_acf_key(name, (u32) (N - 1)) };
+}
+
+
+// @note: ACF_KEY("name") is a key with the hash already computed, the lambda forces evaluation at compile time.
+#define ACF_KEY(NAME) ([]() { constexpr acf_key key_ = make_acf_key(NAME); return key_; }())
+
+
+INLINE
+acf_key make_acf_key(char const *data, u32 size)
+{
+    acf_key result = { data, size, hash_acf_key(data, size) };
+    return result;
+}
+
+
+INLINE
+u32 get_acf_object_index_capacity(u32 count)
+{
+    u32 result = 0;
+    if (count >= ACF_OBJECT_INDEX_THRESHOLD)
+    {
+        result = 1;
+        while (result < 2 * count) result *= 2;
+    }
+    return result;
+}
+
+
+struct acf_node
+{
+    acf_type_t type;
+    u32 count; // @note: Length of the string, or the number of children of the array, object or constructor call.
+
+    union
+    {
+        bool             boolean_value;
+        int64            integer_value;
+        float64          floating_value;
+        acf_type_t       type_value;
+        char const      *string_value;
+        acf_node        *children;
+    };
+
+    union
+    {
+        acf_key         *keys;         // object, followed by the hash index for big objects
+        acf_string_view *newtype_name; // custom
+    };
+
+    bool is_null() const noexcept { return (type == acf_type_t::null); }
+    bool is_boolean() const noexcept { return (type == acf_type_t::boolean); }
+    bool is_integer() const noexcept { return (type == acf_type_t::integer); }
+    bool is_floating() const noexcept { return (type == acf_type_t::floating); }
+    bool is_string() const noexcept { return (type == acf_type_t::string); }
+    bool is_array() const noexcept { return (type == acf_type_t::array); }
+    bool is_object() const noexcept { return (type == acf_type_t::object); }
+    bool is_custom() const noexcept { return (type == acf_type_t::custom); }
+    bool is_type() const noexcept { return (type == acf_type_t::type); }
+
+    bool get_bool() const { ASSERT(is_boolean()); return boolean_value; }
+    int64 get_int() const { ASSERT(is_integer()); return integer_value; }
+    float64 get_float() const { ASSERT(is_floating()); return floating_value; }
+    acf_type_t get_type() const { ASSERT(is_type()); return type_value; }
+    acf_string_view get_string() const { ASSERT(is_string()); return { string_value, count }; }
+    acf_string_view get_custom_type_name() const { ASSERT(is_custom()); return *newtype_name; }
+
+    int64 get_int_or(int64 fallback) const { return is_integer() ? integer_value : fallback; }
+    float64 get_float_or(float64 fallback) const { return is_floating() ? floating_value : (is_integer() ? (float64) integer_value : fallback); }
+
+    u32 size() const
+    {
+        u32 result = (is_array() || is_object() || is_custom()) ? count : 0;
+        return result;
+    }
+
+    acf_string_view get_key(u32 index) const
+    {
+        ASSERT(is_object() && index < count);
+        return keys[index].name();
+    }
+
+    acf_node const& operator [] (int32 index) const;
+    acf_node const& operator [] (char const *key) const;
+    acf_node const& operator [] (acf_key key) const;
+    acf_node const *find(acf_key key) const;
+
+    acf_node const *begin() const { return (is_array() || is_object() || is_custom()) ? children : NULL; }
+    acf_node const *end() const { return (is_array() || is_object() || is_custom()) ? children + count : NULL; }
+};
+
+
+// @note: Missing keys and out of bounds indices return reference to this node,
+// so lookups can be chained without checks: root["a"]["b"][3].get_int_or(0)
+GLOBAL acf_node const acf_null_node = {};
+
+
+struct acf_newtype
+{
+    acf_string_view *name; // @note: Lives in the document's arena, custom nodes point to it.
+    u32 hash;
+    u32 argument_count;
+    acf_type_t arguments[ACF_MAX_NEWTYPE_ARGUMENTS];
+};
+
+
+/*
+    String interning
+
+    The table keeps one copy of every distinct string given to it, and maps
+    it to an id, which never changes and is never reused:
+
+      slots (open addressing on the hash)       entries (id - 1)           blocks
+     ┌───┬───┬───┬───┬───┬───┬───┬───┬─        ┌─────────────────────┐    ┌──────────────────────────┐
+     │ 0 │ 2 │ 0 │ 1 │ 0 │ 3 │ 0 │ 0 │...  ──> │ data, size, hash    ├──> │ "width\0height\0title\0" │
+     └───┴───┴───┴───┴───┴───┴───┴───┴─        └─────────────────────┘    └──────────────────────────┘
+
+    Strings are stored null-terminated in blocks which are never moved, so
+    interned data pointers are as unique as the ids: two interned strings
+    are equal exactly when their pointers are, and comparisons of interned
+    keys stop at the pointer compare.
+
+    Documents which are given a table (document->strings) intern their keys
+    and newtype names while parsing. Objects with the same list of interned
+    keys, like the records of an array, then share one key list and its hash
+    index, so a repeated schema is stored once instead of once per object.
+    The key lists are immutable after parsing, so sharing them is safe.
+
+    The table is not thread-safe, and it has to outlive every document which
+    points into it.
+*/
+
+struct acf_string_block
+{
+    acf_string_block *next;
+    usize used;
+    usize size;
+};
+
+
+struct acf_string_table
+{
+    acf_key *entries; // @note: Entry of the id is entries[id - 1].
+    u32 count;
+    u32 capacity;
+
+    u32 *slots; // @note: 0 is empty, id otherwise.
+    u32 slot_capacity;
+
+    acf_string_block *blocks;
+};
+
+
+// @note: Returns the id of the string, adding it to the table if it is not there yet, or 0 if out of memory.
+u32 intern_acf_string(acf_string_table *table, acf_key key);
+// @note: Returns 0 if the string is not in the table.
+u32 find_acf_string(acf_string_table const *table, acf_key key);
+acf_key get_acf_string(acf_string_table const *table, u32 id);
+void free_acf_string_table(acf_string_table *table);
+
+
+struct acf_document
+{
+    memory::arena_allocator arena;
+    acf_string_table *strings; // @note: Optional, keys and newtype names are interned into it.
+
+    char const *source;
+    usize source_size;
+
+    acf_node root;
+
+    u32 newtype_count;
+    acf_newtype newtypes[ACF_MAX_NEWTYPES];
+    u8 newtype_slots[2 * ACF_MAX_NEWTYPES]; // @note: Hash index of the newtypes by name, 0 is empty, i + 1 otherwise.
+
+    b32 has_error;
+    u32 error_line;
+    u32 error_column;
+    char error_buffer[512];
+};
+
+
+INLINE
+acf_node const& acf_node::operator [] (int32 index) const
+{
+    if ((is_array() || is_custom()) && ((u32) index < count))
+    {
+        return children[index];
+    }
+
+    return acf_null_node;
+}
+
+
+INLINE
+bool operator == (acf_key const& a, acf_key const& b)
+{
+    return (a.hash == b.hash) && (a.name() == b.name());
+}
+
+
+INLINE
+acf_node const *acf_node::find(acf_key key) const
+{
+    if (is_object())
+    {
+        u32 index_capacity = get_acf_object_index_capacity(count);
+        if (index_capacity)
+        {
+            u32 const *index = (u32 const *) (keys + count);
+            u32 mask = index_capacity - 1;
+            for (u32 slot = key.hash & mask; index[slot]; slot = (slot + 1) & mask)
+            {
+                u32 key_index = index[slot] - 1;
+                if (keys[key_index] == key)
+                {
+                    return children + key_index;
+                }
+            }
+        }
+        else
+        {
+            for (u32 i = 0; i < count; i++)
+            {
+                if (keys[i] == key)
+                {
+                    return children + i;
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+INLINE
+acf_node const& acf_node::operator [] (acf_key key) const
+{
+    acf_node const *result = find(key);
+    return result ? *result : acf_null_node;
+}
+
+
+INLINE
+acf_node const& acf_node::operator [] (char const *key) const
+{
+    u32 key_size = 0;
+    while (key[key_size]) key_size += 1;
+
+    acf_node const *result = find(make_acf_key(key, key_size));
+    return result ? *result : acf_null_node;
+}
+
+
+// @note: Deep comparison. Objects are equal when they have the same keys in the same order.
+INLINE
+bool are_acf_nodes_equal(acf_node const& a, acf_node const& b)
+{
+    if (a.type != b.type) return false;
+
+    switch (a.type)
+    {
+        case acf_type_t::null: return true;
+        case acf_type_t::boolean: return a.boolean_value == b.boolean_value;
+        case acf_type_t::integer: return a.integer_value == b.integer_value;
+        case acf_type_t::floating: return a.floating_value == b.floating_value;
+        case acf_type_t::type: return a.type_value == b.type_value;
+        case acf_type_t::string: return a.get_string() == b.get_string();
+
+        case acf_type_t::array:
+        case acf_type_t::object:
+        case acf_type_t::custom:
+        {
+            if (a.count != b.count) return false;
+            if (a.is_custom() && !(*a.newtype_name == *b.newtype_name)) return false;
+
+            for (u32 i = 0; i < a.count; i++)
+            {
+                if (a.is_object() && !(a.get_key(i) == b.get_key(i))) return false;
+                if (!are_acf_nodes_equal(a.children[i], b.children[i])) return false;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void initialize_acf_document(acf_document *document, void *memory, usize size);
+void reset_acf_document(acf_document *document);
+// @note: Memory given to initialize stays with the caller, this gives back the debug allocation log of the arena.
+void release_acf_document(acf_document *document);
+bool parse_acf_document(acf_document *document, char const *source, usize source_size);
+bool register_acf_document_newtype(acf_document *document, char const *name, u32 argument_count, acf_type_t const *arguments);
+
+
+#ifdef ACF_LIB_IMPLEMENTATION
+
+
+enum class acf_document_token_type
+{
+    end_of_file = 0,
+    invalid,
+
+    identifier,
+    integer,
+    integer_out_of_range, // @note: Integer literal which does not fit in int64.
+    floating,
+    string,
+
+    keyword_null,
+    keyword_true,
+    keyword_false,
+    keyword_bool,
+    keyword_int,
+    keyword_float,
+    keyword_string,
+    keyword_array,
+    keyword_object,
+    keyword_type,
+
+    pound = '#',
+    parentheses_open = '(',
+    parentheses_close = ')',
+    comma = ',',
+    semicolon = ';',
+    equals = '=',
+    bracket_open = '[',
+    bracket_close = ']',
+    brace_open = '{',
+    brace_close = '}',
+};
+
+
+struct acf_document_token
+{
+    acf_document_token_type type;
+    u32 size;
+    char const *span;
+
+    union
+    {
+        int64 integer_value;
+        float64 floating_value;
+    };
+};
+
+
+struct acf_document_parser
+{
+    acf_document *document;
+
+    char const *at;
+    char const *end;
+
+    acf_document_token next_token;
+    bool next_token_valid;
+
+    // @note: Children of the containers which are not closed yet. Entry i is scratch_base[-1 - i].
+    struct scratch_entry
+    {
+        acf_key key; // @note: Only set for objects.
+        acf_node node;
+    };
+
+    scratch_entry *scratch_base;
+    u32 scratch_count;
+    usize arena_size; // @note: Size of the arena without the scratch stack.
+
+    u32 depth; // @note: Containers and constructor calls which are not closed yet, the root object included.
+
+    // @note: Array which was parsed already (see acf_parallel.hpp), it is taken as is when the parser meets its '['.
+    struct parsed_array
+    {
+        char const *span;
+        char const *end;
+        acf_node node;
+    };
+
+    parsed_array const *done_array;
+
+    // @note: Key lists of recent objects, by the hash of their keys. Only used with a string table,
+    // objects whose keys are the same interned pointers in the same order share one list.
+    struct shape
+    {
+        acf_key *keys;
+        u32 count;
+        u32 hash;
+    };
+
+    shape shapes[ACF_SHAPE_CACHE_SIZE];
+};
+
+
+INTERNAL bool acf_document_is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+INTERNAL bool acf_document_is_digit(char c) { return c >= '0' && c <= '9'; }
+INTERNAL bool acf_document_is_identifier_head(char c) { return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+INTERNAL bool acf_document_is_identifier_body(char c) { return acf_document_is_identifier_head(c) || acf_document_is_digit(c); }
+
+
+//
+// Lexer fast path
+//
+// Runs of whitespace, comment bodies, string bodies, identifiers and digits
+// are scanned a vector at a time: each byte of the vector is classified with
+// a few compares, and the first byte out of the class is found by the
+// movemask. The remainder, shorter than one vector, is done byte by byte.
+//
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define ACF_VECTOR_SIZE 32
+#define ACF_VECTOR_FULL_MASK 0xFFFFFFFFu
+typedef __m256i acf_vector_t;
+#define ACF_VECTOR_LOADU(POINTER)  _mm256_loadu_si256((__m256i const *) (POINTER))
+#define ACF_VECTOR_SET1(VALUE)     _mm256_set1_epi8((char) (VALUE))
+#define ACF_VECTOR_EQ(A, B)        _mm256_cmpeq_epi8(A, B)
+#define ACF_VECTOR_GT(A, B)        _mm256_cmpgt_epi8(A, B)
+#define ACF_VECTOR_OR(A, B)        _mm256_or_si256(A, B)
+#define ACF_VECTOR_AND(A, B)       _mm256_and_si256(A, B)
+#define ACF_VECTOR_MASK(V)         ((u32) _mm256_movemask_epi8(V))
+
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <immintrin.h>
+
+#define ACF_VECTOR_SIZE 16
+#define ACF_VECTOR_FULL_MASK 0xFFFFu
+typedef __m128i acf_vector_t;
+#define ACF_VECTOR_LOADU(POINTER)  _mm_loadu_si128((__m128i const *) (POINTER))
+#define ACF_VECTOR_SET1(VALUE)     _mm_set1_epi8((char) (VALUE))
+#define ACF_VECTOR_EQ(A, B)        _mm_cmpeq_epi8(A, B)
+#define ACF_VECTOR_GT(A, B)        _mm_cmpgt_epi8(A, B)
+#define ACF_VECTOR_OR(A, B)        _mm_or_si128(A, B)
+#define ACF_VECTOR_AND(A, B)       _mm_and_si128(A, B)
+#define ACF_VECTOR_MASK(V)         ((u32) _mm_movemask_epi8(V))
+
+#endif
+
+
+struct acf_space_class
+{
+    static bool scalar(char c) { return acf_document_is_space(c); }
+#ifdef ACF_VECTOR_SIZE
+    static acf_vector_t vector(acf_vector_t v)
+    {
+        acf_vector_t a = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1(' ')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('\t')));
+        acf_vector_t b = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('\r')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('\n')));
+        return ACF_VECTOR_OR(a, b);
+    }
+#endif
+};
+
+
+struct acf_digit_class
+{
+    static bool scalar(char c) { return acf_document_is_digit(c); }
+#ifdef ACF_VECTOR_SIZE
+    static acf_vector_t vector(acf_vector_t v)
+    {
+        return ACF_VECTOR_AND(ACF_VECTOR_GT(v, ACF_VECTOR_SET1('0' - 1)), ACF_VECTOR_GT(ACF_VECTOR_SET1('9' + 1), v));
+    }
+#endif
+};
+
+
+struct acf_identifier_body_class
+{
+    static bool scalar(char c) { return acf_document_is_identifier_body(c); }
+#ifdef ACF_VECTOR_SIZE
+    static acf_vector_t vector(acf_vector_t v)
+    {
+        // @note: Bytes above 0x7F are negative, so they fail every range check.
+        acf_vector_t lower = ACF_VECTOR_OR(v, ACF_VECTOR_SET1(0x20));
+        acf_vector_t alpha = ACF_VECTOR_AND(ACF_VECTOR_GT(lower, ACF_VECTOR_SET1('a' - 1)), ACF_VECTOR_GT(ACF_VECTOR_SET1('z' + 1), lower));
+        acf_vector_t underscore = ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('_'));
+        return ACF_VECTOR_OR(ACF_VECTOR_OR(alpha, underscore), acf_digit_class::vector(v));
+    }
+#endif
+};
+
+
+struct acf_comment_body_class
+{
+    static bool scalar(char c) { return c != '\n'; }
+#ifdef ACF_VECTOR_SIZE
+    static acf_vector_t vector(acf_vector_t v)
+    {
+        return ACF_VECTOR_EQ(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('\n')), ACF_VECTOR_SET1(0));
+    }
+#endif
+};
+
+
+struct acf_string_body_class
+{
+    static bool scalar(char c) { return c != '"' && c != '\n'; }
+#ifdef ACF_VECTOR_SIZE
+    static acf_vector_t vector(acf_vector_t v)
+    {
+        acf_vector_t stop = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('"')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('\n')));
+        return ACF_VECTOR_EQ(stop, ACF_VECTOR_SET1(0));
+    }
+#endif
+};
+
+
+// @note: Returns the first character in [at, end) which is not in the class, or end.
+template <typename Class>
+INLINE
+char const *acf_scan_while(char const *at, char const *end)
+{
+#ifdef ACF_VECTOR_SIZE
+    while (at + ACF_VECTOR_SIZE <= end)
+    {
+        u32 mask = ACF_VECTOR_MASK(Class::vector(ACF_VECTOR_LOADU(at)));
+        if (mask != ACF_VECTOR_FULL_MASK)
+        {
+            return at + COUNT_TRAILING_ZEROS_U32(~mask);
+        }
+        at += ACF_VECTOR_SIZE;
+    }
+#endif
+
+    while (at < end && Class::scalar(*at)) at += 1;
+    return at;
+}
+
+
+INTERNAL
+void acf_document_report_error(acf_document_parser *parser, char const *location, char const *message, ...)
+{
+    acf_document *document = parser->document;
+    if (document->has_error) return; // @note: Only the first error is meaningful.
+
+    document->has_error = true;
+
+    // @note: Line and column are calculated only here, so the lexer does not track them on every character.
+    char const *line_start = document->source;
+    u32 line = 1;
+    for (char const *c = document->source; c < location; c++)
+    {
+        if (*c == '\n')
+        {
+            line += 1;
+            line_start = c + 1;
+        }
+    }
+
+    char const *line_end = line_start;
+    while (line_end < parser->end && *line_end != '\n' && *line_end != '\r') line_end += 1;
+
+    document->error_line = line;
+    document->error_column = (u32) (location - line_start) + 1;
+
+    int count = snprintf(document->error_buffer, sizeof(document->error_buffer), "%u:%u: ", document->error_line, document->error_column);
+
+    va_list args;
+    va_start(args, message);
+    if (count > 0 && count < (int) sizeof(document->error_buffer))
+    {
+        int n = vsnprintf(document->error_buffer + count, sizeof(document->error_buffer) - count, message, args);
+        if (n > 0) count += n;
+    }
+    va_end(args);
+
+    if (count > 0 && count < (int) sizeof(document->error_buffer))
+    {
+        snprintf(document->error_buffer + count, sizeof(document->error_buffer) - count,
+            "\n%.*s\n%*s^\n", (int) (line_end - line_start), line_start, (int) (location - line_start), "");
+    }
+}
+
+
+INTERNAL
+acf_document_token_type get_acf_document_keyword(char const *s, u32 size)
+{
+    // @note: Every keyword is 3 to 6 characters and starts with one of these letters, most identifiers are rejected here.
+    if ((size < 3) || (size > 6)) return acf_document_token_type::identifier;
+    switch (s[0])
+    {
+        case 'a': case 'b': case 'f': case 'i': case 'n': case 'o': case 's': case 't': break;
+        default: return acf_document_token_type::identifier;
+    }
+
+    struct keyword { char const *name; u32 size; acf_document_token_type type; };
+    GLOBAL keyword const keywords[] =
+    {
+        { "null",   4, acf_document_token_type::keyword_null },
+        { "true",   4, acf_document_token_type::keyword_true },
+        { "false",  5, acf_document_token_type::keyword_false },
+        { "bool",   4, acf_document_token_type::keyword_bool },
+        { "int",    3, acf_document_token_type::keyword_int },
+        { "float",  5, acf_document_token_type::keyword_float },
+        { "string", 6, acf_document_token_type::keyword_string },
+        { "array",  5, acf_document_token_type::keyword_array },
+        { "object", 6, acf_document_token_type::keyword_object },
+        { "type",   4, acf_document_token_type::keyword_type },
+    };
+
+    for (u32 keyword_index = 0; keyword_index < ARRAY_COUNT(keywords); keyword_index++)
+    {
+        if ((keywords[keyword_index].size == size) && (acf_string_view{ s, size } == keywords[keyword_index].name))
+        {
+            return keywords[keyword_index].type;
+        }
+    }
+
+    return acf_document_token_type::identifier;
+}
+
+
+// @note: Decimal rounds to the same double as its first 768 significant digits with one nonzero digit after them,
+// if any of the rest is nonzero, because no halfway point between doubles has more digits than that.
+#define ACF_DOCUMENT_MAX_FLOAT_DIGITS 768
+
+
+//
+// Writes the number as its significant digits and an exponent, which
+// strtod reads however many digits and zeros the span has:
+//
+//     000123.4500e-3  ->  1234500e-7
+//     0.<150 zeros>1  ->  1e-151
+//
+INTERNAL
+float64 acf_document_parse_long_float(char const *span, u32 size)
+{
+    char buffer[ACF_DOCUMENT_MAX_FLOAT_DIGITS + 32];
+    char const *at = span;
+    char const *end = span + size;
+
+    if (at < end && (*at == '-' || *at == '+')) at += 1; // @note: Sign is applied by the caller.
+
+    u32 digit_count = 0;
+    int64 exponent = 0;
+    bool nonzero_dropped = false;
+    for (bool fraction = false; at < end; at++)
+    {
+        if (*at == '.')
+        {
+            fraction = true;
+            continue;
+        }
+        if (!acf_document_is_digit(*at)) break;
+
+        if (digit_count == 0 && *at == '0')
+        {
+            exponent -= fraction;
+        }
+        else if (digit_count < ACF_DOCUMENT_MAX_FLOAT_DIGITS)
+        {
+            buffer[digit_count++] = *at;
+            exponent -= fraction;
+        }
+        else
+        {
+            nonzero_dropped = nonzero_dropped || (*at != '0');
+            exponent += !fraction;
+        }
+    }
+
+    if (digit_count == 0) return 0.0;
+
+    if (nonzero_dropped)
+    {
+        buffer[digit_count++] = '1';
+        exponent -= 1;
+    }
+
+    if (at < end && (*at == 'e' || *at == 'E'))
+    {
+        at += 1;
+        bool negative = (at < end && *at == '-');
+        if (at < end && (*at == '-' || *at == '+')) at += 1;
+
+        // @note: Anything above a few hundred is infinity or zero anyway, the clamp only keeps it from overflowing.
+        int64 written_exponent = 0;
+        for (; at < end && acf_document_is_digit(*at); at++)
+        {
+            if (written_exponent < 1000000000) written_exponent = written_exponent * 10 + (*at - '0');
+        }
+        exponent += negative ? -written_exponent : written_exponent;
+    }
+
+    snprintf(buffer + digit_count, sizeof(buffer) - digit_count, "e%lld", (long long) exponent);
+    float64 result = strtod(buffer, NULL);
+    return result;
+}
+
+
+INTERNAL
+float64 acf_document_parse_float(char const *span, u32 size, u64 mantissa, u32 digit_count, u32 fraction_digit_count)
+{
+    GLOBAL float64 const powers_of_ten[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    float64 result = 0;
+    // @note: Up to 19 digits the mantissa can not overflow u64; above that it wraps around, so it is not used at all.
+    if ((digit_count <= 19) && (mantissa < (1ull << 53)) && (fraction_digit_count < ARRAY_COUNT(powers_of_ten)))
+    {
+        // @note: Both operands are exact, so the division is correctly rounded.
+        result = (float64) mantissa / powers_of_ten[fraction_digit_count];
+    }
+    else
+    {
+        result = acf_document_parse_long_float(span, size);
+    }
+
+    return result;
+}
+
+
+// @note: Leading zeros do not count, so it is exact for any number of digits.
+INTERNAL
+bool acf_document_digits_overflow_u64(char const *at, char const *end)
+{
+    u64 value = 0;
+    for (; at < end; at++)
+    {
+        u64 digit = (u64) (*at - '0');
+        if (value > (UINT64_MAX - digit) / 10) return true;
+        value = value * 10 + digit;
+    }
+    return false;
+}
+
+
+INTERNAL
+acf_document_token acf_document_lex(char const *at, char const *end)
+{
+    // Skip whitespace and comments.
+    loop
+    {
+        // @note: Most runs of whitespace are one or two characters, check them before going wide.
+        if (at < end && acf_document_is_space(*at))
+        {
+            at += 1;
+            if (at < end && acf_document_is_space(*at))
+            {
+                at = acf_scan_while<acf_space_class>(at + 1, end);
+            }
+        }
+
+        if ((at + 1 < end) && (at[0] == '/') && (at[1] == '/'))
+        {
+            at = acf_scan_while<acf_comment_body_class>(at + 2, end);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    acf_document_token token = {};
+    token.span = at;
+
+    if (at == end || *at == 0)
+    {
+        token.type = acf_document_token_type::end_of_file;
+    }
+    else if (*at == '"')
+    {
+        at = acf_scan_while<acf_string_body_class>(at + 1, end);
+
+        if (at < end && *at == '"')
+        {
+            at += 1;
+            token.type = acf_document_token_type::string;
+        }
+        else
+        {
+            token.type = acf_document_token_type::invalid;
+        }
+    }
+    else if (acf_document_is_digit(*at) || *at == '-' || *at == '+')
+    {
+        bool negative = (*at == '-');
+        if (*at == '-' || *at == '+') at += 1;
+
+        u64 mantissa = 0;
+        u32 digit_count = 0;
+        u32 fraction_digit_count = 0;
+
+        char const *digits_begin = at;
+        char const *digits_end = acf_scan_while<acf_digit_class>(at, end);
+        for (; at < digits_end; at++)
+        {
+            mantissa = mantissa * 10 + (*at - '0');
+        }
+        digit_count = (u32) (digits_end - digits_begin);
+
+        // @note: Checked only when the mantissa could have wrapped around, 20 digits and more are rare.
+        bool integer_overflow = (digit_count > 19) && acf_document_digits_overflow_u64(digits_begin, digits_end);
+
+        bool is_floating = false;
+        if (at < end && *at == '.')
+        {
+            at += 1;
+
+            digits_end = acf_scan_while<acf_digit_class>(at, end);
+            fraction_digit_count = (u32) (digits_end - at);
+            digit_count += fraction_digit_count;
+
+            for (; at < digits_end; at++)
+            {
+                mantissa = mantissa * 10 + (*at - '0');
+            }
+
+            is_floating = true;
+        }
+
+        // @note: Exponent is taken only if it has digits, otherwise 'e' is left for the next token.
+        // At the end of the input it is not known yet, so the token is invalid there.
+        bool has_exponent = false;
+        if (at < end && (*at == 'e' || *at == 'E'))
+        {
+            char const *exponent = at + 1;
+            if (exponent < end && (*exponent == '-' || *exponent == '+')) exponent += 1;
+
+            if (exponent < end && acf_document_is_digit(*exponent))
+            {
+                at = acf_scan_while<acf_digit_class>(exponent, end);
+                has_exponent = true;
+            }
+            else if (exponent == end)
+            {
+                at = end;
+                digit_count = 0;
+            }
+        }
+
+        if (has_exponent)
+        {
+            // @note: Always correctly rounded by strtod, exponents are rare in configs.
+            float64 value = acf_document_parse_float(token.span, (u32) (at - token.span), UINT64_MAX, digit_count, 0);
+            token.type = acf_document_token_type::floating;
+            token.floating_value = negative ? -value : value;
+        }
+        else if (is_floating)
+        {
+            float64 value = acf_document_parse_float(token.span, (u32) (at - token.span), mantissa, digit_count, fraction_digit_count);
+            token.type = acf_document_token_type::floating;
+            token.floating_value = negative ? -value : value;
+        }
+        else if (integer_overflow || (mantissa > (negative ? (u64) INT64_MAX + 1 : (u64) INT64_MAX)))
+        {
+            token.type = acf_document_token_type::integer_out_of_range;
+        }
+        else
+        {
+            token.type = acf_document_token_type::integer;
+            token.integer_value = (int64) (negative ? 0 - mantissa : mantissa);
+        }
+
+        if (digit_count == 0)
+        {
+            token.type = acf_document_token_type::invalid;
+        }
+    }
+    else if (acf_document_is_identifier_head(*at))
+    {
+        at = acf_scan_while<acf_identifier_body_class>(at + 1, end);
+        token.type = get_acf_document_keyword(token.span, (u32) (at - token.span));
+    }
+    else
+    {
+        switch (*at)
+        {
+            case '#': case '(': case ')': case ',': case ';':
+            case '=': case '[': case ']': case '{': case '}':
+                token.type = (acf_document_token_type) *at;
+                break;
+
+            default:
+                token.type = acf_document_token_type::invalid;
+        }
+        at += 1;
+    }
+
+    token.size = (u32) (at - token.span);
+
+    return token;
+}
+
+
+INTERNAL
+acf_document_token get_token(acf_document_parser *parser)
+{
+    if (!parser->next_token_valid)
+    {
+        parser->next_token = acf_document_lex(parser->at, parser->end);
+        parser->at = parser->next_token.span + parser->next_token.size;
+        parser->next_token_valid = true;
+    }
+
+    return parser->next_token;
+}
+
+
+INTERNAL
+acf_document_token eat_token(acf_document_parser *parser)
+{
+    acf_document_token result = get_token(parser);
+    parser->next_token_valid = false;
+    return result;
+}
+
+
+INTERNAL
+acf_document_parser::scratch_entry *get_scratch_entry(acf_document_parser *parser, u32 index)
+{
+    acf_document_parser::scratch_entry *result = parser->scratch_base - 1 - index;
+    return result;
+}
+
+
+INTERNAL
+bool push_scratch_entry(acf_document_parser *parser, acf_key key, acf_node node)
+{
+    memory::arena_allocator *arena = &parser->document->arena;
+
+    acf_document_parser::scratch_entry *entry = get_scratch_entry(parser, parser->scratch_count);
+    if ((memory::byte *) entry < arena->memory + arena->used) return false;
+
+    entry->key = key;
+    entry->node = node;
+    parser->scratch_count += 1;
+
+    // @note: Arena allocations must not reach the scratch stack.
+    arena->size = (memory::byte *) entry - arena->memory;
+    return true;
+}
+
+
+// @note: Moves the top of the scratch stack, starting from 'first', into the document's arena.
+// Keys of objects are followed by the hash index if the object is big enough, and the keys
+// that are repeated in big objects are found here, while the index is built. With a string
+// table, an object takes the key list of the last object with the same keys, if it is cached.
+INTERNAL
+bool commit_scratch_entries(acf_document_parser *parser, u32 first, acf_node **children, acf_key **keys, acf_key **duplicate)
+{
+    memory::arena_allocator *arena = &parser->document->arena;
+
+    u32 count = parser->scratch_count - first;
+    if (count == 0) return true;
+
+    acf_node *nodes = ALLOCATE_BUFFER_(arena, acf_node, count);
+    if (nodes == NULL) return false;
+
+    for (u32 i = 0; i < count; i++)
+    {
+        nodes[i] = get_scratch_entry(parser, first + i)->node;
+    }
+    *children = nodes;
+
+    acf_document_parser::shape *shape = NULL;
+    if (keys && parser->document->strings)
+    {
+        u32 shape_hash = count;
+        for (u32 i = 0; i < count; i++)
+        {
+            shape_hash = (shape_hash ^ get_scratch_entry(parser, first + i)->key.hash) * 0x9E3779B1u;
+        }
+
+        shape = parser->shapes + ((shape_hash ^ (shape_hash >> 16)) & (ACF_SHAPE_CACHE_SIZE - 1));
+        bool same = (shape->keys != NULL) && (shape->count == count) && (shape->hash == shape_hash);
+        for (u32 i = 0; same && i < count; i++)
+        {
+            same = (shape->keys[i].data == get_scratch_entry(parser, first + i)->key.data);
+        }
+
+        if (same)
+        {
+            *keys = shape->keys;
+            keys = NULL;
+        }
+        else
+        {
+            shape->keys = NULL;
+            shape->count = count;
+            shape->hash = shape_hash;
+        }
+    }
+
+    if (keys)
+    {
+        u32 index_capacity = get_acf_object_index_capacity(count);
+        usize size = count * sizeof(acf_key) + index_capacity * sizeof(u32);
+
+        acf_key *result = (acf_key *) ALLOCATE_(arena, size, alignof(acf_key));
+        if (result == NULL) return false;
+
+        for (u32 i = 0; i < count; i++)
+        {
+            result[i] = get_scratch_entry(parser, first + i)->key;
+        }
+
+        if (index_capacity)
+        {
+            u32 *index = (u32 *) (result + count);
+            memory::set(index, 0, index_capacity * sizeof(u32));
+
+            u32 mask = index_capacity - 1;
+            for (u32 key_index = 0; key_index < count; key_index++)
+            {
+                u32 slot = result[key_index].hash & mask;
+                while (index[slot])
+                {
+                    if ((result[index[slot] - 1] == result[key_index]) && (*duplicate == NULL))
+                    {
+                        *duplicate = result + key_index;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+                index[slot] = key_index + 1;
+            }
+        }
+        *keys = result;
+
+        if (shape && (*duplicate == NULL))
+        {
+            shape->keys = result;
+        }
+    }
+
+    parser->scratch_count = first;
+    arena->size = (first == 0) ? parser->arena_size : (usize) ((memory::byte *) get_scratch_entry(parser, first - 1) - arena->memory);
+
+    return true;
+}
+
+
+// @note: Places the scratch stack at the end of the document's arena.
+INTERNAL
+void begin_acf_document_parser(acf_document_parser *parser, acf_document *document)
+{
+    *parser = {};
+    parser->document = document;
+
+    memory::arena_allocator *arena = &document->arena;
+    parser->arena_size = arena->size;
+
+    usize scratch_end = ((usize) arena->memory + arena->size) & ~(usize) (alignof(acf_document_parser::scratch_entry) - 1);
+    parser->scratch_base = (acf_document_parser::scratch_entry *) scratch_end;
+}
+
+
+INTERNAL
+void end_acf_document_parser(acf_document_parser *parser)
+{
+    parser->document->arena.size = parser->arena_size;
+    parser->scratch_count = 0;
+}
+
+
+INTERNAL
+bool acf_document_out_of_memory(acf_document_parser *parser, char const *location)
+{
+    acf_document_report_error(parser, location, "Document arena is out of memory (%llu bytes).", (unsigned long long) parser->arena_size);
+    return false;
+}
+
+
+INTERNAL
+bool acf_document_strings_out_of_memory(acf_document_parser *parser, char const *location)
+{
+    acf_document_report_error(parser, location, "String table is out of memory.");
+    return false;
+}
+
+
+//
+// String interning
+//
+
+#define ACF_STRING_BLOCK_SIZE KILOBYTES(64)
+
+GLOBAL memory::mallocator acf_strings_mallocator = { "acf strings" };
+
+
+INTERNAL
+char *copy_acf_string_to_block(acf_string_table *table, char const *data, u32 size)
+{
+    acf_string_block *block = table->blocks;
+    if ((block == NULL) || (block->used + size + 1 > block->size))
+    {
+        // @note: Long strings get blocks of their own, which go after the current one, so its free space is not lost.
+        bool dedicated = (size + 1 > ACF_STRING_BLOCK_SIZE / 4);
+        usize block_size = dedicated ? size + 1 : ACF_STRING_BLOCK_SIZE;
+
+        block = (acf_string_block *) ALLOCATE_(&acf_strings_mallocator, sizeof(acf_string_block) + block_size, alignof(acf_string_block));
+        if (block == NULL) return NULL;
+
+        block->used = 0;
+        block->size = block_size;
+
+        if (dedicated && table->blocks)
+        {
+            block->next = table->blocks->next;
+            table->blocks->next = block;
+        }
+        else
+        {
+            block->next = table->blocks;
+            table->blocks = block;
+        }
+    }
+
+    char *result = (char *) (block + 1) + block->used;
+    memory::copy(result, data, size);
+    result[size] = 0;
+    block->used += size + 1;
+
+    return result;
+}
+
+
+INTERNAL
+bool grow_acf_string_table_slots(acf_string_table *table)
+{
+    u32 slot_capacity = table->slot_capacity ? 2 * table->slot_capacity : 256;
+
+    u32 *slots = ALLOCATE_BUFFER_(&acf_strings_mallocator, u32, slot_capacity);
+    if (slots == NULL) return false;
+    memory::set(slots, 0, slot_capacity * sizeof(u32));
+
+    u32 mask = slot_capacity - 1;
+    for (u32 id = 1; id <= table->count; id++)
+    {
+        u32 slot = table->entries[id - 1].hash & mask;
+        while (slots[slot]) slot = (slot + 1) & mask;
+        slots[slot] = id;
+    }
+
+    if (table->slots) DEALLOCATE_BUFFER(&acf_strings_mallocator, table->slots);
+    table->slots = slots;
+    table->slot_capacity = slot_capacity;
+
+    return true;
+}
+
+
+u32 intern_acf_string(acf_string_table *table, acf_key key)
+{
+    if (2 * (table->count + 1) > table->slot_capacity)
+    {
+        if (!grow_acf_string_table_slots(table)) return 0;
+    }
+
+    u32 mask = table->slot_capacity - 1;
+    u32 slot = key.hash & mask;
+    for (; table->slots[slot]; slot = (slot + 1) & mask)
+    {
+        u32 id = table->slots[slot];
+        if (table->entries[id - 1] == key) return id;
+    }
+
+    if (table->count == table->capacity)
+    {
+        u32 capacity = table->capacity ? 2 * table->capacity : 256;
+        acf_key *entries = table->entries
+            ? REALLOCATE_BUFFER(&acf_strings_mallocator, table->entries, capacity)
+            : ALLOCATE_BUFFER_(&acf_strings_mallocator, acf_key, capacity);
+        if (entries == NULL) return 0;
+
+        table->entries = entries;
+        table->capacity = capacity;
+    }
+
+    char const *data = copy_acf_string_to_block(table, key.data, key.size);
+    if (data == NULL) return 0;
+
+    table->entries[table->count++] = { data, key.size, key.hash };
+    table->slots[slot] = table->count;
+
+    return table->count;
+}
+
+
+u32 find_acf_string(acf_string_table const *table, acf_key key)
+{
+    if (table->slot_capacity == 0) return 0;
+
+    u32 mask = table->slot_capacity - 1;
+    for (u32 slot = key.hash & mask; table->slots[slot]; slot = (slot + 1) & mask)
+    {
+        u32 id = table->slots[slot];
+        if (table->entries[id - 1] == key) return id;
+    }
+
+    return 0;
+}
+
+
+acf_key get_acf_string(acf_string_table const *table, u32 id)
+{
+    ASSERT((id > 0) && (id <= table->count));
+    return table->entries[id - 1];
+}
+
+
+void free_acf_string_table(acf_string_table *table)
+{
+    for (acf_string_block *block = table->blocks; block; )
+    {
+        acf_string_block *next = block->next;
+        DEALLOCATE(&acf_strings_mallocator, block);
+        block = next;
+    }
+    if (table->entries) DEALLOCATE_BUFFER(&acf_strings_mallocator, table->entries);
+    if (table->slots) DEALLOCATE_BUFFER(&acf_strings_mallocator, table->slots);
+
+    *table = {};
+}
+
+
+// @note: Keys of documents with a string table point to their interned copies.
+INTERNAL
+bool intern_acf_document_string(acf_document *document, char const **data, u32 size, u32 hash)
+{
+    if (document->strings)
+    {
+        u32 id = intern_acf_string(document->strings, acf_key{ *data, size, hash });
+        if (id == 0) return false;
+
+        *data = document->strings->entries[id - 1].data;
+    }
+    return true;
+}
+
+
+//
+// Newtypes
+//
+
+// @note: Newtypes are found by the hash of their name in 'slots', which hold the newtype index + 1, or 0 when empty.
+// There are at most ACF_MAX_NEWTYPES and twice as many slots, so the index never fills up. The stream uses the same index.
+INTERNAL
+acf_newtype *find_acf_newtype(acf_newtype *newtypes, u8 const *slots, u32 slot_count, acf_string_view name)
+{
+    u32 hash = hash_acf_key(name.data, name.size);
+    u32 mask = slot_count - 1;
+
+    for (u32 slot = hash & mask; slots[slot]; slot = (slot + 1) & mask)
+    {
+        acf_newtype *newtype = newtypes + slots[slot] - 1;
+        if ((newtype->hash == hash) && (*newtype->name == name))
+        {
+            return newtype;
+        }
+    }
+
+    return NULL;
+}
+
+
+// @note: The hash of the newtype has to be set.
+INTERNAL
+void index_acf_newtype(acf_newtype const *newtypes, u8 *slots, u32 slot_count, u32 newtype_index)
+{
+    u32 mask = slot_count - 1;
+    u32 slot = newtypes[newtype_index].hash & mask;
+    while (slots[slot]) slot = (slot + 1) & mask;
+    slots[slot] = (u8) (newtype_index + 1);
+}
+
+
+INTERNAL
+acf_newtype *find_acf_document_newtype(acf_document *document, acf_string_view name)
+{
+    return find_acf_newtype(document->newtypes, document->newtype_slots, ARRAY_COUNT(document->newtype_slots), name);
+}
+
+
+INTERNAL
+void index_acf_document_newtype(acf_document *document, u32 newtype_index)
+{
+    index_acf_newtype(document->newtypes, document->newtype_slots, ARRAY_COUNT(document->newtype_slots), newtype_index);
+}
+
+
+// @note: Returns NULL when there are ACF_MAX_NEWTYPES already. Arguments are set by the caller.
+INTERNAL
+acf_newtype *add_acf_document_newtype(acf_document *document, acf_string_view *name)
+{
+    if (document->newtype_count == ACF_MAX_NEWTYPES) return NULL;
+
+    u32 newtype_index = document->newtype_count++;
+    acf_newtype *newtype = document->newtypes + newtype_index;
+    newtype->name = name;
+    newtype->hash = hash_acf_key(name->data, name->size);
+    newtype->argument_count = 0;
+
+    index_acf_document_newtype(document, newtype_index);
+    return newtype;
+}
+
+
+// @note: Forgets the newtypes after the first 'count', the index is rebuilt for the rest.
+INTERNAL
+void truncate_acf_document_newtypes(acf_document *document, u32 count)
+{
+    document->newtype_count = count;
+    memory::set(document->newtype_slots, 0, sizeof(document->newtype_slots));
+    for (u32 newtype_index = 0; newtype_index < count; newtype_index++)
+    {
+        index_acf_document_newtype(document, newtype_index);
+    }
+}
+
+
+INTERNAL
+bool acf_document_keyword_to_type(acf_document_token_type token_type, acf_type_t *type)
+{
+    switch (token_type)
+    {
+        case acf_document_token_type::keyword_null:   { *type = acf_type_t::null; } break;
+        case acf_document_token_type::keyword_bool:   { *type = acf_type_t::boolean; } break;
+        case acf_document_token_type::keyword_int:    { *type = acf_type_t::integer; } break;
+        case acf_document_token_type::keyword_float:  { *type = acf_type_t::floating; } break;
+        case acf_document_token_type::keyword_string: { *type = acf_type_t::string; } break;
+        case acf_document_token_type::keyword_object: { *type = acf_type_t::object; } break;
+        case acf_document_token_type::keyword_array:  { *type = acf_type_t::array; } break;
+        case acf_document_token_type::keyword_type:   { *type = acf_type_t::type; } break;
+        default: return false;
+    }
+
+    return true;
+}
+
+
+bool parse_acf_document_value(acf_document_parser *parser, acf_node *result);
+bool parse_acf_document_object(acf_document_parser *parser, acf_node *result, bool braces_optional);
+
+
+bool parse_acf_document_array(acf_document_parser *parser, acf_node *result)
+{
+    eat_token(parser); // '['
+
+    u32 first = parser->scratch_count;
+    loop
+    {
+        acf_document_token t = get_token(parser);
+        if (t.type == acf_document_token_type::bracket_close)
+        {
+            eat_token(parser);
+            break;
+        }
+        if (t.type == acf_document_token_type::end_of_file)
+        {
+            acf_document_report_error(parser, t.span, "Expected ']'.");
+            return false;
+        }
+
+        acf_node value;
+        if (!parse_acf_document_value(parser, &value)) return false;
+        if (!push_scratch_entry(parser, {}, value)) return acf_document_out_of_memory(parser, t.span);
+
+        if (get_token(parser).type == acf_document_token_type::comma)
+        {
+            // Consume optional comma, if present, including trailing comma.
+            eat_token(parser);
+        }
+    }
+
+    *result = {};
+    result->type = acf_type_t::array;
+    result->count = parser->scratch_count - first;
+
+    if (!commit_scratch_entries(parser, first, &result->children, NULL, NULL)) return acf_document_out_of_memory(parser, parser->at);
+    return true;
+}
+
+
+bool parse_acf_document_object(acf_document_parser *parser, acf_node *result, bool braces_optional)
+{
+    acf_document_token open_brace_token = get_token(parser);
+    if (open_brace_token.type == acf_document_token_type::brace_open)
+    {
+        eat_token(parser);
+        braces_optional = false; // Ensure there is closing brace to this open brace.
+    }
+    else if (!braces_optional)
+    {
+        acf_document_report_error(parser, open_brace_token.span, "Expected '{'.");
+        return false;
+    }
+
+    u32 first = parser->scratch_count;
+    loop
+    {
+        acf_document_token t = eat_token(parser);
+        if ((t.type == acf_document_token_type::brace_close && !braces_optional) ||
+            (t.type == acf_document_token_type::end_of_file && braces_optional))
+        {
+            break;
+        }
+
+        if (t.type != acf_document_token_type::identifier)
+        {
+            acf_document_report_error(parser, t.span, (t.type == acf_document_token_type::end_of_file) ? "Expected '}'." : "Expected identifier for key-value pair.");
+            return false;
+        }
+
+        acf_key key = make_acf_key(t.span, t.size);
+        if (!intern_acf_document_string(parser->document, &key.data, key.size, key.hash)) return acf_document_strings_out_of_memory(parser, t.span);
+
+        // @note: Duplicates in big objects are found later, when their hash index is built.
+        u32 check_count = parser->scratch_count - first;
+        if (check_count > ACF_OBJECT_INDEX_THRESHOLD) check_count = ACF_OBJECT_INDEX_THRESHOLD;
+        for (u32 key_index = first; key_index < first + check_count; key_index++)
+        {
+            if (get_scratch_entry(parser, key_index)->key == key)
+            {
+                acf_document_report_error(parser, t.span, "Key '%.*s' already defined in this object.", (int) key.size, key.data);
+                return false;
+            }
+        }
+
+        acf_document_token equals_token = eat_token(parser);
+        if (equals_token.type != acf_document_token_type::equals)
+        {
+            acf_document_report_error(parser, equals_token.span, "Expected '='.");
+            return false;
+        }
+
+        acf_node value;
+        if (!parse_acf_document_value(parser, &value)) return false;
+
+        if (!push_scratch_entry(parser, key, value)) return acf_document_out_of_memory(parser, t.span);
+
+        if (get_token(parser).type == acf_document_token_type::semicolon)
+        {
+            // Consume optional semicolon, if present.
+            eat_token(parser);
+        }
+    }
+
+    *result = {};
+    result->type = acf_type_t::object;
+    result->count = parser->scratch_count - first;
+
+    acf_key *duplicate = NULL;
+    if (!commit_scratch_entries(parser, first, &result->children, &result->keys, &duplicate)) return acf_document_out_of_memory(parser, parser->at);
+    if (duplicate)
+    {
+        acf_document_report_error(parser, duplicate->data, "Key '%.*s' already defined in this object.", (int) duplicate->size, duplicate->data);
+        return false;
+    }
+    return true;
+}
+
+
+bool parse_acf_document_constructor_call(acf_document_parser *parser, acf_node *result)
+{
+    acf_document_token name_token = eat_token(parser);
+
+    acf_newtype *newtype = find_acf_document_newtype(parser->document, { name_token.span, name_token.size });
+    if (newtype == NULL)
+    {
+        acf_document_report_error(parser, name_token.span, "Referencing an identifier '%.*s', which was not declared before!", (int) name_token.size, name_token.span);
+        return false;
+    }
+
+    acf_document_token paren_open_token = eat_token(parser);
+    if (paren_open_token.type != acf_document_token_type::parentheses_open)
+    {
+        acf_document_report_error(parser, paren_open_token.span, "Constructor call have to have parentheses around arguments, even if number of them is 0.");
+        return false;
+    }
+
+    u32 first = parser->scratch_count;
+    for (u32 argument_index = 0; argument_index < newtype->argument_count; argument_index++)
+    {
+        acf_type_t expected = newtype->arguments[argument_index];
+        acf_document_token t = get_token(parser);
+
+        acf_node argument = {};
+        if (expected == acf_type_t::type)
+        {
+            argument.type = acf_type_t::type;
+            if (!acf_document_keyword_to_type(t.type, &argument.type_value))
+            {
+                acf_document_report_error(parser, t.span, "Expected one of the basic types here.");
+                return false;
+            }
+            eat_token(parser);
+        }
+        else
+        {
+            if (t.type == acf_document_token_type::parentheses_close)
+            {
+                acf_document_report_error(parser, t.span, "Argument count mismatch! Expected %u arguments, got %u.", newtype->argument_count, argument_index);
+                return false;
+            }
+
+            if (!parse_acf_document_value(parser, &argument)) return false;
+
+            if ((expected == acf_type_t::floating) && argument.is_integer())
+            {
+                argument.type = acf_type_t::floating;
+                argument.floating_value = (float64) argument.integer_value;
+            }
+
+            if (argument.type != expected)
+            {
+                acf_document_report_error(parser, t.span, "Argument type mismatch! Constructor call expected value of type %s, but got %s.",
+                    get_acf_type_string(expected), get_acf_type_string(argument.type));
+                return false;
+            }
+        }
+
+        if (!push_scratch_entry(parser, {}, argument)) return acf_document_out_of_memory(parser, t.span);
+
+        if (argument_index + 1 < newtype->argument_count) // Do not support trailing comma in function calls.
+        {
+            acf_document_token comma_token = eat_token(parser);
+            if (comma_token.type != acf_document_token_type::comma)
+            {
+                acf_document_report_error(parser, comma_token.span, "Expected ','.");
+                return false;
+            }
+        }
+    }
+
+    acf_document_token paren_close_token = eat_token(parser);
+    if (paren_close_token.type != acf_document_token_type::parentheses_close)
+    {
+        acf_document_report_error(parser, paren_close_token.span, "Expected ')'.");
+        return false;
+    }
+
+    *result = {};
+    result->type = acf_type_t::custom;
+    result->count = parser->scratch_count - first;
+    result->newtype_name = newtype->name;
+
+    if (!commit_scratch_entries(parser, first, &result->children, NULL, NULL)) return acf_document_out_of_memory(parser, parser->at);
+    return true;
+}
+
+
+bool parse_acf_document_value(acf_document_parser *parser, acf_node *result)
+{
+    *result = {};
+
+    acf_document_token t = get_token(parser);
+    switch (t.type)
+    {
+        case acf_document_token_type::keyword_null:  { result->type = acf_type_t::null; eat_token(parser); } break;
+        case acf_document_token_type::keyword_true:  { result->type = acf_type_t::boolean; result->boolean_value = true; eat_token(parser); } break;
+        case acf_document_token_type::keyword_false: { result->type = acf_type_t::boolean; result->boolean_value = false; eat_token(parser); } break;
+        case acf_document_token_type::integer:       { result->type = acf_type_t::integer; result->integer_value = t.integer_value; eat_token(parser); } break;
+        case acf_document_token_type::floating:      { result->type = acf_type_t::floating; result->floating_value = t.floating_value; eat_token(parser); } break;
+
+        case acf_document_token_type::string:
+        {
+            result->type = acf_type_t::string;
+            result->string_value = t.span + 1;
+            result->count = t.size - 2;
+            eat_token(parser);
+        }
+        break;
+
+        case acf_document_token_type::keyword_bool:
+        case acf_document_token_type::keyword_int:
+        case acf_document_token_type::keyword_float:
+        case acf_document_token_type::keyword_string:
+        case acf_document_token_type::keyword_array:
+        case acf_document_token_type::keyword_object:
+        case acf_document_token_type::keyword_type:
+        {
+            result->type = acf_type_t::type;
+            acf_document_keyword_to_type(t.type, &result->type_value);
+            eat_token(parser);
+        }
+        break;
+
+        case acf_document_token_type::identifier:
+        case acf_document_token_type::brace_open:
+        case acf_document_token_type::bracket_open:
+        {
+            if (parser->done_array && (t.span == parser->done_array->span))
+            {
+                *result = parser->done_array->node;
+                parser->at = parser->done_array->end;
+                parser->next_token_valid = false;
+                return true;
+            }
+
+            if (parser->depth == ACF_MAX_DEPTH)
+            {
+                acf_document_report_error(parser, t.span, "Nesting is too deep, maximum depth is %d.", ACF_MAX_DEPTH);
+                return false;
+            }
+
+            parser->depth += 1;
+            bool success = (t.type == acf_document_token_type::identifier) ? parse_acf_document_constructor_call(parser, result)
+                         : (t.type == acf_document_token_type::brace_open) ? parse_acf_document_object(parser, result, false)
+                         : parse_acf_document_array(parser, result);
+            parser->depth -= 1;
+            return success;
+        }
+
+        case acf_document_token_type::integer_out_of_range:
+        {
+            acf_document_report_error(parser, t.span, "Integer does not fit in 64 bits.");
+            return false;
+        }
+
+        default:
+        {
+            acf_document_report_error(parser, t.span, "Expected value.");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool parse_acf_document_directive(acf_document_parser *parser)
+{
+    eat_token(parser); // '#'
+
+    acf_document_token directive_token = eat_token(parser);
+    if (directive_token.type != acf_document_token_type::identifier || acf_string_view{ directive_token.span, directive_token.size } != "newtype")
+    {
+        acf_document_report_error(parser, directive_token.span, "Currently the only supported directive is 'newtype'.");
+        return false;
+    }
+
+    acf_document_token name_token = eat_token(parser);
+    if (name_token.type != acf_document_token_type::identifier)
+    {
+        acf_document_report_error(parser, name_token.span, "You should specify name of your type here.");
+        return false;
+    }
+
+    acf_document_token open_paren_token = eat_token(parser);
+    if (open_paren_token.type != acf_document_token_type::parentheses_open)
+    {
+        acf_document_report_error(parser, open_paren_token.span, "Expected '('.");
+        return false;
+    }
+
+    u32 argument_count = 0;
+    acf_type_t arguments[ACF_MAX_NEWTYPE_ARGUMENTS];
+    loop
+    {
+        acf_document_token t = eat_token(parser);
+        if (t.type == acf_document_token_type::parentheses_close)
+        {
+            break;
+        }
+
+        acf_type_t argument_type;
+        if (!acf_document_keyword_to_type(t.type, &argument_type))
+        {
+            // @note: Nested custom types are forbidden, they overcomplicate matters.
+            acf_document_report_error(parser, t.span, "Expected one of the basic types here.");
+            return false;
+        }
+
+        if (argument_count == ACF_MAX_NEWTYPE_ARGUMENTS)
+        {
+            acf_document_report_error(parser, t.span, "Newtype can have at most %d arguments.", ACF_MAX_NEWTYPE_ARGUMENTS);
+            return false;
+        }
+        arguments[argument_count++] = argument_type;
+
+        if (get_token(parser).type == acf_document_token_type::comma)
+        {
+            // Consume optional comma, if present.
+            eat_token(parser);
+        }
+    }
+
+    char const *name = name_token.span;
+    if (find_acf_document_newtype(parser->document, { name_token.span, name_token.size }))
+    {
+        acf_document_report_error(parser, name, "Newtype '%.*s' is already declared.", (int) name_token.size, name);
+        return false;
+    }
+
+    if (parser->document->newtype_count == ACF_MAX_NEWTYPES)
+    {
+        acf_document_report_error(parser, name, "Too many newtypes declared, maximum is %d.", ACF_MAX_NEWTYPES);
+        return false;
+    }
+
+    acf_string_view *name_view = ALLOCATE_STRUCT_(&parser->document->arena, acf_string_view);
+    if (name_view == NULL) return acf_document_out_of_memory(parser, name);
+    *name_view = { name_token.span, name_token.size };
+
+    if (!intern_acf_document_string(parser->document, &name_view->data, name_view->size, hash_acf_key(name_view->data, name_view->size)))
+    {
+        return acf_document_strings_out_of_memory(parser, name);
+    }
+
+    acf_newtype *newtype = add_acf_document_newtype(parser->document, name_view);
+    newtype->argument_count = argument_count;
+    memory::copy(newtype->arguments, arguments, argument_count * sizeof(acf_type_t));
+
+    return true;
+}
+
+
+void initialize_acf_document(acf_document *document, void *memory, usize size)
+{
+    *document = {};
+    memory::initialize(&document->arena, memory, size, "acf document");
+    reset_acf_document(document);
+}
+
+
+void reset_acf_document(acf_document *document)
+{
+    // @note: Re-initializing the arena also clears its debug allocation log.
+    memory::initialize(&document->arena, document->arena.memory, document->arena.size, document->arena.name);
+
+    document->source = NULL;
+    document->source_size = 0;
+    document->root = {};
+    truncate_acf_document_newtypes(document, 0);
+    document->has_error = false;
+    document->error_line = 0;
+    document->error_column = 0;
+    document->error_buffer[0] = 0;
+}
+
+
+void release_acf_document(acf_document *document)
+{
+    memory::release(&document->arena);
+}
+
+
+bool register_acf_document_newtype(acf_document *document, char const *name, u32 argument_count, acf_type_t const *arguments)
+{
+    if ((document->newtype_count == ACF_MAX_NEWTYPES) || (argument_count > ACF_MAX_NEWTYPE_ARGUMENTS)) return false;
+
+    u32 name_size = 0;
+    while (name[name_size]) name_size += 1;
+
+    acf_string_view *name_view = ALLOCATE_STRUCT_(&document->arena, acf_string_view);
+    if (name_view == NULL) return false;
+    *name_view = { name, name_size };
+
+    if (!intern_acf_document_string(document, &name_view->data, name_size, hash_acf_key(name, name_size))) return false;
+
+    acf_newtype *newtype = add_acf_document_newtype(document, name_view);
+    newtype->argument_count = argument_count;
+    memory::copy(newtype->arguments, arguments, argument_count * sizeof(acf_type_t));
+
+    return true;
+}
+
+
+bool parse_acf_document(acf_document *document, char const *source, usize source_size)
+{
+    document->source = source;
+    document->source_size = source_size;
+    document->root = {};
+    document->has_error = false;
+    document->error_buffer[0] = 0;
+
+    acf_document_parser parser;
+    begin_acf_document_parser(&parser, document);
+    parser.at = source;
+    parser.end = source + source_size;
+    parser.depth = 1; // @note: Root object.
+
+    bool success = true;
+    while (success && get_token(&parser).type == acf_document_token_type::pound)
+    {
+        success = parse_acf_document_directive(&parser);
+    }
+
+    if (success)
+    {
+        success = parse_acf_document_object(&parser, &document->root, true);
+    }
+
+    if (success)
+    {
+        acf_document_token t = get_token(&parser);
+        if (t.type != acf_document_token_type::end_of_file)
+        {
+            acf_document_report_error(&parser, t.span, "Unexpected symbols after the end of the document.");
+            success = false;
+        }
+    }
+
+    end_acf_document_parser(&parser);
+
+    if (!success)
+    {
+        document->root = {};
+    }
+
+    return success;
+}
+
+
+#endif // ACF_LIB_IMPLEMENTATION
+#endif // ACF_DOCUMENT_HPP
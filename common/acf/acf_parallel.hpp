@@ -0,0 +1,493 @@
+#ifndef ACF_PARALLEL_HPP
+#define ACF_PARALLEL_HPP
+
+#include <defines.hpp>
+#include <allocator.hpp>
+#include <acf/acf_document.hpp>
+
+// Standard headers
+#include <string.h>
+
+
+/*
+    ACF Parallel Parsing
+
+    Log-like files are mostly one huge array of records:
+
+        #newtype vec2(float, float)
+        version = 3
+        records = [
+            { time = 0.016; event = "spawn"; position = vec2(1, 2) },
+            { time = 0.033; event = "move";  position = vec2(2, 2) },
+            ...
+        ]
+
+    Elements of such an array do not depend on each other, so they are
+    parsed in parallel, in two phases:
+
+        1. Structural pass, on one thread. It skips strings and comments and
+           counts brackets, without lexing anything, and finds the largest
+           array which is a value in the root object. The array is cut into
+           jobs of about the same size at the commas between its elements.
+
+        2. Every job parses its elements into its own slice of the document's
+           arena, on whatever thread runs it. When all jobs are done, what
+           they used is moved down to close the gaps between the slices, the
+           pointers into the slices are fixed, and the unused tails go back
+           to the arena. Top-level nodes of the jobs are copied into one
+           array in order, and the rest of the document is parsed as usual,
+           taking the ready array when the parser reaches its '['.
+
+     ┌────────────┬────────────┬─    ─┬────────────┬──────────────────────────┐
+     │ directives │ job 0      │ ...  │ job n - 1  │ rest of the document     │
+     └────────────┴────────────┴─    ─┴────────────┴──────────────────────────┘
+      document arena, every job parses into its slice with its own scratch stack
+
+    Half of the free arena is split between the jobs, proportionally to the
+    size of their source, so a parallel parse needs more headroom than the
+    sequential one while it runs, but leaves about as much used. If any job runs out of memory or meets a syntax error,
+    everything is rolled back and the document is parsed sequentially, so
+    the result and the error messages are always the same as the ones of
+    parse_acf_document. Arrays shorter than ACF_PARALLEL_MIN_JOB_SIZE per job
+    are not split at all, and neither are documents with a string table,
+    which is not shared between threads.
+
+    The library does not start threads, the jobs are run by the caller, for
+    example on its work queue:
+
+        acf_parallel_parse *parse = ...; // ~100 KB, better not on the stack
+        u32 job_count = begin_acf_parallel_parse(parse, &document, source, size, thread_count);
+        for (u32 i = 0; i < job_count; i++)
+        {
+            push_work(run_acf_parallel_parse_job, parse, i);
+        }
+        wait_for_all_work();
+        bool success = finish_acf_parallel_parse(parse);
+*/
+
+
+#define ACF_PARALLEL_MAX_JOBS 64
+
+#ifndef ACF_PARALLEL_MIN_JOB_SIZE
+#define ACF_PARALLEL_MIN_JOB_SIZE KILOBYTES(64)
+#endif
+
+
+struct acf_parallel_job
+{
+    char const *begin;
+    char const *end;
+
+    acf_document document; // @note: Only its arena and newtypes are used.
+    acf_node *children;
+    u32 count;
+    b32 successfull;
+};
+
+
+struct acf_parallel_parse
+{
+    acf_document *document;
+    acf_document_parser parser;
+    memory::TemporaryMemory rollback;
+    memory::TemporaryMemory slices; // @note: Open from the start of the job slices until the results are moved down.
+    u32 newtype_count;
+    b32 failed;
+
+    char const *array_begin; // @note: '[' of the array which is split.
+    char const *array_end;   // @note: Right after its ']'.
+
+    u32 job_count;
+    acf_parallel_job jobs[ACF_PARALLEL_MAX_JOBS];
+};
+
+
+// @note: Returns the number of jobs to run, it can be 0 when there is nothing worth splitting.
+u32 begin_acf_parallel_parse(acf_parallel_parse *parse, acf_document *document, char const *source, usize source_size, u32 max_job_count);
+void run_acf_parallel_parse_job(acf_parallel_parse *parse, u32 job_index);
+bool finish_acf_parallel_parse(acf_parallel_parse *parse);
+
+
+#ifdef ACF_LIB_IMPLEMENTATION
+
+
+// @note: Characters which do not change the structure: everything but quotes, slashes, brackets and commas.
+struct acf_structural_class
+{
+    static bool scalar(char c)
+    {
+        switch (c)
+        {
+            case '"': case '/': case ',': case 0:
+            case '[': case ']': case '{': case '}': case '(': case ')':
+                return false;
+        }
+        return true;
+    }
+#ifdef ACF_VECTOR_SIZE
+    static acf_vector_t vector(acf_vector_t v)
+    {
+        acf_vector_t a = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('"')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('/')));
+        acf_vector_t b = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1(',')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1(0)));
+        acf_vector_t c = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('[')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1(']')));
+        acf_vector_t d = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('{')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('}')));
+        acf_vector_t e = ACF_VECTOR_OR(ACF_VECTOR_EQ(v, ACF_VECTOR_SET1('(')), ACF_VECTOR_EQ(v, ACF_VECTOR_SET1(')')));
+        acf_vector_t stop = ACF_VECTOR_OR(ACF_VECTOR_OR(a, b), ACF_VECTOR_OR(ACF_VECTOR_OR(c, d), e));
+        return ACF_VECTOR_EQ(stop, ACF_VECTOR_SET1(0));
+    }
+#endif
+};
+
+
+// @note: Calls back with every bracket and comma outside of strings and comments, until the callback returns false.
+// Stops at the zero character, as the lexer does.
+template <typename Callback>
+INTERNAL
+void scan_acf_structure(char const *at, char const *end, Callback callback)
+{
+    loop
+    {
+        at = acf_scan_while<acf_structural_class>(at, end);
+        if (at == end || *at == 0) break;
+
+        if (*at == '"')
+        {
+            at = acf_scan_while<acf_string_body_class>(at + 1, end);
+            if (at < end && *at == '"') at += 1;
+        }
+        else if (*at == '/')
+        {
+            at = ((at + 1 < end) && (at[1] == '/')) ? acf_scan_while<acf_comment_body_class>(at + 2, end) : at + 1;
+        }
+        else
+        {
+            if (!callback(at)) break;
+            at += 1;
+        }
+    }
+}
+
+
+u32 begin_acf_parallel_parse(acf_parallel_parse *parse, acf_document *document, char const *source, usize source_size, u32 max_job_count)
+{
+    parse->document = document;
+    parse->failed = false;
+    parse->job_count = 0;
+    parse->array_begin = NULL;
+    parse->array_end = NULL;
+    parse->newtype_count = document->newtype_count;
+    parse->rollback = memory::begin_temporary(&document->arena);
+
+    document->source = source;
+    document->source_size = source_size;
+    document->root = {};
+    document->has_error = false;
+    document->error_buffer[0] = 0;
+
+    acf_document_parser *parser = &parse->parser;
+    begin_acf_document_parser(parser, document);
+    parser->at = source;
+    parser->end = source + source_size;
+    parser->depth = 1; // @note: Root object.
+
+    // @note: Directives go first, jobs need the newtypes.
+    while (get_token(parser).type == acf_document_token_type::pound)
+    {
+        if (!parse_acf_document_directive(parser))
+        {
+            parse->failed = true;
+            return 0;
+        }
+    }
+
+    if ((max_job_count < 2) || document->strings || (source_size < 2 * ACF_PARALLEL_MIN_JOB_SIZE)) return 0;
+
+    // @note: Entries of the root object are at depth 1 when it has braces, at 0 otherwise.
+    acf_document_token first_token = get_token(parser);
+    char const *root_begin = first_token.span;
+    int32 root_depth = (first_token.type == acf_document_token_type::brace_open) ? 1 : 0;
+
+    int32 depth = 0;
+    char const *candidate = NULL;
+    scan_acf_structure(root_begin, parser->end, [&](char const *at)
+    {
+        switch (*at)
+        {
+            case '[': case '{': case '(':
+            {
+                if ((*at == '[') && (depth == root_depth)) candidate = at;
+                depth += 1;
+            }
+            break;
+
+            case ']': case '}': case ')':
+            {
+                depth -= 1;
+                if ((*at == ']') && (depth == root_depth) && candidate)
+                {
+                    if (at + 1 - candidate > parse->array_end - parse->array_begin)
+                    {
+                        parse->array_begin = candidate;
+                        parse->array_end = at + 1;
+                    }
+                    candidate = NULL;
+                }
+            }
+            break;
+        }
+        return depth >= 0;
+    });
+
+    usize array_size = parse->array_end - parse->array_begin;
+    u32 job_count = (u32) (array_size / ACF_PARALLEL_MIN_JOB_SIZE);
+    if (job_count > max_job_count) job_count = max_job_count;
+    if (job_count > ACF_PARALLEL_MAX_JOBS) job_count = ACF_PARALLEL_MAX_JOBS;
+    if (job_count < 2) return 0;
+
+    // @note: Every job but the last ends with the comma after its last element, the next one starts after it.
+    char const *job_begin = parse->array_begin + 1;
+    char const *contents_end = parse->array_end - 1;
+
+    depth = 0;
+    scan_acf_structure(job_begin, contents_end, [&](char const *at)
+    {
+        switch (*at)
+        {
+            case '[': case '{': case '(': depth += 1; break;
+            case ']': case '}': case ')': depth -= 1; break;
+
+            case ',':
+            {
+                char const *target = parse->array_begin + (parse->job_count + 1) * array_size / job_count;
+                if ((depth == 0) && (at >= target))
+                {
+                    acf_parallel_job *job = parse->jobs + parse->job_count++;
+                    job->begin = job_begin;
+                    job->end = at + 1;
+                    job_begin = at + 1;
+                }
+            }
+            break;
+        }
+        return parse->job_count + 1 < job_count;
+    });
+
+    acf_parallel_job *last_job = parse->jobs + parse->job_count++;
+    last_job->begin = job_begin;
+    last_job->end = contents_end;
+
+    // @note: Slices are allocated from the document's arena, they are rolled back if the parallel parse fails.
+    memory::arena_allocator *arena = &document->arena;
+    usize job_memory = (arena->size - arena->used) / 2;
+    parse->slices = memory::begin_temporary(arena);
+    for (u32 job_index = 0; job_index < parse->job_count; job_index++)
+    {
+        acf_parallel_job *job = parse->jobs + job_index;
+
+        usize size = (usize) ((f64) job_memory * (f64) (job->end - job->begin) / (f64) array_size) & ~(usize) 15;
+        void *memory = ALLOCATE_(arena, size, 16);
+        ASSERT(memory);
+
+        initialize_acf_document(&job->document, memory, size);
+        job->document.source = source;
+        job->document.source_size = source_size;
+        job->document.newtype_count = document->newtype_count;
+        memory::copy(job->document.newtypes, document->newtypes, document->newtype_count * sizeof(acf_newtype));
+        memory::copy(job->document.newtype_slots, document->newtype_slots, sizeof(document->newtype_slots));
+
+        // @note: Errors are not formatted in jobs, the sequential parse reports them.
+        job->document.has_error = true;
+
+        job->children = NULL;
+        job->count = 0;
+        job->successfull = false;
+    }
+
+    return parse->job_count;
+}
+
+
+void run_acf_parallel_parse_job(acf_parallel_parse *parse, u32 job_index)
+{
+    acf_parallel_job *job = parse->jobs + job_index;
+
+    acf_document_parser parser;
+    begin_acf_document_parser(&parser, &job->document);
+    parser.at = job->begin;
+    parser.end = job->end;
+    parser.depth = 2; // @note: Root object and the array the job is a part of.
+
+    // @note: Same loop as in parse_acf_document_array, the end of the job is the end of the file here.
+    bool successfull = true;
+    while (successfull && get_token(&parser).type != acf_document_token_type::end_of_file)
+    {
+        acf_node value;
+        successfull = parse_acf_document_value(&parser, &value) && push_scratch_entry(&parser, {}, value);
+
+        if (successfull && get_token(&parser).type == acf_document_token_type::comma)
+        {
+            eat_token(&parser);
+        }
+    }
+
+    job->count = parser.scratch_count;
+    successfull = successfull && commit_scratch_entries(&parser, 0, &job->children, NULL, NULL);
+
+    end_acf_document_parser(&parser);
+    job->successfull = successfull;
+}
+
+
+// @note: Bytes in [low, high) were moved by delta, pointers into them follow, others stay as they are.
+template <typename T>
+INTERNAL
+T *relocate_acf_parallel_pointer(T *pointer, memory::byte *low, memory::byte *high, isize delta)
+{
+    memory::byte *at = (memory::byte *) pointer;
+    return ((low <= at) && (at < high)) ? (T *) (at + delta) : pointer;
+}
+
+
+INTERNAL
+void relocate_acf_parallel_nodes(acf_node *nodes, u32 count, memory::byte *low, memory::byte *high, isize delta)
+{
+    for (u32 node_index = 0; node_index < count; node_index++)
+    {
+        acf_node *node = nodes + node_index;
+        if (node->is_array() || node->is_object() || node->is_custom())
+        {
+            node->children = relocate_acf_parallel_pointer(node->children, low, high, delta);
+            if (node->is_object())
+            {
+                node->keys = relocate_acf_parallel_pointer(node->keys, low, high, delta);
+            }
+            relocate_acf_parallel_nodes(node->children, node->count, low, high, delta);
+        }
+    }
+}
+
+
+// @note: Jobs used only the beginnings of their slices. Everything they used is moved down next to each other,
+// in order, so every move goes to lower addresses, then the slices are given back and the moved bytes are
+// allocated again in one piece. Keys and strings point to the source, which does not move.
+INTERNAL
+bool compact_acf_parallel_jobs(acf_parallel_parse *parse)
+{
+    memory::byte *begin = parse->jobs[0].document.arena.memory;
+    memory::byte *to = begin;
+
+    for (u32 job_index = 0; job_index < parse->job_count; job_index++)
+    {
+        acf_parallel_job *job = parse->jobs + job_index;
+        memory::arena_allocator *slice = &job->document.arena;
+
+        to = (memory::byte *) memory::align_pointer(to, 16);
+        isize delta = to - slice->memory;
+
+        memmove(to, slice->memory, slice->used);
+        job->children = relocate_acf_parallel_pointer(job->children, slice->memory, slice->memory + slice->used, delta);
+        relocate_acf_parallel_nodes(job->children, job->count, slice->memory, slice->memory + slice->used, delta);
+
+        to += slice->used;
+    }
+
+    memory::end_temporary(parse->slices);
+
+    // @note: Slices started at the same position with the same alignment, so this lands on the moved bytes.
+    memory::byte *compacted = (memory::byte *) ALLOCATE_(&parse->document->arena, to - begin, 16);
+    return (compacted == begin);
+}
+
+
+bool finish_acf_parallel_parse(acf_parallel_parse *parse)
+{
+    acf_document *document = parse->document;
+    acf_document_parser *parser = &parse->parser;
+
+    bool successfull = !parse->failed;
+    for (u32 job_index = 0; job_index < parse->job_count; job_index++)
+    {
+        successfull = successfull && parse->jobs[job_index].successfull;
+    }
+
+    if (parse->job_count)
+    {
+        if (successfull)
+        {
+            successfull = compact_acf_parallel_jobs(parse);
+        }
+        else
+        {
+            memory::end_temporary(parse->slices);
+        }
+    }
+
+    acf_document_parser::parsed_array array = {};
+    if (successfull && parse->job_count)
+    {
+        u32 count = 0;
+        for (u32 job_index = 0; job_index < parse->job_count; job_index++)
+        {
+            count += parse->jobs[job_index].count;
+        }
+
+        array.span = parse->array_begin;
+        array.end = parse->array_end;
+        array.node.type = acf_type_t::array;
+        array.node.count = count;
+        array.node.children = ALLOCATE_BUFFER_(&document->arena, acf_node, count);
+        successfull = (array.node.children != NULL);
+
+        u32 offset = 0;
+        for (u32 job_index = 0; successfull && job_index < parse->job_count; job_index++)
+        {
+            acf_parallel_job *job = parse->jobs + job_index;
+            if (job->count)
+            {
+                memory::copy(array.node.children + offset, job->children, job->count * sizeof(acf_node));
+                offset += job->count;
+            }
+        }
+
+        parser->done_array = &array;
+    }
+
+    // @note: Children are copied out of the jobs by now, their memory stays in the rollback scope.
+    for (u32 job_index = 0; job_index < parse->job_count; job_index++)
+    {
+        release_acf_document(&parse->jobs[job_index].document);
+    }
+
+    if (successfull)
+    {
+        successfull = parse_acf_document_object(parser, &document->root, true);
+    }
+
+    if (successfull)
+    {
+        acf_document_token t = get_token(parser);
+        if (t.type != acf_document_token_type::end_of_file)
+        {
+            acf_document_report_error(parser, t.span, "Unexpected symbols after the end of the document.");
+            successfull = false;
+        }
+    }
+
+    end_acf_document_parser(parser);
+    parser->done_array = NULL;
+
+    if (successfull)
+    {
+        memory::commit_temporary(parse->rollback);
+        return true;
+    }
+
+    // @note: Sequential parse gives the same error messages in the same places.
+    memory::end_temporary(parse->rollback);
+    truncate_acf_document_newtypes(document, parse->newtype_count);
+    return parse_acf_document(document, document->source, document->source_size);
+}
+
+
+#endif // ACF_LIB_IMPLEMENTATION
+#endif // ACF_PARALLEL_HPP
@@ -0,0 +1,642 @@
+#ifndef ACF_REFLECT_HPP
+#define ACF_REFLECT_HPP
+
+#include <defines.hpp>
+#include <acf/acf_document.hpp>
+#include <acf/acf_stream.hpp>
+
+// Standard headers
+#include <stddef.h>
+
+
+/*
+    ACF Reflection
+
+    Binds ACF values straight into C++ structs. Fields of a struct are
+    declared once, next to the struct, and the descriptor is built at
+    compile time (keys are hashed by the compiler too):
+
+        struct vec2 { float32 x; float32 y; };
+        ACF_STRUCT(vec2, ACF_FIELD(x), ACF_FIELD(y));
+
+        struct window_config
+        {
+            int32 width;
+            int32 height;
+            bool fullscreen;
+            char title[64];       // strings are copied into fixed buffers
+            vec2 position;        // nested struct, an object or vec2(1, 2)
+            float32 tint[4];      // fixed array, from an ACF array
+        };
+        ACF_STRUCT(window_config,
+            ACF_FIELD(width),
+            ACF_FIELD(height),
+            ACF_FIELD(fullscreen),
+            ACF_FIELD(title),
+            ACF_FIELD_NAMED(position, "pos"),
+            ACF_FIELD(tint));
+
+    An object is bound in one pass over its children, every key is matched
+    against the descriptor and the value is written into the field, so
+    there are no repeated lookups and type checks at every access:
+
+        window_config config = {};
+        if (bind_acf(document.root["window"], &config)) { ... }
+
+    With the stream binder the struct is filled from the parse events, and
+    no document is built at all:
+
+        acf_struct_binder binder;
+        begin_acf_bind(&binder, &config);
+        feed_acf_struct_bind(&binder, chunk, chunk_size); // ...
+        if (!finish_acf_struct_bind(&binder)) { binder.stream.error_buffer ... }
+
+    The same descriptor registers the struct as a newtype, with the fields
+    as arguments in declaration order, so "vec2(1, 2)" can be written in
+    the source without the #newtype directive:
+
+        register_acf_document_struct(&document, get_acf_struct<vec2>());
+        register_acf_stream_struct(&binder.stream, get_acf_struct<vec2>()); // after begin_acf_bind
+
+    Keys without a field are skipped, fields without a key keep their
+    values. Types have to match, except that integers are accepted by float
+    fields; integers which do not fit into the field, arrays longer than the
+    field and strings longer than the buffer (including the zero) are errors.
+    ACF_STRUCT has to be used at the global scope, with the plain type name.
+*/
+
+
+enum class acf_field_kind : u8
+{
+    boolean,
+    int32,
+    uint32,
+    int64,
+    float32,
+    float64,
+    string,    // char[N], zero-terminated
+    structure, // nested struct with its own ACF_STRUCT
+};
+
+
+struct acf_struct;
+
+
+struct acf_field
+{
+    acf_key key;
+    u32 offset;
+    u32 size;  // @note: Size of one element, for strings it is the buffer capacity.
+    u32 count; // @note: Number of elements for fixed arrays, 1 otherwise.
+    acf_field_kind kind;
+    acf_struct const *structure;
+};
+
+
+struct acf_struct
+{
+    char const *name;
+    acf_field const *fields;
+    u32 field_count;
+    u32 size;
+};
+
+
+// @note: Defined for each type by ACF_STRUCT.
+template <typename T>
+constexpr acf_struct const *get_acf_struct();
+
+
+template <typename T>
+struct acf_field_traits
+{
+    static constexpr acf_field_kind kind = acf_field_kind::structure;
+    static constexpr acf_struct const *structure() { return get_acf_struct<T>(); }
+};
+
+#define ACF_FIELD_TRAITS(TYPE, KIND) \
+    template <> struct acf_field_traits<TYPE> \
+    { \
+        static constexpr acf_field_kind kind = acf_field_kind::KIND; \
+        static constexpr acf_struct const *structure() { return NULL; } \
+    }
+
+ACF_FIELD_TRAITS(bool,    boolean);
+ACF_FIELD_TRAITS(int32,   int32);
+ACF_FIELD_TRAITS(uint32,  uint32);
+ACF_FIELD_TRAITS(int64,   int64);
+ACF_FIELD_TRAITS(float32, float32);
+ACF_FIELD_TRAITS(float64, float64);
+
+#undef ACF_FIELD_TRAITS
+
+template <usize N>
+struct acf_field_traits<char[N]>
+{
+    static constexpr acf_field_kind kind = acf_field_kind::string;
+    static constexpr acf_struct const *structure() { return NULL; }
+};
+
+
+// @note: Splits T[N] into the element and the count, but char[N] is a single string.
+template <typename T>
+struct acf_field_shape
+{
+    using element = T;
+    static constexpr u32 count = 1;
+};
+
+template <typename T, usize N>
+struct acf_field_shape<T[N]>
+{
+    using element = T;
+    static constexpr u32 count = N;
+};
+
+template <usize N>
+struct acf_field_shape<char[N]>
+{
+    using element = char[N];
+    static constexpr u32 count = 1;
+};
+
+template <usize N, usize M>
+struct acf_field_shape<char[N][M]>
+{
+    using element = char[M];
+    static constexpr u32 count = N;
+};
+
+
+template <typename Field, usize N>
+constexpr acf_field make_acf_field(char const (&name)[N], usize offset)
+{
+    using element = typename acf_field_shape<Field>::element;
+
+    acf_field result = {};
+    result.key = make_acf_key(name);
+    result.offset = (u32) offset;
+    result.size = (u32) sizeof(element);
+    result.count = acf_field_shape<Field>::count;
+    result.kind = acf_field_traits<element>::kind;
+    result.structure = acf_field_traits<element>::structure();
+    return result;
+}
+
+
+#define ACF_FIELD(NAME) ACF_FIELD_NAMED(NAME, #NAME)
+#define ACF_FIELD_NAMED(NAME, KEY) make_acf_field<decltype(acf_self::NAME)>(KEY, offsetof(acf_self, NAME))
+
+#define ACF_STRUCT(TYPE, ...) \
+    namespace acf_reflect_##TYPE \
+    { \
+        using acf_self = TYPE; \
+        GLOBAL constexpr acf_field const fields[] = { __VA_ARGS__ }; \
+        GLOBAL constexpr acf_struct const structure = { #TYPE, fields, (u32) ARRAY_COUNT(fields), (u32) sizeof(TYPE) }; \
+    } \
+    template <> constexpr acf_struct const *get_acf_struct<TYPE>() { return &acf_reflect_##TYPE::structure; } \
+    static_assert(true, "")
+
+
+bool bind_acf_struct(acf_node const& node, acf_struct const *structure, void *result);
+
+template <typename T>
+bool bind_acf(acf_node const& node, T *result)
+{
+    return bind_acf_struct(node, get_acf_struct<T>(), result);
+}
+
+bool register_acf_document_struct(acf_document *document, acf_struct const *structure);
+bool register_acf_stream_struct(acf_stream *stream, acf_struct const *structure);
+
+
+struct acf_struct_binder
+{
+    enum class frame_kind : u8
+    {
+        object, // @note: Fields by key, index is the search hint.
+        custom, // @note: Fields by position.
+        array,  // @note: Elements of a fixed array field.
+        skip,   // @note: Value without a field, everything inside is ignored.
+    };
+
+    struct frame
+    {
+        frame_kind kind;
+        u32 index;
+        acf_struct const *structure;
+        acf_field const *field;
+        u8 *base;
+    };
+
+    acf_stream stream;
+
+    frame frames[ACF_STREAM_MAX_DEPTH];
+    u32 depth;
+    acf_field const *key_field; // @note: Field of the last key, NULL if the key is unknown.
+};
+
+
+void begin_acf_struct_bind(acf_struct_binder *binder, acf_struct const *structure, void *result);
+bool feed_acf_struct_bind(acf_struct_binder *binder, char const *data, usize size);
+bool finish_acf_struct_bind(acf_struct_binder *binder);
+
+template <typename T>
+void begin_acf_bind(acf_struct_binder *binder, T *result)
+{
+    begin_acf_struct_bind(binder, get_acf_struct<T>(), result);
+}
+
+
+#ifdef ACF_LIB_IMPLEMENTATION
+
+
+// @note: Search starts at the hint, which is the field after the previous match, so keys
+// written in the order of the declaration are found at the first comparison.
+INTERNAL
+acf_field const *find_acf_field(acf_struct const *structure, acf_key key, u32 *hint)
+{
+    u32 field_index = (*hint < structure->field_count) ? *hint : 0;
+    for (u32 i = 0; i < structure->field_count; i++)
+    {
+        if (structure->fields[field_index].key == key)
+        {
+            *hint = field_index + 1;
+            return structure->fields + field_index;
+        }
+
+        field_index += 1;
+        if (field_index == structure->field_count) field_index = 0;
+    }
+    return NULL;
+}
+
+
+// @note: Writes one element of the field, value has to be a scalar here.
+INTERNAL
+bool bind_acf_scalar(acf_field const *field, acf_node const& value, u8 *destination)
+{
+    switch (field->kind)
+    {
+        case acf_field_kind::boolean:
+        {
+            if (!value.is_boolean()) return false;
+            *(bool *) destination = value.boolean_value;
+        }
+        break;
+
+        case acf_field_kind::int32:
+        {
+            if (!value.is_integer() || (int64) (int32) value.integer_value != value.integer_value) return false;
+            *(int32 *) destination = (int32) value.integer_value;
+        }
+        break;
+
+        case acf_field_kind::uint32:
+        {
+            if (!value.is_integer() || (int64) (uint32) value.integer_value != value.integer_value) return false;
+            *(uint32 *) destination = (uint32) value.integer_value;
+        }
+        break;
+
+        case acf_field_kind::int64:
+        {
+            if (!value.is_integer()) return false;
+            *(int64 *) destination = value.integer_value;
+        }
+        break;
+
+        case acf_field_kind::float32:
+        {
+            if (!value.is_floating() && !value.is_integer()) return false;
+            *(float32 *) destination = (float32) value.get_float_or(0);
+        }
+        break;
+
+        case acf_field_kind::float64:
+        {
+            if (!value.is_floating() && !value.is_integer()) return false;
+            *(float64 *) destination = value.get_float_or(0);
+        }
+        break;
+
+        case acf_field_kind::string:
+        {
+            if (!value.is_string() || value.count >= field->size) return false;
+            memory::copy(destination, value.string_value, value.count);
+            destination[value.count] = 0;
+        }
+        break;
+
+        case acf_field_kind::structure: return false;
+    }
+
+    return true;
+}
+
+
+INTERNAL
+bool bind_acf_element(acf_field const *field, acf_node const& value, u8 *destination)
+{
+    if (field->kind == acf_field_kind::structure)
+    {
+        return bind_acf_struct(value, field->structure, destination);
+    }
+    return bind_acf_scalar(field, value, destination);
+}
+
+
+INTERNAL
+bool bind_acf_field(acf_field const *field, acf_node const& value, u8 *base)
+{
+    u8 *destination = base + field->offset;
+    if (field->count == 1)
+    {
+        return bind_acf_element(field, value, destination);
+    }
+
+    if (!value.is_array() || value.count > field->count) return false;
+    for (u32 i = 0; i < value.count; i++)
+    {
+        if (!bind_acf_element(field, value.children[i], destination + i * field->size)) return false;
+    }
+    return true;
+}
+
+
+bool bind_acf_struct(acf_node const& node, acf_struct const *structure, void *result)
+{
+    u8 *base = (u8 *) result;
+
+    if (node.is_object())
+    {
+        u32 hint = 0;
+        for (u32 i = 0; i < node.count; i++)
+        {
+            acf_field const *field = find_acf_field(structure, node.keys[i], &hint);
+            if (field && !bind_acf_field(field, node.children[i], base)) return false;
+        }
+        return true;
+    }
+
+    if (node.is_custom())
+    {
+        if ((node.count != structure->field_count) || (*node.newtype_name != structure->name)) return false;
+        for (u32 i = 0; i < node.count; i++)
+        {
+            if (!bind_acf_field(structure->fields + i, node.children[i], base)) return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+
+INTERNAL
+bool get_acf_struct_newtype_arguments(acf_struct const *structure, acf_type_t *arguments)
+{
+    if (structure->field_count > ACF_MAX_NEWTYPE_ARGUMENTS) return false;
+
+    for (u32 i = 0; i < structure->field_count; i++)
+    {
+        acf_field const *field = structure->fields + i;
+        switch (field->kind)
+        {
+            case acf_field_kind::boolean:   arguments[i] = acf_type_t::boolean;  break;
+            case acf_field_kind::int32:
+            case acf_field_kind::uint32:
+            case acf_field_kind::int64:     arguments[i] = acf_type_t::integer;  break;
+            case acf_field_kind::float32:
+            case acf_field_kind::float64:   arguments[i] = acf_type_t::floating; break;
+            case acf_field_kind::string:    arguments[i] = acf_type_t::string;   break;
+            case acf_field_kind::structure: arguments[i] = acf_type_t::object;   break;
+        }
+        if (field->count > 1) arguments[i] = acf_type_t::array;
+    }
+    return true;
+}
+
+
+bool register_acf_document_struct(acf_document *document, acf_struct const *structure)
+{
+    acf_type_t arguments[ACF_MAX_NEWTYPE_ARGUMENTS];
+    return get_acf_struct_newtype_arguments(structure, arguments) &&
+        register_acf_document_newtype(document, structure->name, structure->field_count, arguments);
+}
+
+
+bool register_acf_stream_struct(acf_stream *stream, acf_struct const *structure)
+{
+    u32 name_size = 0;
+    while (structure->name[name_size]) name_size += 1;
+
+    acf_type_t arguments[ACF_MAX_NEWTYPE_ARGUMENTS];
+    return get_acf_struct_newtype_arguments(structure, arguments) &&
+        register_acf_stream_newtype(stream, { structure->name, name_size }, structure->field_count, arguments);
+}
+
+
+// @note: Finds which field, and which element of it, the next value of the top frame goes to.
+// Returns false on error; field is NULL when the value has to be skipped.
+INTERNAL
+bool get_acf_struct_bind_target(acf_struct_binder *binder, acf_field const **field, u8 **destination, bool *is_whole_array)
+{
+    acf_struct_binder::frame *top = binder->frames + binder->depth - 1;
+
+    *field = NULL;
+    *destination = NULL;
+    *is_whole_array = false;
+
+    switch (top->kind)
+    {
+        case acf_struct_binder::frame_kind::object:
+        {
+            *field = binder->key_field;
+            binder->key_field = NULL;
+        }
+        break;
+
+        case acf_struct_binder::frame_kind::custom:
+        {
+            if (top->index == top->structure->field_count)
+            {
+                acf_stream_report_error(&binder->stream, "Too many arguments for '%s'.", top->structure->name);
+                return false;
+            }
+            *field = top->structure->fields + top->index++;
+        }
+        break;
+
+        case acf_struct_binder::frame_kind::array:
+        {
+            if (top->index == top->field->count)
+            {
+                acf_stream_report_error(&binder->stream, "Array has more than %u elements.", top->field->count);
+                return false;
+            }
+            *field = top->field;
+            *destination = top->base + (top->index++) * top->field->size;
+        }
+        return true;
+
+        case acf_struct_binder::frame_kind::skip: return true;
+    }
+
+    if (*field)
+    {
+        *destination = top->base + (*field)->offset;
+        *is_whole_array = ((*field)->count > 1);
+    }
+    return true;
+}
+
+
+INTERNAL
+bool push_acf_struct_bind_frame(acf_struct_binder *binder, acf_struct_binder::frame frame)
+{
+    // @note: The stream has the same depth limit, so this can not overflow.
+    ASSERT(binder->depth < ACF_STREAM_MAX_DEPTH);
+    binder->frames[binder->depth++] = frame;
+    return true;
+}
+
+
+INTERNAL
+bool acf_struct_binder_on_event(void *user_data, acf_event const *event)
+{
+    acf_struct_binder *binder = (acf_struct_binder *) user_data;
+    acf_struct_binder::frame *top = binder->depth ? binder->frames + binder->depth - 1 : NULL;
+
+    switch (event->type)
+    {
+        case acf_event_type::newtype: return true;
+
+        case acf_event_type::key:
+        {
+            binder->key_field = NULL;
+            if (top->kind == acf_struct_binder::frame_kind::object)
+            {
+                binder->key_field = find_acf_field(top->structure, make_acf_key(event->key.data, event->key.size), &top->index);
+            }
+        }
+        return true;
+
+        case acf_event_type::end_object:
+        case acf_event_type::end_array:
+        case acf_event_type::end_custom:
+        {
+            if (top->kind == acf_struct_binder::frame_kind::skip && top->index > 0)
+            {
+                top->index -= 1;
+                return true;
+            }
+
+            if ((top->kind == acf_struct_binder::frame_kind::custom) && (top->index < top->structure->field_count))
+            {
+                acf_stream_report_error(&binder->stream, "Too few arguments for '%s'.", top->structure->name);
+                return false;
+            }
+
+            binder->depth -= 1;
+        }
+        return true;
+
+        default: break;
+    }
+
+    // @note: Root object, it is the only begin event without a frame.
+    if (top == NULL)
+    {
+        return push_acf_struct_bind_frame(binder, { acf_struct_binder::frame_kind::object, 0, binder->frames[0].structure, NULL, binder->frames[0].base });
+    }
+
+    // @note: Nested containers inside of a skipped value only count the depth.
+    if (top->kind == acf_struct_binder::frame_kind::skip)
+    {
+        if (event->type != acf_event_type::value) top->index += 1;
+        return true;
+    }
+
+    acf_field const *field;
+    u8 *destination;
+    bool is_whole_array;
+    if (!get_acf_struct_bind_target(binder, &field, &destination, &is_whole_array)) return false;
+
+    if (field == NULL)
+    {
+        if (event->type == acf_event_type::value) return true;
+        return push_acf_struct_bind_frame(binder, { acf_struct_binder::frame_kind::skip, 0, NULL, NULL, NULL });
+    }
+
+    switch (event->type)
+    {
+        case acf_event_type::value:
+        {
+            if (!is_whole_array && bind_acf_scalar(field, event->value, destination)) return true;
+        }
+        break;
+
+        case acf_event_type::begin_array:
+        {
+            if (is_whole_array)
+            {
+                return push_acf_struct_bind_frame(binder, { acf_struct_binder::frame_kind::array, 0, NULL, field, destination });
+            }
+        }
+        break;
+
+        case acf_event_type::begin_object:
+        {
+            if (!is_whole_array && field->kind == acf_field_kind::structure)
+            {
+                return push_acf_struct_bind_frame(binder, { acf_struct_binder::frame_kind::object, 0, field->structure, NULL, destination });
+            }
+        }
+        break;
+
+        case acf_event_type::begin_custom:
+        {
+            if (!is_whole_array && (field->kind == acf_field_kind::structure) && (*event->newtype->name == field->structure->name))
+            {
+                return push_acf_struct_bind_frame(binder, { acf_struct_binder::frame_kind::custom, 0, field->structure, NULL, destination });
+            }
+        }
+        break;
+
+        default: break;
+    }
+
+    acf_stream_report_error(&binder->stream, "Value does not fit into the field '%.*s'.", (int) field->key.size, field->key.data);
+    return false;
+}
+
+
+void begin_acf_struct_bind(acf_struct_binder *binder, acf_struct const *structure, void *result)
+{
+    binder->depth = 0;
+    binder->key_field = NULL;
+
+    // @note: The root frame is pushed by the first begin_object, until then it only keeps the target.
+    binder->frames[0] = {};
+    binder->frames[0].structure = structure;
+    binder->frames[0].base = (u8 *) result;
+
+    initialize_acf_stream(&binder->stream, acf_struct_binder_on_event, binder);
+}
+
+
+bool feed_acf_struct_bind(acf_struct_binder *binder, char const *data, usize size)
+{
+    return feed_acf_stream(&binder->stream, data, size);
+}
+
+
+bool finish_acf_struct_bind(acf_struct_binder *binder)
+{
+    return finish_acf_stream(&binder->stream);
+}
+
+
+#endif // ACF_LIB_IMPLEMENTATION
+#endif // ACF_REFLECT_HPP
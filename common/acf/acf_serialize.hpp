@@ -0,0 +1,931 @@
+#ifndef ACF_SERIALIZE_HPP
+#define ACF_SERIALIZE_HPP
+
+#include <defines.hpp>
+#include <allocator.hpp>
+#include <acf/acf_document.hpp>
+
+
+/*
+    ACF Serializer
+
+    Writes a document tree back to text, into a growable buffer. Unlike
+    acf_print, which calls printf for every token, the serializer formats
+    everything by hand:
+
+        - the buffer is grown (doubled) only when a token does not fit, every
+          token reserves its maximum size once and is then written without checks;
+        - integers are formatted two digits at a time from a table;
+        - floats are formatted with Grisu3, which gives the shortest digits
+          that parse back to the same double, instead of the six fixed
+          decimals of "%lf", which lost precision on every save.
+
+    The format has no escapes, no infinities and no NaNs, so strings with '"'
+    or a newline in them and non-finite floats can not be written; the
+    serializer returns false then, as well as when the buffer can not grow.
+
+    Usage:
+
+        acf_buffer buffer = {};
+        if (acf_serialize_document(&document, &buffer))
+        {
+            os::write_file(filename, { (memory::byte *) buffer.data, buffer.size });
+        }
+        free_acf_buffer(&buffer);
+
+    Compact output, one line without optional spaces:
+
+        acf_serialize_options options;
+        options.multiline = acf_serialize_options::multiline_t::disabled;
+        options.print_spaces = false;
+*/
+
+
+struct acf_buffer
+{
+    char *data;
+    usize size;
+    usize capacity;
+};
+
+
+struct acf_serialize_options
+{
+    enum class multiline_t
+    {
+        disabled,
+        enabled,
+        smart,
+    };
+
+    bool print_semicolons = true;
+    bool print_commas = true;
+    bool print_spaces = true; // @note: Only affects containers written in one line.
+    int32 indent = 2;
+    multiline_t multiline = multiline_t::smart;
+    int32 max_elements_in_line = 3;
+};
+
+
+#define ACF_FLOAT_BUFFER_SIZE 32
+
+
+bool acf_serialize(acf_node const& node, acf_buffer *buffer, acf_serialize_options options = acf_serialize_options());
+bool acf_serialize_document(acf_document const *document, acf_buffer *buffer, acf_serialize_options options = acf_serialize_options());
+void free_acf_buffer(acf_buffer *buffer);
+
+// @note: Both write at most ACF_FLOAT_BUFFER_SIZE characters, without the terminating zero, and return the size.
+// Floats always get a '.' or an exponent, so they read back as floats. Infinities and NaNs give 0.
+u32 format_acf_int(int64 value, char *buffer);
+u32 format_acf_float(float64 value, char *buffer);
+
+
+#ifdef ACF_LIB_IMPLEMENTATION
+
+
+GLOBAL memory::mallocator acf_buffer_mallocator = { "acf buffer" };
+
+#define ACF_BUFFER_INITIAL_CAPACITY KILOBYTES(4)
+
+
+INTERNAL
+u32 format_acf_u64(u64 value, char *buffer)
+{
+    GLOBAL char const digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    // @note: Filled from the end, then moved to the front.
+    char digits[20];
+    char *at = digits + sizeof(digits);
+    while (value >= 100)
+    {
+        u32 pair = (u32) (value % 100) * 2;
+        value /= 100;
+        at -= 2;
+        at[0] = digit_pairs[pair];
+        at[1] = digit_pairs[pair + 1];
+    }
+    if (value >= 10)
+    {
+        u32 pair = (u32) value * 2;
+        at -= 2;
+        at[0] = digit_pairs[pair];
+        at[1] = digit_pairs[pair + 1];
+    }
+    else
+    {
+        *--at = (char) ('0' + value);
+    }
+
+    u32 size = (u32) (digits + sizeof(digits) - at);
+    memory::copy(buffer, at, size);
+    return size;
+}
+
+
+u32 format_acf_int(int64 value, char *buffer)
+{
+    u32 result = 0;
+    u64 magnitude = (u64) value;
+    if (value < 0)
+    {
+        buffer[result++] = '-';
+        magnitude = 0 - magnitude; // @note: Works for INT64_MIN too.
+    }
+    result += format_acf_u64(magnitude, buffer + result);
+    return result;
+}
+
+
+/*
+    Grisu3, by Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+    Accurately with Integers". The layout follows the well known
+    implementations from nlohmann/json (dtoa_impl) and double-conversion,
+    which in turn follow the paper.
+
+    The double v is turned into a 64-bit "do-it-yourself" float, its
+    neighbours m- and m+ give the interval of numbers that round to v. All
+    three are scaled by a cached power of ten c = 10^-k, so that the exponent
+    of the product lands in [alpha, gamma], then the digits are generated
+    from the scaled upper bound until they fall into the scaled interval.
+
+    The products are off by one unit. Grisu2 shrinks the interval by that
+    and misses the shortest digits for some values (5.028351117114574e132
+    came out with 17 digits). Grisu3 works on the interval widened by the
+    error instead, and gives up when it can not prove that the digits are
+    the shortest and the closest ones, which happens for about 0.5% of
+    doubles. Those go to a slow path on printf and strtod.
+*/
+
+struct acf_diyfp
+{
+    u64 f;
+    int32 e;
+};
+
+
+INTERNAL
+acf_diyfp acf_diyfp_sub(acf_diyfp x, acf_diyfp y)
+{
+    ASSERT(x.e == y.e && x.f >= y.f);
+    acf_diyfp result = { x.f - y.f, x.e };
+    return result;
+}
+
+
+// @note: Upper 64 bits of the 128-bit product, rounded.
+INTERNAL
+acf_diyfp acf_diyfp_mul(acf_diyfp x, acf_diyfp y)
+{
+    u64 x_lo = x.f & 0xFFFFFFFFu;
+    u64 x_hi = x.f >> 32;
+    u64 y_lo = y.f & 0xFFFFFFFFu;
+    u64 y_hi = y.f >> 32;
+
+    u64 p0 = x_lo * y_lo;
+    u64 p1 = x_lo * y_hi;
+    u64 p2 = x_hi * y_lo;
+    u64 p3 = x_hi * y_hi;
+
+    u64 middle = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+    middle += 1ull << 31;
+
+    acf_diyfp result = { p3 + (p2 >> 32) + (p1 >> 32) + (middle >> 32), x.e + y.e + 64 };
+    return result;
+}
+
+
+INTERNAL
+acf_diyfp acf_diyfp_normalize(acf_diyfp x)
+{
+    ASSERT(x.f != 0);
+    while ((x.f >> 63) == 0)
+    {
+        x.f <<= 1;
+        x.e -= 1;
+    }
+    return x;
+}
+
+
+INTERNAL
+acf_diyfp acf_diyfp_normalize_to(acf_diyfp x, int32 target_exponent)
+{
+    int32 delta = x.e - target_exponent;
+    ASSERT(delta >= 0 && ((x.f << delta) >> delta) == x.f);
+
+    acf_diyfp result = { x.f << delta, target_exponent };
+    return result;
+}
+
+
+struct acf_cached_power
+{
+    u64 f;
+    int32 e;
+    int32 k;
+};
+
+
+// @note: Range of the product exponents, for which the digit generation works on 64-bit integers.
+#define ACF_GRISU_ALPHA (-60)
+#define ACF_GRISU_GAMMA (-32)
+
+
+// @note: Finds c = 10^k, such that for the diyfp with exponent e, product exponent is in [alpha, gamma].
+INTERNAL
+acf_cached_power get_acf_cached_power(int32 e)
+{
+    // @note: 10^k for k = -300, -292, ..., 324, normalized.
+    GLOBAL acf_cached_power const cached_powers[] =
+    {
+        { 0xAB70FE17C79AC6CA, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4F, -1034, -292 },
+        { 0xBE5691EF416BD60C, -1007, -284 },
+        { 0x8DD01FAD907FFC3C,  -980, -276 },
+        { 0xD3515C2831559A83,  -954, -268 },
+        { 0x9D71AC8FADA6C9B5,  -927, -260 },
+        { 0xEA9C227723EE8BCB,  -901, -252 },
+        { 0xAECC49914078536D,  -874, -244 },
+        { 0x823C12795DB6CE57,  -847, -236 },
+        { 0xC21094364DFB5637,  -821, -228 },
+        { 0x9096EA6F3848984F,  -794, -220 },
+        { 0xD77485CB25823AC7,  -768, -212 },
+        { 0xA086CFCD97BF97F4,  -741, -204 },
+        { 0xEF340A98172AACE5,  -715, -196 },
+        { 0xB23867FB2A35B28E,  -688, -188 },
+        { 0x84C8D4DFD2C63F3B,  -661, -180 },
+        { 0xC5DD44271AD3CDBA,  -635, -172 },
+        { 0x936B9FCEBB25C996,  -608, -164 },
+        { 0xDBAC6C247D62A584,  -582, -156 },
+        { 0xA3AB66580D5FDAF6,  -555, -148 },
+        { 0xF3E2F893DEC3F126,  -529, -140 },
+        { 0xB5B5ADA8AAFF80B8,  -502, -132 },
+        { 0x87625F056C7C4A8B,  -475, -124 },
+        { 0xC9BCFF6034C13053,  -449, -116 },
+        { 0x964E858C91BA2655,  -422, -108 },
+        { 0xDFF9772470297EBD,  -396, -100 },
+        { 0xA6DFBD9FB8E5B88F,  -369,  -92 },
+        { 0xF8A95FCF88747D94,  -343,  -84 },
+        { 0xB94470938FA89BCF,  -316,  -76 },
+        { 0x8A08F0F8BF0F156B,  -289,  -68 },
+        { 0xCDB02555653131B6,  -263,  -60 },
+        { 0x993FE2C6D07B7FAC,  -236,  -52 },
+        { 0xE45C10C42A2B3B06,  -210,  -44 },
+        { 0xAA242499697392D3,  -183,  -36 },
+        { 0xFD87B5F28300CA0E,  -157,  -28 },
+        { 0xBCE5086492111AEB,  -130,  -20 },
+        { 0x8CBCCC096F5088CC,  -103,  -12 },
+        { 0xD1B71758E219652C,   -77,   -4 },
+        { 0x9C40000000000000,   -50,    4 },
+        { 0xE8D4A51000000000,   -24,   12 },
+        { 0xAD78EBC5AC620000,     3,   20 },
+        { 0x813F3978F8940984,    30,   28 },
+        { 0xC097CE7BC90715B3,    56,   36 },
+        { 0x8F7E32CE7BEA5C70,    83,   44 },
+        { 0xD5D238A4ABE98068,   109,   52 },
+        { 0x9F4F2726179A2245,   136,   60 },
+        { 0xED63A231D4C4FB27,   162,   68 },
+        { 0xB0DE65388CC8ADA8,   189,   76 },
+        { 0x83C7088E1AAB65DB,   216,   84 },
+        { 0xC45D1DF942711D9A,   242,   92 },
+        { 0x924D692CA61BE758,   269,  100 },
+        { 0xDA01EE641A708DEA,   295,  108 },
+        { 0xA26DA3999AEF774A,   322,  116 },
+        { 0xF209787BB47D6B85,   348,  124 },
+        { 0xB454E4A179DD1877,   375,  132 },
+        { 0x865B86925B9BC5C2,   402,  140 },
+        { 0xC83553C5C8965D3D,   428,  148 },
+        { 0x952AB45CFA97A0B3,   455,  156 },
+        { 0xDE469FBD99A05FE3,   481,  164 },
+        { 0xA59BC234DB398C25,   508,  172 },
+        { 0xF6C69A72A3989F5C,   534,  180 },
+        { 0xB7DCBF5354E9BECE,   561,  188 },
+        { 0x88FCF317F22241E2,   588,  196 },
+        { 0xCC20CE9BD35C78A5,   614,  204 },
+        { 0x98165AF37B2153DF,   641,  212 },
+        { 0xE2A0B5DC971F303A,   667,  220 },
+        { 0xA8D9D1535CE3B396,   694,  228 },
+        { 0xFB9B7CD9A4A7443C,   720,  236 },
+        { 0xBB764C4CA7A44410,   747,  244 },
+        { 0x8BAB8EEFB6409C1A,   774,  252 },
+        { 0xD01FEF10A657842C,   800,  260 },
+        { 0x9B10A4E5E9913129,   827,  268 },
+        { 0xE7109BFBA19C0C9D,   853,  276 },
+        { 0xAC2820D9623BF429,   880,  284 },
+        { 0x80444B5E7AA7CF85,   907,  292 },
+        { 0xBF21E44003ACDD2D,   933,  300 },
+        { 0x8E679C2F5E44FF8F,   960,  308 },
+        { 0xD433179D9C8CB841,   986,  316 },
+        { 0x9E19DB92B4E31BA9,  1013,  324 },
+    };
+
+    int32 const min_decimal_exponent = -300;
+    int32 const decimal_exponent_step = 8;
+
+    // @note: k = ceil((alpha - e - 1) * log10(2)), 78913 / 2^18 is log10(2) precise enough for the range.
+    int32 f = ACF_GRISU_ALPHA - e - 1;
+    int32 k = (f * 78913) / (1 << 18) + (f > 0);
+
+    int32 index = (-min_decimal_exponent + k + (decimal_exponent_step - 1)) / decimal_exponent_step;
+    ASSERT(index >= 0 && (u32) index < ARRAY_COUNT(cached_powers));
+
+    acf_cached_power result = cached_powers[index];
+    ASSERT(ACF_GRISU_ALPHA <= result.e + e + 64 && result.e + e + 64 <= ACF_GRISU_GAMMA);
+
+    return result;
+}
+
+
+INTERNAL
+u32 find_largest_acf_pow10(u32 n, u32 *pow10)
+{
+    if (n >= 1000000000) { *pow10 = 1000000000; return 10; }
+    if (n >= 100000000)  { *pow10 = 100000000;  return 9; }
+    if (n >= 10000000)   { *pow10 = 10000000;   return 8; }
+    if (n >= 1000000)    { *pow10 = 1000000;    return 7; }
+    if (n >= 100000)     { *pow10 = 100000;     return 6; }
+    if (n >= 10000)      { *pow10 = 10000;      return 5; }
+    if (n >= 1000)       { *pow10 = 1000;       return 4; }
+    if (n >= 100)        { *pow10 = 100;        return 3; }
+    if (n >= 10)         { *pow10 = 10;         return 2; }
+
+    *pow10 = 1;
+    return 1;
+}
+
+
+// @note: Weeds out the digits which are not the closest to v, moving the last one down while that gets closer. Works on
+// the unsafe interval, which is wider than the real one by the error of the products (unit), so it tells when the
+// result is not provably the shortest and closest: then it returns false, and the slow path is taken.
+INTERNAL
+bool acf_grisu3_round_weed(char *buffer, u32 size, u64 distance_too_high_w, u64 unsafe_interval, u64 rest, u64 ten_k, u64 unit)
+{
+    u64 small_distance = distance_too_high_w - unit;
+    u64 big_distance = distance_too_high_w + unit;
+
+    while ((rest < small_distance) && (unsafe_interval - rest >= ten_k) &&
+           ((rest + ten_k < small_distance) || (small_distance - rest >= rest + ten_k - small_distance)))
+    {
+        ASSERT(buffer[size - 1] != '0');
+        buffer[size - 1] -= 1;
+        rest += ten_k;
+    }
+
+    // @note: Moving down once more could be closer to the far end of the error, so it is not known which is closer.
+    if ((rest < big_distance) && (unsafe_interval - rest >= ten_k) &&
+        ((rest + ten_k < big_distance) || (big_distance - rest > rest + ten_k - big_distance)))
+    {
+        return false;
+    }
+
+    // @note: The digits must be inside the safe interval, away from its ends by the error.
+    return (2 * unit <= rest) && (rest <= unsafe_interval - 4 * unit);
+}
+
+
+INTERNAL
+bool acf_grisu3_digit_gen(char *buffer, u32 *size, int32 *decimal_exponent, acf_diyfp low, acf_diyfp w, acf_diyfp high)
+{
+    ASSERT(low.e == w.e && w.e == high.e);
+
+    // @note: Products are off by at most one unit, digits inside the unsafe interval may still be outside the real one.
+    u64 unit = 1;
+    acf_diyfp too_low = { low.f - unit, low.e };
+    acf_diyfp too_high = { high.f + unit, high.e };
+    u64 unsafe_interval = acf_diyfp_sub(too_high, too_low).f;
+    u64 distance_too_high_w = acf_diyfp_sub(too_high, w).f;
+
+    // @note: too_high = p1 * 2^-e + p2, p1 is the integral part, p2 is the fraction.
+    int32 shift = -w.e;
+    u64 one = 1ull << shift;
+
+    u32 p1 = (u32) (too_high.f >> shift);
+    u64 p2 = too_high.f & (one - 1);
+
+    u32 pow10 = 0;
+    u32 n = find_largest_acf_pow10(p1, &pow10);
+    while (n > 0)
+    {
+        u32 digit = p1 / pow10;
+        p1 = p1 % pow10;
+        buffer[(*size)++] = (char) ('0' + digit);
+        n -= 1;
+
+        u64 rest = ((u64) p1 << shift) + p2;
+        if (rest < unsafe_interval)
+        {
+            *decimal_exponent += n;
+            return acf_grisu3_round_weed(buffer, *size, distance_too_high_w, unsafe_interval, rest, (u64) pow10 << shift, unit);
+        }
+
+        pow10 /= 10;
+    }
+
+    int32 m = 0;
+    loop
+    {
+        p2 *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+
+        u64 digit = p2 >> shift;
+        p2 &= one - 1;
+        buffer[(*size)++] = (char) ('0' + digit);
+        m += 1;
+
+        if (p2 < unsafe_interval) break;
+    }
+
+    *decimal_exponent -= m;
+    return acf_grisu3_round_weed(buffer, *size, distance_too_high_w * unit, unsafe_interval, p2, one, unit);
+}
+
+
+// @note: Writes up to 17 digits of a finite positive value, value = digits * 10^decimal_exponent. Returns 0 when
+// the digits can not be proven to be the shortest, buffer is garbage then.
+INTERNAL
+u32 acf_grisu3(float64 value, char *buffer, int32 *decimal_exponent)
+{
+    u64 bits = 0;
+    memory::copy(&bits, &value, sizeof(bits));
+
+    u64 const hidden_bit = 1ull << 52;
+    int32 const bias = 1075;
+
+    u64 fraction = bits & (hidden_bit - 1);
+    int32 exponent = (int32) (bits >> 52);
+
+    acf_diyfp v = (exponent == 0) ? acf_diyfp{ fraction, 1 - bias } : acf_diyfp{ fraction + hidden_bit, exponent - bias };
+
+    // @note: The lower neighbour is closer, when v is a power of two (but not the smallest normal one).
+    bool lower_boundary_is_closer = (fraction == 0) && (exponent > 1);
+    acf_diyfp plus = { 2 * v.f + 1, v.e - 1 };
+    acf_diyfp minus = lower_boundary_is_closer ? acf_diyfp{ 4 * v.f - 1, v.e - 2 } : acf_diyfp{ 2 * v.f - 1, v.e - 1 };
+
+    plus = acf_diyfp_normalize(plus);
+    minus = acf_diyfp_normalize_to(minus, plus.e);
+    v = acf_diyfp_normalize(v);
+
+    acf_cached_power cached = get_acf_cached_power(plus.e);
+    acf_diyfp c = { cached.f, cached.e };
+
+    acf_diyfp w = acf_diyfp_mul(v, c);
+    acf_diyfp w_minus = acf_diyfp_mul(minus, c);
+    acf_diyfp w_plus = acf_diyfp_mul(plus, c);
+
+    u32 size = 0;
+    *decimal_exponent = -cached.k;
+    bool proven = acf_grisu3_digit_gen(buffer, &size, decimal_exponent, w_minus, w, w_plus);
+    return proven ? size : 0;
+}
+
+
+// @note: Slow path for the values Grisu3 gives up on. Tries 1 to 17 digits, rounded by printf, until they read
+// back as v. The closest digits of a length can miss the interval while the next ones up are still in it, when v is
+// a power of two and the interval above it is twice as wide as the one below, so those are tried too.
+INTERNAL
+u32 acf_shortest_digits_slow(float64 value, char *buffer, int32 *decimal_exponent)
+{
+    u64 bits = 0;
+    memory::copy(&bits, &value, sizeof(bits));
+    bool is_power_of_two = (bits & ((1ull << 52) - 1)) == 0;
+
+    u32 size = 0;
+    for (int32 precision = 1; precision <= 17; precision++)
+    {
+        char text[ACF_FLOAT_BUFFER_SIZE];
+        snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+
+        // @note: "d.ddde+x" to digits and the exponent of the last one.
+        char const *at = text;
+        size = 0;
+        for (; *at != 'e'; at++)
+        {
+            if (*at != '.') buffer[size++] = *at;
+        }
+        *decimal_exponent = (int32) strtol(at + 1, NULL, 10) - (int32) (size - 1);
+
+        float64 closest = strtod(text, NULL);
+        if (closest == value) break;
+
+        if (is_power_of_two && (closest < value))
+        {
+            char next[ACF_FLOAT_BUFFER_SIZE];
+            memory::copy(next, buffer, size);
+
+            int32 i = (int32) size - 1;
+            while (i >= 0 && next[i] == '9') next[i--] = '0';
+            if (i >= 0)
+            {
+                next[i] += 1;
+            }
+            else
+            {
+                next[0] = '1'; // @note: 99.9 + 0.1 is 100.0, as many digits, with the exponent one higher.
+                *decimal_exponent += 1;
+            }
+
+            snprintf(next + size, sizeof(next) - size, "e%d", *decimal_exponent);
+            if (strtod(next, NULL) == value)
+            {
+                memory::copy(buffer, next, size);
+                break;
+            }
+            if (i < 0) *decimal_exponent -= 1;
+        }
+    }
+
+    while ((size > 1) && (buffer[size - 1] == '0'))
+    {
+        size -= 1;
+        *decimal_exponent += 1;
+    }
+    return size;
+}
+
+
+u32 format_acf_float(float64 value, char *buffer)
+{
+    u64 bits = 0;
+    memory::copy(&bits, &value, sizeof(bits));
+
+    char *at = buffer;
+    if (bits >> 63)
+    {
+        *at++ = '-';
+        bits &= ~(1ull << 63);
+        memory::copy(&value, &bits, sizeof(value));
+    }
+
+    if (value == 0)
+    {
+        at[0] = '0';
+        at[1] = '.';
+        at[2] = '0';
+        return (u32) (at + 3 - buffer);
+    }
+
+    if (!(value <= 1.7976931348623157e308))
+    {
+        return 0; // @note: Infinities and NaNs can not be written in ACF.
+    }
+
+    int32 decimal_exponent = 0;
+    int32 k = (int32) acf_grisu3(value, at, &decimal_exponent);
+    if (k == 0)
+    {
+        k = (int32) acf_shortest_digits_slow(value, at, &decimal_exponent);
+    }
+    int32 n = k + decimal_exponent; // @note: Position of the decimal point relative to the first digit.
+
+    // @note: Always produces a '.' or an exponent, so the value reads back as a float.
+    int32 const min_exponent = -4;
+    int32 const max_exponent = 15;
+
+    if (k <= n && n <= max_exponent)
+    {
+        // digits[000].0
+        memory::set(at + k, '0', n - k);
+        at[n] = '.';
+        at[n + 1] = '0';
+        at += n + 2;
+    }
+    else if (0 < n && n <= max_exponent)
+    {
+        // dig.its
+        for (int32 i = k; i > n; i--) at[i] = at[i - 1];
+        at[n] = '.';
+        at += k + 1;
+    }
+    else if (min_exponent < n && n <= 0)
+    {
+        // 0.[000]digits
+        for (int32 i = k - 1; i >= 0; i--) at[i + 2 - n] = at[i];
+        at[0] = '0';
+        at[1] = '.';
+        memory::set(at + 2, '0', -n);
+        at += 2 - n + k;
+    }
+    else
+    {
+        // d[.igits]e-x
+        if (k > 1)
+        {
+            for (int32 i = k; i > 1; i--) at[i] = at[i - 1];
+            at[1] = '.';
+            at += k + 1;
+        }
+        else
+        {
+            at += 1;
+        }
+
+        *at++ = 'e';
+        int32 exponent = n - 1;
+        if (exponent < 0)
+        {
+            *at++ = '-';
+            exponent = -exponent;
+        }
+        at += format_acf_u64((u64) exponent, at);
+    }
+
+    return (u32) (at - buffer);
+}
+
+
+// @note: Makes room for size more characters and returns the write position, or NULL if the buffer can not grow.
+INTERNAL
+char *reserve_acf_buffer(acf_buffer *buffer, usize size)
+{
+    if (buffer->size + size > buffer->capacity)
+    {
+        usize capacity = buffer->capacity ? buffer->capacity : ACF_BUFFER_INITIAL_CAPACITY;
+        while (capacity < buffer->size + size) capacity *= 2;
+
+        char *data = buffer->data
+            ? REALLOCATE_BUFFER(&acf_buffer_mallocator, buffer->data, capacity)
+            : ALLOCATE_BUFFER_(&acf_buffer_mallocator, char, capacity);
+        if (data == NULL) return NULL;
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    return buffer->data + buffer->size;
+}
+
+
+void free_acf_buffer(acf_buffer *buffer)
+{
+    if (buffer->data)
+    {
+        DEALLOCATE_BUFFER(&acf_buffer_mallocator, buffer->data);
+    }
+    *buffer = {};
+}
+
+
+struct acf_serializer
+{
+    acf_buffer *buffer;
+    acf_serialize_options options;
+};
+
+
+// @note: Same measure acf_print uses for the smart mode, but stops counting once the limit is exceeded.
+INTERNAL
+u32 count_acf_serialize_elements(acf_node const& node, u32 limit)
+{
+    u32 result = 0;
+    switch (node.type)
+    {
+        case acf_type_t::array:
+        case acf_type_t::object:
+        {
+            for (u32 i = 0; (i < node.count) && (result <= limit); i++)
+            {
+                result += count_acf_serialize_elements(node.children[i], limit - result + 1) + node.is_object();
+            }
+        }
+        break;
+
+        case acf_type_t::custom: result = node.count + 1; break;
+        default: result = 1;
+    }
+    return result;
+}
+
+
+INTERNAL
+char *write_acf_indent(char *at, acf_serializer *serializer, u32 depth)
+{
+    usize size = (usize) serializer->options.indent * depth;
+    memory::set(at, ' ', size);
+    return at + size;
+}
+
+
+// @note: Literal string, the format has no escapes, so '"' and newlines can not be written.
+INTERNAL
+bool write_acf_string(acf_serializer *serializer, char const *data, u32 size, char quote)
+{
+    char *at = reserve_acf_buffer(serializer->buffer, size + 2);
+    if (at == NULL) return false;
+
+    for (u32 i = 0; i < size; i++)
+    {
+        if (data[i] == '"' || data[i] == '\n') return false;
+    }
+
+    if (quote) *at++ = quote;
+    memory::copy(at, data, size);
+    at += size;
+    if (quote) *at++ = quote;
+
+    serializer->buffer->size = at - serializer->buffer->data;
+    return true;
+}
+
+
+INTERNAL
+bool write_acf_node(acf_serializer *serializer, acf_node const& node, u32 depth, bool in_one_line_parent)
+{
+    acf_serialize_options const& options = serializer->options;
+    acf_buffer *buffer = serializer->buffer;
+
+    switch (node.type)
+    {
+        case acf_type_t::null:
+        case acf_type_t::boolean:
+        case acf_type_t::integer:
+        case acf_type_t::floating:
+        case acf_type_t::type:
+        {
+            char *at = reserve_acf_buffer(buffer, ACF_FLOAT_BUFFER_SIZE);
+            if (at == NULL) return false;
+
+            u32 size = 0;
+            char const *keyword = NULL;
+            switch (node.type)
+            {
+                case acf_type_t::null: keyword = "null"; break;
+                case acf_type_t::boolean: keyword = node.boolean_value ? "true" : "false"; break;
+                case acf_type_t::type: keyword = get_acf_type_string(node.type_value); break;
+                case acf_type_t::integer: size = format_acf_int(node.integer_value, at); break;
+                case acf_type_t::floating:
+                {
+                    size = format_acf_float(node.floating_value, at);
+                    if (size == 0) return false;
+                }
+                break;
+
+                default: break;
+            }
+
+            if (keyword)
+            {
+                while (keyword[size]) { at[size] = keyword[size]; size += 1; }
+            }
+
+            buffer->size += size;
+        }
+        break;
+
+        case acf_type_t::string:
+            return write_acf_string(serializer, node.string_value, node.count, '"');
+
+        case acf_type_t::object:
+        case acf_type_t::array:
+        {
+            bool in_one_line = in_one_line_parent ||
+                (options.multiline == acf_serialize_options::multiline_t::disabled) ||
+                ((options.multiline == acf_serialize_options::multiline_t::smart) &&
+                 (count_acf_serialize_elements(node, options.max_elements_in_line) <= (u32) options.max_elements_in_line));
+
+            bool is_object = node.is_object();
+            bool space = options.print_spaces && !(node.is_array() && node.count == 0);
+            char separator = is_object ? (options.print_semicolons ? ';' : 0) : (options.print_commas ? ',' : 0);
+
+            char *at = reserve_acf_buffer(buffer, 2);
+            if (at == NULL) return false;
+            *at++ = is_object ? '{' : '[';
+            if (!in_one_line) *at++ = '\n';
+            else if (space) *at++ = ' ';
+            buffer->size = at - buffer->data;
+
+            for (u32 i = 0; i < node.count; i++)
+            {
+                if (!in_one_line)
+                {
+                    at = reserve_acf_buffer(buffer, (usize) options.indent * (depth + 1));
+                    if (at == NULL) return false;
+                    buffer->size = write_acf_indent(at, serializer, depth + 1) - buffer->data;
+                }
+
+                if (is_object)
+                {
+                    acf_key const& key = node.keys[i];
+                    if (!write_acf_string(serializer, key.data, key.size, 0)) return false;
+
+                    at = reserve_acf_buffer(buffer, 3);
+                    if (at == NULL) return false;
+                    if (options.print_spaces) *at++ = ' ';
+                    *at++ = '=';
+                    if (options.print_spaces) *at++ = ' ';
+                    buffer->size = at - buffer->data;
+                }
+
+                if (!write_acf_node(serializer, node.children[i], depth + 1, in_one_line)) return false;
+
+                // @note: Without separators values still have to be split by a space or a newline.
+                bool is_last = (i + 1 == node.count);
+                at = reserve_acf_buffer(buffer, 2);
+                if (at == NULL) return false;
+                if (separator && (is_object || !is_last)) *at++ = separator;
+                if (!in_one_line) *at++ = '\n';
+                else if (options.print_spaces || (!separator && !is_last)) *at++ = ' ';
+                buffer->size = at - buffer->data;
+            }
+
+            at = reserve_acf_buffer(buffer, (usize) options.indent * depth + 1);
+            if (at == NULL) return false;
+            if (!in_one_line) at = write_acf_indent(at, serializer, depth);
+            *at++ = is_object ? '}' : ']';
+            buffer->size = at - buffer->data;
+        }
+        break;
+
+        case acf_type_t::custom:
+        {
+            acf_string_view name = *node.newtype_name;
+            if (!write_acf_string(serializer, name.data, name.size, 0)) return false;
+
+            char *at = reserve_acf_buffer(buffer, 1);
+            if (at == NULL) return false;
+            *at++ = '(';
+            buffer->size = at - buffer->data;
+
+            // @note: Arguments are always in one line, commas between them are required.
+            for (u32 i = 0; i < node.count; i++)
+            {
+                if (i > 0)
+                {
+                    at = reserve_acf_buffer(buffer, 2);
+                    if (at == NULL) return false;
+                    *at++ = ',';
+                    if (options.print_spaces) *at++ = ' ';
+                    buffer->size = at - buffer->data;
+                }
+
+                if (!write_acf_node(serializer, node.children[i], depth, true)) return false;
+            }
+
+            at = reserve_acf_buffer(buffer, 1);
+            if (at == NULL) return false;
+            *at++ = ')';
+            buffer->size = at - buffer->data;
+        }
+        break;
+    }
+
+    return true;
+}
+
+
+bool acf_serialize(acf_node const& node, acf_buffer *buffer, acf_serialize_options options)
+{
+    acf_serializer serializer = { buffer, options };
+    return write_acf_node(&serializer, node, 0, false);
+}
+
+
+bool acf_serialize_document(acf_document const *document, acf_buffer *buffer, acf_serialize_options options)
+{
+    acf_serializer serializer = { buffer, options };
+
+    // @note: Newtypes have to be declared before they are used, so all of them go first.
+    for (u32 newtype_index = 0; newtype_index < document->newtype_count; newtype_index++)
+    {
+        acf_newtype const *newtype = document->newtypes + newtype_index;
+
+        if (!write_acf_string(&serializer, "#newtype ", 9, 0)) return false;
+        if (!write_acf_string(&serializer, newtype->name->data, newtype->name->size, 0)) return false;
+
+        char *at = reserve_acf_buffer(buffer, 3 + ACF_MAX_NEWTYPE_ARGUMENTS * 8);
+        if (at == NULL) return false;
+
+        *at++ = '(';
+        for (u32 i = 0; i < newtype->argument_count; i++)
+        {
+            if (i > 0) { *at++ = ','; *at++ = ' '; }
+            for (char const *s = get_acf_type_string(newtype->arguments[i]); *s; s++) *at++ = *s;
+        }
+        *at++ = ')';
+        *at++ = '\n';
+        buffer->size = at - buffer->data;
+    }
+
+    if (!write_acf_node(&serializer, document->root, 0, false)) return false;
+
+    char *at = reserve_acf_buffer(buffer, 1);
+    if (at == NULL) return false;
+    *at++ = '\n';
+    buffer->size = at - buffer->data;
+
+    return true;
+}
+
+
+#endif // ACF_LIB_IMPLEMENTATION
+#endif // ACF_SERIALIZE_HPP
@@ -0,0 +1,1238 @@
+#ifndef ACF_STREAM_HPP
+#define ACF_STREAM_HPP
+
+#include <defines.hpp>
+#include <acf/acf_document.hpp>
+
+// Standard headers
+#include <string.h>
+
+
+/*
+    ACF Stream
+
+    Event-driven ACF parser. The source is fed in chunks of any size, for
+    example straight from the file or from the socket, and the parser calls
+    back for every element it meets:
+
+        #newtype vec2(int, int)      newtype     (vec2)
+        {                            begin_object
+            name = "player";         key (name), value ("player")
+            position = vec2(1, 2);   key (position), begin_custom (vec2), value (1), value (2), end_custom
+            tags = [ 1, 2 ];         key (tags), begin_array, value (1), value (2), end_array
+        }                            end_object
+
+    The root object is reported with begin_object and end_object too, even
+    when its braces are omitted.
+
+    Memory used by the stream is constant, it does not depend on the size of
+    the source or the number of elements in it:
+
+        - the nesting depth is limited to ACF_STREAM_MAX_DEPTH;
+        - a token split between two chunks is carried in a fixed buffer, so
+          such tokens can not be longer than ACF_STREAM_MAX_TOKEN_SIZE bytes
+          (tokens which lie in one chunk have no limit);
+        - comments and whitespace are skipped without carrying anything.
+
+    Keys and strings in the events point into the fed chunk or into the
+    carry buffer, so they are valid only during the callback. Repeated keys
+    are not detected here, because it would require to remember all keys of
+    every open object; the document builder below checks them.
+
+    Usage:
+
+        bool on_event(void *user_data, acf_event const *event) { ... return true; }
+
+        acf_stream stream;
+        initialize_acf_stream(&stream, on_event, user_data);
+
+        while (size_t n = fread(buffer, 1, sizeof(buffer), file))
+        {
+            if (!feed_acf_stream(&stream, buffer, n)) break;
+        }
+        if (!finish_acf_stream(&stream))
+        {
+            osOutputDebugString("%s\n", stream.error_buffer);
+        }
+
+    Document builder rebuilds the usual acf_document from the events, so a
+    document can be parsed from chunks as well. Since the chunks do not
+    outlive the build, the builder copies keys and strings into the arena.
+    parse_acf_document is still the faster way when the whole source is in
+    memory anyway.
+
+        acf_document_builder builder;
+        begin_acf_document_build(&builder, &document);
+        feed_acf_document_build(&builder, chunk, chunk_size); // ...
+        if (finish_acf_document_build(&builder)) { document.root ... }
+*/
+
+
+// @note: Same limit as parse_acf_document, or the two would disagree on deep sources.
+#define ACF_STREAM_MAX_DEPTH ACF_MAX_DEPTH
+
+#ifndef ACF_STREAM_MAX_TOKEN_SIZE
+#define ACF_STREAM_MAX_TOKEN_SIZE 4096
+#endif
+
+#define ACF_STREAM_MAX_NEWTYPE_NAME 64
+
+
+enum class acf_event_type
+{
+    newtype,
+    begin_object,
+    end_object,
+    begin_array,
+    end_array,
+    begin_custom,
+    end_custom,
+    key,
+    value,
+};
+
+
+struct acf_event
+{
+    acf_event_type type;
+
+    acf_string_view key;         // key
+    acf_newtype const *newtype;  // newtype, begin_custom, end_custom
+    acf_node value;              // value, never a container
+};
+
+
+typedef bool acf_event_callback(void *user_data, acf_event const *event);
+
+
+enum class acf_stream_state : u8
+{
+    document_start,
+    directive_name,
+    newtype_name,
+    newtype_open,
+    newtype_argument,
+    newtype_after_argument,
+    document_end,
+
+    object_key,
+    object_equals,
+    object_value,
+    object_after_value,
+
+    array_value,
+    array_after_value,
+
+    call_open,
+    call_argument,
+    call_after_argument,
+};
+
+
+struct acf_stream
+{
+    struct context
+    {
+        acf_type_t type;
+        acf_stream_state state;
+        bool braces_optional;
+        u32 newtype_index;
+        u32 argument_index;
+    };
+
+    acf_event_callback *callback;
+    void *user_data;
+
+    acf_stream_state state; // @note: State outside of the root object.
+    context stack[ACF_STREAM_MAX_DEPTH];
+    u32 depth;
+
+    u32 newtype_count;
+    acf_newtype newtypes[ACF_MAX_NEWTYPES];
+    u8 newtype_slots[2 * ACF_MAX_NEWTYPES]; // @note: Hash index of the newtypes by name, same as in the document.
+    acf_string_view newtype_names[ACF_MAX_NEWTYPES];
+    char newtype_name_buffers[ACF_MAX_NEWTYPES][ACF_STREAM_MAX_NEWTYPE_NAME];
+
+    bool in_comment;
+    u32 carry_size;
+    char carry[ACF_STREAM_MAX_TOKEN_SIZE];
+
+    // @note: Position of the current chunk, or of the carried token, for error messages.
+    char const *chunk;
+    u32 line;
+    u32 column;
+    u32 carry_line;
+    u32 carry_column;
+    char const *token_span;
+    bool token_in_carry;
+
+    b32 has_error;
+    u32 error_line;
+    u32 error_column;
+    char error_buffer[512];
+};
+
+
+void initialize_acf_stream(acf_stream *stream, acf_event_callback *callback, void *user_data);
+bool register_acf_stream_newtype(acf_stream *stream, acf_string_view name, u32 argument_count, acf_type_t const *arguments);
+bool feed_acf_stream(acf_stream *stream, char const *data, usize size);
+bool finish_acf_stream(acf_stream *stream);
+
+// @note: Callbacks can stop the stream with their own error, which is reported at the current token.
+void acf_stream_report_error(acf_stream *stream, char const *message, ...);
+
+
+struct acf_document_builder
+{
+    struct container
+    {
+        acf_type_t type;
+        u32 first;
+        acf_key key;
+        acf_string_view *newtype_name;
+    };
+
+    acf_document *document;
+    acf_document_parser parser; // @note: Only the scratch stack is used.
+    acf_stream stream;
+
+    container containers[ACF_STREAM_MAX_DEPTH];
+    u32 depth;
+    acf_key key; // @note: Key of the next value in the current object.
+
+    bool finished;
+};
+
+
+void begin_acf_document_build(acf_document_builder *builder, acf_document *document);
+bool feed_acf_document_build(acf_document_builder *builder, char const *data, usize size);
+bool finish_acf_document_build(acf_document_builder *builder);
+
+
+#ifdef ACF_LIB_IMPLEMENTATION
+
+
+INTERNAL
+void acf_stream_get_location(acf_stream *stream, char const *location, u32 *line, u32 *column)
+{
+    if (stream->token_in_carry)
+    {
+        *line = stream->carry_line;
+        *column = stream->carry_column;
+    }
+    else
+    {
+        *line = stream->line;
+        *column = stream->column;
+        for (char const *c = stream->chunk; c < location; c++)
+        {
+            if (*c == '\n')
+            {
+                *line += 1;
+                *column = 1;
+            }
+            else
+            {
+                *column += 1;
+            }
+        }
+    }
+}
+
+
+void acf_stream_report_error(acf_stream *stream, char const *message, ...)
+{
+    if (stream->has_error) return; // @note: Only the first error is meaningful.
+
+    stream->has_error = true;
+    acf_stream_get_location(stream, stream->token_span, &stream->error_line, &stream->error_column);
+
+    int count = snprintf(stream->error_buffer, sizeof(stream->error_buffer), "%u:%u: ", stream->error_line, stream->error_column);
+
+    va_list args;
+    va_start(args, message);
+    if (count > 0 && count < (int) sizeof(stream->error_buffer))
+    {
+        vsnprintf(stream->error_buffer + count, sizeof(stream->error_buffer) - count, message, args);
+    }
+    va_end(args);
+}
+
+
+INTERNAL
+bool acf_stream_emit(acf_stream *stream, acf_event const& event)
+{
+    if (!stream->callback(stream->user_data, &event))
+    {
+        acf_stream_report_error(stream, "Stopped by the event handler.");
+        return false;
+    }
+    return true;
+}
+
+
+INTERNAL
+acf_stream_state *get_acf_stream_state(acf_stream *stream)
+{
+    acf_stream_state *result = (stream->depth > 0) ? &stream->stack[stream->depth - 1].state : &stream->state;
+    return result;
+}
+
+
+INTERNAL
+acf_newtype *find_acf_stream_newtype(acf_stream *stream, acf_string_view name)
+{
+    return find_acf_newtype(stream->newtypes, stream->newtype_slots, ARRAY_COUNT(stream->newtype_slots), name);
+}
+
+
+// @note: Called when the value in the current position is complete, moves the parent past it.
+INTERNAL
+void acf_stream_end_value(acf_stream *stream)
+{
+    if (stream->depth == 0)
+    {
+        stream->state = acf_stream_state::document_end;
+        return;
+    }
+
+    acf_stream::context *parent = stream->stack + stream->depth - 1;
+    switch (parent->state)
+    {
+        case acf_stream_state::object_value: parent->state = acf_stream_state::object_after_value; break;
+        case acf_stream_state::array_value:  parent->state = acf_stream_state::array_after_value; break;
+
+        case acf_stream_state::call_argument:
+        {
+            parent->argument_index += 1;
+            parent->state = acf_stream_state::call_after_argument;
+        }
+        break;
+
+        default: ASSERT_FAIL();
+    }
+}
+
+
+INTERNAL
+bool acf_stream_push_context(acf_stream *stream, acf_type_t type, acf_stream_state state)
+{
+    if (stream->depth == ACF_STREAM_MAX_DEPTH)
+    {
+        acf_stream_report_error(stream, "Nesting is too deep, maximum depth is %d.", ACF_STREAM_MAX_DEPTH);
+        return false;
+    }
+
+    acf_stream::context *context = stream->stack + stream->depth++;
+    *context = {};
+    context->type = type;
+    context->state = state;
+    return true;
+}
+
+
+INTERNAL
+bool acf_stream_close_context(acf_stream *stream)
+{
+    acf_stream::context context = stream->stack[--stream->depth];
+
+    acf_event event = {};
+    switch (context.type)
+    {
+        case acf_type_t::object: event.type = acf_event_type::end_object; break;
+        case acf_type_t::array:  event.type = acf_event_type::end_array; break;
+        case acf_type_t::custom:
+        {
+            event.type = acf_event_type::end_custom;
+            event.newtype = stream->newtypes + context.newtype_index;
+        }
+        break;
+
+        default: ASSERT_FAIL();
+    }
+
+    if (!acf_stream_emit(stream, event)) return false;
+
+    acf_stream_end_value(stream);
+    return true;
+}
+
+
+// @note: Starts the value at the token. Arguments of the constructor calls are checked against 'expected'.
+INTERNAL
+bool acf_stream_begin_value(acf_stream *stream, acf_document_token t, acf_type_t const *expected)
+{
+    acf_node value = {};
+    acf_type_t value_type = acf_type_t::null;
+    switch (t.type)
+    {
+        case acf_document_token_type::keyword_null:  { value.type = acf_type_t::null; } break;
+        case acf_document_token_type::keyword_true:  { value.type = acf_type_t::boolean; value.boolean_value = true; } break;
+        case acf_document_token_type::keyword_false: { value.type = acf_type_t::boolean; value.boolean_value = false; } break;
+        case acf_document_token_type::integer:       { value.type = acf_type_t::integer; value.integer_value = t.integer_value; } break;
+        case acf_document_token_type::floating:      { value.type = acf_type_t::floating; value.floating_value = t.floating_value; } break;
+
+        case acf_document_token_type::string:
+        {
+            value.type = acf_type_t::string;
+            value.string_value = t.span + 1;
+            value.count = t.size - 2;
+        }
+        break;
+
+        case acf_document_token_type::keyword_bool:
+        case acf_document_token_type::keyword_int:
+        case acf_document_token_type::keyword_float:
+        case acf_document_token_type::keyword_string:
+        case acf_document_token_type::keyword_array:
+        case acf_document_token_type::keyword_object:
+        case acf_document_token_type::keyword_type:
+        {
+            value.type = acf_type_t::type;
+            acf_document_keyword_to_type(t.type, &value.type_value);
+        }
+        break;
+
+        case acf_document_token_type::identifier:   value_type = acf_type_t::custom; break;
+        case acf_document_token_type::brace_open:   value_type = acf_type_t::object; break;
+        case acf_document_token_type::bracket_open: value_type = acf_type_t::array; break;
+
+        case acf_document_token_type::integer_out_of_range:
+        {
+            acf_stream_report_error(stream, "Integer does not fit in 64 bits.");
+            return false;
+        }
+
+        default:
+        {
+            acf_stream_report_error(stream, "Expected value.");
+            return false;
+        }
+    }
+
+    if (value_type == acf_type_t::null)
+    {
+        value_type = value.type;
+    }
+
+    if (expected)
+    {
+        if ((*expected == acf_type_t::floating) && (value_type == acf_type_t::integer))
+        {
+            value.type = value_type = acf_type_t::floating;
+            value.floating_value = (float64) value.integer_value;
+        }
+
+        if (value_type != *expected)
+        {
+            acf_stream_report_error(stream, "Argument type mismatch! Constructor call expected value of type %s, but got %s.",
+                get_acf_type_string(*expected), get_acf_type_string(value_type));
+            return false;
+        }
+    }
+
+    switch (value_type)
+    {
+        case acf_type_t::object:
+        {
+            acf_event event = {};
+            event.type = acf_event_type::begin_object;
+            return acf_stream_push_context(stream, acf_type_t::object, acf_stream_state::object_key) && acf_stream_emit(stream, event);
+        }
+
+        case acf_type_t::array:
+        {
+            acf_event event = {};
+            event.type = acf_event_type::begin_array;
+            return acf_stream_push_context(stream, acf_type_t::array, acf_stream_state::array_value) && acf_stream_emit(stream, event);
+        }
+
+        case acf_type_t::custom:
+        {
+            acf_newtype *newtype = find_acf_stream_newtype(stream, { t.span, t.size });
+            if (newtype == NULL)
+            {
+                acf_stream_report_error(stream, "Referencing an identifier '%.*s', which was not declared before!", (int) t.size, t.span);
+                return false;
+            }
+
+            // @note: begin_custom is reported when the open parenthesis is met.
+            if (!acf_stream_push_context(stream, acf_type_t::custom, acf_stream_state::call_open)) return false;
+            stream->stack[stream->depth - 1].newtype_index = (u32) (newtype - stream->newtypes);
+            return true;
+        }
+
+        default:
+        {
+            acf_event event = {};
+            event.type = acf_event_type::value;
+            event.value = value;
+            if (!acf_stream_emit(stream, event)) return false;
+
+            acf_stream_end_value(stream);
+            return true;
+        }
+    }
+}
+
+
+INTERNAL
+bool acf_stream_process_token(acf_stream *stream, acf_document_token t)
+{
+    stream->token_span = t.span;
+
+    loop
+    {
+        acf_stream_state *state = get_acf_stream_state(stream);
+        switch (*state)
+        {
+            case acf_stream_state::document_start:
+            {
+                if (t.type == acf_document_token_type::pound)
+                {
+                    *state = acf_stream_state::directive_name;
+                    return true;
+                }
+
+                acf_event event = {};
+                event.type = acf_event_type::begin_object;
+
+                if (!acf_stream_push_context(stream, acf_type_t::object, acf_stream_state::object_key)) return false;
+                if (!acf_stream_emit(stream, event)) return false;
+
+                if (t.type == acf_document_token_type::brace_open) return true;
+
+                // @note: Braces of the root object are optional, so this token is already the first key.
+                stream->stack[0].braces_optional = true;
+            }
+            continue;
+
+            case acf_stream_state::directive_name:
+            {
+                if (t.type != acf_document_token_type::identifier || acf_string_view{ t.span, t.size } != "newtype")
+                {
+                    acf_stream_report_error(stream, "Currently the only supported directive is 'newtype'.");
+                    return false;
+                }
+                *state = acf_stream_state::newtype_name;
+            }
+            return true;
+
+            case acf_stream_state::newtype_name:
+            {
+                if (t.type != acf_document_token_type::identifier)
+                {
+                    acf_stream_report_error(stream, "You should specify name of your type here.");
+                    return false;
+                }
+
+                acf_string_view name = { t.span, t.size };
+                if (find_acf_stream_newtype(stream, name))
+                {
+                    acf_stream_report_error(stream, "Newtype '%.*s' is already declared.", (int) name.size, name.data);
+                    return false;
+                }
+
+                // @note: Registered with no arguments, which are added while they are parsed.
+                if (!register_acf_stream_newtype(stream, name, 0, NULL))
+                {
+                    acf_stream_report_error(stream, "Too many newtypes declared (maximum is %d), or the name is longer than %d characters.",
+                        ACF_MAX_NEWTYPES, ACF_STREAM_MAX_NEWTYPE_NAME);
+                    return false;
+                }
+
+                *state = acf_stream_state::newtype_open;
+            }
+            return true;
+
+            case acf_stream_state::newtype_open:
+            {
+                if (t.type != acf_document_token_type::parentheses_open)
+                {
+                    acf_stream_report_error(stream, "Expected '('.");
+                    return false;
+                }
+                *state = acf_stream_state::newtype_argument;
+            }
+            return true;
+
+            case acf_stream_state::newtype_after_argument:
+            {
+                *state = acf_stream_state::newtype_argument;
+
+                // Consume optional comma, if present.
+                if (t.type == acf_document_token_type::comma) return true;
+            }
+            continue;
+
+            case acf_stream_state::newtype_argument:
+            {
+                acf_newtype *newtype = stream->newtypes + stream->newtype_count - 1;
+                if (t.type == acf_document_token_type::parentheses_close)
+                {
+                    acf_event event = {};
+                    event.type = acf_event_type::newtype;
+                    event.newtype = newtype;
+
+                    *state = acf_stream_state::document_start;
+                    return acf_stream_emit(stream, event);
+                }
+
+                acf_type_t argument_type;
+                if (!acf_document_keyword_to_type(t.type, &argument_type))
+                {
+                    // @note: Nested custom types are forbidden, they overcomplicate matters.
+                    acf_stream_report_error(stream, "Expected one of the basic types here.");
+                    return false;
+                }
+
+                if (newtype->argument_count == ACF_MAX_NEWTYPE_ARGUMENTS)
+                {
+                    acf_stream_report_error(stream, "Newtype can have at most %d arguments.", ACF_MAX_NEWTYPE_ARGUMENTS);
+                    return false;
+                }
+                newtype->arguments[newtype->argument_count++] = argument_type;
+
+                *state = acf_stream_state::newtype_after_argument;
+            }
+            return true;
+
+            case acf_stream_state::document_end:
+            {
+                if (t.type != acf_document_token_type::end_of_file)
+                {
+                    acf_stream_report_error(stream, "Unexpected symbols after the end of the document.");
+                    return false;
+                }
+            }
+            return true;
+
+            case acf_stream_state::object_after_value:
+            {
+                *state = acf_stream_state::object_key;
+
+                // Consume optional semicolon, if present.
+                if (t.type == acf_document_token_type::semicolon) return true;
+            }
+            continue;
+
+            case acf_stream_state::object_key:
+            {
+                bool braces_optional = stream->stack[stream->depth - 1].braces_optional;
+                if ((t.type == acf_document_token_type::brace_close && !braces_optional) ||
+                    (t.type == acf_document_token_type::end_of_file && braces_optional))
+                {
+                    if (!acf_stream_close_context(stream)) return false;
+
+                    // @note: The end of file also ends the document after the root object without braces.
+                    if (t.type == acf_document_token_type::end_of_file) continue;
+                    return true;
+                }
+
+                if (t.type != acf_document_token_type::identifier)
+                {
+                    acf_stream_report_error(stream, (t.type == acf_document_token_type::end_of_file) ? "Expected '}'." : "Expected identifier for key-value pair.");
+                    return false;
+                }
+
+                acf_event event = {};
+                event.type = acf_event_type::key;
+                event.key = { t.span, t.size };
+
+                *state = acf_stream_state::object_equals;
+                return acf_stream_emit(stream, event);
+            }
+
+            case acf_stream_state::object_equals:
+            {
+                if (t.type != acf_document_token_type::equals)
+                {
+                    acf_stream_report_error(stream, "Expected '='.");
+                    return false;
+                }
+                *state = acf_stream_state::object_value;
+            }
+            return true;
+
+            case acf_stream_state::object_value:
+                return acf_stream_begin_value(stream, t, NULL);
+
+            case acf_stream_state::array_after_value:
+            {
+                *state = acf_stream_state::array_value;
+
+                // Consume optional comma, if present, including trailing comma.
+                if (t.type == acf_document_token_type::comma) return true;
+            }
+            continue;
+
+            case acf_stream_state::array_value:
+            {
+                if (t.type == acf_document_token_type::bracket_close)
+                {
+                    return acf_stream_close_context(stream);
+                }
+                if (t.type == acf_document_token_type::end_of_file)
+                {
+                    acf_stream_report_error(stream, "Expected ']'.");
+                    return false;
+                }
+                return acf_stream_begin_value(stream, t, NULL);
+            }
+
+            case acf_stream_state::call_open:
+            {
+                acf_stream::context *context = stream->stack + stream->depth - 1;
+                if (t.type != acf_document_token_type::parentheses_open)
+                {
+                    acf_stream_report_error(stream, "Constructor call have to have parentheses around arguments, even if number of them is 0.");
+                    return false;
+                }
+
+                acf_event event = {};
+                event.type = acf_event_type::begin_custom;
+                event.newtype = stream->newtypes + context->newtype_index;
+
+                *state = (event.newtype->argument_count > 0) ? acf_stream_state::call_argument : acf_stream_state::call_after_argument;
+                return acf_stream_emit(stream, event);
+            }
+
+            case acf_stream_state::call_argument:
+            {
+                acf_stream::context *context = stream->stack + stream->depth - 1;
+                acf_newtype *newtype = stream->newtypes + context->newtype_index;
+                acf_type_t expected = newtype->arguments[context->argument_index];
+
+                if (expected == acf_type_t::type)
+                {
+                    acf_node argument = {};
+                    argument.type = acf_type_t::type;
+                    if (!acf_document_keyword_to_type(t.type, &argument.type_value))
+                    {
+                        acf_stream_report_error(stream, "Expected one of the basic types here.");
+                        return false;
+                    }
+
+                    acf_event event = {};
+                    event.type = acf_event_type::value;
+                    event.value = argument;
+                    if (!acf_stream_emit(stream, event)) return false;
+
+                    acf_stream_end_value(stream);
+                    return true;
+                }
+
+                if (t.type == acf_document_token_type::parentheses_close)
+                {
+                    acf_stream_report_error(stream, "Argument count mismatch! Expected %u arguments, got %u.", newtype->argument_count, context->argument_index);
+                    return false;
+                }
+
+                return acf_stream_begin_value(stream, t, &expected);
+            }
+
+            case acf_stream_state::call_after_argument:
+            {
+                acf_stream::context *context = stream->stack + stream->depth - 1;
+                if (context->argument_index < stream->newtypes[context->newtype_index].argument_count)
+                {
+                    // @note: Do not support trailing comma in function calls.
+                    if (t.type != acf_document_token_type::comma)
+                    {
+                        acf_stream_report_error(stream, "Expected ','.");
+                        return false;
+                    }
+                    *state = acf_stream_state::call_argument;
+                    return true;
+                }
+
+                if (t.type != acf_document_token_type::parentheses_close)
+                {
+                    acf_stream_report_error(stream, "Expected ')'.");
+                    return false;
+                }
+                return acf_stream_close_context(stream);
+            }
+        }
+
+        return true;
+    }
+}
+
+
+// @note: Tokens which end exactly at the end of the chunk may continue in the next one.
+INTERNAL
+bool acf_stream_token_may_continue(acf_document_token t)
+{
+    bool result = (t.type != acf_document_token_type::string) && ((u32) t.type < (u32) acf_document_token_type::pound);
+    return result;
+}
+
+
+INTERNAL
+void acf_stream_advance_location(acf_stream *stream, char const *data, char const *end)
+{
+    if (data == end) return;
+
+    char const *line_start = NULL;
+    for (char const *c = data; (c = (char const *) memchr(c, '\n', end - c)) != NULL; c++)
+    {
+        stream->line += 1;
+        line_start = c + 1;
+    }
+
+    stream->column = line_start ? (u32) (end - line_start) + 1 : stream->column + (u32) (end - data);
+}
+
+
+INTERNAL
+bool acf_stream_consume(acf_stream *stream, char const *data, usize size, bool final)
+{
+    if (stream->has_error) return false;
+
+    char const *at = data;
+    char const *end = data + size;
+
+    stream->chunk = data;
+    stream->token_in_carry = false;
+
+    while (stream->carry_size > 0)
+    {
+        // @note: The rest of the carried token has to be in this chunk, unless it is too long.
+        usize copy_size = ACF_STREAM_MAX_TOKEN_SIZE - stream->carry_size;
+        if (copy_size > size) copy_size = size;
+        memory::copy(stream->carry + stream->carry_size, data, copy_size);
+
+        char const *carry_end = stream->carry + stream->carry_size + copy_size;
+
+        if ((stream->carry_size == 1) && (stream->carry[0] == '/') && (copy_size > 0) && (data[0] == '/'))
+        {
+            // @note: Comment, which started at the very end of the previous chunk.
+            stream->in_comment = true;
+            at += 1;
+        }
+        else
+        {
+            acf_document_token t = acf_document_lex(stream->carry, carry_end);
+            if (t.type == acf_document_token_type::end_of_file)
+            {
+                t.type = acf_document_token_type::invalid;
+                t.size = 1;
+            }
+            char const *token_end = t.span + t.size;
+
+            if ((token_end == carry_end) && !final)
+            {
+                if (copy_size < size)
+                {
+                    stream->token_in_carry = true;
+                    stream->token_span = stream->carry;
+                    acf_stream_report_error(stream, "Token is longer than %d bytes, which is the maximum for tokens split between chunks.", ACF_STREAM_MAX_TOKEN_SIZE);
+                    return false;
+                }
+
+                stream->carry_size += (u32) copy_size;
+                acf_stream_advance_location(stream, data, end);
+                return true;
+            }
+
+            stream->token_in_carry = true;
+            if (!acf_stream_process_token(stream, t)) return false;
+            stream->token_in_carry = false;
+
+            char const *carried_end = stream->carry + stream->carry_size;
+            if (token_end < carried_end)
+            {
+                // @note: The token is shorter than it looked at the end of the previous chunk, like "1e" followed
+                // by "x", so the rest of the carried bytes is lexed again, together with this chunk.
+                u32 consumed = (u32) (token_end - stream->carry);
+                stream->carry_size -= consumed;
+                stream->carry_column += consumed;
+                memmove(stream->carry, token_end, stream->carry_size);
+                continue;
+            }
+
+            at += token_end - carried_end;
+        }
+
+        stream->carry_size = 0;
+    }
+
+    loop
+    {
+        if (stream->in_comment)
+        {
+            at = acf_scan_while<acf_comment_body_class>(at, end);
+            if (at == end) break;
+            stream->in_comment = false;
+        }
+
+        at = acf_scan_while<acf_space_class>(at, end);
+        if (at == end) break;
+
+        if (*at == '/')
+        {
+            if ((at + 1 == end) && !final)
+            {
+                stream->carry[0] = '/';
+                stream->carry_size = 1;
+                acf_stream_get_location(stream, at, &stream->carry_line, &stream->carry_column);
+                break;
+            }
+            if ((at + 1 < end) && (at[1] == '/'))
+            {
+                stream->in_comment = true;
+                at += 2;
+                continue;
+            }
+        }
+
+        acf_document_token t = acf_document_lex(at, end);
+        if (t.type == acf_document_token_type::end_of_file)
+        {
+            // @note: Zero byte, which is the end of the source for the lexer.
+            t.type = acf_document_token_type::invalid;
+            t.size = 1;
+        }
+
+        char const *token_end = t.span + t.size;
+        if ((token_end == end) && !final && acf_stream_token_may_continue(t))
+        {
+            if (t.size > ACF_STREAM_MAX_TOKEN_SIZE)
+            {
+                stream->token_span = t.span;
+                acf_stream_report_error(stream, "Token is longer than %d bytes, which is the maximum for tokens split between chunks.", ACF_STREAM_MAX_TOKEN_SIZE);
+                return false;
+            }
+
+            memory::copy(stream->carry, t.span, t.size);
+            stream->carry_size = t.size;
+            acf_stream_get_location(stream, at, &stream->carry_line, &stream->carry_column);
+            break;
+        }
+
+        if (!acf_stream_process_token(stream, t)) return false;
+        at = token_end;
+    }
+
+    if (final)
+    {
+        acf_document_token t = {};
+        t.type = acf_document_token_type::end_of_file;
+        t.span = end;
+        if (!acf_stream_process_token(stream, t)) return false;
+    }
+
+    acf_stream_advance_location(stream, data, end);
+    return true;
+}
+
+
+void initialize_acf_stream(acf_stream *stream, acf_event_callback *callback, void *user_data)
+{
+    stream->callback = callback;
+    stream->user_data = user_data;
+
+    stream->state = acf_stream_state::document_start;
+    stream->depth = 0;
+    stream->newtype_count = 0;
+    memory::set(stream->newtype_slots, 0, sizeof(stream->newtype_slots));
+
+    stream->in_comment = false;
+    stream->carry_size = 0;
+
+    stream->chunk = NULL;
+    stream->line = 1;
+    stream->column = 1;
+    stream->token_span = NULL;
+    stream->token_in_carry = false;
+
+    stream->has_error = false;
+    stream->error_line = 0;
+    stream->error_column = 0;
+    stream->error_buffer[0] = 0;
+}
+
+
+bool register_acf_stream_newtype(acf_stream *stream, acf_string_view name, u32 argument_count, acf_type_t const *arguments)
+{
+    if ((stream->newtype_count == ACF_MAX_NEWTYPES) || (argument_count > ACF_MAX_NEWTYPE_ARGUMENTS) || (name.size > ACF_STREAM_MAX_NEWTYPE_NAME)) return false;
+
+    u32 newtype_index = stream->newtype_count++;
+
+    // @note: The name is copied, because chunks do not live long enough.
+    memory::copy(stream->newtype_name_buffers[newtype_index], name.data, name.size);
+    stream->newtype_names[newtype_index] = { stream->newtype_name_buffers[newtype_index], name.size };
+
+    acf_newtype *newtype = stream->newtypes + newtype_index;
+    newtype->name = stream->newtype_names + newtype_index;
+    newtype->hash = hash_acf_key(name.data, name.size);
+    newtype->argument_count = argument_count;
+    if (argument_count > 0)
+    {
+        memory::copy(newtype->arguments, arguments, argument_count * sizeof(acf_type_t));
+    }
+
+    index_acf_newtype(stream->newtypes, stream->newtype_slots, ARRAY_COUNT(stream->newtype_slots), newtype_index);
+    return true;
+}
+
+
+bool feed_acf_stream(acf_stream *stream, char const *data, usize size)
+{
+    bool result = acf_stream_consume(stream, data, size, false);
+    return result;
+}
+
+
+bool finish_acf_stream(acf_stream *stream)
+{
+    bool result = acf_stream_consume(stream, NULL, 0, true);
+    return result;
+}
+
+
+//
+// Document builder
+//
+
+INTERNAL
+char const *acf_document_builder_copy_string(acf_document_builder *builder, acf_string_view string)
+{
+    char *result = ALLOCATE_BUFFER_(&builder->document->arena, char, string.size ? string.size : 1);
+    if (result && string.size)
+    {
+        memory::copy(result, string.data, string.size);
+    }
+    return result;
+}
+
+
+INTERNAL
+bool acf_document_builder_out_of_memory(acf_document_builder *builder)
+{
+    acf_stream_report_error(&builder->stream, "Document arena is out of memory (%llu bytes).", (unsigned long long) builder->parser.arena_size);
+    return false;
+}
+
+
+INTERNAL
+bool acf_document_builder_strings_out_of_memory(acf_document_builder *builder)
+{
+    acf_stream_report_error(&builder->stream, "String table is out of memory.");
+    return false;
+}
+
+
+INTERNAL
+bool acf_document_builder_push(acf_document_builder *builder, acf_node node)
+{
+    if (builder->depth == 0)
+    {
+        builder->document->root = node;
+        return true;
+    }
+
+    acf_key key = {};
+    if (builder->containers[builder->depth - 1].type == acf_type_t::object)
+    {
+        key = builder->key;
+    }
+
+    if (!push_scratch_entry(&builder->parser, key, node)) return acf_document_builder_out_of_memory(builder);
+    return true;
+}
+
+
+INTERNAL
+bool acf_document_builder_on_event(void *user_data, acf_event const *event)
+{
+    acf_document_builder *builder = (acf_document_builder *) user_data;
+    acf_document_parser *parser = &builder->parser;
+    acf_document *document = builder->document;
+
+    switch (event->type)
+    {
+        case acf_event_type::newtype:
+        {
+            acf_string_view *name = ALLOCATE_STRUCT_(&document->arena, acf_string_view);
+            char const *name_data = acf_document_builder_copy_string(builder, *event->newtype->name);
+            if ((name == NULL) || (name_data == NULL)) return acf_document_builder_out_of_memory(builder);
+            *name = { name_data, event->newtype->name->size };
+            if (!intern_acf_document_string(document, &name->data, name->size, hash_acf_key(name->data, name->size))) return acf_document_builder_strings_out_of_memory(builder);
+
+            // @note: The stream has the same limit on newtypes, so there is always place for this one.
+            acf_newtype *newtype = add_acf_document_newtype(document, name);
+            newtype->argument_count = event->newtype->argument_count;
+            memory::copy(newtype->arguments, event->newtype->arguments, sizeof(newtype->arguments));
+        }
+        break;
+
+        case acf_event_type::key:
+        {
+            acf_key key = make_acf_key(event->key.data, event->key.size);
+            if (document->strings)
+            {
+                // @note: Interned keys are already stable, there is no need to copy them to the arena.
+                if (!intern_acf_document_string(document, &key.data, key.size, key.hash)) return acf_document_builder_strings_out_of_memory(builder);
+            }
+            else
+            {
+                key.data = acf_document_builder_copy_string(builder, event->key);
+                if (key.data == NULL) return acf_document_builder_out_of_memory(builder);
+            }
+
+            // @note: Duplicates in big objects are found later, when their hash index is built.
+            u32 first = builder->containers[builder->depth - 1].first;
+            u32 check_count = parser->scratch_count - first;
+            if (check_count > ACF_OBJECT_INDEX_THRESHOLD) check_count = ACF_OBJECT_INDEX_THRESHOLD;
+            for (u32 key_index = first; key_index < first + check_count; key_index++)
+            {
+                if (get_scratch_entry(parser, key_index)->key == key)
+                {
+                    acf_stream_report_error(&builder->stream, "Key '%.*s' already defined in this object.", (int) key.size, key.data);
+                    return false;
+                }
+            }
+
+            builder->key = key;
+        }
+        break;
+
+        case acf_event_type::value:
+        {
+            acf_node value = event->value;
+            if (value.is_string())
+            {
+                value.string_value = acf_document_builder_copy_string(builder, value.get_string());
+                if (value.string_value == NULL) return acf_document_builder_out_of_memory(builder);
+            }
+
+            return acf_document_builder_push(builder, value);
+        }
+
+        case acf_event_type::begin_object:
+        case acf_event_type::begin_array:
+        case acf_event_type::begin_custom:
+        {
+            acf_document_builder::container *container = builder->containers + builder->depth++;
+            container->first = parser->scratch_count;
+            container->key = builder->key;
+            container->newtype_name = NULL;
+
+            if (event->type == acf_event_type::begin_object) container->type = acf_type_t::object;
+            if (event->type == acf_event_type::begin_array) container->type = acf_type_t::array;
+            if (event->type == acf_event_type::begin_custom)
+            {
+                // @note: Newtypes of the stream and the document are registered in the same order.
+                container->type = acf_type_t::custom;
+                container->newtype_name = document->newtypes[event->newtype - builder->stream.newtypes].name;
+            }
+        }
+        break;
+
+        case acf_event_type::end_object:
+        case acf_event_type::end_array:
+        case acf_event_type::end_custom:
+        {
+            acf_document_builder::container container = builder->containers[--builder->depth];
+
+            acf_node node = {};
+            node.type = container.type;
+            node.count = parser->scratch_count - container.first;
+
+            acf_key *duplicate = NULL;
+            bool committed = (container.type == acf_type_t::object)
+                ? commit_scratch_entries(parser, container.first, &node.children, &node.keys, &duplicate)
+                : commit_scratch_entries(parser, container.first, &node.children, NULL, NULL);
+            if (!committed) return acf_document_builder_out_of_memory(builder);
+
+            if (duplicate)
+            {
+                acf_stream_report_error(&builder->stream, "Key '%.*s' already defined in this object.", (int) duplicate->size, duplicate->data);
+                return false;
+            }
+
+            if (container.type == acf_type_t::custom)
+            {
+                node.newtype_name = container.newtype_name;
+            }
+
+            builder->key = container.key;
+            return acf_document_builder_push(builder, node);
+        }
+    }
+
+    return true;
+}
+
+
+INTERNAL
+bool end_acf_document_build(acf_document_builder *builder, bool success)
+{
+    if (!success)
+    {
+        builder->finished = true;
+        end_acf_document_parser(&builder->parser);
+
+        acf_document *document = builder->document;
+        document->root = {};
+        document->has_error = true;
+        document->error_line = builder->stream.error_line;
+        document->error_column = builder->stream.error_column;
+        memory::copy(document->error_buffer, builder->stream.error_buffer, sizeof(document->error_buffer));
+    }
+
+    return success;
+}
+
+
+void begin_acf_document_build(acf_document_builder *builder, acf_document *document)
+{
+    builder->document = document;
+    builder->depth = 0;
+    builder->key = {};
+    builder->finished = false;
+
+    document->source = NULL;
+    document->source_size = 0;
+    document->root = {};
+    document->has_error = false;
+    document->error_buffer[0] = 0;
+
+    begin_acf_document_parser(&builder->parser, document);
+
+    initialize_acf_stream(&builder->stream, acf_document_builder_on_event, builder);
+    for (u32 newtype_index = 0; newtype_index < document->newtype_count; newtype_index++)
+    {
+        acf_newtype *newtype = document->newtypes + newtype_index;
+        register_acf_stream_newtype(&builder->stream, *newtype->name, newtype->argument_count, newtype->arguments);
+    }
+}
+
+
+bool feed_acf_document_build(acf_document_builder *builder, char const *data, usize size)
+{
+    if (builder->finished) return false;
+
+    bool result = end_acf_document_build(builder, feed_acf_stream(&builder->stream, data, size));
+    return result;
+}
+
+
+bool finish_acf_document_build(acf_document_builder *builder)
+{
+    if (builder->finished) return false;
+
+    bool result = end_acf_document_build(builder, finish_acf_stream(&builder->stream));
+    if (result)
+    {
+        builder->finished = true;
+        end_acf_document_parser(&builder->parser);
+    }
+    return result;
+}
+
+
+#endif // ACF_LIB_IMPLEMENTATION
+#endif // ACF_STREAM_HPP
@@ -0,0 +1,40 @@
+#ifndef ACF_TYPES_HPP
+#define ACF_TYPES_HPP
+
+#include <defines.hpp>
+
+
+enum class acf_type_t
+{
+    null = 0,
+    boolean,
+    integer,
+    floating,
+    string,
+    object,
+    array,
+    custom,
+    type,
+};
+
+INTERNAL
+char const *get_acf_type_string(acf_type_t type)
+{
+    switch (type)
+    {
+        case acf_type_t::null: return "null";
+        case acf_type_t::boolean: return "bool";
+        case acf_type_t::integer: return "int";
+        case acf_type_t::floating: return "float";
+        case acf_type_t::string: return "string";
+        case acf_type_t::object: return "object";
+        case acf_type_t::array: return "array";
+        case acf_type_t::custom: return "custom";
+        case acf_type_t::type: return "type";
+    }
+
+    return "<none>";
+}
+
+
+#endif // ACF_TYPES_HPP
@@ -4,14 +4,82 @@
 #include <os/memory.hpp>
 #include <code_location.hpp>
 
+#include <stdlib.h>
+
 
 #ifdef ASUKA_DEBUG
+/*
+                               Allocation Log
+
+    In debug builds every allocator keeps the log of its live allocations.
+    The log is an open-addressing hash table keyed by pointer. Removed entries
+    become tombstones, so probe chains are never broken, and the table
+    grows (or rehashes away tombstones) when it is 3/4 full.
+
+    Along with that allocations are aggregated by the call site, so the debug
+    overlay can show how many allocations and bytes each CodeLocation holds,
+    and what was the peak, without walking the whole table.
+
+    Tables live in pages which the log allocates itself, chained into a list
+    of blocks. A table which was outgrown is freed right away, and the one
+    which is full of tombstones is rehashed in place, so a log which keeps
+    the same number of live allocations holds the same pages forever:
+
+      blocks → [ hash table 1024 ] → [ site hash 128 ] → [ sites 64 ]
+
+    Log copied back from a snapshot of the game memory (looped playback)
+    points to its tables of that time, which are freed if the log has grown
+    since. Loops have to be recorded after the allocations settle.
+
+    Zero-initialized log is valid and empty: the first block is allocated on
+    the first push. Owner of the log has to call release_allocation_log.
+*/
+
+
+#define ALLOCATION_LOG_TOMBSTONE ((void *) 1)
+#define ALLOCATION_LOG_PENDING_INDEX ((usize) 1 << (8 * sizeof(usize) - 1)) // @note: Set in the site index of entries which wait for the in-place rehash.
+#define ALLOCATION_LOG_INITIAL_CAPACITY   256
+#define ALLOCATION_SITES_INITIAL_CAPACITY 64
+
+
 struct AllocationLogEntry
 {
     CodeLocation cl;
     void *pointer;
     usize size;
-    usize index;
+    usize index = 0; // @note: index of the call site in AllocationLog::sites, set on push
+};
+
+struct AllocationSite
+{
+    CodeLocation cl;
+    usize count; // live allocations
+    usize bytes; // live bytes
+    usize peak_bytes;
+    usize total_count; // all allocations ever made from this site
+};
+
+struct AllocationLogBlock
+{
+    AllocationLogBlock *next;
+    usize size; // bytes, with this header
+};
+
+struct AllocationLog
+{
+    AllocationLogEntry *hash_table;
+    usize capacity; // @note: always power of 2
+    usize allocation_count;
+    usize tombstone_count;
+
+    AllocationSite *sites; // @note: dense array, so it is cheap to iterate over
+    usize site_count;
+    usize site_capacity;
+
+    u32 *site_hash_table; // @note: index + 1 into 'sites', 0 means empty slot
+    usize site_hash_capacity;
+
+    AllocationLogBlock *blocks;
 };
 
 AllocationLogEntry null_allocation_entry()
@@ -20,17 +88,251 @@ AllocationLogEntry null_allocation_entry()
     return result;
 }
 
-struct AllocationLog
+INLINE
+bool is_live_allocation_entry(AllocationLogEntry *entry)
 {
-    AllocationLogEntry hash_table[2048];
-    usize allocation_count = 0;
-};
+    bool result = (entry->pointer != NULL) && (entry->pointer != ALLOCATION_LOG_TOMBSTONE);
+    return result;
+}
+
+INLINE
+uint64 hash_pointer(void const *pointer)
+{
+    // @note: Murmur3 finalizer. Pointers are aligned, so low bits are always zero and cannot be used as-is.
+    uint64 h = (uint64) pointer;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+INLINE
+uint64 hash_code_location(CodeLocation cl)
+{
+    // @note: In unity build __FILE__ and __FUNCTION__ are the same literals for the same call site, so pointers are enough.
+    uint64 result = hash_pointer(cl.filename) ^ hash_pointer(cl.function) ^ ((uint64) cl.line * 0x9e3779b97f4a7c15ull);
+    return result;
+}
+
+// @note: Pages come zeroed from the OS.
+INLINE
+void *allocate_allocation_log_block(AllocationLog *log, usize size)
+{
+    usize block_size = sizeof(AllocationLogBlock) + size;
+    AllocationLogBlock *block = (AllocationLogBlock *) memory::allocate_pages(block_size);
+    ASSERT_MSG(block, "Could not allocate pages for the allocation log!");
+
+    block->next = log->blocks;
+    block->size = block_size;
+    log->blocks = block;
+
+    return block + 1;
+}
+
+INLINE
+void free_allocation_log_block(AllocationLog *log, void *memory)
+{
+    for (AllocationLogBlock **link = &log->blocks; *link; link = &(*link)->next)
+    {
+        AllocationLogBlock *block = *link;
+        if (block + 1 == memory)
+        {
+            *link = block->next;
+            memory::free_pages(block);
+            return;
+        }
+    }
+
+    ASSERT_FAIL("Freeing the block which does not belong to this allocation log!");
+}
 
 INLINE
 void initialize_allocation_log(AllocationLog *log)
 {
-    memory::set(log->hash_table, 0, sizeof(log->hash_table));
+    if (log->hash_table)
+    {
+        memory::set(log->hash_table, 0, log->capacity * sizeof(AllocationLogEntry));
+    }
+    if (log->site_hash_table)
+    {
+        memory::set(log->site_hash_table, 0, log->site_hash_capacity * sizeof(u32));
+    }
     log->allocation_count = 0;
+    log->tombstone_count = 0;
+    log->site_count = 0;
+}
+
+INLINE
+void release_allocation_log(AllocationLog *log)
+{
+    AllocationLogBlock *block = log->blocks;
+    while (block)
+    {
+        AllocationLogBlock *next = block->next;
+        memory::free_pages(block);
+        block = next;
+    }
+
+    *log = {};
+}
+
+//
+// Clears tombstones without a new table. Live entries are marked pending
+// first; then every pending entry goes to the first slot of its probe chain
+// which is not taken by an entry placed before it, swapping with a pending
+// entry if it has to. Placed entries never move again, so the slots between
+// the hash of a placed entry and its slot stay taken, and lookups find it.
+//
+INLINE
+void rehash_allocation_log_in_place(AllocationLog *log)
+{
+    for (usize index = 0; index < log->capacity; index++)
+    {
+        AllocationLogEntry *entry = log->hash_table + index;
+        if (entry->pointer == ALLOCATION_LOG_TOMBSTONE)
+        {
+            *entry = null_allocation_entry();
+        }
+        else if (entry->pointer != NULL)
+        {
+            entry->index |= ALLOCATION_LOG_PENDING_INDEX;
+        }
+    }
+
+    for (usize index = 0; index < log->capacity; index++)
+    {
+        AllocationLogEntry *entry = log->hash_table + index;
+        while (entry->index & ALLOCATION_LOG_PENDING_INDEX)
+        {
+            entry->index &= ~ALLOCATION_LOG_PENDING_INDEX;
+            for (uint64 probe = hash_pointer(entry->pointer);; probe++)
+            {
+                AllocationLogEntry *slot = log->hash_table + (probe & (log->capacity - 1));
+                if (slot == entry)
+                {
+                    break;
+                }
+                if (slot->pointer == NULL)
+                {
+                    *slot = *entry;
+                    *entry = null_allocation_entry();
+                    break;
+                }
+                if (slot->index & ALLOCATION_LOG_PENDING_INDEX)
+                {
+                    AllocationLogEntry pending = *slot;
+                    *slot = *entry;
+                    *entry = pending;
+                    break;
+                }
+            }
+        }
+    }
+
+    log->tombstone_count = 0;
+}
+
+INLINE
+void resize_allocation_log(AllocationLog *log, usize new_capacity)
+{
+    if (new_capacity == log->capacity)
+    {
+        rehash_allocation_log_in_place(log);
+        return;
+    }
+
+    AllocationLogEntry *old_table = log->hash_table;
+    usize old_capacity = log->capacity;
+
+    log->hash_table = (AllocationLogEntry *) allocate_allocation_log_block(log, new_capacity * sizeof(AllocationLogEntry));
+    log->capacity = new_capacity;
+    log->tombstone_count = 0;
+
+    for (usize old_index = 0; old_index < old_capacity; old_index++)
+    {
+        AllocationLogEntry *old_entry = old_table + old_index;
+        if (is_live_allocation_entry(old_entry))
+        {
+            for (uint64 index = hash_pointer(old_entry->pointer);; index++)
+            {
+                AllocationLogEntry *slot = log->hash_table + (index & (new_capacity - 1));
+                if (slot->pointer == NULL)
+                {
+                    *slot = *old_entry;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (old_table)
+    {
+        free_allocation_log_block(log, old_table);
+    }
+}
+
+INLINE
+usize get_allocation_site_index(AllocationLog *log, CodeLocation cl)
+{
+    if ((log->site_count + 1) * 4 > log->site_hash_capacity * 3)
+    {
+        usize new_capacity = log->site_hash_capacity ? 2 * log->site_hash_capacity : ALLOCATION_SITES_INITIAL_CAPACITY;
+
+        if (log->site_hash_table)
+        {
+            free_allocation_log_block(log, log->site_hash_table);
+        }
+        log->site_hash_table = (u32 *) allocate_allocation_log_block(log, new_capacity * sizeof(u32));
+        log->site_hash_capacity = new_capacity;
+
+        for (usize site_index = 0; site_index < log->site_count; site_index++)
+        {
+            for (uint64 index = hash_code_location(log->sites[site_index].cl);; index++)
+            {
+                u32 *slot = log->site_hash_table + (index & (new_capacity - 1));
+                if (*slot == 0)
+                {
+                    *slot = (u32) (site_index + 1);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint64 index = hash_code_location(cl);; index++)
+    {
+        u32 *slot = log->site_hash_table + (index & (log->site_hash_capacity - 1));
+        if (*slot == 0)
+        {
+            if (log->site_count == log->site_capacity)
+            {
+                AllocationSite *old_sites = log->sites;
+
+                log->site_capacity = log->site_capacity ? 2 * log->site_capacity : ALLOCATION_SITES_INITIAL_CAPACITY;
+                log->sites = (AllocationSite *) allocate_allocation_log_block(log, log->site_capacity * sizeof(AllocationSite));
+                if (old_sites)
+                {
+                    memory::copy(log->sites, old_sites, log->site_count * sizeof(AllocationSite));
+                    free_allocation_log_block(log, old_sites);
+                }
+            }
+
+            AllocationSite *site = log->sites + log->site_count;
+            *site = {};
+            site->cl = cl;
+
+            *slot = (u32) (++log->site_count);
+            return log->site_count - 1;
+        }
+
+        AllocationSite *site = log->sites + (*slot - 1);
+        if ((site->cl.filename == cl.filename) && (site->cl.function == cl.function) && (site->cl.line == cl.line))
+        {
+            return *slot - 1;
+        }
+    }
 }
 
 INLINE
@@ -38,69 +340,136 @@ AllocationLogEntry *get_allocation_entry(AllocationLog *log, void *pointer)
 {
     AllocationLogEntry *result = NULL;
 
-    uint64 hash = (uint64) pointer;
-    for (uint64 offset = 0; offset < ARRAY_COUNT(log->hash_table); offset++)
+    if (log->capacity > 0)
     {
-        uint64 index = (hash + offset) % ARRAY_COUNT(log->hash_table);
-        AllocationLogEntry *entry = log->hash_table + index;
-        if (entry->pointer == pointer || entry->pointer == NULL)
+        for (uint64 index = hash_pointer(pointer);; index++)
         {
-            result = entry;
-            break;
+            AllocationLogEntry *entry = log->hash_table + (index & (log->capacity - 1));
+            if (entry->pointer == pointer)
+            {
+                result = entry;
+                break;
+            }
+            if (entry->pointer == NULL)
+            {
+                break;
+            }
         }
     }
+
     return result;
 }
 
 INLINE
 void push_allocation_entry(AllocationLog *log, AllocationLogEntry entry)
 {
-    ASSERT(log->allocation_count < ARRAY_COUNT(log->hash_table));
+    if ((log->allocation_count + log->tombstone_count + 1) * 4 > log->capacity * 3)
+    {
+        // @note: If table is filled mostly by tombstones, rehash it with the same size.
+        usize new_capacity = log->capacity ? log->capacity : ALLOCATION_LOG_INITIAL_CAPACITY;
+        if ((log->allocation_count + 1) * 2 > new_capacity)
+        {
+            new_capacity *= 2;
+        }
+        resize_allocation_log(log, new_capacity);
+    }
 
     AllocationLogEntry *hash_slot = NULL;
-    uint64 hash = (uint64) entry.pointer;
-    for (uint64 offset = 0; offset < ARRAY_COUNT(log->hash_table); offset++)
+    for (uint64 index = hash_pointer(entry.pointer);; index++)
     {
-        uint64 index = (hash + offset) % ARRAY_COUNT(log->hash_table);
-        AllocationLogEntry *slot = log->hash_table + index;
-        if (slot->pointer == NULL)
+        AllocationLogEntry *slot = log->hash_table + (index & (log->capacity - 1));
+        if (slot->pointer == NULL || slot->pointer == ALLOCATION_LOG_TOMBSTONE)
         {
+            if (slot->pointer == ALLOCATION_LOG_TOMBSTONE)
+            {
+                log->tombstone_count -= 1;
+            }
             hash_slot = slot;
-            log->allocation_count += 1;
             break;
         }
     }
 
-    ASSERT(hash_slot);
+    entry.index = get_allocation_site_index(log, entry.cl);
+
+    AllocationSite *site = log->sites + entry.index;
+    site->count += 1;
+    site->total_count += 1;
+    site->bytes += entry.size;
+    if (site->bytes > site->peak_bytes)
+    {
+        site->peak_bytes = site->bytes;
+    }
+
     *hash_slot = entry;
+    log->allocation_count += 1;
+}
+
+INLINE
+void remove_allocation_entry(AllocationLog *log, AllocationLogEntry *entry)
+{
+    AllocationSite *site = log->sites + entry->index;
+    site->count -= 1;
+    site->bytes -= entry->size;
+
+    *entry = null_allocation_entry();
+    entry->pointer = ALLOCATION_LOG_TOMBSTONE;
+
+    log->allocation_count -= 1;
+    log->tombstone_count += 1;
 }
 
 INLINE
 void pop_allocation_entry(AllocationLog *log, void *pointer)
 {
-    AllocationLogEntry *hash_slot = NULL;
-    uint64 hash = (uint64) pointer;
-    for (uint64 offset = 0; offset < ARRAY_COUNT(log->hash_table); offset++)
+    AllocationLogEntry *hash_slot = get_allocation_entry(log, pointer);
+
+    ASSERT_MSG(hash_slot, "Deallocating pointer which was not allocated by this allocator!");
+    remove_allocation_entry(log, hash_slot);
+}
+
+// @note: For the memory which was reallocated in place.
+INLINE
+void resize_allocation_entry(AllocationLog *log, AllocationLogEntry *entry, usize new_size)
+{
+    AllocationSite *site = log->sites + entry->index;
+    site->bytes = site->bytes - entry->size + new_size;
+    if (site->bytes > site->peak_bytes)
+    {
+        site->peak_bytes = site->bytes;
+    }
+
+    entry->size = new_size;
+}
+
+INLINE
+void resize_allocation_entry(AllocationLog *log, void *pointer, usize new_size)
+{
+    AllocationLogEntry *hash_slot = get_allocation_entry(log, pointer);
+
+    ASSERT_MSG(hash_slot, "Reallocating pointer which was not allocated by this allocator!");
+    resize_allocation_entry(log, hash_slot, new_size);
+}
+
+INLINE
+void pop_allocation_entries_in_range(AllocationLog *log, void *begin, void *end)
+{
+    for (uint64 index = 0; index < log->capacity; index++)
     {
-        uint64 index = (hash + offset) % ARRAY_COUNT(log->hash_table);
         AllocationLogEntry *entry = log->hash_table + index;
-        if (entry->pointer == pointer)
+        if (is_live_allocation_entry(entry) && (begin <= entry->pointer) && (entry->pointer < end))
         {
-            hash_slot = entry;
-            log->allocation_count -= 1;
-            break;
+            remove_allocation_entry(log, entry);
         }
     }
-
-    ASSERT(hash_slot->pointer);
-    *hash_slot = null_allocation_entry();
 }
 #endif // ASUKA_DEBUG
 
 
 #include <memory/arena_allocator.hpp>
+#include <memory/concurrent_arena_allocator.hpp>
 #include <memory/pool_allocator.hpp>
 #include <memory/mallocator.hpp>
+#include <memory/slab_allocator.hpp>
 
 
 /*
@@ -109,7 +478,9 @@ void pop_allocation_entry(AllocationLog *log, void *pointer)
     This module implements various allocator strategies.
     Following allocators are implemented:
       - arena (linear) allocator
+      - concurrent arena allocator (lock-free, for many threads)
       - pool allocator
+      - slab allocator (power-of-two size classes over pool pages)
       - mallocator
     Yet to be implemented
       - stack allocator
@@ -121,6 +492,7 @@ void pop_allocation_entry(AllocationLog *log, void *pointer)
       - allocate__ allocates memory of given size withing the initialized memory buffer
       - reallocate__ extends memory chunk if it's possible, but reallocates otherwise
       - deallocate__ frees allocated memory
+      - release__ gives back everything the allocator holds besides the memory it was given
 
     You should not call these functions directly, but rather use macroses, to
     ensure that all meta-information about location of the call in the source
@@ -175,6 +547,14 @@ void initialize(Allocator *allocator, void *memory, usize size, char const *name
 }
 
 
+// @note: Memory given to initialize stays with the caller, the allocator must not be used after that.
+template <typename Allocator>
+void release(Allocator *allocator)
+{
+    release__(allocator);
+}
+
+
 template <typename Allocator>
 void *allocate_(Allocator *allocator, usize requested_size, usize alignment, CodeLocation cl)
 {
@@ -0,0 +1,212 @@
+#include "asset_loader.hpp"
+#include "png.hpp"
+
+#include <string.h>
+
+
+void initialize_asset_loader(asset_loader *loader, asset_pack const *pack) {
+    memset(loader, 0, sizeof(asset_loader));
+    loader->pack = pack;
+
+    // @note: Slot 0 is the invalid asset, so completions can use 0 for an empty cell.
+    loader->slot_count = 1;
+
+    for (u32 y = 0; y < ASSET_LOADER_PLACEHOLDER_SIZE; y++) {
+        for (u32 x = 0; x < ASSET_LOADER_PLACEHOLDER_SIZE; x++) {
+            bool is_magenta = ((x / 4) + (y / 4)) % 2 == 0;
+            loader->placeholder_pixels[y * ASSET_LOADER_PLACEHOLDER_SIZE + x] = is_magenta ? 0xffff00ff : 0xff000000;
+        }
+    }
+
+    loader->placeholder.pixels = loader->placeholder_pixels;
+    loader->placeholder.size = sizeof(loader->placeholder_pixels);
+    loader->placeholder.width = ASSET_LOADER_PLACEHOLDER_SIZE;
+    loader->placeholder.height = ASSET_LOADER_PLACEHOLDER_SIZE;
+    loader->placeholder.bytes_per_pixel = 4;
+}
+
+
+INTERNAL
+asset_slot *get_asset_slot(asset_loader const *loader, asset_id id) {
+    asset_slot *result = NULL;
+    if (id.index > 0 && id.index < loader->slot_count) {
+        result = (asset_slot *) loader->slots + id.index;
+    }
+    return result;
+}
+
+
+INTERNAL
+asset_id add_asset(asset_loader *loader, char const *name, asset_type type) {
+    asset_id result = {};
+
+    for (u32 index = 1; index < loader->slot_count; index++) {
+        if (strcmp(loader->slots[index].name, name) == 0) {
+            result.index = index;
+            return result;
+        }
+    }
+
+    usize name_length = strlen(name);
+    if (name_length >= ASSET_PACK_NAME_SIZE) return result;
+    if (loader->slot_count >= ASSET_LOADER_MAX_ASSETS) return result;
+
+    asset_slot *slot = loader->slots + loader->slot_count;
+    memcpy(slot->name, name, name_length + 1);
+    slot->type = type;
+    slot->state = ASSET_STATE_UNLOADED;
+
+    result.index = loader->slot_count;
+    loader->slot_count += 1;
+
+    return result;
+}
+
+
+asset_id add_bitmap_asset(asset_loader *loader, char const *name) {
+    return add_asset(loader, name, ASSET_TYPE_BITMAP);
+}
+
+
+asset_id add_sound_asset(asset_loader *loader, char const *name) {
+    return add_asset(loader, name, ASSET_TYPE_SOUND);
+}
+
+
+asset_id add_ready_bitmap_asset(asset_loader *loader, char const *name, Bitmap bitmap) {
+    asset_id result = add_asset(loader, name, ASSET_TYPE_BITMAP);
+
+    asset_slot *slot = get_asset_slot(loader, result);
+    if (slot && slot->state == ASSET_STATE_UNLOADED) {
+        slot->bitmap = bitmap;
+        slot->state = bitmap.pixels ? ASSET_STATE_READY : ASSET_STATE_FAILED;
+    }
+
+    return result;
+}
+
+
+void request_asset(asset_loader *loader, asset_id id) {
+    asset_slot *slot = get_asset_slot(loader, id);
+    if (slot == NULL || slot->state != ASSET_STATE_UNLOADED) return;
+
+    // @note: Assets from the pack do not need any loading.
+    if (loader->pack) {
+        if (slot->type == ASSET_TYPE_BITMAP) {
+            slot->bitmap = get_asset_bitmap(loader->pack, slot->name);
+            if (slot->bitmap.pixels) {
+                slot->state = ASSET_STATE_READY;
+                return;
+            }
+        } else if (slot->type == ASSET_TYPE_SOUND) {
+            slot->sound = get_asset_sound(loader->pack, slot->name);
+            if (slot->sound.samples) {
+                slot->state = ASSET_STATE_READY;
+                return;
+            }
+        }
+    }
+
+    // @note: Too many assets on their way already, the next call will try again.
+    if (loader->in_flight_count >= ASSET_LOADER_QUEUE_SIZE) return;
+
+    u32 write = loader->request_write;
+    loader->requests[write % ASSET_LOADER_QUEUE_SIZE] = id.index;
+    slot->state = ASSET_STATE_QUEUED;
+    loader->in_flight_count += 1;
+
+    ATOMIC_STORE_U32(&loader->request_write, write + 1);
+}
+
+
+asset_state get_asset_state(asset_loader const *loader, asset_id id) {
+    asset_slot *slot = get_asset_slot(loader, id);
+    asset_state result = slot ? slot->state : ASSET_STATE_FAILED;
+    return result;
+}
+
+
+Bitmap *get_bitmap(asset_loader *loader, asset_id id) {
+    Bitmap *result = &loader->placeholder;
+
+    asset_slot *slot = get_asset_slot(loader, id);
+    if (slot && slot->type == ASSET_TYPE_BITMAP) {
+        if (slot->state == ASSET_STATE_UNLOADED) {
+            request_asset(loader, id);
+        }
+        if (slot->state == ASSET_STATE_READY) {
+            result = &slot->bitmap;
+        }
+    }
+
+    return result;
+}
+
+
+wav_file_contents *get_sound(asset_loader *loader, asset_id id) {
+    wav_file_contents *result = NULL;
+
+    asset_slot *slot = get_asset_slot(loader, id);
+    if (slot && slot->type == ASSET_TYPE_SOUND) {
+        if (slot->state == ASSET_STATE_UNLOADED) {
+            request_asset(loader, id);
+        }
+        if (slot->state == ASSET_STATE_READY) {
+            result = &slot->sound;
+        }
+    }
+
+    return result;
+}
+
+
+b32 run_asset_loader_job(asset_loader *loader) {
+    u32 index = 0;
+    loop {
+        u32 read = ATOMIC_LOAD_U32(&loader->request_read);
+        u32 write = ATOMIC_LOAD_U32(&loader->request_write);
+        if (read == write) return false;
+
+        // @note: The cell cannot be reused before this request completes, so reading it before taking it is safe.
+        index = loader->requests[read % ASSET_LOADER_QUEUE_SIZE];
+        if (ATOMIC_COMPARE_EXCHANGE_U32(&loader->request_read, read, read + 1)) break;
+    }
+
+    // @note: Only this thread touches the slot until the completion is published.
+    asset_slot *slot = loader->slots + index;
+    if (slot->type == ASSET_TYPE_BITMAP) {
+        slot->bitmap = load_png_file(slot->name);
+    } else if (slot->type == ASSET_TYPE_SOUND) {
+        slot->sound = Asuka::load_wav_file(slot->name);
+    }
+
+    u32 completion = ATOMIC_FETCH_ADD_U32(&loader->completion_write, 1);
+    ATOMIC_STORE_U32(loader->completions + (completion % ASSET_LOADER_QUEUE_SIZE), index);
+
+    return true;
+}
+
+
+u32 finish_loaded_assets(asset_loader *loader) {
+    u32 result = 0;
+
+    loop {
+        u32 volatile *cell = loader->completions + (loader->completion_read % ASSET_LOADER_QUEUE_SIZE);
+
+        // @note: Workers publish out of order, the next completion could be still on its way.
+        u32 index = ATOMIC_LOAD_U32(cell);
+        if (index == 0) break;
+
+        ATOMIC_STORE_U32(cell, 0);
+        loader->completion_read += 1;
+        loader->in_flight_count -= 1;
+
+        asset_slot *slot = loader->slots + index;
+        b32 loaded = (slot->type == ASSET_TYPE_BITMAP) ? (slot->bitmap.pixels != NULL) : (slot->sound.samples != NULL);
+        slot->state = loaded ? ASSET_STATE_READY : ASSET_STATE_FAILED;
+
+        result += 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,133 @@
+#ifndef ASUKA_COMMON_ASSET_LOADER_HPP
+#define ASUKA_COMMON_ASSET_LOADER_HPP
+
+#include <defines.hpp>
+#include <bitmap.hpp>
+#include <wav.hpp>
+#include <asset_pack.hpp>
+
+
+//
+// Assets by handles, loaded in the background.
+//
+// The game adds assets by name and gets an asset_id back. get_bitmap gives
+// the placeholder until the bitmap is loaded, so nothing waits for the
+// disk; the first call for an asset asks for it. Assets from the asset pack
+// are ready right away, the others are loaded from their files and decoded
+// by worker threads:
+//
+//     game thread                         worker threads
+//
+//     get_bitmap  --> requests  -------->  run_asset_loader_job
+//                     [SPMC ring]            load_png_file, ...
+//                                                |
+//     finish_loaded_assets <-- completions <-----+
+//     (once per frame)         [MPSC ring]
+//
+// Both rings are lock-free. The game thread is the only one which pushes
+// requests, takes completions and changes the state of assets, so the
+// game reads bitmaps without any synchronization. Worker writes the bitmap
+// of the asset before it publishes the completion, and the game does not
+// look at the bitmap until it takes the completion.
+//
+// There are never more than ASSET_LOADER_QUEUE_SIZE assets on their way,
+// from the request to the completion, so neither ring can overflow; the
+// requests which do not fit are made again by the next get_bitmap.
+//
+// The loader does not start threads, the platform layer does, and runs
+// run_asset_loader_job on them:
+//
+//     while (running)
+//     {
+//         if (!run_asset_loader_job(loader)) sleep(1 ms);
+//     }
+//
+// @note: Everything but run_asset_loader_job is for the game thread only.
+//
+
+#define ASSET_LOADER_MAX_ASSETS 256
+#define ASSET_LOADER_QUEUE_SIZE 64 // @note: Has to be a power of two.
+#define ASSET_LOADER_PLACEHOLDER_SIZE 16
+
+
+struct asset_id {
+    u32 index; // @note: 0 is an invalid asset.
+};
+
+
+enum asset_state : u32 {
+    ASSET_STATE_UNLOADED = 0,
+    ASSET_STATE_QUEUED,
+    ASSET_STATE_READY,
+    ASSET_STATE_FAILED,
+};
+
+
+struct asset_slot {
+    char name[ASSET_PACK_NAME_SIZE];
+    asset_type type;
+    asset_state state;
+
+    Bitmap bitmap;
+    wav_file_contents sound;
+};
+
+
+struct asset_loader {
+    asset_pack const *pack;
+
+    // @note: Magenta and black checkers, easy to notice, as placeholders should be.
+    Bitmap placeholder;
+    u32 placeholder_pixels[ASSET_LOADER_PLACEHOLDER_SIZE * ASSET_LOADER_PLACEHOLDER_SIZE];
+
+    asset_slot slots[ASSET_LOADER_MAX_ASSETS];
+    u32 slot_count;
+
+    u32 in_flight_count;
+
+    u32 requests[ASSET_LOADER_QUEUE_SIZE];
+    u32 volatile request_write;
+    u32 volatile request_read;
+
+    u32 volatile completions[ASSET_LOADER_QUEUE_SIZE]; // @note: Index of the asset, 0 if the cell is empty.
+    u32 volatile completion_write;
+    u32 completion_read;
+};
+
+
+void initialize_asset_loader(asset_loader *loader, asset_pack const *pack = NULL);
+
+//
+// Adding an asset with the name which is there already gives the same id.
+// Returns the invalid id when there is no space for more assets, or when
+// the name is too long.
+//
+asset_id add_bitmap_asset(asset_loader *loader, char const *name);
+asset_id add_sound_asset(asset_loader *loader, char const *name);
+
+// @note: For bitmaps the game has already, like the ones compiled into the executable.
+asset_id add_ready_bitmap_asset(asset_loader *loader, char const *name, Bitmap bitmap);
+
+void request_asset(asset_loader *loader, asset_id id);
+asset_state get_asset_state(asset_loader const *loader, asset_id id);
+
+//
+// Return the asset when it is ready, and ask for it when it is not. Until
+// then, get_bitmap gives the placeholder and get_sound gives NULL. Asset
+// which failed to load gives the same.
+//
+Bitmap *get_bitmap(asset_loader *loader, asset_id id);
+wav_file_contents *get_sound(asset_loader *loader, asset_id id);
+
+// @note: Loads one requested asset, on a worker thread. Returns false if there was nothing to do.
+b32 run_asset_loader_job(asset_loader *loader);
+
+// @note: Makes loaded assets ready, once per frame. Returns how many of them there were.
+u32 finish_loaded_assets(asset_loader *loader);
+
+
+#ifdef UNITY_BUILD
+#include "asset_loader.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_ASSET_LOADER_HPP
@@ -0,0 +1,261 @@
+#include "asset_pack.hpp"
+#include "crc.hpp"
+
+#include <string.h>
+
+
+INTERNAL
+u64 align_asset_pack_offset(u64 offset) {
+    u64 result = (offset + (ASSET_PACK_ALIGNMENT - 1)) & ~(u64) (ASSET_PACK_ALIGNMENT - 1);
+    return result;
+}
+
+
+INTERNAL
+u64 get_asset_source_size(asset_pack_source const *source) {
+    u64 result = 0;
+    switch (source->type) {
+        case ASSET_TYPE_BITMAP: result = source->bitmap.size; break;
+        case ASSET_TYPE_SOUND:  result = source->sound.samples_count * sizeof(sound_sample_t); break;
+        default: break;
+    }
+    return result;
+}
+
+
+// @note: Size of the data, as the metadata of the entry says it has to be.
+INTERNAL
+u64 get_asset_entry_expected_size(asset_pack_entry const *entry) {
+    u64 result = 0;
+    switch (entry->type) {
+        case ASSET_TYPE_BITMAP: {
+            result = (u64) entry->bitmap.width * entry->bitmap.height * entry->bitmap.bytes_per_pixel;
+            break;
+        }
+        case ASSET_TYPE_SOUND: {
+            result = entry->sound.samples_count * sizeof(sound_sample_t);
+            break;
+        }
+        default: break;
+    }
+    return result;
+}
+
+
+bool parse_asset_pack(asset_pack *pack, void const *data, usize size) {
+    *pack = {};
+
+    u8 const *bytes = (u8 const *) data;
+    if (bytes == NULL || size < sizeof(asset_pack_header)) return false;
+
+    asset_pack_header const *header = (asset_pack_header const *) bytes;
+    if (header->magic != ASSET_PACK_MAGIC) return false;
+    if (header->version != ASSET_PACK_VERSION) return false;
+    if (header->alignment != ASSET_PACK_ALIGNMENT) return false;
+    if (header->file_size != size) return false;
+
+    u64 directory_size = (u64) header->entry_count * sizeof(asset_pack_entry);
+    if (header->directory_offset < sizeof(asset_pack_header)) return false;
+    if (header->directory_offset % alignof(asset_pack_entry) != 0) return false;
+    if (header->directory_offset + directory_size > size) return false;
+
+    asset_pack_entry const *entries = (asset_pack_entry const *) (bytes + header->directory_offset);
+    if (compute_crc((u8 const *) entries, directory_size) != header->directory_crc) return false;
+
+    for (u32 i = 0; i < header->entry_count; i++) {
+        asset_pack_entry const *entry = entries + i;
+
+        if (memchr(entry->name, 0, ASSET_PACK_NAME_SIZE) == NULL) return false;
+        if (i > 0 && strcmp(entries[i - 1].name, entry->name) >= 0) return false;
+
+        if (entry->type != ASSET_TYPE_BITMAP && entry->type != ASSET_TYPE_SOUND) return false;
+        if (entry->size != get_asset_entry_expected_size(entry)) return false;
+
+        // @note: Written this way, so huge offsets cannot overflow.
+        if (entry->offset % ASSET_PACK_ALIGNMENT != 0) return false;
+        if (entry->offset > size || entry->size > size - entry->offset) return false;
+    }
+
+    pack->header = header;
+    pack->entries = entries;
+    return true;
+}
+
+
+bool open_asset_pack(asset_pack *pack, char const *filename) {
+    *pack = {};
+
+    os::mapped_file file = os::map_file(filename);
+    if (file.data == NULL) {
+        return false;
+    }
+
+    if (!parse_asset_pack(pack, file.data, file.size)) {
+        os::unmap_file(&file);
+        return false;
+    }
+
+    pack->file = file;
+    return true;
+}
+
+
+void close_asset_pack(asset_pack *pack) {
+    os::unmap_file(&pack->file);
+    *pack = {};
+}
+
+
+bool verify_asset_pack(asset_pack const *pack) {
+    if (pack->header == NULL) return false;
+
+    u8 const *bytes = (u8 const *) pack->header;
+    for (u32 i = 0; i < pack->header->entry_count; i++) {
+        asset_pack_entry const *entry = pack->entries + i;
+        if (compute_crc(bytes + entry->offset, entry->size) != entry->crc) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+asset_pack_entry const *find_asset(asset_pack const *pack, char const *name) {
+    if (pack->header == NULL) return NULL;
+
+    // @note: Entries are sorted by name.
+    u32 lo = 0;
+    u32 hi = pack->header->entry_count;
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2;
+        int order = strcmp(pack->entries[mid].name, name);
+        if (order == 0) return pack->entries + mid;
+        if (order < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+
+Bitmap get_asset_bitmap(asset_pack const *pack, char const *name) {
+    Bitmap result {};
+
+    asset_pack_entry const *entry = find_asset(pack, name);
+    if (entry && entry->type == ASSET_TYPE_BITMAP) {
+        result.pixels = (void *) ((u8 const *) pack->header + entry->offset);
+        result.size = entry->size;
+        result.width = entry->bitmap.width;
+        result.height = entry->bitmap.height;
+        result.bytes_per_pixel = entry->bitmap.bytes_per_pixel;
+    }
+
+    return result;
+}
+
+
+wav_file_contents get_asset_sound(asset_pack const *pack, char const *name) {
+    wav_file_contents result {};
+
+    asset_pack_entry const *entry = find_asset(pack, name);
+    if (entry && entry->type == ASSET_TYPE_SOUND) {
+        result.samples_per_second = (i32) entry->sound.samples_per_second;
+        result.channels = (i32) entry->sound.channels;
+        result.samples = (sound_sample_t *) ((u8 const *) pack->header + entry->offset);
+        result.samples_count = entry->sound.samples_count;
+    }
+
+    return result;
+}
+
+
+usize get_asset_pack_size(asset_pack_source const *sources, u32 count) {
+    u64 result = sizeof(asset_pack_header) + (u64) count * sizeof(asset_pack_entry);
+    for (u32 i = 0; i < count; i++) {
+        result = align_asset_pack_offset(result) + get_asset_source_size(sources + i);
+    }
+    return (usize) result;
+}
+
+
+usize write_asset_pack(asset_pack_source const *sources, u32 count, u8 *output, usize capacity) {
+    usize size = get_asset_pack_size(sources, count);
+    if (size > capacity) return 0;
+
+    memset(output, 0, size);
+
+    asset_pack_header *header = (asset_pack_header *) output;
+    header->magic = ASSET_PACK_MAGIC;
+    header->version = ASSET_PACK_VERSION;
+    header->alignment = ASSET_PACK_ALIGNMENT;
+    header->entry_count = count;
+    header->directory_offset = sizeof(asset_pack_header);
+    header->file_size = size;
+
+    asset_pack_entry *entries = (asset_pack_entry *) (output + header->directory_offset);
+
+    // @note: Data goes in the order of sources, so the packer decides what lies next to what.
+    u64 offset = header->directory_offset + (u64) count * sizeof(asset_pack_entry);
+    for (u32 i = 0; i < count; i++) {
+        asset_pack_source const *source = sources + i;
+        asset_pack_entry *entry = entries + i;
+
+        usize name_length = strlen(source->name);
+        if (name_length >= ASSET_PACK_NAME_SIZE) return 0;
+        memcpy(entry->name, source->name, name_length);
+
+        void const *data = NULL;
+        entry->type = source->type;
+        switch (source->type) {
+            case ASSET_TYPE_BITMAP: {
+                entry->bitmap.width = source->bitmap.width;
+                entry->bitmap.height = source->bitmap.height;
+                entry->bitmap.bytes_per_pixel = source->bitmap.bytes_per_pixel;
+                data = source->bitmap.pixels;
+                break;
+            }
+            case ASSET_TYPE_SOUND: {
+                entry->sound.samples_per_second = (u32) source->sound.samples_per_second;
+                entry->sound.channels = (u32) source->sound.channels;
+                entry->sound.samples_count = source->sound.samples_count;
+                data = source->sound.samples;
+                break;
+            }
+            default: return 0;
+        }
+
+        entry->size = get_asset_source_size(source);
+        if (entry->size != get_asset_entry_expected_size(entry)) return 0;
+
+        offset = align_asset_pack_offset(offset);
+        entry->offset = offset;
+        if (entry->size > 0) {
+            memcpy(output + offset, data, entry->size);
+        }
+        entry->crc = compute_crc(output + offset, entry->size);
+        offset += entry->size;
+    }
+
+    // @note: Insertion sort by name, there are tens of entries, not thousands.
+    for (u32 i = 1; i < count; i++) {
+        asset_pack_entry entry = entries[i];
+        u32 j = i;
+        while (j > 0 && strcmp(entries[j - 1].name, entry.name) > 0) {
+            entries[j] = entries[j - 1];
+            j -= 1;
+        }
+        entries[j] = entry;
+    }
+
+    for (u32 i = 1; i < count; i++) {
+        if (strcmp(entries[i - 1].name, entries[i].name) == 0) return 0;
+    }
+
+    header->directory_crc = compute_crc((u8 const *) entries, (usize) count * sizeof(asset_pack_entry));
+
+    return size;
+}
@@ -0,0 +1,125 @@
+#ifndef ASUKA_COMMON_ASSET_PACK_HPP
+#define ASUKA_COMMON_ASSET_PACK_HPP
+
+#include <defines.hpp>
+#include <bitmap.hpp>
+#include <wav.hpp>
+#include <os/file.hpp>
+
+
+//
+// Asset pack is one file with all bitmaps and sounds of the game, decoded
+// and converted by the asset packer ahead of time, in the same form
+// decode_png and load_wav_file give them:
+//
+//   +-----------------------------+  0
+//   | asset_pack_header           |
+//   +-----------------------------+  header.directory_offset
+//   | asset_pack_entry [count]    |  sorted by name
+//   +-----------------------------+  aligned to ASSET_PACK_ALIGNMENT
+//   | pixels or samples of entry  |
+//   +-----------------------------+  aligned to ASSET_PACK_ALIGNMENT
+//   | ...                         |
+//   +-----------------------------+  header.file_size
+//
+// The game maps the file and hands out pointers right into the mapping,
+// so opening it reads the directory only, and the pages with pixels are
+// loaded by the OS when they are drawn for the first time.
+//
+// @note: Mapping is read-only, bitmaps and sounds from the pack must not be written to.
+//
+
+#define ASSET_PACK_MAGIC      0x6b504141u // "AAPk"
+#define ASSET_PACK_VERSION    1
+#define ASSET_PACK_ALIGNMENT  64
+#define ASSET_PACK_NAME_SIZE  40
+
+
+enum asset_type : u32 {
+    ASSET_TYPE_NONE = 0,
+    ASSET_TYPE_BITMAP,
+    ASSET_TYPE_SOUND,
+};
+
+
+struct asset_pack_header {
+    u32 magic;
+    u32 version;
+    u32 alignment;       // of the data, ASSET_PACK_ALIGNMENT
+    u32 entry_count;
+    u32 directory_offset;
+    u32 directory_crc;   // of all entries
+    u64 file_size;
+};
+
+
+struct asset_pack_entry {
+    char name[ASSET_PACK_NAME_SIZE]; // zero-terminated
+    u32 type;
+    u32 crc;    // of the data, checked by verify_asset_pack only
+    u64 offset; // from the beginning of the file
+    u64 size;   // in bytes
+    union {
+        struct {
+            u32 width;
+            u32 height;
+            u32 bytes_per_pixel;
+            u32 reserved;
+        } bitmap;
+        struct {
+            u32 samples_per_second;
+            u32 channels;
+            u64 samples_count;
+        } sound;
+    };
+};
+
+
+struct asset_pack {
+    os::mapped_file file;
+    asset_pack_header const *header;
+    asset_pack_entry const *entries;
+};
+
+
+//
+// Checks the header and the directory of the pack in memory, with its
+// CRC, but not the data itself. On error the pack is empty, and lookups
+// find nothing.
+//
+bool parse_asset_pack(asset_pack *pack, void const *data, usize size);
+bool open_asset_pack(asset_pack *pack, char const *filename);
+void close_asset_pack(asset_pack *pack);
+
+// @note: Checks CRCs of all entries, which reads the whole file.
+bool verify_asset_pack(asset_pack const *pack);
+
+asset_pack_entry const *find_asset(asset_pack const *pack, char const *name);
+Bitmap get_asset_bitmap(asset_pack const *pack, char const *name);
+wav_file_contents get_asset_sound(asset_pack const *pack, char const *name);
+
+
+//
+// Writing of packs, for the asset packer.
+//
+struct asset_pack_source {
+    char const *name;
+    asset_type type;
+    Bitmap bitmap;
+    wav_file_contents sound;
+};
+
+usize get_asset_pack_size(asset_pack_source const *sources, u32 count);
+
+//
+// Writes the pack into the output and returns its size. Returns 0 if it
+// does not fit, or if some name is too long or there are two of the same.
+//
+usize write_asset_pack(asset_pack_source const *sources, u32 count, u8 *output, usize capacity);
+
+
+#ifdef UNITY_BUILD
+#include "asset_pack.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_ASSET_PACK_HPP
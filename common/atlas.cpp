@@ -0,0 +1,230 @@
+#include "atlas.hpp"
+
+#include <string.h>
+
+
+void initialize_skyline_packer(skyline_packer *packer, u32 width, u32 height) {
+    packer->width = width;
+    packer->height = height;
+
+    packer->nodes[0].x = 0;
+    packer->nodes[0].y = 0;
+    packer->nodes[0].width = width;
+    packer->node_count = 1;
+}
+
+
+// @note: Where the rectangle would lie if its left edge were at the node, on top of every node under it.
+INTERNAL
+bool skyline_fits(skyline_packer const *packer, u32 index, u32 width, u32 height, u32 *y) {
+    u32 x = packer->nodes[index].x;
+    if (x + width > packer->width) return false;
+
+    u32 top = 0;
+    u32 remaining = width;
+    while (remaining > 0) {
+        skyline_node const *node = packer->nodes + index;
+        if (node->y > top) top = node->y;
+        if (top + height > packer->height) return false;
+
+        remaining -= (node->width < remaining) ? node->width : remaining;
+        index += 1;
+    }
+
+    *y = top;
+    return true;
+}
+
+
+INTERNAL
+void remove_skyline_node(skyline_packer *packer, u32 index) {
+    memmove(packer->nodes + index, packer->nodes + index + 1, (packer->node_count - index - 1) * sizeof(skyline_node));
+    packer->node_count -= 1;
+}
+
+
+bool skyline_pack(skyline_packer *packer, u32 width, u32 height, u32 *x, u32 *y) {
+    // @note: Empty rectangles would make nodes of no width.
+    if (width == 0 || height == 0) return false;
+    if (packer->node_count >= SKYLINE_MAX_NODES) return false;
+
+    // @note: Bottom-left, the lowest bottom edge wins, and the narrowest node on a tie, to leave wide ones for wide sprites.
+    u32 best_index = packer->node_count;
+    u32 best_bottom = 0;
+    u32 best_width = 0;
+    u32 best_y = 0;
+
+    for (u32 index = 0; index < packer->node_count; index++) {
+        u32 top = 0;
+        if (!skyline_fits(packer, index, width, height, &top)) continue;
+
+        u32 bottom = top + height;
+        u32 node_width = packer->nodes[index].width;
+        if (best_index == packer->node_count || bottom < best_bottom || (bottom == best_bottom && node_width < best_width)) {
+            best_index = index;
+            best_bottom = bottom;
+            best_width = node_width;
+            best_y = top;
+        }
+    }
+
+    if (best_index == packer->node_count) return false;
+
+    skyline_node node = {};
+    node.x = packer->nodes[best_index].x;
+    node.y = best_y + height;
+    node.width = width;
+
+    memmove(packer->nodes + best_index + 1, packer->nodes + best_index, (packer->node_count - best_index) * sizeof(skyline_node));
+    packer->nodes[best_index] = node;
+    packer->node_count += 1;
+
+    // @note: Nodes under the new one are covered by it, wholly or partly.
+    u32 index = best_index + 1;
+    while (index < packer->node_count) {
+        skyline_node *previous = packer->nodes + index - 1;
+        skyline_node *current = packer->nodes + index;
+
+        u32 previous_end = previous->x + previous->width;
+        if (current->x >= previous_end) break;
+
+        u32 shrink = previous_end - current->x;
+        if (current->width <= shrink) {
+            remove_skyline_node(packer, index);
+        } else {
+            current->x += shrink;
+            current->width -= shrink;
+            break;
+        }
+    }
+
+    for (u32 i = 0; i + 1 < packer->node_count;) {
+        if (packer->nodes[i].y == packer->nodes[i + 1].y) {
+            packer->nodes[i].width += packer->nodes[i + 1].width;
+            remove_skyline_node(packer, i + 1);
+        } else {
+            i += 1;
+        }
+    }
+
+    *x = node.x;
+    *y = best_y;
+    return true;
+}
+
+
+void initialize_texture_atlas(texture_atlas *atlas, u32 page_width, u32 page_height, u32 padding) {
+    memset(atlas, 0, sizeof(texture_atlas));
+    atlas->page_width = page_width;
+    atlas->page_height = page_height;
+    atlas->padding = padding;
+}
+
+
+bool pack_texture_atlas(texture_atlas *atlas, Bitmap const *bitmaps, u32 count, atlas_sprite *sprites) {
+    if (count > TEXTURE_ATLAS_MAX_SPRITES) return false;
+
+    // @note: Tallest first, the skyline stays flatter this way. Insertion sort, there are tens of sprites.
+    u32 order[TEXTURE_ATLAS_MAX_SPRITES];
+    for (u32 i = 0; i < count; i++) {
+        u32 index = i;
+        u32 j = i;
+        while (j > 0) {
+            Bitmap const *a = bitmaps + order[j - 1];
+            Bitmap const *b = bitmaps + index;
+            bool is_before = (b->height > a->height) || (b->height == a->height && b->width > a->width);
+            if (!is_before) break;
+
+            order[j] = order[j - 1];
+            j -= 1;
+        }
+        order[j] = index;
+    }
+
+    u32 padding = atlas->padding;
+    for (u32 i = 0; i < count; i++) {
+        u32 index = order[i];
+        Bitmap const *bitmap = bitmaps + index;
+
+        atlas_sprite *sprite = sprites + index;
+        sprite->page = NULL;
+        sprite->x = 0;
+        sprite->y = 0;
+        sprite->width = bitmap->width;
+        sprite->height = bitmap->height;
+
+        if (bitmap->pixels == NULL || bitmap->bytes_per_pixel != 4) continue;
+        if (bitmap->width == 0 || bitmap->height == 0) continue;
+
+        u32 padded_width = bitmap->width + 2 * padding;
+        u32 padded_height = bitmap->height + 2 * padding;
+        if (padded_width > atlas->page_width || padded_height > atlas->page_height) continue;
+
+        u32 x = 0;
+        u32 y = 0;
+        u32 page_index = 0;
+        while (page_index < atlas->page_count) {
+            if (skyline_pack(atlas->packers + page_index, padded_width, padded_height, &x, &y)) break;
+            page_index += 1;
+        }
+
+        if (page_index == atlas->page_count) {
+            if (atlas->page_count == TEXTURE_ATLAS_MAX_PAGES) return false;
+
+            initialize_skyline_packer(atlas->packers + page_index, atlas->page_width, atlas->page_height);
+
+            Bitmap *page = atlas->pages + page_index;
+            page->pixels = NULL;
+            page->width = atlas->page_width;
+            page->height = atlas->page_height;
+            page->bytes_per_pixel = 4;
+            page->size = (usize) page->width * page->height * page->bytes_per_pixel;
+
+            atlas->page_count += 1;
+
+            // @note: Cannot fail, the sprite fits into the page and the page is empty.
+            if (!skyline_pack(atlas->packers + page_index, padded_width, padded_height, &x, &y)) return false;
+        }
+
+        sprite->page = atlas->pages + page_index;
+        sprite->x = x + padding;
+        sprite->y = y + padding;
+    }
+
+    return true;
+}
+
+
+usize get_texture_atlas_pages_size(texture_atlas const *atlas) {
+    usize result = (usize) atlas->page_count * atlas->page_width * atlas->page_height * 4;
+    return result;
+}
+
+
+void fill_texture_atlas_pages(texture_atlas *atlas, void *memory, Bitmap const *bitmaps, u32 count, atlas_sprite const *sprites) {
+    memset(memory, 0, get_texture_atlas_pages_size(atlas));
+
+    u8 *page_memory = (u8 *) memory;
+    for (u32 page_index = 0; page_index < atlas->page_count; page_index++) {
+        Bitmap *page = atlas->pages + page_index;
+        page->pixels = page_memory;
+        page_memory += page->size;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        atlas_sprite const *sprite = sprites + i;
+        if (sprite->page == NULL) continue;
+
+        Bitmap const *bitmap = bitmaps + i;
+        usize page_pitch = (usize) sprite->page->width * 4;
+        usize bitmap_pitch = (usize) bitmap->width * 4;
+
+        u8 *destination = (u8 *) sprite->page->pixels + sprite->y * page_pitch + (usize) sprite->x * 4;
+        u8 const *source = (u8 const *) bitmap->pixels;
+        for (u32 y = 0; y < sprite->height; y++) {
+            memcpy(destination, source, bitmap_pitch);
+            destination += page_pitch;
+            source += bitmap_pitch;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef ASUKA_COMMON_ATLAS_HPP
+#define ASUKA_COMMON_ATLAS_HPP
+
+#include <defines.hpp>
+#include <bitmap.hpp>
+
+
+//
+// Texture atlas puts many small bitmaps into few big pages, so sprites
+// drawn one after another are next to each other in memory, and one page
+// can be one texture for the renderer.
+//
+// Sprites are placed by a skyline packer. Skyline is the outline of the
+// sprites placed so far, seen from the bottom of the page, and every new
+// sprite goes onto the skyline where its bottom edge ends up the lowest:
+//
+//     +------------------------+  page_height
+//     |                        |
+//     |            +----+      |
+//     +-------+    |    |      |
+//     |       |    | 3  +------+  <- skyline
+//     |   1   +----+    |  4   |
+//     |       |  2 |    |      |
+//     +-------+----+----+------+  0
+//
+// Packing is done first, without any pixels, so the caller knows how much
+// memory the pages need before it allocates them:
+//
+//     pack_texture_atlas(&atlas, bitmaps, count, sprites);
+//     void *memory = allocate(get_texture_atlas_pages_size(&atlas));
+//     fill_texture_atlas_pages(&atlas, memory, bitmaps, count, sprites);
+//
+// Every sprite has a transparent border of atlas->padding pixels around
+// it, so filtering at its edges does not pick up its neighbours.
+//
+// @note: Pages are 4 bytes per pixel, only bitmaps with 4 bytes per pixel go into the atlas.
+//
+
+#define SKYLINE_MAX_NODES 256
+#define TEXTURE_ATLAS_MAX_PAGES 4
+#define TEXTURE_ATLAS_MAX_SPRITES 256
+
+
+struct skyline_node {
+    u32 x;
+    u32 y; // height of the skyline over [x, x + width)
+    u32 width;
+};
+
+
+struct skyline_packer {
+    u32 width;
+    u32 height;
+
+    // @note: Sorted by x, they cover the whole width of the page with no gaps.
+    skyline_node nodes[SKYLINE_MAX_NODES];
+    u32 node_count;
+};
+
+
+// @note: Sprites point into the atlas, it must not move once it is packed.
+struct atlas_sprite {
+    Bitmap *page; // NULL if the sprite is not in the atlas
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+};
+
+
+struct texture_atlas {
+    u32 page_width;
+    u32 page_height;
+    u32 padding;
+
+    skyline_packer packers[TEXTURE_ATLAS_MAX_PAGES];
+    Bitmap pages[TEXTURE_ATLAS_MAX_PAGES];
+    u32 page_count;
+};
+
+
+void initialize_skyline_packer(skyline_packer *packer, u32 width, u32 height);
+
+// @note: Returns false if the rectangle does not fit anywhere.
+bool skyline_pack(skyline_packer *packer, u32 width, u32 height, u32 *x, u32 *y);
+
+void initialize_texture_atlas(texture_atlas *atlas, u32 page_width, u32 page_height, u32 padding = 1);
+
+//
+// Places every bitmap into the atlas, the tallest first, and writes where
+// it went to sprites. Bitmaps which cannot go into the atlas, because they
+// are not 4 bytes per pixel or because they are bigger than a page, get
+// sprites with no page. Returns false if the pages ran out.
+//
+bool pack_texture_atlas(texture_atlas *atlas, Bitmap const *bitmaps, u32 count, atlas_sprite *sprites);
+
+usize get_texture_atlas_pages_size(texture_atlas const *atlas);
+
+// @note: Memory has to be get_texture_atlas_pages_size bytes, the atlas points into it from then on.
+void fill_texture_atlas_pages(texture_atlas *atlas, void *memory, Bitmap const *bitmaps, u32 count, atlas_sprite const *sprites);
+
+
+#ifdef UNITY_BUILD
+#include "atlas.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_ATLAS_HPP
@@ -1,69 +1,313 @@
 /*
 
 Reference: http://www.libpng.org/pub/png/spec/1.2/PNG-CRCAppendix.html
+           https://www.intel.com/content/dam/www/public/us/en/documents/white-papers/fast-crc-computation-generic-polynomials-pclmulqdq-paper.pdf
 
 */
 
 #include "crc.hpp"
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CRC_PCLMUL 1
+#include <immintrin.h>
+#if defined(ASUKA_COMPILER_MICROSOFT)
+#include <intrin.h>
+#define CRC_TARGET_PCLMUL
+#else
+#include <cpuid.h>
+#define CRC_TARGET_PCLMUL __attribute__((target("sse2,pclmul")))
+#endif
+#endif
 
-//
-// Table of CRCs of all 8-bit messages.
-//
-u32 crc_table[256];
 
-// Flag: has the table been computed? Initially false.
-i32 crc_table_computed = 0;
+// polynomial: 1+x+x^2+x^4+x^5+x^7+x^8+x^10+x^11+x^12+x^16+x^22+x^23+x26+x^32
+// 1110'1101'1011'1000'1000'0011'0010'0000
+// Note: x^32 is not written explicitly, it is implied; To account this last 1 bit
+//       we take 1's compliment of the result.
+#define CRC_POLYNOMIAL 0xedb88320u // Hex representation of this polynomial, bits reversed
+
 
 //
-// Make the table for a fast CRC.
+// Tables of CRCs of all 8-bit messages, followed by zero bytes:
+//
+//   entries[0][n]  CRC of byte n, the classic table
+//   entries[k][n]  CRC of byte n followed by k zero bytes
+//
+// With them, 8 bytes are done in one step (slicing-by-8): every byte of
+// the word looks up how it affects the CRC from its distance to the end
+// of the word, and the results are xor'ed together.
 //
-void make_crc_table() {
-    for (i32 n = 0; n < 256; n++) {
-        u32 c = (u32) n;
-        for (i32 k = 0; k < 8; k++) {
-            if (c & 1) {
-                // polynomial: 1+x+x^2+x^4+x^5+x^7+x^8+x^10+x^11+x^12+x^16+x^22+x^23+x26+x^32
-                // 1110'1101'1011'1000'1000'0011'0010'0000
-                // Note: x^32 is not written explicitly, it is implied; To account this last 1 bit
-                //       we take 1's compliment of the result.
-                u32 polynomial = 0xedb88320; // Hex representation of this polynomial
-                c = polynomial ^ (c >> 1);
-            } else {
-                c = c >> 1;
-            }
+// Tables are computed by the compiler, there is nothing to initialize.
+//
+struct crc_tables {
+    u32 entries[8][256];
+};
+
+constexpr crc_tables make_crc_tables() {
+    crc_tables result = {};
+    for (u32 n = 0; n < 256; n++) {
+        u32 c = n;
+        for (u32 k = 0; k < 8; k++) {
+            c = (c & 1) ? (CRC_POLYNOMIAL ^ (c >> 1)) : (c >> 1);
         }
-        crc_table[n] = c;
+        result.entries[0][n] = c;
     }
-    crc_table_computed = 1;
+    for (u32 n = 0; n < 256; n++) {
+        for (u32 k = 1; k < 8; k++) {
+            u32 c = result.entries[k - 1][n];
+            result.entries[k][n] = result.entries[0][c & 0xff] ^ (c >> 8);
+        }
+    }
+    return result;
 }
 
+GLOBAL constexpr crc_tables crc_table = make_crc_tables();
+
+
 //
 // Update a running CRC with the bytes buf[0..len-1] -- the CRC
 // should be initialized to all 1's, and the transmitted value
-// is the 1's complement of the final running CRC (see the crc() routine below).
+// is the 1's complement of the final running CRC (see the compute_crc() routine below).
+//
+// One byte at a time, the other versions are checked against this one.
 //
-u32 update_crc(u32 init, u8 *buf, usize len) {
+INTERNAL
+u32 update_crc_bytewise(u32 init, u8 const *buf, usize len) {
     u32 crc = init;
 
-    if (!crc_table_computed) {
-        make_crc_table();
-    }
-
     for (usize n = 0; n < len; n++) {
-        crc = crc_table[(crc ^ buf[n]) & 0xff] ^ (crc >> 8);
-        //              ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
-        //                   What is going on here???
+        crc = crc_table.entries[0][(crc ^ buf[n]) & 0xff] ^ (crc >> 8);
+        //    ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+        //    Lower byte of the CRC is shifted out with the new byte, and the
+        //    table says what it leaves in the rest of the register.
     }
 
     return crc;
 }
 
+// @note: Bytes of the word are taken from the lowest, as they go in the message, which assumes little-endian machine.
+INTERNAL
+u32 update_crc_slicing_by_8(u32 init, u8 const *buf, usize len) {
+    u32 crc = init;
+
+    for (; len >= 8; len -= 8) {
+        u32 low, high;
+        memcpy(&low, buf, 4);
+        memcpy(&high, buf + 4, 4);
+        low ^= crc;
+
+        crc = crc_table.entries[7][low & 0xff] ^
+              crc_table.entries[6][(low >> 8) & 0xff] ^
+              crc_table.entries[5][(low >> 16) & 0xff] ^
+              crc_table.entries[4][low >> 24] ^
+              crc_table.entries[3][high & 0xff] ^
+              crc_table.entries[2][(high >> 8) & 0xff] ^
+              crc_table.entries[1][(high >> 16) & 0xff] ^
+              crc_table.entries[0][high >> 24];
+        buf += 8;
+    }
+
+    return update_crc_bytewise(crc, buf, len);
+}
+
+
+#if CRC_PCLMUL
+
+//
+// Carry-less multiplication, PCLMULQDQ
+//
+// Four 128-bit accumulators are folded forward over 64 bytes at a time:
+// multiplying by x^(512+64) and x^512 modulo P moves a register 64 bytes
+// further into the message, where it is xor'ed with the data. Then they
+// are folded into one, and the last 128 bits are reduced to 32 with
+// Barrett reduction. Constants are the bit-reflected ones from the end
+// of the Intel paper, for the same polynomial.
+//
+// @note: 'len' is at least 64 and a multiple of 16.
+//
+INTERNAL CRC_TARGET_PCLMUL
+u32 update_crc_pclmul(u32 init, u8 const *buf, usize len) {
+    __m128i const k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    __m128i const k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    __m128i const k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    __m128i const poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    __m128i const mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128((__m128i const *) (buf + 0x00));
+    __m128i x2 = _mm_loadu_si128((__m128i const *) (buf + 0x10));
+    __m128i x3 = _mm_loadu_si128((__m128i const *) (buf + 0x20));
+    __m128i x4 = _mm_loadu_si128((__m128i const *) (buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) init));
+
+    buf += 64;
+    len -= 64;
+
+    // Fold by 4 over blocks of 64 bytes.
+    while (len >= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((__m128i const *) (buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((__m128i const *) (buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((__m128i const *) (buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((__m128i const *) (buf + 0x30)));
+
+        buf += 64;
+        len -= 64;
+    }
+
+    // Fold the four accumulators into one, then by 1 over the blocks of 16 bytes left.
+    __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (len >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((__m128i const *) buf)), x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    // Fold 128 bits to 64.
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits.
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (u32) _mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+INTERNAL
+bool is_pclmul_supported() {
+    u32 registers[4] = {}; // eax, ebx, ecx, edx
+#if defined(ASUKA_COMPILER_MICROSOFT)
+    __cpuid((int *) registers, 1);
+#else
+    __get_cpuid(1, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+    return (registers[2] & (1u << 1)) != 0; // ECX.PCLMULQDQ
+}
+
+enum crc_implementation_t : u32 {
+    CRC_IMPLEMENTATION_UNKNOWN = 0,
+    CRC_IMPLEMENTATION_SLICING_BY_8,
+    CRC_IMPLEMENTATION_PCLMUL,
+};
+
+// @note: Threads racing on the first call find out the same value and write it whole, so it needs no lock.
+GLOBAL u32 volatile crc_implementation = CRC_IMPLEMENTATION_UNKNOWN;
+
+#endif // CRC_PCLMUL
+
+// @note: Below this size the setup of the folding costs more than it saves.
+#define CRC_PCLMUL_MIN_SIZE 64
+
+u32 update_crc(u32 init, u8 const *buf, usize len) {
+    u32 crc = init;
+
+#if CRC_PCLMUL
+    if (len >= CRC_PCLMUL_MIN_SIZE) {
+        if (crc_implementation == CRC_IMPLEMENTATION_UNKNOWN) {
+            crc_implementation = is_pclmul_supported() ? CRC_IMPLEMENTATION_PCLMUL : CRC_IMPLEMENTATION_SLICING_BY_8;
+        }
+
+        if (crc_implementation == CRC_IMPLEMENTATION_PCLMUL) {
+            usize folded = len & ~(usize) 15;
+            crc = update_crc_pclmul(crc, buf, folded);
+            buf += folded;
+            len -= folded;
+        }
+    }
+#endif // CRC_PCLMUL
+
+    return update_crc_slicing_by_8(crc, buf, len);
+}
+
 //
 // Return the CRC of the bytes buf[0..len-1].
 //
-u32 compute_crc(u8 *buf, usize len) {
+u32 compute_crc(u8 const *buf, usize len) {
     return update_crc(0xffff'ffff, buf, len) ^ 0xffff'ffff;
     //                ^^^^^^^^^^^            ^^^^^^^^^^^^^
     //                Initialize all 1's     Take 1's complement of the result
 }
+
+
+//
+// Combining
+//
+// CRC is linear: the CRC of A followed by B is the CRC of A, moved past
+// len(B) zero bytes, xor'ed with the CRC of B. Moving past n zero bytes
+// is multiplication by x^(8n) modulo P, which is found by squaring: the
+// table holds x^(2^k) modulo P, and the bits of 8n pick which of them to
+// multiply together. This is the method of zlib's crc32_combine.
+//
+// Polynomials are bit-reflected as the CRCs are, x^0 is the highest bit.
+//
+
+// @note: a * b modulo P.
+INTERNAL
+constexpr u32 multiply_crc_polynomials(u32 a, u32 b) {
+    u32 result = 0;
+    for (u32 m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) {
+            result ^= b;
+        }
+        b = (b & 1) ? ((b >> 1) ^ CRC_POLYNOMIAL) : (b >> 1);
+    }
+    return result;
+}
+
+struct crc_power_table {
+    u32 entries[32];
+};
+
+constexpr crc_power_table make_crc_power_table() {
+    crc_power_table result = {};
+    u32 p = 1u << 30; // x^1
+    for (u32 k = 0; k < 32; k++) {
+        result.entries[k] = p;
+        p = multiply_crc_polynomials(p, p);
+    }
+    return result;
+}
+
+GLOBAL constexpr crc_power_table crc_powers = make_crc_power_table();
+
+u32 crc_combine(u32 crc1, u32 crc2, usize len2) {
+    // x^(8 * len2) is x^(len2 * 2^3), so the bits of len2 start from the power 3.
+    u32 p = 1u << 31; // x^0
+    for (u32 k = 3; len2 != 0; len2 >>= 1, k++) {
+        if (len2 & 1) {
+            p = multiply_crc_polynomials(crc_powers.entries[k & 31], p);
+        }
+    }
+    return multiply_crc_polynomials(p, crc1) ^ crc2;
+}
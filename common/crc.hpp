@@ -3,11 +3,31 @@
 
 #include "defines.hpp"
 
+#include <string.h>
+
+
+//
+// CRC-32 of PNG and zlib. It goes with carry-less multiplication where the
+// CPU has it, and with slicing-by-8 otherwise; the choice is made on the
+// first call.
+//
 
 //
 // Return the CRC of the bytes buf[0..len-1].
 //
-u32 compute_crc(u8 *buf, usize len);
+u32 compute_crc(u8 const *buf, usize len);
+
+//
+// Update a running CRC with the bytes buf[0..len-1]. Running CRC starts
+// with all 1's, and the CRC is its 1's complement in the end.
+//
+u32 update_crc(u32 init, u8 const *buf, usize len);
+
+//
+// CRC of A followed by B, from compute_crc of both of them and the size
+// of B, so parts of a buffer can be checksummed separately, in parallel.
+//
+u32 crc_combine(u32 crc1, u32 crc2, usize len2);
 
 
 #ifdef UNITY_BUILD
@@ -114,6 +114,21 @@ typedef double float64;
 
 #define INTERLOCKED_COMPARE_EXCHANGE InterlockedCompareExchange
 
+// @note: both return the value *before* the addition.
+#define ATOMIC_FETCH_ADD_U32(PTR, VALUE) ((u32) _InterlockedExchangeAdd((long volatile *) (PTR), (long) (VALUE)))
+#define ATOMIC_FETCH_ADD_U64(PTR, VALUE) ((u64) _InterlockedExchangeAdd64((__int64 volatile *) (PTR), (__int64) (VALUE)))
+
+// @note: Returns true if *PTR was EXPECTED, and so it is DESIRED now.
+#define ATOMIC_COMPARE_EXCHANGE_U32(PTR, EXPECTED, DESIRED) \
+    ((u32) _InterlockedCompareExchange((long volatile *) (PTR), (long) (DESIRED), (long) (EXPECTED)) == (u32) (EXPECTED))
+
+// @note: Load acquires and store releases, so what was written before the store is seen after the load.
+#define ATOMIC_LOAD_U32(PTR)         ((u32) _InterlockedOr((long volatile *) (PTR), 0))
+#define ATOMIC_STORE_U32(PTR, VALUE) ((void) _InterlockedExchange((long volatile *) (PTR), (long) (VALUE)))
+
+// @note: X must not be zero.
+#define COUNT_TRAILING_ZEROS_U32(X) ((u32) _tzcnt_u32(X))
+
 #endif // ASUKA_COMPILER_MICROSOFT
 
 #ifdef ASUKA_COMPILER_GNU
@@ -147,6 +162,39 @@ typedef double float64;
 #define ASUKA_DEBUG_BREAK __builtin_trap
 #define FORCE_INLINE __attribute__((always_inline))
 
+// @note: both return the value *before* the addition.
+#define ATOMIC_FETCH_ADD_U32(PTR, VALUE) ((u32) __atomic_fetch_add((PTR), (VALUE), __ATOMIC_ACQ_REL))
+#define ATOMIC_FETCH_ADD_U64(PTR, VALUE) ((u64) __atomic_fetch_add((PTR), (VALUE), __ATOMIC_ACQ_REL))
+
+// @note: Returns true if *PTR was EXPECTED, and so it is DESIRED now.
+#define ATOMIC_COMPARE_EXCHANGE_U32(PTR, EXPECTED, DESIRED) \
+    __sync_bool_compare_and_swap((PTR), (u32) (EXPECTED), (u32) (DESIRED))
+
+// @note: Load acquires and store releases, so what was written before the store is seen after the load.
+#define ATOMIC_LOAD_U32(PTR)         ((u32) __atomic_load_n((PTR), __ATOMIC_ACQUIRE))
+#define ATOMIC_STORE_U32(PTR, VALUE) __atomic_store_n((PTR), (u32) (VALUE), __ATOMIC_RELEASE)
+
+// @note: X must not be zero.
+#define COUNT_TRAILING_ZEROS_U32(X) ((u32) __builtin_ctz(X))
+
+// @note: Assembler copies the file into read-only data, as NAME[] ending at NAME_end[]; the path is relative to where the compiler runs.
+#define INCBIN(NAME, FILEPATH) \
+    __asm__( \
+        ".pushsection .rodata\n" \
+        ".balign 16\n" \
+        ".global " #NAME "\n" \
+        ".hidden " #NAME "\n" \
+        #NAME ":\n" \
+        ".incbin \"" FILEPATH "\"\n" \
+        ".global " #NAME "_end\n" \
+        ".hidden " #NAME "_end\n" \
+        #NAME "_end:\n" \
+        ".byte 0\n" \
+        ".popsection\n" \
+    ); \
+    extern "C" u8 const NAME[]; \
+    extern "C" u8 const NAME##_end[]
+
 #if ASUKA_DLL_BUILD
 #define ASUKA_DLL_EXPORT __attribute__((dllexport))
 #else
@@ -211,6 +259,7 @@ typedef double float64;
 #define INTERNAL         static
 #define PERSIST          static
 #define GLOBAL           static
+#define THREAD_LOCAL     thread_local
 #define INLINE           inline
 
 #define ARRAY_COUNT(ARRAY) (sizeof(ARRAY) / sizeof((ARRAY)[0]))
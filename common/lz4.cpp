@@ -0,0 +1,285 @@
+#include "lz4.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// @note: Limits of the format: no match starts in the last 12 bytes, and the last 5 bytes are literals.
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_LAST_LITERALS 5
+
+#define LZ4_HASH_BITS 16
+#define LZ4_WINDOW_MASK 0xFFFF
+#define LZ4_MAX_CHAIN_STEPS 256
+#define LZ4_GOOD_MATCH_LENGTH 256
+#define LZ4_NO_POSITION 0xFFFFFFFF
+
+// @note: Compressed blocks are read with u32 positions.
+#define LZ4_MAX_INPUT_SIZE 0x7E000000
+
+
+INTERNAL INLINE
+u32 read_lz4_u32(u8 const *bytes) {
+    u32 result;
+    memcpy(&result, bytes, sizeof(result));
+    return result;
+}
+
+
+INTERNAL INLINE
+void copy_lz4_8_bytes(u8 *destination, u8 const *source) {
+    u64 chunk;
+    memcpy(&chunk, source, sizeof(chunk));
+    memcpy(destination, &chunk, sizeof(chunk));
+}
+
+
+//
+// Compression
+//
+
+usize get_lz4_compress_bound(usize size) {
+    usize result = size + size / 255 + 16;
+    return result;
+}
+
+
+INTERNAL INLINE
+u32 get_lz4_hash(u32 sequence) {
+    u32 result = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+    return result;
+}
+
+
+// @note: Returns NULL if the output is full.
+INTERNAL
+u8 *write_lz4_length(u8 *out, u8 *out_end, usize length) {
+    while (length >= 255) {
+        if (out >= out_end) return NULL;
+        *out++ = 255;
+        length -= 255;
+    }
+    if (out >= out_end) return NULL;
+    *out++ = (u8) length;
+    return out;
+}
+
+
+// @note: Match length of zero makes the last sequence, of literals only.
+INTERNAL
+u8 *write_lz4_sequence(u8 *out, u8 *out_end, u8 const *literals, usize literal_count, usize offset, usize match_length) {
+    if (out >= out_end) return NULL;
+    u8 *token = out++;
+
+    *token = (u8) (((literal_count < 15) ? literal_count : 15) << 4);
+    if (literal_count >= 15) {
+        out = write_lz4_length(out, out_end, literal_count - 15);
+        if (out == NULL) return NULL;
+    }
+
+    if ((usize) (out_end - out) < literal_count) return NULL;
+    memcpy(out, literals, literal_count);
+    out += literal_count;
+
+    if (match_length > 0) {
+        if (out_end - out < 2) return NULL;
+        *out++ = (u8) (offset & 0xFF);
+        *out++ = (u8) (offset >> 8);
+
+        usize length = match_length - LZ4_MIN_MATCH;
+        *token |= (u8) ((length < 15) ? length : 15);
+        if (length >= 15) {
+            out = write_lz4_length(out, out_end, length - 15);
+        }
+    }
+
+    return out;
+}
+
+
+//
+// Every position is hashed by its first 4 bytes. Head holds the last
+// position of each hash, and chain holds, for each position in the window,
+// the distance back to the previous one with the same hash, so all match
+// candidates are walked from the nearest, until they are out of the window.
+//
+usize lz4_compress(u8 const *input, usize size, u8 *output, usize capacity) {
+    if (size > LZ4_MAX_INPUT_SIZE) return 0;
+
+    u8 *out = output;
+    u8 *out_end = output + capacity;
+    usize anchor = 0;
+
+    if (size > LZ4_MATCH_FIND_LIMIT) {
+        u32 *head = (u32 *) malloc(sizeof(u32) << LZ4_HASH_BITS);
+        u16 *chain = (u16 *) malloc(sizeof(u16) * (LZ4_WINDOW_MASK + 1));
+        if (head == NULL || chain == NULL) {
+            free(head);
+            free(chain);
+            return 0;
+        }
+        memset(head, 0xFF, sizeof(u32) << LZ4_HASH_BITS);
+
+        usize match_find_end = size - LZ4_MATCH_FIND_LIMIT;
+        usize match_end = size - LZ4_LAST_LITERALS;
+        usize inserted = 0;
+
+        usize position = 0;
+        while (position <= match_find_end) {
+            // @note: Positions before this one go into the chains first, the nearest candidate is found first.
+            for (; inserted < position; inserted++) {
+                u32 hash = get_lz4_hash(read_lz4_u32(input + inserted));
+                u32 previous = head[hash];
+                chain[inserted & LZ4_WINDOW_MASK] = (previous != LZ4_NO_POSITION && inserted - previous <= LZ4_MAX_OFFSET)
+                    ? (u16) (inserted - previous) : 0;
+                head[hash] = (u32) inserted;
+            }
+
+            u32 sequence = read_lz4_u32(input + position);
+            usize best_length = 0;
+            usize best_offset = 0;
+
+            u32 candidate = head[get_lz4_hash(sequence)];
+            for (u32 step = 0; step < LZ4_MAX_CHAIN_STEPS && candidate != LZ4_NO_POSITION; step++) {
+                usize offset = position - candidate;
+                if (offset > LZ4_MAX_OFFSET) break;
+
+                if (read_lz4_u32(input + candidate) == sequence) {
+                    usize length = LZ4_MIN_MATCH;
+                    while (position + length < match_end && input[candidate + length] == input[position + length]) {
+                        length += 1;
+                    }
+                    if (length > best_length) {
+                        best_length = length;
+                        best_offset = offset;
+                        // @note: Longer match would hardly make the block smaller, and on runs the chains are long.
+                        if (position + length == match_end || length >= LZ4_GOOD_MATCH_LENGTH) break;
+                    }
+                }
+
+                u16 distance = chain[candidate & LZ4_WINDOW_MASK];
+                if (distance == 0) break;
+                candidate -= distance;
+            }
+
+            if (best_length >= LZ4_MIN_MATCH && position + best_length <= match_end) {
+                out = write_lz4_sequence(out, out_end, input + anchor, position - anchor, best_offset, best_length);
+                if (out == NULL) break;
+
+                position += best_length;
+                anchor = position;
+            } else {
+                position += 1;
+            }
+        }
+
+        free(head);
+        free(chain);
+
+        if (out == NULL) return 0;
+    }
+
+    out = write_lz4_sequence(out, out_end, input + anchor, size - anchor, 0, 0);
+
+    usize result = (out != NULL) ? (usize) (out - output) : 0;
+    return result;
+}
+
+
+//
+// Decompression
+//
+
+// @note: Returns false if the input ends before the length does.
+INTERNAL INLINE
+bool read_lz4_length(u8 const **in, u8 const *in_end, usize *length) {
+    u32 byte;
+    do {
+        if (*in >= in_end) return false;
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+
+//
+// Copies are done 8 bytes at a time, and may write past the end of the
+// literals or of the match, where the next sequence writes anyway, as long
+// as there is room for it in the output. Match closer than 8 bytes behind
+// repeats with the period of its offset, so after its first bytes are
+// copied one by one, the rest is copied in chunks from the multiple of the
+// period which is at least 8 bytes behind.
+//
+bool lz4_decompress(u8 const *input, usize size, u8 *output, usize output_size) {
+    u8 const *in = input;
+    u8 const *in_end = input + size;
+    u8 *out = output;
+    u8 *out_end = output + output_size;
+
+    loop {
+        if (in >= in_end) return false;
+        u32 token = *in++;
+
+        usize literal_count = token >> 4;
+        if (literal_count == 15) {
+            if (!read_lz4_length(&in, in_end, &literal_count)) return false;
+        }
+
+        if ((usize) (in_end - in) < literal_count) return false;
+        if ((usize) (out_end - out) < literal_count) return false;
+
+        if (literal_count <= 16 && in_end - in >= 16 && out_end - out >= 16) {
+            copy_lz4_8_bytes(out, in);
+            copy_lz4_8_bytes(out + 8, in + 8);
+        } else {
+            memcpy(out, in, literal_count);
+        }
+        in += literal_count;
+        out += literal_count;
+
+        // @note: Last sequence has no match.
+        if (in == in_end) break;
+
+        if (in_end - in < 2) return false;
+        usize offset = (usize) in[0] | ((usize) in[1] << 8);
+        in += 2;
+
+        if (offset == 0 || offset > (usize) (out - output)) return false;
+
+        usize match_length = token & 15;
+        if (match_length == 15) {
+            if (!read_lz4_length(&in, in_end, &match_length)) return false;
+        }
+        match_length += LZ4_MIN_MATCH;
+
+        if ((usize) (out_end - out) < match_length) return false;
+
+        u8 const *match = out - offset;
+        u8 *match_out_end = out + match_length;
+
+        if ((usize) (out_end - out) < match_length + 8) {
+            // @note: Too close to the end of the output for chunks.
+            while (out < match_out_end) *out++ = *match++;
+            continue;
+        }
+
+        if (offset < 8) {
+            usize period = offset * ((8 + offset - 1) / offset);
+            usize head = (match_length < period) ? match_length : period;
+            for (usize i = 0; i < head; i++) out[i] = match[i];
+            out += head;
+            match = out - period;
+        }
+
+        while (out < match_out_end) {
+            copy_lz4_8_bytes(out, match);
+            out += 8;
+            match += 8;
+        }
+        out = match_out_end;
+    }
+
+    bool result = (out == out_end);
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef ASUKA_COMMON_LZ4_HPP
+#define ASUKA_COMMON_LZ4_HPP
+
+#include <defines.hpp>
+
+
+//
+// LZ4 block format, without the frame around it. Block is a list of
+// sequences, each of them is literals, copied as they are, followed by a
+// match, copied from the output decompressed so far:
+//
+//     +-------+------------------+----------+--------+------------------+
+//     | token | literals length  | literals | offset | match length     |
+//     | 4 : 4 | 255, ..., < 255  |          | u16 LE | 255, ..., < 255  |
+//     +-------+------------------+----------+--------+------------------+
+//
+// High half of the token is the number of literals, low half is the match
+// length minus 4. When either of them is 15, bytes added to it follow,
+// until one which is less than 255. The last sequence has literals only,
+// the last 5 bytes are always literals, and no match starts in the last
+// 12 bytes, as the reference implementation wants it.
+//
+// Decompression is one pass of copies, with no tables, which is why blobs
+// embedded into the executable are compressed with it: they expand about
+// as fast as memory is written.
+//
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+
+
+usize get_lz4_compress_bound(usize size);
+
+//
+// Compresses the input into the output, which should be at least
+// get_lz4_compress_bound of the input size. Returns the size of the block,
+// or 0 if it did not fit. Compression is for tools, it searches hard for
+// the longest matches, and allocates its tables with malloc.
+//
+usize lz4_compress(u8 const *input, usize size, u8 *output, usize capacity);
+
+//
+// Decompresses the block into exactly output_size bytes. Broken blocks,
+// or blocks which would decompress into any other size, are refused, and
+// nothing is ever read or written out of the buffers.
+//
+bool lz4_decompress(u8 const *input, usize size, u8 *output, usize output_size);
+
+
+#ifdef UNITY_BUILD
+#include "lz4.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_LZ4_HPP
@@ -8,6 +8,17 @@
 // when you need to calculate something, but it does not live longer than
 // the length of frame or scope of the function.
 //
+// Temporary memory is a checkpoint on the arena: everything allocated between
+// begin_temporary and end_temporary is freed at once when the scope ends,
+// so the same scratch space can be reused many times inside one frame.
+// Scopes have to be closed in the reverse order they were opened.
+//
+//  ┌──────────────┬────────────────────┬─────────────────────
+//  │ before scope │ temporary scope    │ free
+//  └──────────────┴────────────────────┴─────────────────────
+//   ↑              ↑                    ↑
+//   memory         temporary.used       used
+//
 
 #include <defines.hpp>
 #include <os/memory.hpp>
@@ -20,6 +31,7 @@ struct arena_allocator {
     usize size; // bytes
     usize used; // bytes
     usize last_allocation_size; // @note: saved last allocation size for reallocation capability
+    u32 temporary_count; // @note: number of currently open temporary scopes
 
     char const *name;
 
@@ -36,6 +48,7 @@ void initialize__(arena_allocator *allocator, void* memory, usize size, char con
     allocator->size = size;
     allocator->used = 0;
     allocator->last_allocation_size = 0;
+    allocator->temporary_count = 0;
 
     allocator->name = name;
 
@@ -45,6 +58,15 @@ void initialize__(arena_allocator *allocator, void* memory, usize size, char con
 }
 
 
+INLINE
+void release__(arena_allocator *allocator)
+{
+#if ASUKA_DEBUG
+    release_allocation_log(&allocator->log);
+#endif // ASUKA_DEBUG
+}
+
+
 INLINE
 void* allocate__(arena_allocator *allocator, usize requested_size, usize alignment, CodeLocation cl)
 {
@@ -93,6 +115,10 @@ void *reallocate__(arena_allocator *allocator, void *pointer, usize new_size, us
             allocator->used += (new_size - last_allocation_size);
             allocator->last_allocation_size = new_size;
         }
+
+#if ASUKA_DEBUG
+        resize_allocation_entry(&allocator->log, pointer, new_size);
+#endif // ASUKA_DEBUG
     }
     else
     {
@@ -105,4 +131,111 @@ void *reallocate__(arena_allocator *allocator, void *pointer, usize new_size, us
 }
 
 
+struct TemporaryMemory
+{
+    arena_allocator *arena;
+    usize used;
+    usize last_allocation_size;
+    u32 temporary_index;
+};
+
+
+INLINE
+TemporaryMemory begin_temporary(arena_allocator *allocator)
+{
+    TemporaryMemory result;
+    result.arena = allocator;
+    result.used = allocator->used;
+    result.last_allocation_size = allocator->last_allocation_size;
+    result.temporary_index = allocator->temporary_count++;
+
+    return result;
+}
+
+
+INLINE
+void end_temporary(TemporaryMemory temporary)
+{
+    arena_allocator *allocator = temporary.arena;
+
+    ASSERT_MSG(allocator->temporary_count > 0, "There is no open temporary scope on this arena!");
+    ASSERT_MSG(temporary.temporary_index + 1 == allocator->temporary_count, "Temporary scopes should be closed in reverse order!");
+    ASSERT(allocator->used >= temporary.used);
+
+#if ASUKA_DEBUG
+    pop_allocation_entries_in_range(&allocator->log, allocator->memory + temporary.used, allocator->memory + allocator->used);
+#endif // ASUKA_DEBUG
+
+    allocator->used = temporary.used;
+    allocator->last_allocation_size = temporary.last_allocation_size;
+    allocator->temporary_count -= 1;
+}
+
+
+// @note: Closes the scope, but keeps everything allocated in it, for work which can still be rolled back until it succeeds.
+INLINE
+void commit_temporary(TemporaryMemory temporary)
+{
+    arena_allocator *allocator = temporary.arena;
+
+    ASSERT_MSG(allocator->temporary_count > 0, "There is no open temporary scope on this arena!");
+    ASSERT_MSG(temporary.temporary_index + 1 == allocator->temporary_count, "Temporary scopes should be closed in reverse order!");
+
+    allocator->temporary_count -= 1;
+}
+
+
+//
+// Closes temporary scope automatically when leaving C++ scope:
+//
+//     {
+//         memory::temporary_scope scratch(&game_state->temp_arena);
+//         // ... allocations from temp_arena ...
+//     } // <- all of them are freed here
+//
+struct temporary_scope
+{
+    TemporaryMemory temporary;
+
+    temporary_scope(arena_allocator *allocator) : temporary(begin_temporary(allocator)) {}
+    ~temporary_scope() { end_temporary(temporary); }
+
+    temporary_scope(temporary_scope const&) = delete;
+    temporary_scope& operator = (temporary_scope const&) = delete;
+};
+
+
+//
+// Every thread can have its own scratch arena. It is fetched without any
+// synchronization, so worker threads never contend for scratch memory.
+// The thread should give it memory once at startup; the arena header
+// is placed in the beginning of that memory.
+//
+GLOBAL THREAD_LOCAL arena_allocator *thread_scratch_arena;
+
+
+INLINE
+arena_allocator *initialize_thread_scratch(void *memory, usize size, char const *name = "scratch")
+{
+    auto aligned = get_aligned_pointer(memory, alignof(arena_allocator));
+    ASSERT(aligned.padding + sizeof(arena_allocator) <= size);
+
+    // @note: Header is in the memory which was never initialized, and its log would be taken for the tables of the previous arena.
+    arena_allocator *result = (arena_allocator *) aligned.pointer;
+    *result = {};
+    initialize__(result, aligned.pointer + sizeof(arena_allocator), size - aligned.padding - sizeof(arena_allocator), name);
+
+    thread_scratch_arena = result;
+    return result;
+}
+
+
+INLINE
+arena_allocator *get_thread_scratch()
+{
+    ASSERT_MSG(thread_scratch_arena, "Scratch arena was not initialized on this thread!");
+    return thread_scratch_arena;
+}
+
+
 } // namespace memory
@@ -0,0 +1,194 @@
+#pragma once
+
+//
+//                         Concurrent Arena Allocator
+//
+// Same as the arena allocator, but many threads can allocate from it at the
+// same time. Allocation is one atomic add on the 'used' counter, so there
+// are no locks and no retries. The price is that each allocation reserves
+// (alignment - 1) extra bytes to align the pointer after the bump.
+//
+// Deallocation and reallocation are not supported: the arena is supposed
+// to hold shared per-frame data and be re-initialized when all threads are
+// done with it.
+//
+// In debug builds every thread writes allocations into its own log, so
+// threads do not fight over one hash table. Logs are merged on read.
+// A thread takes a free log on its first allocation from the arena, and
+// logs are given back when the arena is re-initialized. Threads which come
+// after all CONCURRENT_ARENA_MAX_THREADS logs are taken write into one
+// shared log under a spin lock: slower, but any number of threads works.
+//
+
+#include <defines.hpp>
+#include <os/memory.hpp>
+
+namespace memory
+{
+
+
+#define CONCURRENT_ARENA_MAX_THREADS 8
+
+
+struct concurrent_arena_allocator
+{
+    byte *memory;
+    usize size; // bytes
+    usize volatile used; // bytes
+
+    char const *name;
+
+#if ASUKA_DEBUG
+    u32 volatile thread_ids[CONCURRENT_ARENA_MAX_THREADS]; // @note: Owner of the log with the same index, 0 if the log is free.
+    AllocationLog thread_logs[CONCURRENT_ARENA_MAX_THREADS];
+
+    u32 volatile shared_log_lock;
+    AllocationLog shared_log; // @note: For the threads which did not get a log of their own.
+#endif // ASUKA_DEBUG
+};
+
+
+#if ASUKA_DEBUG
+GLOBAL u32 volatile concurrent_arena_thread_counter;
+GLOBAL THREAD_LOCAL u32 concurrent_arena_thread_id;
+
+// @note: Returns NULL if all logs are taken by other threads.
+INLINE
+AllocationLog *get_thread_allocation_log(concurrent_arena_allocator *allocator)
+{
+    if (concurrent_arena_thread_id == 0)
+    {
+        concurrent_arena_thread_id = ATOMIC_FETCH_ADD_U32(&concurrent_arena_thread_counter, 1) + 1;
+    }
+
+    for (u32 thread_index = 0; thread_index < CONCURRENT_ARENA_MAX_THREADS; thread_index++)
+    {
+        u32 volatile *owner = allocator->thread_ids + thread_index;
+        if ((ATOMIC_LOAD_U32(owner) == concurrent_arena_thread_id) || ATOMIC_COMPARE_EXCHANGE_U32(owner, 0, concurrent_arena_thread_id))
+        {
+            return allocator->thread_logs + thread_index;
+        }
+    }
+
+    return NULL;
+}
+#endif // ASUKA_DEBUG
+
+
+INLINE
+void initialize__(concurrent_arena_allocator *allocator, void *memory, usize size, char const *name = "concurrent arena")
+{
+    allocator->memory = (byte *) memory;
+    allocator->size = size;
+    allocator->used = 0;
+
+    allocator->name = name;
+
+#if ASUKA_DEBUG
+    for (u32 thread_index = 0; thread_index < CONCURRENT_ARENA_MAX_THREADS; thread_index++)
+    {
+        allocator->thread_ids[thread_index] = 0;
+        initialize_allocation_log(allocator->thread_logs + thread_index);
+    }
+
+    allocator->shared_log_lock = 0;
+    initialize_allocation_log(&allocator->shared_log);
+#endif // ASUKA_DEBUG
+}
+
+
+INLINE
+void release__(concurrent_arena_allocator *allocator)
+{
+#if ASUKA_DEBUG
+    for (u32 thread_index = 0; thread_index < CONCURRENT_ARENA_MAX_THREADS; thread_index++)
+    {
+        release_allocation_log(allocator->thread_logs + thread_index);
+    }
+    release_allocation_log(&allocator->shared_log);
+#endif // ASUKA_DEBUG
+}
+
+
+INLINE
+void *allocate__(concurrent_arena_allocator *allocator, usize requested_size, usize alignment, CodeLocation cl)
+{
+    byte *result = NULL;
+
+    usize reserved_size = requested_size + alignment - 1;
+    usize offset = ATOMIC_FETCH_ADD_U64(&allocator->used, reserved_size);
+
+    if (offset + reserved_size <= allocator->size)
+    {
+        result = (byte *) align_pointer(allocator->memory + offset, alignment);
+
+#if ASUKA_DEBUG
+        AllocationLog *log = get_thread_allocation_log(allocator);
+        if (log)
+        {
+            push_allocation_entry(log, {cl, result, requested_size});
+        }
+        else
+        {
+            while (!ATOMIC_COMPARE_EXCHANGE_U32(&allocator->shared_log_lock, 0, 1)) {}
+            push_allocation_entry(&allocator->shared_log, {cl, result, requested_size});
+            ATOMIC_STORE_U32(&allocator->shared_log_lock, 0);
+        }
+#endif // ASUKA_DEBUG
+    }
+
+    return result;
+}
+
+
+INLINE
+void deallocate__(concurrent_arena_allocator *, void *, CodeLocation)
+{
+    // @note: deallocate does nothing in the concurrent arena allocator!
+}
+
+
+INLINE
+void *reallocate__(concurrent_arena_allocator *, void *, usize, usize, CodeLocation)
+{
+    ASSERT_FAIL("Concurrent arena does not support reallocation!");
+    return NULL;
+}
+
+
+#if ASUKA_DEBUG
+INLINE
+usize get_allocation_count(concurrent_arena_allocator *allocator)
+{
+    usize result = 0;
+    for (u32 thread_index = 0; thread_index < CONCURRENT_ARENA_MAX_THREADS; thread_index++)
+    {
+        result += allocator->thread_logs[thread_index].allocation_count;
+    }
+    result += allocator->shared_log.allocation_count;
+    return result;
+}
+
+
+// @note: Callback is called as callback(AllocationLogEntry *entry) for each live allocation of all threads.
+// Read logs only when no other thread allocates from the arena.
+template <typename Callback>
+void for_each_allocation_entry(concurrent_arena_allocator *allocator, Callback callback)
+{
+    for (u32 thread_index = 0; thread_index <= CONCURRENT_ARENA_MAX_THREADS; thread_index++)
+    {
+        AllocationLog *log = (thread_index < CONCURRENT_ARENA_MAX_THREADS) ? allocator->thread_logs + thread_index : &allocator->shared_log;
+        for (usize entry_index = 0; entry_index < log->capacity; entry_index++)
+        {
+            AllocationLogEntry *entry = log->hash_table + entry_index;
+            if (is_live_allocation_entry(entry))
+            {
+                callback(entry);
+            }
+        }
+    }
+}
+#endif // ASUKA_DEBUG
+
+
+} // namespace memory
@@ -31,6 +31,16 @@ void initialize__(mallocator *allocator, void *memory, usize size, char const *n
 }
 
 
+// @note: Live allocations are not freed, only the log.
+INLINE
+void release__(mallocator *allocator)
+{
+#if ASUKA_DEBUG
+    release_allocation_log(&allocator->log);
+#endif // ASUKA_DEBUG
+}
+
+
 INLINE
 void *allocate__(mallocator *allocator, usize size, usize alignment, CodeLocation cl)
 {
@@ -47,23 +57,38 @@ void *allocate__(mallocator *allocator, usize size, usize alignment, CodeLocatio
 INLINE
 void deallocate__(mallocator *allocator, void *memory_to_free, CodeLocation cl)
 {
-    free(memory_to_free);
-
 #if ASUKA_DEBUG
     pop_allocation_entry(&allocator->log, memory_to_free);
 #endif // ASUKA_DEBUG
+
+    free(memory_to_free);
 }
 
 
 INLINE
 void *reallocate__(mallocator *allocator, void *pointer, usize new_size, usize alignment, CodeLocation cl)
 {
+#if ASUKA_DEBUG
+    // @note: Entry is found before realloc, the old pointer can not be looked up after it.
+    AllocationLogEntry *entry = NULL;
+    if (pointer)
+    {
+        entry = get_allocation_entry(&allocator->log, pointer);
+        ASSERT_MSG(entry, "Reallocating pointer which was not allocated by this allocator!");
+    }
+#endif // ASUKA_DEBUG
+
     void *result = realloc(pointer, new_size);
 
 #if ASUKA_DEBUG
-    if (result != pointer)
+    // @note: If realloc fails, the old memory is still there and still in the log.
+    if (result && (result == pointer))
+    {
+        resize_allocation_entry(&allocator->log, entry, new_size);
+    }
+    else if (result)
     {
-        pop_allocation_entry(&allocator->log, pointer);
+        if (entry) remove_allocation_entry(&allocator->log, entry);
         push_allocation_entry(&allocator->log, {cl, result, new_size});
     }
 #endif // ASUKA_DEBUG
@@ -85,6 +85,14 @@ void initialize__(pool_allocator<ChunkSize> *allocator, void *memory, usize size
 #endif // ASUKA_DEBUG
 }
 
+template <usize ChunkSize>
+void release__(pool_allocator<ChunkSize> *allocator)
+{
+#if ASUKA_DEBUG
+    release_allocation_log(&allocator->log);
+#endif // ASUKA_DEBUG
+}
+
 template <usize ChunkSize>
 void *allocate__(pool_allocator<ChunkSize> *allocator, usize requested_size, usize alignment, CodeLocation cl)
 {
@@ -0,0 +1,335 @@
+#pragma once
+
+//
+//                              Slab Allocator
+//
+// Slab allocator serves small objects of many different sizes. Requests are
+// rounded up to the power-of-two size class (16, 32, ..., 2048 bytes), and
+// each size class works like a pool allocator over its own pages.
+//
+// Memory is divided into pages of SLAB_PAGE_SIZE bytes, which are given to
+// size classes on demand. Size class of every page is kept in a small table
+// in the beginning of memory, so the chunks do not need any header: when the
+// chunk is freed, its size class is found by the page it belongs to.
+//
+//   page_classes              pages
+//  ┌─┬─┬─┬─┬───┬─────────────┬──────────────┬──────────────┬─────
+//  │0│3│0│.│...│  (padding)  │ 16 byte      │ 128 byte     │ ...
+//  └─┴─┴─┴─┴───┴─────────────┴──────────────┴──────────────┴─────
+//
+// Free chunks keep the pointer to the next free chunk of the same size class
+// in their first bytes. Chunks in fresh pages are not threaded into the free
+// list in advance, instead the page is bumped until it ends.
+//
+// Requests bigger than the largest size class go straight to malloc, and so
+// do small ones when there are no free pages left. Such blocks have a header
+// in front of them with the block malloc gave and the usable size, so they
+// are aligned however they were asked to be.
+//
+
+#include <defines.hpp>
+#include <os/memory.hpp>
+
+namespace memory
+{
+
+
+#define SLAB_PAGE_SIZE        KILOBYTES(64)
+#define SLAB_MIN_CHUNK_SIZE   16
+#define SLAB_MAX_CHUNK_SIZE   2048
+#define SLAB_SIZE_CLASS_COUNT 8 // 16, 32, 64, 128, 256, 512, 1024, 2048
+
+
+struct slab_allocator
+{
+    struct free_chunk
+    {
+        free_chunk *next_chunk;
+    };
+
+    // @note: Right before every block which comes from malloc.
+    struct heap_header
+    {
+        void *block;
+        usize size;
+    };
+
+    struct size_class
+    {
+        free_chunk *free_list;
+
+        // @note: Part of the last given page which was never allocated.
+        byte *bump;
+        byte *bump_end;
+    };
+
+    byte *memory;
+    usize size; // bytes
+    usize used; // bytes
+    char const *name;
+
+    u8 *page_classes;
+    byte *pages;
+    usize page_count;
+    usize next_page_index;
+
+    size_class classes[SLAB_SIZE_CLASS_COUNT];
+
+#if ASUKA_DEBUG
+    AllocationLog log;
+#endif // ASUKA_DEBUG
+};
+
+
+INLINE
+u32 get_slab_size_class(usize requested_size, usize alignment)
+{
+    usize size = (requested_size > alignment) ? requested_size : alignment;
+
+    u32 result = 0;
+    while (((usize) SLAB_MIN_CHUNK_SIZE << result) < size)
+    {
+        result += 1;
+    }
+    return result;
+}
+
+
+INLINE
+usize get_slab_chunk_size(u32 size_class)
+{
+    usize result = (usize) SLAB_MIN_CHUNK_SIZE << size_class;
+    return result;
+}
+
+
+INLINE
+b32 is_slab_pointer(slab_allocator *allocator, void *pointer)
+{
+    b32 result = ((byte *) pointer >= allocator->pages) &&
+                 ((byte *) pointer < allocator->pages + allocator->page_count * SLAB_PAGE_SIZE);
+    return result;
+}
+
+
+INLINE
+void *allocate_slab_heap_block(usize requested_size, usize alignment)
+{
+    if (alignment < alignof(slab_allocator::heap_header)) alignment = alignof(slab_allocator::heap_header);
+
+    byte *result = NULL;
+    byte *block = (byte *) malloc(sizeof(slab_allocator::heap_header) + alignment - 1 + requested_size);
+    if (block)
+    {
+        result = (byte *) align_pointer(block + sizeof(slab_allocator::heap_header), alignment);
+
+        slab_allocator::heap_header *header = (slab_allocator::heap_header *) result - 1;
+        header->block = block;
+        header->size = requested_size;
+    }
+    return result;
+}
+
+
+INLINE
+slab_allocator::heap_header *get_slab_heap_header(void *pointer)
+{
+    slab_allocator::heap_header *result = (slab_allocator::heap_header *) pointer - 1;
+    return result;
+}
+
+
+INLINE
+void initialize__(slab_allocator *allocator, void *memory, usize size, char const *name = "slab")
+{
+    ASSERT_MSG(memory, "Initializing allocator with NULL!\n");
+
+    allocator->memory = (byte *) memory;
+    allocator->size = size;
+    allocator->used = 0;
+    allocator->name = name;
+
+    // @note: Reserve one byte per page for the page table, then align pages, so chunks are aligned to their size.
+    usize max_page_count = size / SLAB_PAGE_SIZE;
+    allocator->page_classes = (u8 *) memory;
+
+    byte *pages = (byte *) align_pointer(allocator->memory + max_page_count, SLAB_MAX_CHUNK_SIZE);
+    byte *memory_end = allocator->memory + size;
+
+    allocator->pages = pages;
+    allocator->page_count = (pages < memory_end) ? (usize) (memory_end - pages) / SLAB_PAGE_SIZE : 0;
+    allocator->next_page_index = 0;
+
+    for (u32 class_index = 0; class_index < SLAB_SIZE_CLASS_COUNT; class_index++)
+    {
+        slab_allocator::size_class *sc = allocator->classes + class_index;
+        sc->free_list = NULL;
+        sc->bump = NULL;
+        sc->bump_end = NULL;
+    }
+
+#if ASUKA_DEBUG
+    initialize_allocation_log(&allocator->log);
+#endif // ASUKA_DEBUG
+}
+
+
+INLINE
+void release__(slab_allocator *allocator)
+{
+#if ASUKA_DEBUG
+    release_allocation_log(&allocator->log);
+#endif // ASUKA_DEBUG
+}
+
+
+INLINE
+void *allocate__(slab_allocator *allocator, usize requested_size, usize alignment, CodeLocation cl)
+{
+    byte *result = NULL;
+
+    u32 class_index = get_slab_size_class(requested_size, alignment);
+    if (class_index < SLAB_SIZE_CLASS_COUNT)
+    {
+        slab_allocator::size_class *sc = allocator->classes + class_index;
+        usize chunk_size = get_slab_chunk_size(class_index);
+
+        if (sc->free_list)
+        {
+            result = (byte *) sc->free_list;
+            sc->free_list = sc->free_list->next_chunk;
+        }
+        else
+        {
+            if ((sc->bump + chunk_size > sc->bump_end) && (allocator->next_page_index < allocator->page_count))
+            {
+                usize page_index = allocator->next_page_index++;
+                allocator->page_classes[page_index] = (u8) class_index;
+
+                sc->bump = allocator->pages + page_index * SLAB_PAGE_SIZE;
+                sc->bump_end = sc->bump + SLAB_PAGE_SIZE;
+            }
+
+            if (sc->bump + chunk_size <= sc->bump_end)
+            {
+                result = sc->bump;
+                sc->bump += chunk_size;
+            }
+        }
+
+        if (result)
+        {
+            allocator->used += chunk_size;
+        }
+    }
+
+    if (result == NULL)
+    {
+        result = (byte *) allocate_slab_heap_block(requested_size, alignment);
+    }
+
+#if ASUKA_DEBUG
+    if (result)
+    {
+        push_allocation_entry(&allocator->log, {cl, result, requested_size});
+    }
+#endif // ASUKA_DEBUG
+
+    return result;
+}
+
+
+INLINE
+void deallocate__(slab_allocator *allocator, void *memory_to_free, CodeLocation)
+{
+    if (memory_to_free == NULL) return;
+
+#if ASUKA_DEBUG
+    pop_allocation_entry(&allocator->log, memory_to_free);
+#endif // ASUKA_DEBUG
+
+    if (is_slab_pointer(allocator, memory_to_free))
+    {
+        usize page_index = ((byte *) memory_to_free - allocator->pages) / SLAB_PAGE_SIZE;
+        u32 class_index = allocator->page_classes[page_index];
+
+        slab_allocator::free_chunk *chunk = (slab_allocator::free_chunk *) memory_to_free;
+        chunk->next_chunk = allocator->classes[class_index].free_list;
+        allocator->classes[class_index].free_list = chunk;
+
+        allocator->used -= get_slab_chunk_size(class_index);
+    }
+    else
+    {
+        free(get_slab_heap_header(memory_to_free)->block);
+    }
+}
+
+
+INLINE
+void *reallocate__(slab_allocator *allocator, void *pointer, usize new_size, usize alignment, CodeLocation cl)
+{
+    void *result = NULL;
+
+    if (pointer == NULL)
+    {
+        result = allocate__(allocator, new_size, alignment, cl);
+    }
+    else if (is_slab_pointer(allocator, pointer))
+    {
+        usize page_index = ((byte *) pointer - allocator->pages) / SLAB_PAGE_SIZE;
+        usize chunk_size = get_slab_chunk_size(allocator->page_classes[page_index]);
+
+        if ((new_size <= chunk_size) && (((usize) pointer & (alignment - 1)) == 0))
+        {
+            // @note: Chunk is already big enough, nothing to do.
+            result = pointer;
+
+#if ASUKA_DEBUG
+            resize_allocation_entry(&allocator->log, pointer, new_size);
+#endif // ASUKA_DEBUG
+        }
+        else
+        {
+            result = allocate__(allocator, new_size, alignment, cl);
+            if (result)
+            {
+                memory::copy(result, pointer, (new_size < chunk_size) ? new_size : chunk_size);
+                deallocate__(allocator, pointer, cl);
+            }
+        }
+    }
+    else
+    {
+#if ASUKA_DEBUG
+        AllocationLogEntry *entry = get_allocation_entry(&allocator->log, pointer);
+        ASSERT_MSG(entry, "Reallocating pointer which was not allocated by this allocator!");
+#endif // ASUKA_DEBUG
+
+        slab_allocator::heap_header *header = get_slab_heap_header(pointer);
+        if ((new_size <= header->size) && (((usize) pointer & (alignment - 1)) == 0))
+        {
+            // @note: Block keeps its size, so it can grow back in place later.
+            result = pointer;
+
+#if ASUKA_DEBUG
+            resize_allocation_entry(&allocator->log, entry, new_size);
+#endif // ASUKA_DEBUG
+        }
+        else
+        {
+            // @note: realloc would not keep the alignment, the block is moved by hand.
+            result = allocate__(allocator, new_size, alignment, cl);
+            if (result)
+            {
+                memory::copy(result, pointer, (new_size < header->size) ? new_size : header->size);
+                deallocate__(allocator, pointer, cl);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+} // namespace memory
@@ -0,0 +1,346 @@
+#include "mipmap.hpp"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define MIPMAP_SSE2 1
+#endif
+
+
+//
+// Mip levels
+//
+
+INTERNAL
+u32 get_next_mip_dimension(u32 dimension) {
+    return (dimension > 1) ? dimension / 2 : 1;
+}
+
+
+usize get_mip_chain_size(Bitmap const *bitmap) {
+    if (bitmap->pixels == NULL || bitmap->bytes_per_pixel != 4) return 0;
+    if (bitmap->width == 0 || bitmap->height == 0) return 0;
+
+    usize result = 0;
+
+    u32 width = bitmap->width;
+    u32 height = bitmap->height;
+    u32 level_count = 1;
+    while ((width > 1 || height > 1) && level_count < MIP_CHAIN_MAX_LEVELS) {
+        width = get_next_mip_dimension(width);
+        height = get_next_mip_dimension(height);
+        result += (usize) width * height * 4;
+        level_count += 1;
+    }
+
+    return result;
+}
+
+
+// @note: Odd last column or row of the source is dropped, like the odd pixel is with halving.
+INTERNAL
+void downsample_mip_row_scalar(u8 *out, u8 const *row0, u8 const *row1, u32 source_width, u32 x_begin, u32 width) {
+    for (u32 x = x_begin; x < width; x++) {
+        u32 x0 = 2 * x;
+        u32 x1 = (x0 + 1 < source_width) ? x0 + 1 : x0;
+        for (u32 channel = 0; channel < 4; channel++) {
+            u32 sum = row0[4 * x0 + channel] + row0[4 * x1 + channel] + row1[4 * x0 + channel] + row1[4 * x1 + channel];
+            out[4 * x + channel] = (u8) ((sum + 2) >> 2);
+        }
+    }
+}
+
+
+#if MIPMAP_SSE2
+
+// @note: Two pixels of the level from four pixels of two rows of the previous one. Returns where it stopped.
+INTERNAL
+u32 downsample_mip_row_sse2(u8 *out, u8 const *row0, u8 const *row1, u32 source_width, u32 width) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i two = _mm_set1_epi16(2);
+
+    u32 x = 0;
+    for (; x + 2 <= width && 2 * x + 4 <= source_width; x += 2) {
+        __m128i a = _mm_loadu_si128((__m128i const *) (row0 + 8 * x));
+        __m128i b = _mm_loadu_si128((__m128i const *) (row1 + 8 * x));
+
+        // @note: Columns added first, [p0 p1] and [p2 p3], then the pixels of each pair.
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+        _mm_storel_epi64((__m128i *) (out + 4 * x), _mm_packus_epi16(sum, sum));
+    }
+    return x;
+}
+
+#endif // MIPMAP_SSE2
+
+
+INTERNAL
+void downsample_mip_level(Bitmap const *source, Bitmap *level) {
+    usize source_pitch = (usize) source->width * 4;
+    for (u32 y = 0; y < level->height; y++) {
+        u32 y0 = 2 * y;
+        u32 y1 = (y0 + 1 < source->height) ? y0 + 1 : y0;
+
+        u8 const *row0 = (u8 const *) source->pixels + y0 * source_pitch;
+        u8 const *row1 = (u8 const *) source->pixels + y1 * source_pitch;
+        u8 *out = (u8 *) level->pixels + (usize) y * level->width * 4;
+
+        u32 x = 0;
+#if MIPMAP_SSE2
+        x = downsample_mip_row_sse2(out, row0, row1, source->width, level->width);
+#endif // MIPMAP_SSE2
+        downsample_mip_row_scalar(out, row0, row1, source->width, x, level->width);
+    }
+}
+
+
+void build_mip_chain(mip_chain *chain, Bitmap const *bitmap, void *memory) {
+    chain->levels[0] = *bitmap;
+    chain->level_count = 1;
+
+    if (get_mip_chain_size(bitmap) == 0) return;
+
+    u8 *level_memory = (u8 *) memory;
+    while (chain->level_count < MIP_CHAIN_MAX_LEVELS) {
+        Bitmap const *previous = chain->levels + chain->level_count - 1;
+        if (previous->width == 1 && previous->height == 1) break;
+
+        Bitmap *level = chain->levels + chain->level_count;
+        level->width = get_next_mip_dimension(previous->width);
+        level->height = get_next_mip_dimension(previous->height);
+        level->bytes_per_pixel = 4;
+        level->size = (usize) level->width * level->height * 4;
+        level->pixels = level_memory;
+        level_memory += level->size;
+
+        downsample_mip_level(previous, level);
+        chain->level_count += 1;
+    }
+}
+
+
+u32 select_mip_level(mip_chain const *chain, f32 scale) {
+    u32 result = 0;
+    while (result + 1 < chain->level_count && scale <= 0.5f) {
+        scale *= 2.0f;
+        result += 1;
+    }
+    return result;
+}
+
+
+//
+// Scaled blit
+//
+// Coordinates in the bitmap are 16.16 fixed point, and pixels of the
+// target are sampled at their centers, so at 1:1 every sample falls right
+// onto a pixel of the bitmap. Interpolation weights are 7-bit, so products
+// of differences of 8-bit values with them fit into 16 bits, and scalar
+// and vector kernels do the same integer math, to the bit:
+//
+//     lerp(a, b, t) = a + (((b - a) * t) >> 7),   t in [0, 128]
+//
+// Colors are interpolated between the rows first, then between the
+// columns, and the result is blended over the target by its alpha.
+//
+
+INTERNAL
+i32 lerp7(i32 a, i32 b, i32 t) {
+    return a + (((b - a) * t) >> 7);
+}
+
+
+INTERNAL
+void get_bilinear_sample(i32 coordinate, i32 size, i32 *index0, i32 *index1, i32 *fraction) {
+    if (coordinate < 0) coordinate = 0;
+
+    i32 index = coordinate >> 16;
+    i32 t = (coordinate >> 9) & 127;
+    if (index >= size - 1) {
+        index = size - 1;
+        t = 0;
+    }
+
+    *index0 = index;
+    *index1 = (index + 1 < size) ? index + 1 : index;
+    *fraction = t;
+}
+
+
+struct scaled_blit_row {
+    u32 *out;
+    i32 count;
+
+    u8 const *row0;
+    u8 const *row1;
+    i32 fy;
+
+    i32 u;
+    i32 u_step;
+    i32 source_width;
+
+    i32 alpha_k; // alpha of the blit, 129 is opaque
+};
+
+
+INTERNAL
+void blit_scaled_row_scalar(scaled_blit_row const *row) {
+    i32 u = row->u;
+    for (i32 i = 0; i < row->count; i++) {
+        i32 x0, x1, fx;
+        get_bilinear_sample(u, row->source_width, &x0, &x1, &fx);
+        u += row->u_step;
+
+        u8 const *p00 = row->row0 + 4 * x0;
+        u8 const *p01 = row->row0 + 4 * x1;
+        u8 const *p10 = row->row1 + 4 * x0;
+        u8 const *p11 = row->row1 + 4 * x1;
+
+        i32 color[4];
+        for (u32 channel = 0; channel < 4; channel++) {
+            i32 left = lerp7(p00[channel], p10[channel], row->fy);
+            i32 right = lerp7(p01[channel], p11[channel], row->fy);
+            color[channel] = lerp7(left, right, fx);
+        }
+
+        i32 a = (color[3] * row->alpha_k + 128) >> 8;
+
+        // @note: Bitmap is RGBA, target is BGRx.
+        u32 back = row->out[i];
+        i32 blue = lerp7(back & 0xff, color[2], a);
+        i32 green = lerp7((back >> 8) & 0xff, color[1], a);
+        i32 red = lerp7((back >> 16) & 0xff, color[0], a);
+
+        row->out[i] = (u32) blue | ((u32) green << 8) | ((u32) red << 16);
+    }
+}
+
+
+#if MIPMAP_SSE2
+
+// @note: One pixel at a time, in 16-bit lanes: both texels of a row are in one register, both rows in two.
+INTERNAL
+void blit_scaled_row_sse2(scaled_blit_row const *row) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i fy = _mm_set1_epi16((i16) row->fy);
+    __m128i alpha_k = _mm_set1_epi16((i16) row->alpha_k);
+    __m128i half = _mm_set1_epi16(128);
+
+    i32 u = row->u;
+    for (i32 i = 0; i < row->count; i++) {
+        i32 x0, x1, fx;
+        get_bilinear_sample(u, row->source_width, &x0, &x1, &fx);
+        u += row->u_step;
+
+        __m128i top = _mm_unpacklo_epi32(
+            _mm_cvtsi32_si128(*(i32 const *) (row->row0 + 4 * x0)),
+            _mm_cvtsi32_si128(*(i32 const *) (row->row0 + 4 * x1)));
+        __m128i bottom = _mm_unpacklo_epi32(
+            _mm_cvtsi32_si128(*(i32 const *) (row->row1 + 4 * x0)),
+            _mm_cvtsi32_si128(*(i32 const *) (row->row1 + 4 * x1)));
+
+        __m128i a = _mm_unpacklo_epi8(top, zero);
+        __m128i b = _mm_unpacklo_epi8(bottom, zero);
+
+        // @note: [left right] between the rows, then left to right.
+        __m128i v = _mm_add_epi16(a, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(b, a), fy), 7));
+        __m128i v_right = _mm_srli_si128(v, 8);
+        __m128i color = _mm_add_epi16(v, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(v_right, v), _mm_set1_epi16((i16) fx)), 7));
+
+        // @note: RGBA to BGRA, and the alpha in every lane.
+        __m128i source = _mm_shufflelo_epi16(color, _MM_SHUFFLE(3, 0, 1, 2));
+        __m128i alpha = _mm_shufflelo_epi16(color, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(alpha, alpha_k), half), 8);
+
+        __m128i back = _mm_unpacklo_epi8(_mm_cvtsi32_si128((i32) row->out[i]), zero);
+        __m128i blended = _mm_add_epi16(back, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(source, back), alpha), 7));
+
+        row->out[i] = (u32) _mm_cvtsi128_si32(_mm_packus_epi16(blended, blended)) & 0x00ffffff;
+    }
+}
+
+#endif // MIPMAP_SSE2
+
+
+INTERNAL
+void blit_bitmap_scaled_(blit_target target, f32 left, f32 top, f32 width, f32 height, Bitmap const *bitmap, f32 alpha, bool scalar) {
+    if (bitmap->pixels == NULL || bitmap->bytes_per_pixel != 4) return;
+    if (bitmap->width == 0 || bitmap->height == 0) return;
+
+    if (alpha > 1.0f) alpha = 1.0f;
+    i32 alpha_k = (alpha > 0.0f) ? (i32) (alpha * 129.0f + 0.5f) : 0;
+    if (alpha_k == 0) return;
+
+    i32 dest_left = (i32) floorf(left + 0.5f);
+    i32 dest_top = (i32) floorf(top + 0.5f);
+    i32 dest_width = (i32) floorf(left + width + 0.5f) - dest_left;
+    i32 dest_height = (i32) floorf(top + height + 0.5f) - dest_top;
+    if (dest_width <= 0 || dest_height <= 0) return;
+
+    i32 x_begin = (dest_left > 0) ? dest_left : 0;
+    i32 y_begin = (dest_top > 0) ? dest_top : 0;
+    i32 x_end = (dest_left + dest_width < target.width) ? dest_left + dest_width : target.width;
+    i32 y_end = (dest_top + dest_height < target.height) ? dest_top + dest_height : target.height;
+    if (x_begin >= x_end || y_begin >= y_end) return;
+
+    i32 u_step = (i32) (((i64) bitmap->width << 16) / dest_width);
+    i32 v_step = (i32) (((i64) bitmap->height << 16) / dest_height);
+
+    scaled_blit_row row = {};
+    row.count = x_end - x_begin;
+    row.u = (i32) ((i64) (x_begin - dest_left) * u_step + u_step / 2 - (1 << 15));
+    row.u_step = u_step;
+    row.source_width = (i32) bitmap->width;
+    row.alpha_k = alpha_k;
+
+    usize source_pitch = (usize) bitmap->width * 4;
+    for (i32 y = y_begin; y < y_end; y++) {
+        i32 v = (i32) ((i64) (y - dest_top) * v_step + v_step / 2 - (1 << 15));
+
+        i32 y0, y1;
+        get_bilinear_sample(v, (i32) bitmap->height, &y0, &y1, &row.fy);
+        row.row0 = (u8 const *) bitmap->pixels + y0 * source_pitch;
+        row.row1 = (u8 const *) bitmap->pixels + y1 * source_pitch;
+        row.out = (u32 *) ((u8 *) target.memory + (isize) y * target.pitch) + x_begin;
+
+#if MIPMAP_SSE2
+        if (!scalar) {
+            blit_scaled_row_sse2(&row);
+            continue;
+        }
+#endif // MIPMAP_SSE2
+        blit_scaled_row_scalar(&row);
+    }
+}
+
+
+INTERNAL
+void blit_bitmap_scaled_scalar(blit_target target, f32 left, f32 top, f32 width, f32 height, Bitmap const *bitmap, f32 alpha = 1.0f) {
+    blit_bitmap_scaled_(target, left, top, width, height, bitmap, alpha, true);
+}
+
+
+void blit_bitmap_scaled(blit_target target, f32 left, f32 top, f32 width, f32 height, Bitmap const *bitmap, f32 alpha) {
+    blit_bitmap_scaled_(target, left, top, width, height, bitmap, alpha, false);
+}
+
+
+void blit_mip_chain(blit_target target, f32 left, f32 top, f32 width, f32 height, mip_chain const *chain, f32 alpha) {
+    if (chain->level_count == 0) return;
+
+    Bitmap const *base = chain->levels;
+    if (base->width == 0 || base->height == 0) return;
+
+    // @note: Scale of the sharper direction, so the level is never blurrier than it has to be.
+    f32 scale_x = width / (f32) base->width;
+    f32 scale_y = height / (f32) base->height;
+    f32 scale = (scale_x > scale_y) ? scale_x : scale_y;
+
+    u32 level = select_mip_level(chain, scale);
+    blit_bitmap_scaled(target, left, top, width, height, chain->levels + level, alpha);
+}
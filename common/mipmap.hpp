@@ -0,0 +1,69 @@
+#ifndef ASUKA_COMMON_MIPMAP_HPP
+#define ASUKA_COMMON_MIPMAP_HPP
+
+#include <defines.hpp>
+#include <bitmap.hpp>
+
+
+//
+// Mip chain is the bitmap with its copies, each half the size of the one
+// before, down to one pixel. Every pixel of the next level is the average
+// of 2x2 pixels of the previous one (box filter):
+//
+//     level 0   60 x 100   the bitmap itself, not copied
+//     level 1   30 x 50
+//     level 2   15 x 25
+//     ...
+//     level 6    1 x 1
+//
+// Scaled blit samples one level bilinearly. Level is picked so that it is
+// never shrunk more than twice, so every pixel drawn reads at most four
+// neighbouring pixels, and drawing zoomed out costs about the same as
+// drawing at 1:1, with no aliasing.
+//
+// @note: Only bitmaps of 4 bytes per pixel (RGBA) have mip levels and can be blitted scaled.
+//
+
+#define MIP_CHAIN_MAX_LEVELS 16
+
+
+struct mip_chain {
+    Bitmap levels[MIP_CHAIN_MAX_LEVELS];
+    u32 level_count;
+};
+
+
+// @note: 32-bit pixels, memory order BBGGRRxx, like the offscreen buffer.
+struct blit_target {
+    void *memory;
+    i32 width;
+    i32 height;
+    i32 pitch;
+};
+
+
+// @note: Size of all levels but the first one, in bytes.
+usize get_mip_chain_size(Bitmap const *bitmap);
+
+// @note: Memory has to be get_mip_chain_size bytes. Bitmaps which are not RGBA get a chain of one level.
+void build_mip_chain(mip_chain *chain, Bitmap const *bitmap, void *memory);
+
+// @note: Level to sample when the bitmap is drawn scale times its size.
+u32 select_mip_level(mip_chain const *chain, f32 scale);
+
+//
+// Draws the bitmap into the rectangle of the target, sampling it bilinearly,
+// and blends it over the target by its alpha times the given alpha.
+// Position is of the top-left corner, rows of the bitmap go down the target.
+//
+void blit_bitmap_scaled(blit_target target, f32 left, f32 top, f32 width, f32 height, Bitmap const *bitmap, f32 alpha = 1.0f);
+
+// @note: Picks the level of the chain for the rectangle, and blits it.
+void blit_mip_chain(blit_target target, f32 left, f32 top, f32 width, f32 height, mip_chain const *chain, f32 alpha = 1.0f);
+
+
+#ifdef UNITY_BUILD
+#include "mipmap.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_MIPMAP_HPP
@@ -0,0 +1,474 @@
+#include "mixer.hpp"
+
+#include <math/float.hpp>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define MIXER_SSE2 1
+#endif
+
+
+//
+// Kernels
+//
+// Gain of frame i of a piece is start + step * i, computed the same way in
+// every kernel, so the vector and scalar ones come out the same to the bit.
+//
+
+INTERNAL
+void mix_voice_samples_scalar(f32 *block, sound_sample_t const *samples, u32 channels, u32 begin, u32 count,
+                              f32 left, f32 right, f32 left_step, f32 right_step) {
+    for (u32 i = begin; i < count; i++) {
+        f32 index = (f32) i;
+        f32 left_gain = left + left_step * index;
+        f32 right_gain = right + right_step * index;
+
+        // @note: Mono sample goes to both sides.
+        f32 left_sample = (f32) samples[channels * i];
+        f32 right_sample = (f32) samples[channels * i + channels - 1];
+
+        block[2 * i] += left_sample * left_gain;
+        block[2 * i + 1] += right_sample * right_gain;
+    }
+}
+
+
+INTERNAL
+void convert_mix_block_scalar(sound_sample_t *output, f32 const *block, u32 begin, u32 count, f32 volume) {
+    for (u32 i = begin; i < count; i++) {
+        f32 sample = block[i] * volume;
+        if (sample > 32767.0f) sample = 32767.0f;
+        if (sample < -32768.0f) sample = -32768.0f;
+        output[i] = (sound_sample_t) lrintf(sample);
+    }
+}
+
+
+#if MIXER_SSE2
+
+// @note: Four frames at a time, two in each register: L R L R. Returns where it stopped.
+INTERNAL
+u32 mix_voice_samples_sse2(f32 *block, sound_sample_t const *samples, u32 channels, u32 count,
+                           f32 left, f32 right, f32 left_step, f32 right_step) {
+    __m128 start = _mm_setr_ps(left, right, left, right);
+    __m128 step = _mm_setr_ps(left_step, right_step, left_step, right_step);
+    __m128 index = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+    __m128 two = _mm_set1_ps(2.0f);
+
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pairs;
+        if (channels == 2) {
+            pairs = _mm_loadu_si128((__m128i const *) (samples + 2 * i));
+        } else {
+            __m128i mono = _mm_loadl_epi64((__m128i const *) (samples + i));
+            pairs = _mm_unpacklo_epi16(mono, mono);
+        }
+
+        // @note: Each sample into the upper half of 32 bits, and shifted back down, which extends its sign.
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(pairs, pairs), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(pairs, pairs), 16));
+
+        __m128 gain_lo = _mm_add_ps(start, _mm_mul_ps(step, index));
+        index = _mm_add_ps(index, two);
+        __m128 gain_hi = _mm_add_ps(start, _mm_mul_ps(step, index));
+        index = _mm_add_ps(index, two);
+
+        _mm_storeu_ps(block + 2 * i, _mm_add_ps(_mm_loadu_ps(block + 2 * i), _mm_mul_ps(lo, gain_lo)));
+        _mm_storeu_ps(block + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(block + 2 * i + 4), _mm_mul_ps(hi, gain_hi)));
+    }
+    return i;
+}
+
+
+// @note: Clamped before the conversion, which would make INT_MIN of anything out of range. Returns where it stopped.
+INTERNAL
+u32 convert_mix_block_sse2(sound_sample_t *output, f32 const *block, u32 count, f32 volume) {
+    __m128 scale = _mm_set1_ps(volume);
+    __m128 high = _mm_set1_ps(32767.0f);
+    __m128 low = _mm_set1_ps(-32768.0f);
+
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(block + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(block + i + 4), scale);
+        a = _mm_max_ps(_mm_min_ps(a, high), low);
+        b = _mm_max_ps(_mm_min_ps(b, high), low);
+
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i *) (output + i), packed);
+    }
+    return i;
+}
+
+#endif // MIXER_SSE2
+
+
+INTERNAL
+void mix_voice_samples(f32 *block, sound_sample_t const *samples, u32 channels, u32 count,
+                       f32 left, f32 right, f32 left_step, f32 right_step) {
+    u32 i = 0;
+#if MIXER_SSE2
+    i = mix_voice_samples_sse2(block, samples, channels, count, left, right, left_step, right_step);
+#endif // MIXER_SSE2
+    mix_voice_samples_scalar(block, samples, channels, i, count, left, right, left_step, right_step);
+}
+
+
+INTERNAL
+void convert_mix_block(sound_sample_t *output, f32 const *block, u32 count, f32 volume) {
+    u32 i = 0;
+#if MIXER_SSE2
+    i = convert_mix_block_sse2(output, block, count, volume);
+#endif // MIXER_SSE2
+    convert_mix_block_scalar(output, block, i, count, volume);
+}
+
+
+//
+// Voices
+//
+
+INTERNAL
+void get_voice_gains(f32 volume, f32 pan, i32 channels, f32 *left, f32 *right) {
+    pan = clamp(pan, -1.0f, 1.0f);
+    if (channels == 1) {
+        f32 angle = (pan + 1.0f) * (0.25f * PI);
+        *left = volume * cosf(angle);
+        *right = volume * sinf(angle);
+    } else {
+        *left = volume * ((pan > 0.0f) ? 1.0f - pan : 1.0f);
+        *right = volume * ((pan < 0.0f) ? 1.0f + pan : 1.0f);
+    }
+}
+
+
+INTERNAL
+i32 get_voice_channels(sound_voice const *voice) {
+    i32 result = voice->sound ? voice->sound->channels : voice->stream->channels;
+    return result;
+}
+
+
+// @note: Frames the voice has in one piece from its cursor, up to frame_count. Looping sound starts over at its end.
+INTERNAL
+u32 get_voice_frames(sound_voice *voice, u32 frame_count, sound_sample_t const **samples) {
+    u32 result = 0;
+    if (voice->sound) {
+        u64 total = voice->sound->samples_count / voice->sound->channels;
+        if (voice->cursor >= total && voice->is_looping) voice->cursor = 0;
+
+        u64 available = total - voice->cursor;
+        result = (u32) ((available < frame_count) ? available : frame_count);
+        *samples = voice->sound->samples + voice->cursor * voice->sound->channels;
+    } else {
+        result = Asuka::peek_wav_stream(voice->stream, samples);
+        if (result > frame_count) result = frame_count;
+    }
+    return result;
+}
+
+
+INTERNAL
+void advance_voice(sound_voice *voice, u32 frame_count) {
+    if (voice->sound) {
+        voice->cursor += frame_count;
+    } else {
+        Asuka::consume_wav_stream(voice->stream, frame_count);
+    }
+}
+
+
+INTERNAL
+bool is_voice_ended(sound_voice *voice) {
+    bool result = false;
+    if (voice->sound) {
+        u64 total = voice->sound->samples_count / voice->sound->channels;
+        result = (voice->cursor >= total) && (!voice->is_looping || total == 0);
+    } else {
+        result = Asuka::is_wav_stream_ended(voice->stream);
+    }
+    return result;
+}
+
+
+// @note: Channels of the frames into separate arrays, in float, for the resampler.
+INTERNAL
+void convert_source_samples(f32 *left, f32 *right, sound_sample_t const *samples, u32 channels, u32 count) {
+    if (channels == 2) {
+        for (u32 i = 0; i < count; i++) {
+            left[i] = (f32) samples[2 * i];
+            right[i] = (f32) samples[2 * i + 1];
+        }
+    } else {
+        for (u32 i = 0; i < count; i++) {
+            left[i] = (f32) samples[i];
+        }
+    }
+}
+
+
+//
+// Source arrays of the mixer get the history of the voice, then as many
+// new frames as the output frames of the block move over. Frames the
+// voice does not have are silence: after the end of a sound they flush
+// the filter, and the voice ends once all of its history is silence; for
+// a stream which was not refilled in time, they are a gap, and the stream
+// goes on from where it stopped.
+//
+INTERNAL
+void mix_resampled_voice(sound_mixer *mixer, sound_voice *voice, u32 frame_count, bool is_silent,
+                         f32 left_gain, f32 right_gain, f32 left_step, f32 right_step) {
+    u32 channels = (u32) get_voice_channels(voice);
+    f32 *left = mixer->source[0];
+    f32 *right = (channels == 2) ? mixer->source[1] : left;
+
+    u64 end = voice->fraction + (u64) frame_count * voice->step;
+    u32 needed = (u32) (end >> 32);
+
+    memcpy(left, voice->history[0], sizeof(voice->history[0]));
+    if (channels == 2) {
+        memcpy(right, voice->history[1], sizeof(voice->history[1]));
+    }
+
+    u32 done = 0;
+    while (done < needed) {
+        sound_sample_t const *samples = NULL;
+        u32 frames = get_voice_frames(voice, needed - done, &samples);
+        if (frames == 0) break;
+
+        convert_source_samples(left + RESAMPLER_TAPS + done, right + RESAMPLER_TAPS + done, samples, channels, frames);
+        advance_voice(voice, frames);
+        done += frames;
+    }
+
+    if (done < needed) {
+        memset(left + RESAMPLER_TAPS + done, 0, (needed - done) * sizeof(f32));
+        if (channels == 2) {
+            memset(right + RESAMPLER_TAPS + done, 0, (needed - done) * sizeof(f32));
+        }
+        if (is_voice_ended(voice)) {
+            voice->tail_frames += needed - done;
+        }
+    }
+
+    if (!is_silent) {
+        resample_frames(mixer->block, left, right, channels, voice->filter, voice->fraction, voice->step, frame_count,
+                        left_gain, right_gain, left_step, right_step);
+    }
+
+    voice->fraction = (u32) end;
+    memcpy(voice->history[0], left + needed, sizeof(voice->history[0]));
+    if (channels == 2) {
+        memcpy(voice->history[1], right + needed, sizeof(voice->history[1]));
+    }
+}
+
+
+//
+// Gains ramp from where the last block ended to the ones of the volume and
+// the pan now. Voice with no gains on both ends is not mixed, but its
+// cursor still goes on. Stream which has no frames yet (it was not
+// refilled in time) is silent for the rest of the block, and goes on from
+// where it stopped.
+//
+INTERNAL
+void mix_voice(sound_mixer *mixer, sound_voice *voice, u32 frame_count) {
+    i32 channels = get_voice_channels(voice);
+
+    f32 left, right;
+    get_voice_gains(voice->volume, voice->pan, channels, &left, &right);
+    if (!voice->has_gains) {
+        voice->left_gain = left;
+        voice->right_gain = right;
+        voice->has_gains = true;
+    }
+
+    f32 start_left = voice->left_gain;
+    f32 start_right = voice->right_gain;
+    f32 left_step = (left - start_left) / (f32) frame_count;
+    f32 right_step = (right - start_right) / (f32) frame_count;
+    bool is_silent = (start_left == 0.0f) && (start_right == 0.0f) && (left == 0.0f) && (right == 0.0f);
+
+    if (voice->filter) {
+        mix_resampled_voice(mixer, voice, frame_count, is_silent, start_left, start_right, left_step, right_step);
+    } else {
+        u32 done = 0;
+        while (done < frame_count) {
+            sound_sample_t const *samples = NULL;
+            u32 frames = get_voice_frames(voice, frame_count - done, &samples);
+            if (frames == 0) break;
+
+            if (!is_silent) {
+                f32 index = (f32) done;
+                mix_voice_samples(mixer->block + 2 * done, samples, channels, frames,
+                                  start_left + left_step * index, start_right + right_step * index, left_step, right_step);
+            }
+
+            advance_voice(voice, frames);
+            done += frames;
+        }
+    }
+
+    voice->left_gain = left;
+    voice->right_gain = right;
+
+    if (is_voice_ended(voice) && (voice->filter == NULL || voice->tail_frames >= RESAMPLER_TAPS)) {
+        voice->is_playing = false;
+    }
+}
+
+
+// @note: Filter for the rate, made if there is none yet. NULL if the rate can not be resampled, or there is no room for its filter.
+INTERNAL
+resampler_filter const *get_mixer_filter(sound_mixer *mixer, i32 samples_per_second) {
+    if (samples_per_second <= 0) return NULL;
+    if ((u64) samples_per_second > (u64) RESAMPLER_MAX_STEP * mixer->samples_per_second) return NULL;
+
+    f32 cutoff = get_resampler_cutoff((u32) samples_per_second, mixer->samples_per_second);
+    for (u32 index = 0; index < mixer->filter_count; index++) {
+        if (mixer->filters[index].cutoff == cutoff) {
+            return mixer->filters + index;
+        }
+    }
+
+    if (mixer->filter_count == SOUND_MIXER_MAX_FILTERS) return NULL;
+
+    resampler_filter *result = mixer->filters + mixer->filter_count++;
+    build_resampler_filter(result, cutoff);
+    return result;
+}
+
+
+INTERNAL
+sound_voice_id start_voice(sound_mixer *mixer, wav_file_contents const *sound, Asuka::wav_stream *stream, i32 samples_per_second,
+                           f32 volume, f32 pan, bool is_looping) {
+    sound_voice_id result = {};
+
+    resampler_filter const *filter = NULL;
+    if ((u32) samples_per_second != mixer->samples_per_second) {
+        filter = get_mixer_filter(mixer, samples_per_second);
+        if (filter == NULL) return result;
+    }
+
+    for (u32 index = 0; index < SOUND_MIXER_MAX_VOICES; index++) {
+        sound_voice *voice = mixer->voices + index;
+        if (voice->is_playing) continue;
+
+        u32 generation = voice->generation + 1;
+        if (generation == 0) generation = 1;
+
+        *voice = {};
+        voice->sound = sound;
+        voice->stream = stream;
+        voice->volume = volume;
+        voice->pan = pan;
+        voice->generation = generation;
+        voice->is_looping = is_looping;
+        voice->is_playing = true;
+        voice->filter = filter;
+        if (filter) {
+            voice->step = get_resampler_step((u32) samples_per_second, mixer->samples_per_second);
+        }
+
+        result.index = index;
+        result.generation = generation;
+        break;
+    }
+
+    return result;
+}
+
+
+INTERNAL
+sound_voice *get_voice(sound_mixer *mixer, sound_voice_id id) {
+    sound_voice *result = NULL;
+    if (id.index < SOUND_MIXER_MAX_VOICES && id.generation != 0) {
+        sound_voice *voice = mixer->voices + id.index;
+        if (voice->is_playing && voice->generation == id.generation) {
+            result = voice;
+        }
+    }
+    return result;
+}
+
+
+void initialize_sound_mixer(sound_mixer *mixer, u32 samples_per_second) {
+    memset(mixer->voices, 0, sizeof(mixer->voices));
+    mixer->master_volume = 1.0f;
+    mixer->samples_per_second = samples_per_second;
+    mixer->filter_count = 0;
+}
+
+
+sound_voice_id play_sound(sound_mixer *mixer, wav_file_contents const *sound, f32 volume, f32 pan, bool is_looping) {
+    sound_voice_id result = {};
+    if (sound == NULL || sound->samples == NULL) return result;
+    if (sound->channels != 1 && sound->channels != 2) return result;
+
+    result = start_voice(mixer, sound, NULL, sound->samples_per_second, volume, pan, is_looping);
+    return result;
+}
+
+
+sound_voice_id play_sound_stream(sound_mixer *mixer, Asuka::wav_stream *stream, f32 volume, f32 pan) {
+    sound_voice_id result = {};
+    if (stream == NULL || stream->buffer == NULL) return result;
+    if (stream->channels != 1 && stream->channels != 2) return result;
+
+    result = start_voice(mixer, NULL, stream, stream->samples_per_second, volume, pan, stream->is_looping);
+    return result;
+}
+
+
+void stop_sound(sound_mixer *mixer, sound_voice_id id) {
+    sound_voice *voice = get_voice(mixer, id);
+    if (voice) {
+        voice->is_playing = false;
+    }
+}
+
+
+void set_sound_volume(sound_mixer *mixer, sound_voice_id id, f32 volume, f32 pan) {
+    sound_voice *voice = get_voice(mixer, id);
+    if (voice) {
+        voice->volume = volume;
+        voice->pan = pan;
+    }
+}
+
+
+bool is_sound_playing(sound_mixer *mixer, sound_voice_id id) {
+    bool result = (get_voice(mixer, id) != NULL);
+    return result;
+}
+
+
+u32 get_playing_voice_count(sound_mixer *mixer) {
+    u32 result = 0;
+    for (u32 index = 0; index < SOUND_MIXER_MAX_VOICES; index++) {
+        if (mixer->voices[index].is_playing) result += 1;
+    }
+    return result;
+}
+
+
+void mix_sound(sound_mixer *mixer, sound_sample_t *output, u32 frame_count) {
+    u32 done = 0;
+    while (done < frame_count) {
+        u32 block_frames = frame_count - done;
+        if (block_frames > SOUND_MIXER_BLOCK_FRAMES) block_frames = SOUND_MIXER_BLOCK_FRAMES;
+
+        memset(mixer->block, 0, block_frames * 2 * sizeof(f32));
+        for (u32 index = 0; index < SOUND_MIXER_MAX_VOICES; index++) {
+            sound_voice *voice = mixer->voices + index;
+            if (voice->is_playing) {
+                mix_voice(mixer, voice, block_frames);
+            }
+        }
+
+        convert_mix_block(output + 2 * done, mixer->block, block_frames * 2, mixer->master_volume);
+        done += block_frames;
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef ASUKA_COMMON_MIXER_HPP
+#define ASUKA_COMMON_MIXER_HPP
+
+#include <defines.hpp>
+#include <wav.hpp>
+#include <resampler.hpp>
+
+
+//
+// Mixer plays any number of voices, up to SOUND_MIXER_MAX_VOICES, into
+// the stereo output. Output is mixed block by block, in float:
+//
+//     voice 0 (i16, mono or stereo) --- * gains ---+
+//     voice 1                       --- * gains ---+--> f32 block --> * master --> i16, saturated
+//     ...                                          |
+//     voice N                       --- * gains ---+
+//
+// Each voice has a volume and a pan, which make its left and right gains.
+// When they change, gains ramp to the new ones over one block, so there
+// are no clicks. Voice plays a sound in memory, or a stream, which only
+// has a ring of frames in memory and is refilled from the file by
+// whoever owns it, so long music never has to be loaded at once.
+//
+// Pan of mono voices keeps the power constant, and the center is -3 dB on
+// each side. Pan of stereo voices is a balance: the center plays both
+// channels as they are, and the other side goes down linearly.
+//
+// Sounds at the rate of the output are mixed as they are. Sounds at other
+// rates, up to RESAMPLER_MAX_STEP times the output rate, go through the
+// resampler: frames of the block are converted to float into the source
+// arrays of the mixer, after the last RESAMPLER_TAPS frames of the block
+// before, which the voice keeps, and the filter runs over them.
+//
+// @note: Filters are made when the first sound of their rate is played, the mixer has room for SOUND_MIXER_MAX_FILTERS.
+//
+
+#define SOUND_MIXER_MAX_VOICES 64
+#define SOUND_MIXER_BLOCK_FRAMES 512
+#define SOUND_MIXER_MAX_FILTERS 4
+
+
+struct sound_voice {
+    wav_file_contents const *sound;
+    Asuka::wav_stream *stream;
+    u64 cursor; // in frames, of the sound in memory
+
+    f32 volume;
+    f32 pan;
+
+    // @note: Gains the last block ended with, the next block ramps from them.
+    f32 left_gain;
+    f32 right_gain;
+
+    u32 generation;
+    b32 is_playing;
+    b32 is_looping;
+    b32 has_gains;
+
+    // @note: Only for sounds which are not at the rate of the output.
+    resampler_filter const *filter;
+    u64 step;
+    u32 fraction; // of the source frame the next output frame is at
+    u32 tail_frames; // of silence after the end, which flush the filter
+    f32 history[2][RESAMPLER_TAPS];
+};
+
+
+// @note: Generation tells the sound which was started in the voice from the ones started before, and is never 0.
+struct sound_voice_id {
+    u32 index;
+    u32 generation;
+};
+
+
+struct sound_mixer {
+    sound_voice voices[SOUND_MIXER_MAX_VOICES];
+    f32 master_volume;
+    u32 samples_per_second;
+
+    resampler_filter filters[SOUND_MIXER_MAX_FILTERS];
+    u32 filter_count;
+
+    f32 block[SOUND_MIXER_BLOCK_FRAMES * 2];
+    f32 source[2][RESAMPLER_TAPS + RESAMPLER_MAX_STEP * SOUND_MIXER_BLOCK_FRAMES];
+};
+
+
+void initialize_sound_mixer(sound_mixer *mixer, u32 samples_per_second = 48000);
+
+//
+// Starts the sound in a free voice. Returns the id with generation 0 if
+// all voices are playing, or the sound can not be played: it has to be
+// mono or stereo, at a rate the mixer can resample. The sound and the
+// stream have to stay while the voice plays.
+//
+sound_voice_id play_sound(sound_mixer *mixer, wav_file_contents const *sound, f32 volume = 1.0f, f32 pan = 0.0f, bool is_looping = false);
+sound_voice_id play_sound_stream(sound_mixer *mixer, Asuka::wav_stream *stream, f32 volume = 1.0f, f32 pan = 0.0f);
+
+// @note: All of these do nothing for a voice which has ended, even if another sound plays in it now.
+void stop_sound(sound_mixer *mixer, sound_voice_id id);
+void set_sound_volume(sound_mixer *mixer, sound_voice_id id, f32 volume, f32 pan);
+bool is_sound_playing(sound_mixer *mixer, sound_voice_id id);
+
+u32 get_playing_voice_count(sound_mixer *mixer);
+
+// @note: Output is interleaved stereo, frame_count frames of left and right samples.
+void mix_sound(sound_mixer *mixer, sound_sample_t *output, u32 frame_count);
+
+
+#ifdef UNITY_BUILD
+#include "mixer.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_MIXER_HPP
@@ -24,5 +24,25 @@ bool write_file(const char* filename, byte_array contents) {
     return internal::write_file(filename, contents);
 }
 
+mapped_file map_file(const char* filename) {
+    return internal::map_file(filename);
+}
+
+void unmap_file(mapped_file *file) {
+    internal::unmap_file(file);
+}
+
+opened_file open_file(const char* filename) {
+    return internal::open_file(filename);
+}
+
+usize read_file(opened_file *file, u64 offset, void *buffer, usize size) {
+    return internal::read_file(file, offset, buffer, size);
+}
+
+void close_file(opened_file *file) {
+    internal::close_file(file);
+}
+
 
 } // namespace os
@@ -12,6 +12,29 @@ namespace os {
 byte_array load_entire_file(const char* filepath);
 bool write_file(const char* filepath, byte_array contents);
 
+// @note: Read-only view of the whole file, pages are loaded by the OS on first access.
+struct mapped_file
+{
+    memory::byte const *data;
+    usize size;
+};
+
+mapped_file map_file(const char* filepath);
+void unmap_file(mapped_file *file);
+
+// @note: File opened for reading at any offset. Reads do not move a shared cursor, so the file can be read from any thread.
+struct opened_file
+{
+    u64 handle;
+    u64 size;
+    b32 is_open;
+};
+
+opened_file open_file(const char* filepath);
+// @note: Returns the number of bytes read, less than asked only at the end of the file or on error.
+usize read_file(opened_file *file, u64 offset, void *buffer, usize size);
+void close_file(opened_file *file);
+
 } // os
 
 #if UNITY_BUILD
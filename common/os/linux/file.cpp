@@ -3,6 +3,7 @@
 #include "file.hpp"
 #include <os/memory.hpp>
 
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -47,9 +48,112 @@ byte_array load_entire_file(const char* filename)
 }
 
 
-bool write_file(const char* filename, byte_array file) {
-    NOT_IMPLEMENTED();
-    return false;
+bool write_file(const char* filename, byte_array file)
+{
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    usize bytes_written = 0;
+    while (bytes_written < file.size)
+    {
+        ssize_t n = write(fd, file.data + bytes_written, file.size - bytes_written);
+        if (n <= 0) break;
+        bytes_written += n;
+    }
+
+    close(fd);
+    return (bytes_written == file.size);
+}
+
+
+mapped_file map_file(const char* filename)
+{
+    mapped_file result = {};
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return result;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void *memory = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (memory != MAP_FAILED)
+        {
+            result.data = (memory::byte const *) memory;
+            result.size = st.st_size;
+        }
+    }
+
+    // @note: The mapping keeps the file open by itself.
+    close(fd);
+    return result;
+}
+
+
+void unmap_file(mapped_file *file)
+{
+    if (file->data)
+    {
+        munmap((void *) file->data, file->size);
+    }
+    *file = {};
+}
+
+
+opened_file open_file(const char* filename)
+{
+    opened_file result = {};
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return result;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return result;
+    }
+
+    result.handle = (u64) fd;
+    result.size = st.st_size;
+    result.is_open = true;
+    return result;
+}
+
+
+usize read_file(opened_file *file, u64 offset, void *buffer, usize size)
+{
+    usize bytes_read = 0;
+    if (!file->is_open) return bytes_read;
+
+    // @note: pread can read less than asked, even before the end of the file.
+    while (bytes_read < size)
+    {
+        ssize_t n = pread((int) file->handle, (u8 *) buffer + bytes_read, size - bytes_read, offset + bytes_read);
+        if (n <= 0) break;
+        bytes_read += n;
+    }
+
+    return bytes_read;
+}
+
+
+void close_file(opened_file *file)
+{
+    if (file->is_open)
+    {
+        close((int) file->handle);
+    }
+    *file = {};
 }
 
 
@@ -1,13 +1,35 @@
 #include "memory.hpp"
 #include <sys/mman.h>
+#include <stddef.h>
 
 namespace memory {
 namespace internal {
 
 
-static void *allocations[1024] {};
-static usize allocations_sizes[1024] {};
+// @note: munmap needs the size, so it is kept along with every mapping. Allocation logs map pages from many threads, hence the lock.
+#define MAX_PAGE_ALLOCATIONS 4096
+
+static void *allocations[MAX_PAGE_ALLOCATIONS] {};
+static usize allocations_sizes[MAX_PAGE_ALLOCATIONS] {};
 int allocations_count = 0;
+static u32 volatile allocations_lock = 0;
+
+static void lock_allocations() {
+    while (!ATOMIC_COMPARE_EXCHANGE_U32(&allocations_lock, 0, 1)) {}
+}
+
+static void unlock_allocations() {
+    ATOMIC_STORE_U32(&allocations_lock, 0);
+}
+
+static void push_allocation(void* memory, usize size) {
+    lock_allocations();
+    ASSERT_MSG(allocations_count < MAX_PAGE_ALLOCATIONS, "Too many page allocations!");
+    allocations[allocations_count] = memory;
+    allocations_sizes[allocations_count] = size;
+    allocations_count += 1;
+    unlock_allocations();
+}
 
 void* allocate_pages(void* base_address, uint64 size) {
     void* memory = mmap(base_address, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -15,10 +37,7 @@ void* allocate_pages(void* base_address, uint64 size) {
         return 0;
     }
 
-    allocations[allocations_count] = memory;
-    allocations_sizes[allocations_count] = size;
-    allocations_count += 1;
-
+    push_allocation(memory, size);
     return memory;
 }
 
@@ -28,10 +47,7 @@ void* allocate_pages(uint64 size) {
         return 0;
     }
 
-    allocations[allocations_count] = memory;
-    allocations_sizes[allocations_count] = size;
-    allocations_count += 1;
-
+    push_allocation(memory, size);
     return memory;
 }
 
@@ -41,13 +57,23 @@ void free_pages(void* memory, usize size) {
 }
 
 void free_pages(void *memory) {
+    usize size = 0;
+
+    lock_allocations();
     for (int i = 0; i < allocations_count; i++) {
         if (allocations[i] == memory) {
-            free_pages(memory, allocations_sizes[i]);
+            size = allocations_sizes[i];
             allocations_count -= 1;
-            return;
+            allocations[i] = allocations[allocations_count];
+            allocations_sizes[i] = allocations_sizes[allocations_count];
+            break;
         }
     }
+    unlock_allocations();
+
+    if (size) {
+        free_pages(memory, size);
+    }
 }
 
 // const char* get_allocate_pages_error() {
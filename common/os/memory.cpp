@@ -1,5 +1,9 @@
 #include "memory.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#endif
+
 #if ASUKA_OS_WINDOWS
 #include "windows/memory.hpp"
 #endif
@@ -28,6 +32,145 @@ void free_pages(void* memory) {
     return internal::free_pages(memory);
 }
 
+//
+// memory::set and memory::copy
+//
+// Sizes below one vector are done byte by byte. Bigger sizes store one
+// unaligned vector at the head and one at the tail (they may overlap the
+// middle part), and the middle part is done with aligned stores, four vectors
+// at a time. Sizes starting from MEMORY_NON_TEMPORAL_THRESHOLD bypass the
+// cache with streaming stores, because they would evict everything anyway.
+//
+// Only compiler intrinsics are used, so it works in the nocrt build too.
+// Source and destination of memory::copy must not overlap.
+//
+
+#define MEMORY_NON_TEMPORAL_THRESHOLD MEGABYTES(4)
+
+#if defined(__AVX2__)
+
+#define MEMORY_VECTOR_SIZE 32
+typedef __m256i memory_vector_t;
+#define MEMORY_VECTOR_SET1(VALUE)          _mm256_set1_epi8((char) (VALUE))
+#define MEMORY_VECTOR_LOADU(POINTER)       _mm256_loadu_si256((__m256i const *) (POINTER))
+#define MEMORY_VECTOR_STOREU(POINTER, V)   _mm256_storeu_si256((__m256i *) (POINTER), V)
+#define MEMORY_VECTOR_STORE(POINTER, V)    _mm256_store_si256((__m256i *) (POINTER), V)
+#define MEMORY_VECTOR_STREAM(POINTER, V)   _mm256_stream_si256((__m256i *) (POINTER), V)
+
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+
+#define MEMORY_VECTOR_SIZE 16
+typedef __m128i memory_vector_t;
+#define MEMORY_VECTOR_SET1(VALUE)          _mm_set1_epi8((char) (VALUE))
+#define MEMORY_VECTOR_LOADU(POINTER)       _mm_loadu_si128((__m128i const *) (POINTER))
+#define MEMORY_VECTOR_STOREU(POINTER, V)   _mm_storeu_si128((__m128i *) (POINTER), V)
+#define MEMORY_VECTOR_STORE(POINTER, V)    _mm_store_si128((__m128i *) (POINTER), V)
+#define MEMORY_VECTOR_STREAM(POINTER, V)   _mm_stream_si128((__m128i *) (POINTER), V)
+
+#endif
+
+
+#ifdef MEMORY_VECTOR_SIZE
+
+void set(void *memory, u8 value, usize size) {
+    u8 *d = (u8 *)memory;
+
+    if (size < MEMORY_VECTOR_SIZE) {
+        for (usize i = 0; i < size; i++) {
+            d[i] = value;
+        }
+        return;
+    }
+
+    memory_vector_t v = MEMORY_VECTOR_SET1(value);
+    u8 *end = d + size;
+
+    // Unaligned head and tail.
+    MEMORY_VECTOR_STOREU(d, v);
+    MEMORY_VECTOR_STOREU(end - MEMORY_VECTOR_SIZE, v);
+
+    // Aligned middle part.
+    u8 *p = (u8 *)(((usize)d + MEMORY_VECTOR_SIZE) & ~(usize)(MEMORY_VECTOR_SIZE - 1));
+    u8 *aligned_end = (u8 *)((usize)end & ~(usize)(MEMORY_VECTOR_SIZE - 1));
+
+    if (size >= MEMORY_NON_TEMPORAL_THRESHOLD) {
+        for (; p + 4 * MEMORY_VECTOR_SIZE <= aligned_end; p += 4 * MEMORY_VECTOR_SIZE) {
+            MEMORY_VECTOR_STREAM(p + 0 * MEMORY_VECTOR_SIZE, v);
+            MEMORY_VECTOR_STREAM(p + 1 * MEMORY_VECTOR_SIZE, v);
+            MEMORY_VECTOR_STREAM(p + 2 * MEMORY_VECTOR_SIZE, v);
+            MEMORY_VECTOR_STREAM(p + 3 * MEMORY_VECTOR_SIZE, v);
+        }
+        _mm_sfence();
+    } else {
+        for (; p + 4 * MEMORY_VECTOR_SIZE <= aligned_end; p += 4 * MEMORY_VECTOR_SIZE) {
+            MEMORY_VECTOR_STORE(p + 0 * MEMORY_VECTOR_SIZE, v);
+            MEMORY_VECTOR_STORE(p + 1 * MEMORY_VECTOR_SIZE, v);
+            MEMORY_VECTOR_STORE(p + 2 * MEMORY_VECTOR_SIZE, v);
+            MEMORY_VECTOR_STORE(p + 3 * MEMORY_VECTOR_SIZE, v);
+        }
+    }
+
+    for (; p < aligned_end; p += MEMORY_VECTOR_SIZE) {
+        MEMORY_VECTOR_STORE(p, v);
+    }
+}
+
+void copy(void *destination, void const *source, usize size) {
+    u8 *d = (u8 *)destination;
+    u8 const *s = (u8 const *)source;
+
+    if (size < MEMORY_VECTOR_SIZE) {
+        for (usize i = 0; i < size; i++) {
+            d[i] = s[i];
+        }
+        return;
+    }
+
+    // Unaligned head and tail.
+    memory_vector_t head = MEMORY_VECTOR_LOADU(s);
+    memory_vector_t tail = MEMORY_VECTOR_LOADU(s + size - MEMORY_VECTOR_SIZE);
+    MEMORY_VECTOR_STOREU(d, head);
+    MEMORY_VECTOR_STOREU(d + size - MEMORY_VECTOR_SIZE, tail);
+
+    // Middle part is aligned by the destination, source is read unaligned.
+    usize offset = MEMORY_VECTOR_SIZE - ((usize)d & (MEMORY_VECTOR_SIZE - 1));
+    usize aligned_size = (size - offset) & ~(usize)(MEMORY_VECTOR_SIZE - 1);
+    u8 *p = d + offset;
+    u8 const *q = s + offset;
+    u8 *aligned_end = p + aligned_size;
+
+    if (size >= MEMORY_NON_TEMPORAL_THRESHOLD) {
+        for (; p + 4 * MEMORY_VECTOR_SIZE <= aligned_end; p += 4 * MEMORY_VECTOR_SIZE, q += 4 * MEMORY_VECTOR_SIZE) {
+            memory_vector_t v0 = MEMORY_VECTOR_LOADU(q + 0 * MEMORY_VECTOR_SIZE);
+            memory_vector_t v1 = MEMORY_VECTOR_LOADU(q + 1 * MEMORY_VECTOR_SIZE);
+            memory_vector_t v2 = MEMORY_VECTOR_LOADU(q + 2 * MEMORY_VECTOR_SIZE);
+            memory_vector_t v3 = MEMORY_VECTOR_LOADU(q + 3 * MEMORY_VECTOR_SIZE);
+            MEMORY_VECTOR_STREAM(p + 0 * MEMORY_VECTOR_SIZE, v0);
+            MEMORY_VECTOR_STREAM(p + 1 * MEMORY_VECTOR_SIZE, v1);
+            MEMORY_VECTOR_STREAM(p + 2 * MEMORY_VECTOR_SIZE, v2);
+            MEMORY_VECTOR_STREAM(p + 3 * MEMORY_VECTOR_SIZE, v3);
+        }
+        _mm_sfence();
+    } else {
+        for (; p + 4 * MEMORY_VECTOR_SIZE <= aligned_end; p += 4 * MEMORY_VECTOR_SIZE, q += 4 * MEMORY_VECTOR_SIZE) {
+            memory_vector_t v0 = MEMORY_VECTOR_LOADU(q + 0 * MEMORY_VECTOR_SIZE);
+            memory_vector_t v1 = MEMORY_VECTOR_LOADU(q + 1 * MEMORY_VECTOR_SIZE);
+            memory_vector_t v2 = MEMORY_VECTOR_LOADU(q + 2 * MEMORY_VECTOR_SIZE);
+            memory_vector_t v3 = MEMORY_VECTOR_LOADU(q + 3 * MEMORY_VECTOR_SIZE);
+            MEMORY_VECTOR_STORE(p + 0 * MEMORY_VECTOR_SIZE, v0);
+            MEMORY_VECTOR_STORE(p + 1 * MEMORY_VECTOR_SIZE, v1);
+            MEMORY_VECTOR_STORE(p + 2 * MEMORY_VECTOR_SIZE, v2);
+            MEMORY_VECTOR_STORE(p + 3 * MEMORY_VECTOR_SIZE, v3);
+        }
+    }
+
+    for (; p < aligned_end; p += MEMORY_VECTOR_SIZE, q += MEMORY_VECTOR_SIZE) {
+        MEMORY_VECTOR_STORE(p, MEMORY_VECTOR_LOADU(q));
+    }
+}
+
+#else // MEMORY_VECTOR_SIZE
+
 void set(void *memory, u8 value, usize size) {
     u8 *m = (u8 *)memory;
     for (usize i = 0; i < size; i++) {
@@ -43,6 +186,8 @@ void copy(void *destination, void const *source, usize size) {
     }
 }
 
+#endif // MEMORY_VECTOR_SIZE
+
 template <typename T>
 void fill_buffer(T *buffer, T value, usize size) {
     for (usize i = 0; i < size; i++) {
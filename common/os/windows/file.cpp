@@ -83,5 +83,129 @@ bool write_file(const char* filename, byte_array file)
 }
 
 
+mapped_file map_file(const char* filename)
+{
+    mapped_file result = {};
+
+    HANDLE FileHandle = CreateFileA(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        return result;
+    }
+
+    defer { CloseHandle(FileHandle); };
+
+    LARGE_INTEGER FileSize;
+    if (GetFileSizeEx(FileHandle, &FileSize) == 0 || FileSize.QuadPart == 0)
+    {
+        return result;
+    }
+
+    HANDLE MappingHandle = CreateFileMappingA(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (MappingHandle == NULL)
+    {
+        return result;
+    }
+
+    // @note: The view keeps the mapping and the file open by itself.
+    void *Memory = MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(MappingHandle);
+
+    if (Memory)
+    {
+        result.data = (memory::byte const *) Memory;
+        result.size = FileSize.QuadPart;
+    }
+
+    return result;
+}
+
+
+void unmap_file(mapped_file *file)
+{
+    if (file->data)
+    {
+        UnmapViewOfFile(file->data);
+    }
+    *file = {};
+}
+
+
+opened_file open_file(const char* filename)
+{
+    opened_file result = {};
+
+    HANDLE FileHandle = CreateFileA(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        return result;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (GetFileSizeEx(FileHandle, &FileSize) == 0)
+    {
+        CloseHandle(FileHandle);
+        return result;
+    }
+
+    result.handle = (u64) FileHandle;
+    result.size = FileSize.QuadPart;
+    result.is_open = true;
+    return result;
+}
+
+
+usize read_file(opened_file *file, u64 offset, void *buffer, usize size)
+{
+    usize bytes_read = 0;
+    if (!file->is_open) return bytes_read;
+
+    while (bytes_read < size)
+    {
+        // @note: Offset in OVERLAPPED makes the read positional, even though the handle is synchronous.
+        OVERLAPPED Overlapped = {};
+        Overlapped.Offset = (DWORD) ((offset + bytes_read) & 0xFFFFFFFF);
+        Overlapped.OffsetHigh = (DWORD) ((offset + bytes_read) >> 32);
+
+        usize ToRead = size - bytes_read;
+        DWORD BytesToRead = (ToRead > 0x40000000) ? 0x40000000 : (DWORD) ToRead;
+        DWORD BytesRead = 0;
+        if (ReadFile((HANDLE) file->handle, (u8 *) buffer + bytes_read, BytesToRead, &BytesRead, &Overlapped) == FALSE || BytesRead == 0)
+        {
+            break;
+        }
+        bytes_read += BytesRead;
+    }
+
+    return bytes_read;
+}
+
+
+void close_file(opened_file *file)
+{
+    if (file->is_open)
+    {
+        CloseHandle((HANDLE) file->handle);
+    }
+    *file = {};
+}
+
+
 } // internal
 } // os
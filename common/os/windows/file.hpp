@@ -5,6 +5,11 @@ namespace internal {
 
 byte_array load_entire_file(const char* filename);
 bool write_file(const char* filename, byte_array contents);
+mapped_file map_file(const char* filename);
+void unmap_file(mapped_file *file);
+opened_file open_file(const char* filename);
+usize read_file(opened_file *file, u64 offset, void *buffer, usize size);
+void close_file(opened_file *file);
 
 } // internal
 } // os
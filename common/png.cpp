@@ -1,6 +1,8 @@
 /*
 
 Reference: http://www.libpng.org/pub/png/spec/1.2/PNG-Structure.html
+           https://www.rfc-editor.org/rfc/rfc1950 (zlib)
+           https://www.rfc-editor.org/rfc/rfc1951 (DEFLATE)
 
 */
 
@@ -10,10 +12,11 @@ Reference: http://www.libpng.org/pub/png/spec/1.2/PNG-Structure.html
 #include "crc.hpp"
 
 #include "stdlib.h"
+#include "string.h"
 
-#if 1
-#define STB_IMAGE_IMPLEMENTATION
-#include <external/stb_image.h>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define PNG_SSE2 1
 #endif
 
 
@@ -55,6 +58,15 @@ enum PNG_InterlaceMethod : u8 {
     PNG_INTERLACE_ADAM7 = 1,
 };
 
+// Filter type byte in front of every scanline
+enum PNG_FilterType : u8 {
+    PNG_FILTER_NONE = 0,
+    PNG_FILTER_SUB = 1,
+    PNG_FILTER_UP = 2,
+    PNG_FILTER_AVERAGE = 3,
+    PNG_FILTER_PAETH = 4,
+};
+
 
 u32 change_endianess(u32 n) {
     return ((n & 0xFF000000) >> 24)
@@ -70,6 +82,8 @@ enum {
     PNG_SIGNATURE_1 = PNG_MAGIC_NUMBER(137, 80, 78, 71),
     PNG_SIGNATURE_2 = PNG_MAGIC_NUMBER(13, 10, 26, 10),
     PNG_IHDR_ID = PNG_MAGIC_NUMBER('I', 'H', 'D', 'R'),
+    PNG_PLTE_ID = PNG_MAGIC_NUMBER('P', 'L', 'T', 'E'),
+    PNG_tRNS_ID = PNG_MAGIC_NUMBER('t', 'R', 'N', 'S'),
     PNG_sRGB_ID = PNG_MAGIC_NUMBER('s', 'R', 'G', 'B'),
     PNG_IDAT_ID = PNG_MAGIC_NUMBER('I', 'D', 'A', 'T'),
     PNG_IEND_ID = PNG_MAGIC_NUMBER('I', 'E', 'N', 'D'),
@@ -77,254 +91,1176 @@ enum {
 
 namespace png {
 
+using crc_t = u32;
+
 INTERNAL
-u8 *consume_memory(u8 **data, u64 size) {
-    u8 *result = *data;
-    *data += size;
-    return result;
+u32 read_u32_be(u8 const *data) {
+    u32 result;
+    memcpy(&result, data, sizeof(result));
+    return change_endianess(result);
 }
 
-using crc_t = u32;
-
 } // png
 
-#define PNG_CONSUME_STRUCT(POINTER, TYPE) \
-    (TYPE *)png::consume_memory(&POINTER, sizeof(TYPE)); void(0)
-
 
+//
+// Bits of DEFLATE stream are packed starting from the least significant bit
+// of every byte. Fetcher keeps up to 64 of them in a register and refills it
+// with one unaligned 8-byte load, so one refill is enough for a whole
+// length/distance pair (at most 15 + 5 + 15 + 13 = 48 bits):
+//
+//   bits:  ...xxxxxxxxxx|yyyyyyyy  <- next code is in the low bits
+//                        ↑
+//                        available_bits
+//
+// Past the end of input it is refilled with zero bytes, which are counted,
+// so reading them is found out after the block instead of on every refill.
+//
 struct bit_fetcher {
-    u8* buffer;
-    u32 bits;
+    u8 const *at;
+    u8 const *end;
+    u64 bits;
     u32 available_bits;
+    u32 overrun_bytes; // @note: Zero bytes given past the end of input.
 };
 
-struct huffman_code {
+INTERNAL INLINE
+void refill_bits(bit_fetcher *fetcher) {
+    if (fetcher->end - fetcher->at >= 8) {
+        // @note: Bits above available_bits are the same bytes the next refill loads again, so OR is safe.
+        u64 word;
+        memcpy(&word, fetcher->at, sizeof(word));
+        fetcher->bits |= word << fetcher->available_bits;
+        fetcher->at += (63 - fetcher->available_bits) >> 3;
+        fetcher->available_bits |= 56;
+    } else {
+        while (fetcher->available_bits <= 56) {
+            u64 byte = 0;
+            if (fetcher->at < fetcher->end) {
+                byte = *fetcher->at++;
+            } else {
+                fetcher->overrun_bytes += 1;
+            }
+            fetcher->bits |= byte << fetcher->available_bits;
+            fetcher->available_bits += 8;
+        }
+    }
+}
 
-};
+// @note: Caller makes sure there are n bits available.
+INTERNAL INLINE
+u32 take_bits(bit_fetcher *fetcher, u32 n) {
+    u32 result = (u32) (fetcher->bits & ((1ull << n) - 1));
+    fetcher->bits >>= n;
+    fetcher->available_bits -= n;
+    return result;
+}
 
 INTERNAL
 u32 get_bits(bit_fetcher* fetcher, u32 n) {
     ASSERT(n <= 32);
 
-    u32 result;
-
     if (fetcher->available_bits < n) {
-        do {
-            fetcher->bits |= ((u32)(*fetcher->buffer++)) << fetcher->available_bits;
-            fetcher->available_bits += 8;
-        } while (fetcher->available_bits <= 24);
+        refill_bits(fetcher);
     }
 
-    result = fetcher->bits & ((1 << n) - 1);
-    fetcher->bits = fetcher->bits >> n;
-    fetcher->available_bits -= n;
+    return take_bits(fetcher, n);
+}
 
-    return result;
+// @note: True when zero bytes from past the end of input were consumed.
+INTERNAL
+bool is_input_overrun(bit_fetcher *fetcher) {
+    return (fetcher->overrun_bytes * 8 > fetcher->available_bits);
 }
 
+// @note: Drops bits up to the byte boundary and gives the buffered whole bytes back to the input.
 INTERNAL
-huffman_code generate_huffman() {
-    huffman_code result {};
+bool align_bits_to_byte(bit_fetcher *fetcher) {
+    take_bits(fetcher, fetcher->available_bits & 7);
+
+    u32 buffered_bytes = fetcher->available_bits >> 3;
+    if (buffered_bytes < fetcher->overrun_bytes) return false;
+
+    fetcher->at -= buffered_bytes - fetcher->overrun_bytes;
+    fetcher->bits = 0;
+    fetcher->available_bits = 0;
+    fetcher->overrun_bytes = 0;
+    return true;
+}
+
+
+//
+// Huffman codes are decoded with lookup tables indexed by the next
+// root_bits bits of the stream. Entry of a code not longer than root_bits is
+// repeated in every slot its code is a prefix of, and it says everything
+// about the symbol, so literals, lengths with their extra bits and the end
+// of block are resolved in one lookup:
+//
+//   31             16 15    12 11     8 7          0
+//  ┌─────────────────┬────────┬────────┬────────────┐
+//  │ value           │ kind   │ extra  │ length     │
+//  └─────────────────┴────────┴────────┴────────────┘
+//    literal byte,     huffman  number   bits of the
+//    base of length    _entry   of extra code to
+//    or distance,      _kind    bits     consume
+//    subtable offset
+//
+// Longer codes go through a subtable, as in zlib: the root entry points to
+// it and says how many more bits index it. Codes of PNG files are rarely
+// longer than 10 bits, so the second lookup is rare.
+//
+enum huffman_entry_kind : u32 {
+    HUFFMAN_LITERAL = 0,
+    HUFFMAN_LENGTH,
+    HUFFMAN_DISTANCE,
+    HUFFMAN_END_OF_BLOCK,
+    HUFFMAN_SUBTABLE,
+    HUFFMAN_INVALID,
+};
+
+#define HUFFMAN_ENTRY(VALUE, KIND, EXTRA, LENGTH) \
+    ((((u32) (VALUE)) << 16) | (((u32) (KIND)) << 12) | (((u32) (EXTRA)) << 8) | ((u32) (LENGTH)))
 
+#define HUFFMAN_ENTRY_VALUE(ENTRY)  ((ENTRY) >> 16)
+#define HUFFMAN_ENTRY_KIND(ENTRY)  (((ENTRY) >> 12) & 0xF)
+#define HUFFMAN_ENTRY_EXTRA(ENTRY) (((ENTRY) >> 8) & 0xF)
+#define HUFFMAN_ENTRY_LENGTH(ENTRY) ((ENTRY) & 0xFF)
+
+#define HUFFMAN_MAX_CODE_LENGTH 15
+
+#define HUFFMAN_LITLEN_ROOT_BITS   10
+#define HUFFMAN_DISTANCE_ROOT_BITS 8
+#define HUFFMAN_PRECODE_ROOT_BITS  7
+
+// @note: Root table and all subtables for the worst valid code, as computed by zlib's 'enough' tool.
+#define HUFFMAN_LITLEN_TABLE_SIZE   1334
+#define HUFFMAN_DISTANCE_TABLE_SIZE 402
+#define HUFFMAN_PRECODE_TABLE_SIZE  128
+
+#define HUFFMAN_LITLEN_SYMBOLS   288
+#define HUFFMAN_DISTANCE_SYMBOLS 32
+#define HUFFMAN_PRECODE_SYMBOLS  19
+
+
+// @note: Entries of every symbol without the code length, which is added when the table is built.
+struct huffman_symbol_entries {
+    u32 litlen[HUFFMAN_LITLEN_SYMBOLS];
+    u32 distance[HUFFMAN_DISTANCE_SYMBOLS];
+    u32 precode[HUFFMAN_PRECODE_SYMBOLS];
+};
+
+constexpr huffman_symbol_entries make_huffman_symbol_entries() {
+    constexpr u16 length_base[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    constexpr u8 length_extra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    constexpr u16 distance_base[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    constexpr u8 distance_extra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    huffman_symbol_entries result = {};
+    for (u32 symbol = 0; symbol < HUFFMAN_LITLEN_SYMBOLS; symbol++) {
+        if (symbol < 256) {
+            result.litlen[symbol] = HUFFMAN_ENTRY(symbol, HUFFMAN_LITERAL, 0, 0);
+        } else if (symbol == 256) {
+            result.litlen[symbol] = HUFFMAN_ENTRY(0, HUFFMAN_END_OF_BLOCK, 0, 0);
+        } else if (symbol < 286) {
+            result.litlen[symbol] = HUFFMAN_ENTRY(length_base[symbol - 257], HUFFMAN_LENGTH, length_extra[symbol - 257], 0);
+        } else {
+            result.litlen[symbol] = HUFFMAN_ENTRY(0, HUFFMAN_INVALID, 0, 0);
+        }
+    }
+    for (u32 symbol = 0; symbol < HUFFMAN_DISTANCE_SYMBOLS; symbol++) {
+        result.distance[symbol] = (symbol < 30)
+            ? HUFFMAN_ENTRY(distance_base[symbol], HUFFMAN_DISTANCE, distance_extra[symbol], 0)
+            : HUFFMAN_ENTRY(0, HUFFMAN_INVALID, 0, 0);
+    }
+    for (u32 symbol = 0; symbol < HUFFMAN_PRECODE_SYMBOLS; symbol++) {
+        result.precode[symbol] = HUFFMAN_ENTRY(symbol, HUFFMAN_LITERAL, 0, 0);
+    }
     return result;
 }
 
-INTERNAL
-u32 decode_huffman(huffman_code *huffman) {
-    u32 result {};
+GLOBAL constexpr huffman_symbol_entries huffman_symbols = make_huffman_symbol_entries();
+
 
+struct huffman_code {
+    u32 *entries;
+    u32 capacity;
+    u32 root_bits;
+};
+
+INTERNAL
+u32 reverse_bits(u32 code, u32 length) {
+    u32 result = 0;
+    for (u32 i = 0; i < length; i++) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
     return result;
 }
 
+//
+// Builds the lookup table of canonical Huffman code from the code lengths
+// (RFC 1951, 3.2.2). Over-subscribed lengths are an error; incomplete
+// codes are allowed, and the missing codes decode to HUFFMAN_INVALID.
+//
 INTERNAL
-void decode_idat_chunk(u8 *data, usize size, Bitmap *result) {
-    u8 CMF = *data;
-    u8 CM  = 0x0F & CMF; // CompressionMethod
+bool generate_huffman(huffman_code *code, u8 const *lengths, u32 symbol_count, u32 const *symbol_entries) {
+    u32 count[HUFFMAN_MAX_CODE_LENGTH + 1] = {};
+    for (u32 symbol = 0; symbol < symbol_count; symbol++) {
+        count[lengths[symbol]] += 1;
+    }
+    count[0] = 0;
+
+    i32 left = 1;
+    u32 max_length = 0;
+    for (u32 length = 1; length <= HUFFMAN_MAX_CODE_LENGTH; length++) {
+        left = (left << 1) - (i32) count[length];
+        if (left < 0) return false;
+        if (count[length]) max_length = length;
+    }
+
+    // Symbols sorted by code length, and by value inside of the same length, are in the order of their codes.
+    u32 offsets[HUFFMAN_MAX_CODE_LENGTH + 2] = {};
+    for (u32 length = 1; length <= HUFFMAN_MAX_CODE_LENGTH; length++) {
+        offsets[length + 1] = offsets[length] + count[length];
+    }
 
-    ASSERT(CM == 8); // CM=8 denotes 'deflate' algorithm of compression
+    u16 sorted[HUFFMAN_LITLEN_SYMBOLS];
+    for (u32 symbol = 0; symbol < symbol_count; symbol++) {
+        if (lengths[symbol]) {
+            sorted[offsets[lengths[symbol]]++] = (u16) symbol;
+        }
+    }
 
-    u8 CINFO = (0xF0 & CMF) >> 4; // CompressionINFO
+    u32 root_size = 1u << code->root_bits;
+    u32 root_mask = root_size - 1;
+    ASSERT(root_size <= code->capacity);
 
-    // CINFO = log_2(LZ77_window_size) - 8;
-    // Therefore => u32 LZ77_window_size = 1 << (CINFO + 8);
-    //
-    // CINFO=7 indicates 32768 window size.
+    u32 const invalid = HUFFMAN_ENTRY(0, HUFFMAN_INVALID, 0, code->root_bits);
+    for (u32 i = 0; i < root_size; i++) {
+        code->entries[i] = invalid;
+    }
 
-    ASSERT(CINFO < 8); // CINFO above 7 are not allowed by the specification
-    // CompressionINFO is not defined if CompressionMethod != 8
+    u32 used = root_size;
+    u32 subtable_prefix = root_size; // @note: No subtable yet.
+    u32 subtable_offset = 0;
+    u32 subtable_bits = 0;
+
+    u32 next_code = 0;
+    u32 symbol_index = 0;
+    for (u32 length = 1; length <= max_length; length++) {
+        for (; count[length] > 0; count[length]--) {
+            u32 entry = symbol_entries[sorted[symbol_index++]];
+            u32 reversed = reverse_bits(next_code++, length);
+
+            if (length <= code->root_bits) {
+                for (u32 slot = reversed; slot < root_size; slot += (1u << length)) {
+                    code->entries[slot] = entry | length;
+                }
+            } else {
+                u32 prefix = reversed & root_mask;
+                if (prefix != subtable_prefix) {
+                    // Subtable is as big as the codes left under this prefix need, codes with the same prefix are consecutive.
+                    subtable_bits = length - code->root_bits;
+                    i32 room = 1 << subtable_bits;
+                    while (subtable_bits + code->root_bits < max_length) {
+                        room -= (i32) count[subtable_bits + code->root_bits];
+                        if (room <= 0) break;
+                        subtable_bits += 1;
+                        room <<= 1;
+                    }
 
-    u32 LZ77_window_size = 1 << (CINFO + 8);
+                    if (used + (1u << subtable_bits) > code->capacity) return false;
 
-    u8 FLG = *(data + 1); // Flags
+                    subtable_prefix = prefix;
+                    subtable_offset = used;
+                    used += 1u << subtable_bits;
 
-    u8 FCHECK = (0x1F & FLG);
-    u8 FDICT  = (0x20 & FLG) >> 5;
-    u8 FLEVEL = (0xC0 & FLG) >> 6;
+                    for (u32 i = 0; i < (1u << subtable_bits); i++) {
+                        code->entries[subtable_offset + i] = HUFFMAN_ENTRY(0, HUFFMAN_INVALID, 0, 0);
+                    }
+                    code->entries[prefix] = HUFFMAN_ENTRY(subtable_offset, HUFFMAN_SUBTABLE, subtable_bits, code->root_bits);
+                }
 
-    ASSERT((CMF * 256 + FLG) % 31 == 0); // The FCHECK value must be such that CMF and FLG, when viewed as
-                                         // a 16-bit unsigned integer stored in MSB order (CMF*256 + FLG),
-                                         // is a multiple of 31.
-    ASSERT(FDICT == 0);
+                u32 sub_length = length - code->root_bits;
+                for (u32 slot = reversed >> code->root_bits; slot < (1u << subtable_bits); slot += (1u << sub_length)) {
+                    code->entries[subtable_offset + slot] = entry | sub_length;
+                }
+            }
+        }
+        next_code <<= 1;
+    }
 
-    u8* zlib_data = data + 2;
+    return true;
+}
 
+// @note: Consumes the code and returns its entry. Caller makes sure there are at least 15 bits available.
+INTERNAL INLINE
+u32 decode_huffman(bit_fetcher *fetcher, huffman_code const *huffman) {
+    u32 entry = huffman->entries[fetcher->bits & ((1u << huffman->root_bits) - 1)];
+    if (HUFFMAN_ENTRY_KIND(entry) == HUFFMAN_SUBTABLE) {
+        take_bits(fetcher, huffman->root_bits);
+        entry = huffman->entries[HUFFMAN_ENTRY_VALUE(entry) + (fetcher->bits & ((1u << HUFFMAN_ENTRY_EXTRA(entry)) - 1))];
+    }
+    take_bits(fetcher, HUFFMAN_ENTRY_LENGTH(entry));
+    return entry;
+}
+
+
+struct inflate_state {
     bit_fetcher fetcher;
-    fetcher.buffer = zlib_data;
-    fetcher.bits = 0;
-    fetcher.available_bits = 0;
 
-    u8 BFINAL;
-    u8 BTYPE;
-    do {
-        BFINAL = (u8)get_bits(&fetcher, 1); // ((*zlib_data) & 0b0000'0001);
-        BTYPE  = (u8)get_bits(&fetcher, 2); // ((*zlib_data) & 0b0000'0110) >> 1;
+    u32 litlen_entries[HUFFMAN_LITLEN_TABLE_SIZE];
+    u32 distance_entries[HUFFMAN_DISTANCE_TABLE_SIZE];
+    u32 precode_entries[HUFFMAN_PRECODE_TABLE_SIZE];
 
-        ASSERT(BTYPE != 3); // @debug: reserved value for error!
+    huffman_code litlen;
+    huffman_code distance;
+    huffman_code precode;
+};
 
-        if (BTYPE == 0) { // Stored with no compression.
-            zlib_data += 1; // Skip remaining bits in currently processed byte.
+INTERNAL
+bool generate_fixed_huffman(inflate_state *state) {
+    u8 lengths[HUFFMAN_LITLEN_SYMBOLS + HUFFMAN_DISTANCE_SYMBOLS];
+    for (u32 i = 0; i < 144; i++) lengths[i] = 8;
+    for (u32 i = 144; i < 256; i++) lengths[i] = 9;
+    for (u32 i = 256; i < 280; i++) lengths[i] = 7;
+    for (u32 i = 280; i < 288; i++) lengths[i] = 8;
+    for (u32 i = 0; i < HUFFMAN_DISTANCE_SYMBOLS; i++) lengths[HUFFMAN_LITLEN_SYMBOLS + i] = 5;
+
+    return generate_huffman(&state->litlen, lengths, HUFFMAN_LITLEN_SYMBOLS, huffman_symbols.litlen) &&
+           generate_huffman(&state->distance, lengths + HUFFMAN_LITLEN_SYMBOLS, HUFFMAN_DISTANCE_SYMBOLS, huffman_symbols.distance);
+}
+
+// Reads the code lengths of dynamic block, themselves compressed with the 'precode' (RFC 1951, 3.2.7).
+INTERNAL
+bool generate_dynamic_huffman(inflate_state *state) {
+    bit_fetcher *fetcher = &state->fetcher;
+
+    u32 HLIT  = get_bits(fetcher, 5) + 257;
+    u32 HDIST = get_bits(fetcher, 5) + 1;
+    u32 HCLEN = get_bits(fetcher, 4) + 4;
+
+    if (HLIT > 286 || HDIST > 30) return false;
 
-            u16 LEN = *(u16*)zlib_data;
-            zlib_data += 2;
+    // (HCLEN + 4) x 3 bits: code lengths for the code length
+    // alphabet given just above, in the order: 16, 17, 18,
+    // 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    u8 code_lengths_order[HUFFMAN_PRECODE_SYMBOLS] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    u8 code_lengths[HUFFMAN_PRECODE_SYMBOLS] = {};
 
-            u16 NLEN = *(u16*)zlib_data;
-            zlib_data += 2;
+    for (u32 i = 0; i < HCLEN; i++) {
+        code_lengths[code_lengths_order[i]] = (u8) get_bits(fetcher, 3);
+    }
+
+    if (!generate_huffman(&state->precode, code_lengths, HUFFMAN_PRECODE_SYMBOLS, huffman_symbols.precode)) return false;
+
+    u8 lengths[286 + 30];
+    u32 length_count = HLIT + HDIST;
+    for (u32 i = 0; i < length_count;) {
+        refill_bits(fetcher);
+
+        u32 entry = decode_huffman(fetcher, &state->precode);
+        if (HUFFMAN_ENTRY_KIND(entry) != HUFFMAN_LITERAL) return false;
+
+        u32 symbol = HUFFMAN_ENTRY_VALUE(entry);
+        if (symbol < 16) {
+            lengths[i++] = (u8) symbol;
+            continue;
+        }
 
-            ASSERT(LEN == ~NLEN);
-            // Test this on something.
+        u8 value = 0;
+        u32 repeat = 0;
+        if (symbol == 16) {
+            if (i == 0) return false;
+            value = lengths[i - 1];
+            repeat = 3 + take_bits(fetcher, 2);
+        } else if (symbol == 17) {
+            repeat = 3 + take_bits(fetcher, 3);
         } else {
-            if (BTYPE == 2) { // Compressed with dynamic Huffman code
+            repeat = 11 + take_bits(fetcher, 7);
+        }
+
+        if (i + repeat > length_count) return false;
+        while (repeat--) {
+            lengths[i++] = value;
+        }
+    }
 
-                // read representation of code trees (see subsection below)
+    // Block without the end of block code could not end.
+    if (lengths[256] == 0) return false;
 
-                u32 HLIT  = get_bits(&fetcher, 5) + 257;
-                u32 HDIST = get_bits(&fetcher, 5) + 1;
-                u32 HCLEN = get_bits(&fetcher, 4) + 4;
+    return generate_huffman(&state->litlen, lengths, HLIT, huffman_symbols.litlen) &&
+           generate_huffman(&state->distance, lengths + HLIT, HDIST, huffman_symbols.distance);
+}
 
-                // (HCLEN + 4) x 3 bits: code lengths for the code length
-                // alphabet given just above, in the order: 16, 17, 18,
-                // 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+//
+// Copies the match of LZ77 'length' bytes from 'distance' bytes back. When
+// there is room after it, the copy goes in 16 or 8-byte chunks, which may
+// write up to 15 bytes past the match; they are overwritten later anyway.
+// Chunks never overlap their source: with short distances the pattern is
+// repeated from a register instead.
+//
+// @note: Whole repeats of the pattern of 'distance' bytes in 8 bytes, to not divide per match.
+GLOBAL u8 const png_match_pattern_step[8] = { 0, 8, 8, 6, 8, 5, 6, 7 };
+
+INTERNAL INLINE
+void copy_match(u8 *out, u32 distance, u32 length, u8 *out_end) {
+    u8 const *source = out - distance;
+    u8 *end = out + length;
+
+    if (out_end - end >= 16) {
+        if (distance >= 16) {
+            do {
+                memcpy(out, source, 16);
+                out += 16;
+                source += 16;
+            } while (out < end);
+        } else if (distance >= 8) {
+            do {
+                memcpy(out, source, 8);
+                out += 8;
+                source += 8;
+            } while (out < end);
+        } else {
+            // After a multiple of distance bytes the pattern starts over.
+            u8 pattern[8];
+            for (u32 i = 0; i < distance; i++) {
+                pattern[i] = source[i];
+            }
+            for (u32 i = distance; i < 8; i++) {
+                pattern[i] = pattern[i - distance];
+            }
+            u32 step = png_match_pattern_step[distance];
+            do {
+                memcpy(out, pattern, 8);
+                out += step;
+            } while (out < end);
+        }
+    } else {
+        for (u32 i = 0; i < length; i++) {
+            out[i] = source[i];
+        }
+    }
+}
 
-                ASSERT(HCLEN <= 19);
-                u8 code_lengths_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
-                u8 code_lengths[19] {};
+// Output room the fast loop needs: three literals and the longest match, plus what chunked copies write past it.
+#define INFLATE_FAST_OUTPUT_MARGIN (3 + 258 + 16)
 
-                for (u32 i = 0; i < HCLEN; i++) {
-                    code_lengths[code_lengths_order[i]] = (u8)get_bits(&fetcher, 3);
+//
+// Decodes one block of Huffman codes. The fetcher and the tables are copied
+// to locals, otherwise every byte written to the output could alias them and
+// they would be reloaded from memory after each one.
+//
+// While there is room for the longest match, output is not checked per
+// literal, and up to three literals are decoded after one refill:
+// 56 bits are enough for three codes of at most 15 bits.
+//
+INTERNAL
+bool inflate_huffman_block(inflate_state *state, u8 *out_begin, u8 **out_pointer, u8 *out_end) {
+    bit_fetcher fetcher = state->fetcher;
+    huffman_code const litlen = state->litlen;
+    huffman_code const distances = state->distance;
+
+    u8 *out = *out_pointer;
+    u8 *out_fast_end = (out_end - out > INFLATE_FAST_OUTPUT_MARGIN) ? out_end - INFLATE_FAST_OUTPUT_MARGIN : out;
+
+    bool success = true;
+    loop {
+        refill_bits(&fetcher);
+
+        u32 entry = decode_huffman(&fetcher, &litlen);
+        if (out < out_fast_end) {
+            if (HUFFMAN_ENTRY_KIND(entry) == HUFFMAN_LITERAL) {
+                *out++ = (u8) HUFFMAN_ENTRY_VALUE(entry);
+                entry = decode_huffman(&fetcher, &litlen);
+                if (HUFFMAN_ENTRY_KIND(entry) == HUFFMAN_LITERAL) {
+                    *out++ = (u8) HUFFMAN_ENTRY_VALUE(entry);
+                    entry = decode_huffman(&fetcher, &litlen);
+                    if (HUFFMAN_ENTRY_KIND(entry) == HUFFMAN_LITERAL) {
+                        *out++ = (u8) HUFFMAN_ENTRY_VALUE(entry);
+                        continue;
+                    }
                 }
+                // Length and distance with their extra bits take up to 33 bits more.
+                refill_bits(&fetcher);
+            }
+        } else if (HUFFMAN_ENTRY_KIND(entry) == HUFFMAN_LITERAL) {
+            if (out == out_end) {
+                success = false;
+                break;
+            }
+            *out++ = (u8) HUFFMAN_ENTRY_VALUE(entry);
+            continue;
+        }
 
-                // DEFLATE algorithm to generate codes
-                // 1) Count the number of codes for each code length.
-                //    Let bl_count[N] be the number of codes of length N, N >= 1.
+        if (HUFFMAN_ENTRY_KIND(entry) == HUFFMAN_END_OF_BLOCK) break;
+        if (HUFFMAN_ENTRY_KIND(entry) != HUFFMAN_LENGTH) {
+            success = false;
+            break;
+        }
 
-                u32 bl_count[19] {};
+        u32 length = HUFFMAN_ENTRY_VALUE(entry) + take_bits(&fetcher, HUFFMAN_ENTRY_EXTRA(entry));
 
-                for (int i = 0; i < 19; i++) {
-                    bl_count[code_lengths[i]]++;
-                }
+        entry = decode_huffman(&fetcher, &distances);
+        if (HUFFMAN_ENTRY_KIND(entry) != HUFFMAN_DISTANCE) {
+            success = false;
+            break;
+        }
 
-                // 2) Find the numerical value of the smallest code for each code length:
+        u32 distance = HUFFMAN_ENTRY_VALUE(entry) + take_bits(&fetcher, HUFFMAN_ENTRY_EXTRA(entry));
 
-                i32 code = 0;
-                bl_count[0] = 0;
-                u32 next_code[16] {};
+        if ((distance > (usize) (out - out_begin)) || (length > (usize) (out_end - out))) {
+            success = false;
+            break;
+        }
 
-                for (u32 bits = 1; bits < 16; bits++) {
-                    code = (code + bl_count[bits-1]) << 1;
-                    next_code[bits] = code;
-                }
+        copy_match(out, distance, length, out_end);
+        out += length;
+    }
+
+    state->fetcher = fetcher;
+    *out_pointer = out;
+    return success;
+}
+
+INTERNAL
+bool inflate_stored_block(bit_fetcher *fetcher, u8 **out_pointer, u8 *out_end) {
+    // Skip remaining bits in currently processed byte.
+    if (!align_bits_to_byte(fetcher)) return false;
+    if (fetcher->end - fetcher->at < 4) return false;
+
+    u32 LEN  = fetcher->at[0] | (fetcher->at[1] << 8);
+    u32 NLEN = fetcher->at[2] | (fetcher->at[3] << 8);
+    fetcher->at += 4;
+
+    if (LEN != (~NLEN & 0xFFFF)) return false;
+    if ((usize) (fetcher->end - fetcher->at) < LEN || (usize) (out_end - *out_pointer) < LEN) return false;
+
+    memcpy(*out_pointer, fetcher->at, LEN);
+    *out_pointer += LEN;
+    fetcher->at += LEN;
+    return true;
+}
+
+INTERNAL
+u32 compute_adler32(u8 const *data, usize size) {
+    u32 a = 1;
+    u32 b = 0;
+
+    while (size > 0) {
+        // 5552 is the most bytes before b could overflow 32 bits.
+        usize n = (size < 5552) ? size : 5552;
+        size -= n;
+
+        for (; n >= 4; n -= 4) {
+            a += data[0]; b += a;
+            a += data[1]; b += a;
+            a += data[2]; b += a;
+            a += data[3]; b += a;
+            data += 4;
+        }
+        for (; n > 0; n--) {
+            a += *data++; b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+    }
+
+    return (b << 16) | a;
+}
+
+//
+// Decompresses zlib stream into the output buffer of known size, and
+// checks its Adler-32. Returns false on corrupted or truncated input and
+// when the output does not fit.
+//
+bool inflate_zlib(u8 const *data, usize size, u8 *output, usize output_capacity, usize *output_size) {
+    if (size < 6) return false;
+
+    u8 CMF = data[0];
+    u8 FLG = data[1];
+
+    // CM=8 denotes 'deflate' algorithm of compression
+    // CINFO = log_2(LZ77_window_size) - 8, above 7 are not allowed by the specification
+    // The FCHECK value must be such that CMF and FLG, when viewed as
+    // a 16-bit unsigned integer stored in MSB order (CMF*256 + FLG),
+    // is a multiple of 31.
+    if ((CMF & 0x0F) != 8 || (CMF >> 4) > 7) return false;
+    if ((CMF * 256 + FLG) % 31 != 0) return false;
+    if (FLG & 0x20) return false; // FDICT: preset dictionaries are not used in PNG.
+
+    inflate_state *state = (inflate_state *) malloc(sizeof(inflate_state));
+    if (state == NULL) return false;
+
+    state->litlen = { state->litlen_entries, HUFFMAN_LITLEN_TABLE_SIZE, HUFFMAN_LITLEN_ROOT_BITS };
+    state->distance = { state->distance_entries, HUFFMAN_DISTANCE_TABLE_SIZE, HUFFMAN_DISTANCE_ROOT_BITS };
+    state->precode = { state->precode_entries, HUFFMAN_PRECODE_TABLE_SIZE, HUFFMAN_PRECODE_ROOT_BITS };
+
+    bit_fetcher *fetcher = &state->fetcher;
+    fetcher->at = data + 2;
+    fetcher->end = data + size;
+    fetcher->bits = 0;
+    fetcher->available_bits = 0;
+    fetcher->overrun_bytes = 0;
+
+    u8 *out = output;
+    u8 *out_end = output + output_capacity;
+
+    bool success = true;
+    u32 BFINAL = 0;
+    while (success && BFINAL == 0) {
+        BFINAL = get_bits(fetcher, 1);
+        u32 BTYPE = get_bits(fetcher, 2);
 
-                // u32 max_code; // should be used later? ??
-
-                // 3) Assign numerical values to all codes, using consecutive
-                //    values for all codes of the same length with the base
-                //    values determined at step 2. Codes that are never used
-                //    (which have a bit length of zero) must not be assigned a
-                //    value.
-
-                // for (u32 n = 0;  n <= max_code; n++) {
-                //     len = tree[n].Len;
-                //     if (len != 0) {
-                //         tree[n].Code = next_code[len];
-                //         next_code[len]++;
-                //     }
-                // }
-
-            } else if (BTYPE == 1) {
-                // Compressed with fixed Huffman code
-                // ???
+        if (BTYPE == 0) { // Stored with no compression.
+            success = inflate_stored_block(fetcher, &out, out_end);
+        } else if (BTYPE == 1) { // Compressed with fixed Huffman code
+            success = generate_fixed_huffman(state) && inflate_huffman_block(state, output, &out, out_end);
+        } else if (BTYPE == 2) { // Compressed with dynamic Huffman code
+            success = generate_dynamic_huffman(state) && inflate_huffman_block(state, output, &out, out_end);
+        } else {
+            success = false; // Reserved value for error!
+        }
+
+        success = success && !is_input_overrun(fetcher);
+    }
+
+    // Adler-32 of the uncompressed data follows the last block, in MSB order.
+    success = success && align_bits_to_byte(fetcher) && (fetcher->end - fetcher->at >= 4);
+    success = success && (png::read_u32_be(fetcher->at) == compute_adler32(output, out - output));
+
+    free(state);
+
+    *output_size = out - output;
+    return success;
+}
+
+
+//
+// Unfiltering
+//
+// Every scanline starts with the filter type byte, and the filters predict
+// the byte from the ones of the pixel to the left (a), above (b) and above
+// to the left (c), whole pixels of at least one byte apart:
+//
+//     c b
+//     a x
+//
+INTERNAL INLINE
+u8 paeth_predictor(i32 a, i32 b, i32 c) {
+    i32 p = a + b - c;
+    i32 pa = abs(p - a);
+    i32 pb = abs(p - b);
+    i32 pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return (u8) a;
+    if (pb <= pc) return (u8) b;
+    return (u8) c;
+}
+
+// @note: Unfilters the row in place; 'previous' is the unfiltered row above, zeros for the first one.
+//        Vector kernels are checked against this one.
+INTERNAL
+bool unfilter_png_row_scalar(u8 filter, u8 *row, u8 const *previous, usize row_size, u32 bpp) {
+    switch (filter) {
+        case PNG_FILTER_NONE:
+            break;
+
+        case PNG_FILTER_SUB:
+            for (usize i = bpp; i < row_size; i++) {
+                row[i] = (u8) (row[i] + row[i - bpp]);
             }
+            break;
 
-#if 0
-            while (true /* until end of block recognized */) {
-                huffman_code test_ {};
-                u32 literal_length_value = decode_huffman(&test_);
-                if (literal_length_value < 256) {
-                    // copy value (literal byte) to output stream
-                } else {
-                    if (literal_length_value == 256) // end of block
-                        break;
-                    else {
-                        // decode distance from input stream
+        case PNG_FILTER_UP:
+            for (usize i = 0; i < row_size; i++) {
+                row[i] = (u8) (row[i] + previous[i]);
+            }
+            break;
 
-                        // move backwards distance bytes in the output
-                        // stream, and copy length bytes from this
-                        // position to the output stream.
+        case PNG_FILTER_AVERAGE:
+            for (usize i = 0; i < bpp && i < row_size; i++) {
+                row[i] = (u8) (row[i] + (previous[i] >> 1));
+            }
+            for (usize i = bpp; i < row_size; i++) {
+                row[i] = (u8) (row[i] + ((row[i - bpp] + previous[i]) >> 1));
+            }
+            break;
 
-                    }
+        case PNG_FILTER_PAETH:
+            for (usize i = 0; i < bpp && i < row_size; i++) {
+                row[i] = (u8) (row[i] + previous[i]);
+            }
+            for (usize i = bpp; i < row_size; i++) {
+                row[i] = (u8) (row[i] + paeth_predictor(row[i - bpp], previous[i], previous[i - bpp]));
+            }
+            break;
+
+        default:
+            return false;
+    }
+    return true;
+}
+
+
+#if PNG_SSE2
+
+//
+// Vector kernels, SSE2
+//
+// Sub, Average and Paeth depend on the pixel to the left, so they can not
+// go 16 bytes at a time. Instead, one whole pixel of 3, 4, 6 or 8 bytes
+// is kept in a register, and all of its bytes are predicted at once:
+//
+//     c ← b     row above   (previous)
+//     ↓   ↓
+//     a ← x     this row, 'a' stays in the register for the next pixel
+//
+// Up has no such dependency and is done 16 bytes at a time. Sub of 4 and
+// 8-byte pixels adds 16 bytes of them at once, as a prefix sum in the
+// register. Rows of 1 and 2-byte pixels go to the scalar loops; there is too
+// little work in one pixel for a register.
+//
+
+// @note: Pixels of 3 and 6 bytes are put together from smaller loads, memcpy of 3 bytes would go through the stack.
+template <u32 BPP>
+INTERNAL INLINE
+__m128i load_png_pixel(u8 const *p) {
+    if (BPP == 8) {
+        return _mm_loadl_epi64((__m128i const *) p);
+    } else if (BPP == 6) {
+        u32 low;
+        u16 high;
+        memcpy(&low, p, 4);
+        memcpy(&high, p + 4, 2);
+        return _mm_insert_epi16(_mm_cvtsi32_si128((int) low), high, 2);
+    } else if (BPP == 4) {
+        u32 value;
+        memcpy(&value, p, 4);
+        return _mm_cvtsi32_si128((int) value);
+    } else {
+        u16 low;
+        memcpy(&low, p, 2);
+        return _mm_cvtsi32_si128((int) (low | (p[2] << 16)));
+    }
+}
+
+template <u32 BPP>
+INTERNAL INLINE
+void store_png_pixel(u8 *p, __m128i pixel) {
+    if (BPP == 8) {
+        _mm_storel_epi64((__m128i *) p, pixel);
+    } else if (BPP == 6) {
+        u32 low = (u32) _mm_cvtsi128_si32(pixel);
+        u16 high = (u16) _mm_extract_epi16(pixel, 2);
+        memcpy(p, &low, 4);
+        memcpy(p + 4, &high, 2);
+    } else if (BPP == 4) {
+        u32 value = (u32) _mm_cvtsi128_si32(pixel);
+        memcpy(p, &value, 4);
+    } else {
+        u32 value = (u32) _mm_cvtsi128_si32(pixel);
+        u16 low = (u16) value;
+        memcpy(p, &low, 2);
+        p[2] = (u8) (value >> 16);
+    }
+}
+
+INTERNAL
+void unfilter_png_row_up_sse2(u8 *row, u8 const *previous, usize row_size) {
+    usize i = 0;
+    for (; i + 16 <= row_size; i += 16) {
+        __m128i x = _mm_loadu_si128((__m128i const *) (row + i));
+        __m128i b = _mm_loadu_si128((__m128i const *) (previous + i));
+        _mm_storeu_si128((__m128i *) (row + i), _mm_add_epi8(x, b));
+    }
+    for (; i < row_size; i++) {
+        row[i] = (u8) (row[i] + previous[i]);
+    }
+}
+
+template <u32 BPP>
+INTERNAL
+void unfilter_png_row_sub_sse2(u8 *row, usize row_size) {
+    __m128i a = _mm_setzero_si128();
+    usize i = 0;
+
+    if (BPP == 4 || BPP == 8) {
+        // Prefix sum of the pixels in the register, then the last one is carried to the next 16 bytes.
+        for (; i + 16 <= row_size; i += 16) {
+            __m128i x = _mm_loadu_si128((__m128i const *) (row + i));
+            if (BPP == 4) {
+                x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+            }
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi8(x, a);
+            _mm_storeu_si128((__m128i *) (row + i), x);
+            a = (BPP == 4) ? _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3)) : _mm_unpackhi_epi64(x, x);
+        }
+    }
+
+    for (; i + BPP <= row_size; i += BPP) {
+        a = _mm_add_epi8(a, load_png_pixel<BPP>(row + i));
+        store_png_pixel<BPP>(row + i, a);
+    }
+}
+
+template <u32 BPP>
+INTERNAL
+void unfilter_png_row_average_sse2(u8 *row, u8 const *previous, usize row_size) {
+    __m128i const one = _mm_set1_epi8(1);
+    __m128i a = _mm_setzero_si128();
+
+    usize i = 0;
+    for (; i + BPP <= row_size; i += BPP) {
+        __m128i b = load_png_pixel<BPP>(previous + i);
+        __m128i x = load_png_pixel<BPP>(row + i);
+
+        // (a + b) >> 1 without overflow: pavgb rounds up, so the lost low bit is taken back.
+        __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(x, average);
+        store_png_pixel<BPP>(row + i, a);
+    }
+}
+
+INTERNAL INLINE
+__m128i abs_i16_sse2(__m128i x) {
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+INTERNAL INLINE
+__m128i select_sse2(__m128i condition, __m128i then_value, __m128i else_value) {
+    return _mm_or_si128(_mm_and_si128(condition, then_value), _mm_andnot_si128(condition, else_value));
+}
+
+//
+// Paeth predictor of every byte at once, in 16-bit lanes, without branches:
+//
+//     p = a + b - c,  pa = |p - a| = |b - c|,  pb = |p - b| = |a - c|,
+//     pc = |p - c| = |(b - c) + (a - c)|
+//
+// and the first of a, b, c with the smallest distance wins, as in the
+// scalar paeth_predictor.
+//
+template <u32 BPP>
+INTERNAL
+void unfilter_png_row_paeth_sse2(u8 *row, u8 const *previous, usize row_size) {
+    __m128i const zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+
+    usize i = 0;
+    for (; i + BPP <= row_size; i += BPP) {
+        __m128i b = _mm_unpacklo_epi8(load_png_pixel<BPP>(previous + i), zero);
+        __m128i x = _mm_unpacklo_epi8(load_png_pixel<BPP>(row + i), zero);
+
+        __m128i pa = _mm_sub_epi16(b, c);
+        __m128i pb = _mm_sub_epi16(a, c);
+        __m128i pc = abs_i16_sse2(_mm_add_epi16(pa, pb));
+        pa = abs_i16_sse2(pa);
+        pb = abs_i16_sse2(pb);
+
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        __m128i nearest = select_sse2(_mm_cmpeq_epi16(pa, smallest), a,
+                          select_sse2(_mm_cmpeq_epi16(pb, smallest), b, c));
+
+        // @note: Sum of two bytes in a 16-bit lane, the byte add keeps it below 256.
+        a = _mm_add_epi8(x, nearest);
+        store_png_pixel<BPP>(row + i, _mm_packus_epi16(a, a));
+        c = b;
+    }
+}
+
+// @note: Returns false when there is no kernel for the filter and pixel size, the scalar loop does the row then.
+INTERNAL
+bool unfilter_png_row_sse2(u8 filter, u8 *row, u8 const *previous, usize row_size, u32 bpp) {
+    // Pixels of 8 and 16-bit samples are whole bytes, so their rows are whole pixels.
+    ASSERT(bpp < 3 || row_size % bpp == 0);
+
+    if (filter == PNG_FILTER_UP) {
+        unfilter_png_row_up_sse2(row, previous, row_size);
+        return true;
+    } else if (filter == PNG_FILTER_SUB) {
+        switch (bpp) {
+            case 3: unfilter_png_row_sub_sse2<3>(row, row_size); break;
+            case 4: unfilter_png_row_sub_sse2<4>(row, row_size); break;
+            case 6: unfilter_png_row_sub_sse2<6>(row, row_size); break;
+            case 8: unfilter_png_row_sub_sse2<8>(row, row_size); break;
+            default: return false;
+        }
+    } else if (filter == PNG_FILTER_AVERAGE) {
+        switch (bpp) {
+            case 3: unfilter_png_row_average_sse2<3>(row, previous, row_size); break;
+            case 4: unfilter_png_row_average_sse2<4>(row, previous, row_size); break;
+            case 6: unfilter_png_row_average_sse2<6>(row, previous, row_size); break;
+            case 8: unfilter_png_row_average_sse2<8>(row, previous, row_size); break;
+            default: return false;
+        }
+    } else if (filter == PNG_FILTER_PAETH) {
+        switch (bpp) {
+            case 3: unfilter_png_row_paeth_sse2<3>(row, previous, row_size); break;
+            case 4: unfilter_png_row_paeth_sse2<4>(row, previous, row_size); break;
+            case 6: unfilter_png_row_paeth_sse2<6>(row, previous, row_size); break;
+            case 8: unfilter_png_row_paeth_sse2<8>(row, previous, row_size); break;
+            default: return false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif // PNG_SSE2
+
+INTERNAL
+bool unfilter_png_row(u8 filter, u8 *row, u8 const *previous, usize row_size, u32 bpp) {
+#if PNG_SSE2
+    if (unfilter_png_row_sse2(filter, row, previous, row_size, bpp)) return true;
+#endif // PNG_SSE2
+    return unfilter_png_row_scalar(filter, row, previous, row_size, bpp);
+}
+
+
+//
+// Decoding
+//
+
+struct png_image_info {
+    u32 width;
+    u32 height;
+    u8  bit_depth;
+    u8  color_type;
+    u8  interlace_method;
+
+    u32 channels;        // samples per pixel in the file
+    u32 filter_bpp;      // bytes per whole pixel, at least 1
+    u32 output_channels; // bytes per pixel of the bitmap
+
+    u8  palette[256 * 4];
+    u32 palette_size;
+
+    bool has_transparent_color; // tRNS of grayscale or truecolor image
+    u16  transparent_color[3];
+};
+
+INTERNAL
+usize get_png_row_size(png_image_info const *info, u32 width) {
+    return ((usize) width * info->channels * info->bit_depth + 7) / 8;
+}
+
+// Adam7 passes: the first pixel and the step between pixels of each of them.
+GLOBAL u32 const png_adam7_x0[7] = { 0, 4, 0, 2, 0, 1, 0 };
+GLOBAL u32 const png_adam7_y0[7] = { 0, 0, 4, 0, 2, 0, 1 };
+GLOBAL u32 const png_adam7_dx[7] = { 8, 8, 4, 4, 2, 2, 1 };
+GLOBAL u32 const png_adam7_dy[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+INTERNAL
+u32 get_png_pass_count(png_image_info const *info) {
+    return (info->interlace_method == PNG_INTERLACE_ADAM7) ? 7 : 1;
+}
+
+// @note: Size of the pass in pixels, the whole image is one pass without interlacing. Passes can be empty.
+INTERNAL
+void get_png_pass_size(png_image_info const *info, u32 pass, u32 *width, u32 *height) {
+    if (info->interlace_method == PNG_INTERLACE_ADAM7) {
+        *width  = (info->width  + png_adam7_dx[pass] - png_adam7_x0[pass] - 1) / png_adam7_dx[pass];
+        *height = (info->height + png_adam7_dy[pass] - png_adam7_y0[pass] - 1) / png_adam7_dy[pass];
+    } else {
+        *width = info->width;
+        *height = info->height;
+    }
+}
+
+// Converts unfiltered row to 8-bit samples of the output format: palette is expanded,
+// 16-bit samples lose the low byte, and the transparent color gets the alpha channel.
+INTERNAL
+void convert_png_row(png_image_info const *info, u8 const *row, u32 width, u8 *out) {
+    u32 depth = info->bit_depth;
+
+    if (info->color_type == 3) {
+        u32 out_n = info->output_channels;
+        for (u32 x = 0; x < width; x++) {
+            u32 index;
+            if (depth == 8) {
+                index = row[x];
+            } else {
+                u32 bit = x * depth;
+                index = (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+            }
+            memcpy(out + x * out_n, info->palette + index * 4, out_n);
+        }
+        return;
+    }
+
+    u32 n = info->channels;
+    if (depth == 8 && !info->has_transparent_color) {
+        memcpy(out, row, (usize) width * n);
+        return;
+    }
+
+    // Low bit depths are only allowed for grayscale, which is scaled to the whole 0..255 range.
+    u8 const scale[9] = { 0, 0xFF, 0x55, 0, 0x11, 0, 0, 0, 0x01 };
+
+    u32 out_n = info->output_channels;
+    for (u32 x = 0; x < width; x++) {
+        bool transparent = info->has_transparent_color;
+        for (u32 k = 0; k < n; k++) {
+            u32 sample;
+            u8 value;
+            if (depth == 16) {
+                sample = (row[(x * n + k) * 2] << 8) | row[(x * n + k) * 2 + 1];
+                value = (u8) (sample >> 8);
+            } else if (depth == 8) {
+                sample = row[x * n + k];
+                value = (u8) sample;
+            } else {
+                u32 bit = x * depth;
+                sample = (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+                value = (u8) (sample * scale[depth]);
+            }
+            transparent = transparent && (sample == info->transparent_color[k]);
+            out[x * out_n + k] = value;
+        }
+        if (info->has_transparent_color) {
+            out[x * out_n + n] = transparent ? 0 : 255;
+        }
+    }
+}
+
+// @note: Rows of the bitmap go bottom-up, as the renderer expects.
+INTERNAL
+u8 *get_bitmap_row(Bitmap *bitmap, u32 y) {
+    return (u8 *) bitmap->pixels + (usize) (bitmap->height - 1 - y) * bitmap->width * bitmap->bytes_per_pixel;
+}
+
+INTERNAL
+bool decode_png_image(png_image_info const *info, u8 *raw, usize raw_size, Bitmap *result) {
+    bool interlaced = (info->interlace_method == PNG_INTERLACE_ADAM7);
+
+    usize max_row_size = get_png_row_size(info, info->width);
+    u8 *zero_row = (u8 *) calloc(max_row_size + 1, 1);
+    u8 *converted = interlaced ? (u8 *) malloc((usize) info->width * info->output_channels) : NULL;
+
+    bool success = (zero_row != NULL) && (!interlaced || converted != NULL);
+
+    u8 *at = raw;
+    for (u32 pass = 0; success && pass < get_png_pass_count(info); pass++) {
+        u32 pass_width, pass_height;
+        get_png_pass_size(info, pass, &pass_width, &pass_height);
+        if (pass_width == 0 || pass_height == 0) continue;
+
+        usize row_size = get_png_row_size(info, pass_width);
+        if ((usize) (raw + raw_size - at) < (row_size + 1) * pass_height) {
+            success = false;
+            break;
+        }
+
+        u8 const *previous = zero_row + 1;
+        for (u32 y = 0; y < pass_height; y++) {
+            u8 *row = at + 1;
+            if (!unfilter_png_row(at[0], row, previous, row_size, info->filter_bpp)) {
+                success = false;
+                break;
+            }
+
+            if (interlaced) {
+                convert_png_row(info, row, pass_width, converted);
+
+                u8 *out = get_bitmap_row(result, png_adam7_y0[pass] + y * png_adam7_dy[pass]);
+                u32 n = info->output_channels;
+                for (u32 x = 0; x < pass_width; x++) {
+                    memcpy(out + (usize) (png_adam7_x0[pass] + x * png_adam7_dx[pass]) * n, converted + (usize) x * n, n);
                 }
+            } else {
+                convert_png_row(info, row, pass_width, get_bitmap_row(result, y));
             }
-#endif
 
+            previous = row;
+            at += row_size + 1;
         }
-    } while (BFINAL == 0);
-
-    u8 debug_ = 0;
-
-    // do
-    //    read block header from input stream.
-    //    if stored with no compression
-    //       skip any remaining bits in current partially
-    //          processed byte
-    //       read LEN and NLEN (see next section)
-    //       copy LEN bytes of data to output
-    //    otherwise
-    //       if compressed with dynamic Huffman codes
-    //          read representation of code trees (see
-    //             subsection below)
-    //       loop (until end of block code recognized)
-    //          decode literal/length value from input stream
-    //          if value < 256
-    //             copy value (literal byte) to output stream
-    //          otherwise
-    //             if value = end of block (256)
-    //                break from loop
-    //             otherwise (value = 257..285)
-    //                decode distance from input stream
-
-    //                move backwards distance bytes in the output
-    //                stream, and copy length bytes from this
-    //                position to the output stream.
-    //       end loop
-    // while not last block
-}
-
-Bitmap load_png_file_myself(const char *filename) {
+    }
+
+    free(converted);
+    free(zero_row);
+    return success;
+}
+
+INTERNAL
+bool read_png_header(u8 const *data, u32 size, png_image_info *info) {
+    if (size != sizeof(PNG_IHDRHeader)) return false;
+
+    PNG_IHDRHeader ihdr;
+    memcpy(&ihdr, data, sizeof(ihdr));
+
+    info->width = change_endianess(ihdr.width);
+    info->height = change_endianess(ihdr.height);
+    info->bit_depth = ihdr.bit_depth;
+    info->color_type = ihdr.color_type;
+    info->interlace_method = ihdr.interlace_method;
+
+    // @note: Sanity limit, so sizes of the buffers can not overflow.
+    if (info->width == 0 || info->height == 0 || info->width > (1u << 24) || info->height > (1u << 24)) return false;
+    if ((u64) info->width * info->height > (1ull << 30)) return false;
+
+    // Only compression method 0 (deflate/inflate compression with
+    // a sliding window of at most 32768 bytes) is defined.
+    // All standard PNG images must be compressed with this scheme.
+    if (ihdr.compression_method != 0 || ihdr.filter_method != 0) return false;
+    if (ihdr.interlace_method != PNG_INTERLACE_NONE && ihdr.interlace_method != PNG_INTERLACE_ADAM7) return false;
+
+    u32 depth = info->bit_depth;
+    switch (info->color_type) {
+        case 0: info->channels = 1; if (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16) return false; break;
+        case 2: info->channels = 3; if (depth != 8 && depth != 16) return false; break;
+        case 3: info->channels = 1; if (depth != 1 && depth != 2 && depth != 4 && depth != 8) return false; break;
+        case 4: info->channels = 2; if (depth != 8 && depth != 16) return false; break;
+        case 6: info->channels = 4; if (depth != 8 && depth != 16) return false; break;
+        default: return false;
+    }
+
+    info->filter_bpp = (info->channels * depth + 7) / 8;
+    info->output_channels = info->channels;
+    return true;
+}
+
+Bitmap decode_png(void const *data, usize size) {
     Bitmap result {};
 
-    byte_array contents = os::load_entire_file(filename);
+    u8 const *at = (u8 const *) data;
+    u8 const *end = at + size;
+
+    if (size < 8) return result;
 
-    u8 *data = (u8 *) contents.get_data();
+    u32 signature1, signature2;
+    memcpy(&signature1, at, sizeof(signature1));
+    memcpy(&signature2, at + 4, sizeof(signature2));
+    if (signature1 != PNG_SIGNATURE_1 || signature2 != PNG_SIGNATURE_2) return result;
+    at += 8;
 
-    u32 signature1 = *PNG_CONSUME_STRUCT(data, u32);
-    u32 signature2 = *PNG_CONSUME_STRUCT(data, u32);
+    png_image_info info {};
+    for (u32 i = 0; i < 256; i++) {
+        info.palette[i * 4 + 3] = 255;
+    }
 
-    ASSERT(signature1 == PNG_SIGNATURE_1);
-    ASSERT(signature2 == PNG_SIGNATURE_2);
+    bool has_header = false;
+    bool success = true;
 
-    bool end = false;
+    // IDAT chunks are parts of one zlib stream; when there are many of them, they are joined.
+    u8 const *idat = NULL;
+    usize idat_size = 0;
+    u8 *joined = NULL;
+    usize joined_capacity = 0;
 
-    while (data < ((u8 *)contents.data + contents.size)) {
+    bool end_found = false;
+    while (success && !end_found) {
         //
         // Chunks of PNG file follow this layout:
         //
@@ -333,48 +1269,132 @@ Bitmap load_png_file_myself(const char *filename) {
         // +-------------------+-------------+----------------+
         // |<-    8 bytes    ->|<- N bytes ->|<-  4  bytes  ->|
         //
+        if (end - at < 12) {
+            success = false;
+            break;
+        }
 
-        PNG_ChunkHeader chunk_header = *PNG_CONSUME_STRUCT(data, PNG_ChunkHeader);
+        PNG_ChunkHeader chunk_header;
+        memcpy(&chunk_header, at, sizeof(chunk_header));
         chunk_header.size_of_data = change_endianess(chunk_header.size_of_data);
 
-        u32 chunk_type_size = sizeof(chunk_header.type);
-        png::crc_t computed_crc = change_endianess(compute_crc(data - chunk_type_size, chunk_header.size_of_data + chunk_type_size));
-
-        if (chunk_header.type == PNG_IHDR_ID) {
-            PNG_IHDRHeader *ihdr = PNG_CONSUME_STRUCT(data, PNG_IHDRHeader);
-
-            result.width = change_endianess(ihdr->width);
-            result.height = change_endianess(ihdr->height);
-            result.bytes_per_pixel = ihdr->bit_depth / 8;
-            result.size = result.width * result.height * result.bytes_per_pixel;
-            result.pixels = malloc(result.size);
+        if (chunk_header.size_of_data > (usize) (end - at) - 12) {
+            success = false;
+            break;
+        }
 
-            // Only compression method 0 (deflate/inflate compression with
-            // a sliding window of at most 32768 bytes) is defined.
-            // All standard PNG images must be compressed with this scheme.
-            ASSERT(ihdr->compression_method == 0);
+        u8 const *chunk = at + sizeof(PNG_ChunkHeader);
+        u32 chunk_size = chunk_header.size_of_data;
 
-            // Adam7 interlace method is not supported.
-            ASSERT(ihdr->interlace_method == PNG_INTERLACE_NONE);
+        u32 chunk_type_size = sizeof(chunk_header.type);
+        png::crc_t computed_crc = compute_crc(chunk - chunk_type_size, chunk_size + chunk_type_size);
+        if (png::read_u32_be(chunk + chunk_size) != computed_crc) {
+            success = false;
+            break;
         }
 
-        if (chunk_header.type == PNG_sRGB_ID) {
-            PNG_RenderingIntent *rendering_intent = PNG_CONSUME_STRUCT(data, PNG_RenderingIntent);
+        if (!has_header && chunk_header.type != PNG_IHDR_ID) {
+            success = false;
+            break;
         }
 
-        if (chunk_header.type == PNG_IDAT_ID) {
-            decode_idat_chunk(data, chunk_header.size_of_data, &result);
-            data += chunk_header.size_of_data;
+        if (chunk_header.type == PNG_IHDR_ID) {
+            success = !has_header && read_png_header(chunk, chunk_size, &info);
+            has_header = true;
+        } else if (chunk_header.type == PNG_PLTE_ID) {
+            success = (chunk_size % 3 == 0) && (chunk_size / 3 <= 256);
+            info.palette_size = chunk_size / 3;
+            for (u32 i = 0; success && i < info.palette_size; i++) {
+                memcpy(info.palette + i * 4, chunk + i * 3, 3);
+            }
+        } else if (chunk_header.type == PNG_tRNS_ID) {
+            if (idat) {
+                success = false;
+            } else if (info.color_type == 3) {
+                success = (info.palette_size > 0) && (chunk_size <= info.palette_size);
+                for (u32 i = 0; success && i < chunk_size; i++) {
+                    info.palette[i * 4 + 3] = chunk[i];
+                }
+                info.output_channels = 4;
+            } else if (info.color_type == 0 || info.color_type == 2) {
+                success = (chunk_size == info.channels * 2);
+                for (u32 k = 0; success && k < info.channels; k++) {
+                    info.transparent_color[k] = (u16) ((chunk[k * 2] << 8) | chunk[k * 2 + 1]);
+                }
+                info.has_transparent_color = true;
+                info.output_channels = info.channels + 1;
+            } else {
+                success = false; // Images with alpha channel can not have tRNS.
+            }
+        } else if (chunk_header.type == PNG_IDAT_ID) {
+            if (idat == NULL) {
+                idat = chunk;
+                idat_size = chunk_size;
+            } else {
+                if (joined == NULL || idat_size + chunk_size > joined_capacity) {
+                    joined_capacity = 2 * (idat_size + chunk_size);
+                    u8 *buffer = (u8 *) realloc(joined, joined_capacity);
+                    if (buffer == NULL) {
+                        success = false;
+                        break;
+                    }
+                    if (joined == NULL) {
+                        memcpy(buffer, idat, idat_size);
+                    }
+                    joined = buffer;
+                    idat = joined;
+                }
+                memcpy(joined + idat_size, chunk, chunk_size);
+                idat_size += chunk_size;
+            }
+        } else if (chunk_header.type == PNG_IEND_ID) {
+            // IEND chunk has no data.
+            end_found = true;
+        } else if ((chunk_header.type & 0x20) == 0) {
+            success = false; // Unknown critical chunk, its first letter is uppercase.
         }
 
-        if (chunk_header.type == PNG_IEND_ID) {
-            // IEND chunk has no data.
-            end = true;
+        at = chunk + chunk_size + sizeof(png::crc_t);
+    }
+
+    if (success && info.color_type == 3) {
+        success = (info.palette_size > 0);
+        info.output_channels = (info.output_channels == 4) ? 4 : 3;
+    }
+    success = success && (idat != NULL);
+
+    u8 *raw = NULL;
+    usize raw_size = 0;
+    if (success) {
+        for (u32 pass = 0; pass < get_png_pass_count(&info); pass++) {
+            u32 pass_width, pass_height;
+            get_png_pass_size(&info, pass, &pass_width, &pass_height);
+            if (pass_width && pass_height) {
+                raw_size += (get_png_row_size(&info, pass_width) + 1) * pass_height;
+            }
         }
 
-        png::crc_t *chunk_crc = PNG_CONSUME_STRUCT(data, png::crc_t);
-        
-        ASSERT(*chunk_crc == computed_crc);
+        raw = (u8 *) malloc(raw_size);
+        usize inflated_size = 0;
+        success = (raw != NULL) && inflate_zlib(idat, idat_size, raw, raw_size, &inflated_size) && (inflated_size == raw_size);
+    }
+
+    if (success) {
+        result.width = info.width;
+        result.height = info.height;
+        result.bytes_per_pixel = info.output_channels;
+        result.size = (usize) info.width * info.height * info.output_channels;
+        result.pixels = malloc(result.size);
+
+        success = (result.pixels != NULL) && decode_png_image(&info, raw, raw_size, &result);
+    }
+
+    free(raw);
+    free(joined);
+
+    if (!success) {
+        free(result.pixels);
+        result = {};
     }
 
     return result;
@@ -384,25 +1404,12 @@ Bitmap load_png_file_myself(const char *filename) {
 Bitmap load_png_file(const char* filename) {
     Bitmap result {};
 
-#if 1
-    byte_array contents = os::load_entire_file(filename);
-    if (contents.is_empty()) {
-        // @todo: handle error
-        return result;
+    // @note: File which cannot be opened fails the same way as a broken one, with no pixels.
+    os::mapped_file file = os::map_file(filename);
+    if (file.data != NULL) {
+        result = decode_png(file.data, file.size);
+        os::unmap_file(&file);
     }
 
-    stbi_set_flip_vertically_on_load(true);
-
-    i32 x, y, n;
-    u8 *pixels = stbi_load(filename, &x, &y, &n, 0);
-
-    result.pixels = pixels;
-    result.size = x * y * n;
-    result.width = x;
-    result.height = y;
-    result.bytes_per_pixel = n;
-#endif
-
     return result;
 }
-
@@ -4,9 +4,19 @@
 #include <defines.hpp>
 #include <bitmap.hpp>
 
-Bitmap load_png_file_myself(const char *filename);
+//
+// Decodes PNG of any color type, bit depth and interlacing into 8-bit
+// samples: palette is expanded to RGB(A), tRNS adds the alpha channel and
+// 16-bit samples lose their low byte. Rows go bottom-up. Pixels are
+// allocated with malloc; on error the bitmap is empty.
+//
+Bitmap decode_png(void const *data, usize size);
+// @note: Bitmap is empty if the file cannot be read or decoded; the asset loader marks such assets as failed.
 Bitmap load_png_file(const char* filename);
 
+// @note: Decompresses zlib stream (RFC 1950) and checks its Adler-32. Fails if the output does not fit.
+bool inflate_zlib(u8 const *data, usize size, u8 *output, usize output_capacity, usize *output_size);
+
 #ifdef UNITY_BUILD
 #include "png.cpp"
 #endif // UNITY_BUILD
@@ -0,0 +1,202 @@
+#include "resampler.hpp"
+
+#include <math/float.hpp>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define RESAMPLER_SSE2 1
+#endif
+
+
+//
+// Filter
+//
+
+// @note: Modified Bessel function of the first kind, of order 0, which the Kaiser window is made of.
+INTERNAL
+f64 get_bessel_i0(f64 x) {
+    f64 result = 1.0;
+    f64 term = 1.0;
+    for (u32 k = 1; k < 64; k++) {
+        f64 half = x / (2.0 * k);
+        term *= half * half;
+        result += term;
+        if (term < result * 1e-15) break;
+    }
+    return result;
+}
+
+
+f32 get_resampler_cutoff(u32 source_rate, u32 target_rate) {
+    f32 result = 0.5f * RESAMPLER_PASSBAND;
+    if (target_rate < source_rate) {
+        result *= (f32) target_rate / (f32) source_rate;
+    }
+    return result;
+}
+
+
+u64 get_resampler_step(u32 source_rate, u32 target_rate) {
+    u64 result = ((u64) source_rate << 32) / target_rate;
+    return result;
+}
+
+
+//
+// Row of the phase p is the filter for the fraction p / RESAMPLER_PHASES,
+// and one more row is made for the fraction 1, so the last phase has its
+// deltas too. Every row is normalized to the gain of 1, so a constant
+// comes out the same, whatever the fractions are.
+//
+void build_resampler_filter(resampler_filter *filter, f32 cutoff) {
+    filter->cutoff = cutoff;
+
+    f64 const center = RESAMPLER_TAPS / 2 - 1;
+    f64 const half = RESAMPLER_TAPS / 2;
+    f64 const window_scale = 1.0 / get_bessel_i0(RESAMPLER_KAISER_BETA);
+
+    f64 previous[RESAMPLER_TAPS];
+    for (u32 phase = 0; phase <= RESAMPLER_PHASES; phase++) {
+        f64 row[RESAMPLER_TAPS];
+        f64 sum = 0.0;
+
+        for (u32 k = 0; k < RESAMPLER_TAPS; k++) {
+            f64 distance = (f64) k - center - (f64) phase / RESAMPLER_PHASES;
+            f64 x = distance / half;
+            f64 window = (x * x < 1.0) ? get_bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - x * x)) * window_scale : 0.0;
+
+            f64 angle = 2.0 * (f64) PI * cutoff * distance;
+            f64 sinc = (distance == 0.0) ? 1.0 : sin(angle) / angle;
+
+            row[k] = 2.0 * cutoff * sinc * window;
+            sum += row[k];
+        }
+
+        for (u32 k = 0; k < RESAMPLER_TAPS; k++) {
+            row[k] /= sum;
+        }
+
+        if (phase > 0) {
+            for (u32 k = 0; k < RESAMPLER_TAPS; k++) {
+                filter->coefficients[phase - 1][k] = (f32) previous[k];
+                filter->deltas[phase - 1][k] = (f32) (row[k] - previous[k]);
+            }
+        }
+
+        memcpy(previous, row, sizeof(row));
+    }
+}
+
+
+//
+// Kernels
+//
+// Taps are summed in four lanes, k % 4, which are added up as
+// (0 + 2) + (1 + 3) at the end, the way the vector kernel does it, so the
+// two come out the same to the bit. Gains of frame i are start + step * i,
+// like in the mixer.
+//
+
+INTERNAL
+void resample_frames_scalar(f32 *block, f32 const *left, f32 const *right, u32 channels, resampler_filter const *filter,
+                            u64 position, u64 step, u32 begin, u32 count,
+                            f32 left_gain, f32 right_gain, f32 left_step, f32 right_step) {
+    position += step * begin;
+    for (u32 i = begin; i < count; i++, position += step) {
+        u32 base = (u32) (position >> 32);
+        u32 fraction = (u32) position;
+        u32 phase = fraction >> (32 - RESAMPLER_PHASE_BITS);
+        f32 t = (f32) ((fraction >> (32 - RESAMPLER_PHASE_BITS - 16)) & 0xffff) * (1.0f / 65536.0f);
+
+        f32 const *coefficients = filter->coefficients[phase];
+        f32 const *deltas = filter->deltas[phase];
+
+        f32 left_sums[4] = {};
+        f32 right_sums[4] = {};
+        for (u32 k = 0; k < RESAMPLER_TAPS; k++) {
+            f32 coefficient = coefficients[k] + deltas[k] * t;
+            left_sums[k % 4] += coefficient * left[base + k];
+            if (channels == 2) {
+                right_sums[k % 4] += coefficient * right[base + k];
+            }
+        }
+
+        f32 left_sample = (left_sums[0] + left_sums[2]) + (left_sums[1] + left_sums[3]);
+        f32 right_sample = left_sample;
+        if (channels == 2) {
+            right_sample = (right_sums[0] + right_sums[2]) + (right_sums[1] + right_sums[3]);
+        }
+
+        f32 index = (f32) i;
+        block[2 * i] += left_sample * (left_gain + left_step * index);
+        block[2 * i + 1] += right_sample * (right_gain + right_step * index);
+    }
+}
+
+
+#if RESAMPLER_SSE2
+
+INTERNAL
+f32 get_horizontal_sum_sse2(__m128 sums) {
+    __m128 pairs = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+    f32 result = _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    return result;
+}
+
+
+// @note: Four taps at a time; coefficients are interpolated once, and used for both channels. Returns where it stopped.
+INTERNAL
+u32 resample_frames_sse2(f32 *block, f32 const *left, f32 const *right, u32 channels, resampler_filter const *filter,
+                         u64 position, u64 step, u32 count,
+                         f32 left_gain, f32 right_gain, f32 left_step, f32 right_step) {
+    STATIC_ASSERT(RESAMPLER_TAPS % 4 == 0);
+
+    u32 i = 0;
+    for (; i < count; i++, position += step) {
+        u32 base = (u32) (position >> 32);
+        u32 fraction = (u32) position;
+        u32 phase = fraction >> (32 - RESAMPLER_PHASE_BITS);
+        f32 t = (f32) ((fraction >> (32 - RESAMPLER_PHASE_BITS - 16)) & 0xffff) * (1.0f / 65536.0f);
+
+        f32 const *coefficients = filter->coefficients[phase];
+        f32 const *deltas = filter->deltas[phase];
+        __m128 fractions = _mm_set1_ps(t);
+
+        __m128 left_sums = _mm_setzero_ps();
+        __m128 right_sums = _mm_setzero_ps();
+        if (channels == 2) {
+            for (u32 k = 0; k < RESAMPLER_TAPS; k += 4) {
+                __m128 coefficient = _mm_add_ps(_mm_loadu_ps(coefficients + k), _mm_mul_ps(_mm_loadu_ps(deltas + k), fractions));
+                left_sums = _mm_add_ps(left_sums, _mm_mul_ps(coefficient, _mm_loadu_ps(left + base + k)));
+                right_sums = _mm_add_ps(right_sums, _mm_mul_ps(coefficient, _mm_loadu_ps(right + base + k)));
+            }
+        } else {
+            for (u32 k = 0; k < RESAMPLER_TAPS; k += 4) {
+                __m128 coefficient = _mm_add_ps(_mm_loadu_ps(coefficients + k), _mm_mul_ps(_mm_loadu_ps(deltas + k), fractions));
+                left_sums = _mm_add_ps(left_sums, _mm_mul_ps(coefficient, _mm_loadu_ps(left + base + k)));
+            }
+        }
+
+        f32 left_sample = get_horizontal_sum_sse2(left_sums);
+        f32 right_sample = (channels == 2) ? get_horizontal_sum_sse2(right_sums) : left_sample;
+
+        f32 index = (f32) i;
+        block[2 * i] += left_sample * (left_gain + left_step * index);
+        block[2 * i + 1] += right_sample * (right_gain + right_step * index);
+    }
+    return i;
+}
+
+#endif // RESAMPLER_SSE2
+
+
+void resample_frames(f32 *block, f32 const *left, f32 const *right, u32 channels, resampler_filter const *filter,
+                     u64 position, u64 step, u32 count, f32 left_gain, f32 right_gain, f32 left_step, f32 right_step) {
+    u32 i = 0;
+#if RESAMPLER_SSE2
+    i = resample_frames_sse2(block, left, right, channels, filter, position, step, count, left_gain, right_gain, left_step, right_step);
+#endif // RESAMPLER_SSE2
+    resample_frames_scalar(block, left, right, channels, filter, position, step, i, count, left_gain, right_gain, left_step, right_step);
+}
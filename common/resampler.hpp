@@ -0,0 +1,75 @@
+#ifndef ASUKA_COMMON_RESAMPLER_HPP
+#define ASUKA_COMMON_RESAMPLER_HPP
+
+#include <defines.hpp>
+
+
+//
+// Polyphase resampler, which changes the rate of a sound by any ratio.
+// Every target frame falls somewhere between two source frames; the
+// filter for that fraction is a windowed sinc of RESAMPLER_TAPS taps,
+// taken from a table of RESAMPLER_PHASES phases, and interpolated
+// between the two nearest ones:
+//
+//     source      x[i]  x[i+1]  ...   x[i+15]  x[i+16]  ...   x[i+31]
+//                                        |  fraction
+//                                        v
+//     target                             y[j] = sum of x[i+k] * h[phase][k]
+//
+// Position of the target frame in the source is a 32.32 fixed point
+// number, which goes up by the step (source rate / target rate) with
+// every frame, so it never drifts, however long a sound plays.
+//
+// Cutoff of the filter (-6 dB) is at RESAMPLER_PASSBAND of the Nyquist
+// frequency of the lower of the two rates. Above the stopband, it takes
+// out more than 80 dB, mirrored images of upsampled sounds included:
+//
+//     rates              passband (-0.3 dB)   -6 dB       stopband (-80 dB)
+//     22050 -> 48000     8.9 kHz              9.9 kHz     11.7 kHz
+//     44100 -> 48000     17.7 kHz             19.8 kHz    23.4 kHz
+//     96000 -> 48000     16.9 kHz             21.7 kHz    29.4 kHz
+//
+// @note: Filter is centered on its tap 15, so the target lags the source by 15 frames of the source.
+//
+
+#define RESAMPLER_TAPS 32
+#define RESAMPLER_PHASE_BITS 7
+#define RESAMPLER_PHASES (1 << RESAMPLER_PHASE_BITS)
+#define RESAMPLER_PASSBAND 0.9f
+#define RESAMPLER_KAISER_BETA 8.0
+
+// @note: Source can have up to this many frames for one frame of the target.
+#define RESAMPLER_MAX_STEP 4
+
+
+struct resampler_filter {
+    f32 cutoff; // in cycles per frame of the source
+
+    f32 coefficients[RESAMPLER_PHASES][RESAMPLER_TAPS];
+    f32 deltas[RESAMPLER_PHASES][RESAMPLER_TAPS]; // to the coefficients of the next phase
+};
+
+
+// @note: Sounds of one ratio share the filter: all upsampled sounds use the same one.
+f32 get_resampler_cutoff(u32 source_rate, u32 target_rate);
+void build_resampler_filter(resampler_filter *filter, f32 cutoff);
+
+// @note: Source frames per target frame, in 32.32 fixed point.
+u64 get_resampler_step(u32 source_rate, u32 target_rate);
+
+//
+// Resamples count frames into the stereo block, adding them to it with
+// gains which ramp the same way the mixer ones do. Position is of the
+// first target frame, from the beginning of the source, and the source
+// has to have RESAMPLER_TAPS frames from where the last target frame is.
+// Channels are in separate arrays; for mono, right is the same as left.
+//
+void resample_frames(f32 *block, f32 const *left, f32 const *right, u32 channels, resampler_filter const *filter,
+                     u64 position, u64 step, u32 count, f32 left_gain, f32 right_gain, f32 left_step, f32 right_step);
+
+
+#ifdef UNITY_BUILD
+#include "resampler.cpp"
+#endif // UNITY_BUILD
+
+#endif // ASUKA_COMMON_RESAMPLER_HPP
@@ -1,20 +1,19 @@
 #include "wav.hpp"
 #include "os/file.hpp"
 
+#include <string.h>
+
 
 namespace Asuka {
 
 
-struct RIFF_Header {
+struct WAV_Chunk {
     u32 ChunkID;
     u32 ChunkSize;
-    u8  Format[4];
 };
 
 
 struct WAV_Format {
-    u32 Subchunk1ID;
-    u32 Subchunk1Size;
     u16 AudioFormat;
     u16 NumChannels;
     u32 SampleRate;
@@ -24,89 +23,226 @@ struct WAV_Format {
 };
 
 
-struct WAV_Data {
-    u32 Subchunk2ID;
-    u32 Subchunk2Size;
-};
-
-
 #define WAV_MAGIC_NUMBER(a, b, c, d) ((((u32)a) << 0) | (((u32)b) << 8) | (((u32)c) << 16) | (((u32)d) << 24))
 
 enum {
     WAV_RIFF_ID = WAV_MAGIC_NUMBER('R', 'I', 'F', 'F'),
+    WAV_WAVE_ID = WAV_MAGIC_NUMBER('W', 'A', 'V', 'E'),
     WAV_FMT_ID  = WAV_MAGIC_NUMBER('f', 'm', 't', ' '),
     WAV_DATA_ID = WAV_MAGIC_NUMBER('d', 'a', 't', 'a'),
 };
 
+#define WAV_FORMAT_PCM 1
 
-INTERNAL
-u8 *consume_memory(u8 **data, u64 size) {
-    u8 *result = *data;
+// @note: How much of the beginning of the file a stream reads to find the data chunk.
+#define WAV_STREAM_HEADER_SIZE 4096
 
-    *data += size;
 
-    return result;
-}
+bool parse_wav_header(void const *data, usize size, u64 file_size, wav_header *header) {
+    *header = {};
+
+    u8 const *bytes = (u8 const *) data;
+    if (size < 12) return false;
+
+    u32 riff_id, wave_id;
+    memcpy(&riff_id, bytes, 4);
+    memcpy(&wave_id, bytes + 8, 4);
+    if (riff_id != WAV_RIFF_ID || wave_id != WAV_WAVE_ID) return false;
+
+    WAV_Format format {};
+    bool has_format = false;
 
-#define WAV_CONSUME_STRUCT(POINTER, TYPE) \
-    (TYPE *)consume_memory(&POINTER, sizeof(TYPE)); void(0)
+    usize position = 12;
+    while (position + sizeof(WAV_Chunk) <= size) {
+        WAV_Chunk chunk;
+        memcpy(&chunk, bytes + position, sizeof(chunk));
+        position += sizeof(WAV_Chunk);
+
+        if (chunk.ChunkID == WAV_FMT_ID) {
+            if (chunk.ChunkSize < sizeof(WAV_Format) || position + sizeof(WAV_Format) > size) return false;
+            memcpy(&format, bytes + position, sizeof(format));
+            has_format = true;
+        } else if (chunk.ChunkID == WAV_DATA_ID) {
+            if (!has_format || position > file_size) return false;
+            if (format.AudioFormat != WAV_FORMAT_PCM || format.BitsPerSample != 16) return false;
+            if (format.NumChannels != 1 && format.NumChannels != 2) return false;
+            if (format.SampleRate == 0) return false;
+
+            // @note: Writers which did not know the length leave the size too big; data ends with the file.
+            u64 data_size = chunk.ChunkSize;
+            if (data_size > file_size - position) data_size = file_size - position;
+
+            u64 frame_size = format.NumChannels * sizeof(sound_sample_t);
+            header->samples_per_second = format.SampleRate;
+            header->channels = format.NumChannels;
+            header->data_offset = position;
+            header->data_size = data_size - data_size % frame_size;
+            return true;
+        }
+
+        // @note: Chunks are padded to an even size.
+        position += chunk.ChunkSize + (chunk.ChunkSize & 1);
+    }
+
+    return false;
+}
 
 
 wav_file_contents load_wav_file(const char* filename) {
     wav_file_contents result {};
 
-    byte_array contents = os::load_entire_file(filename);
-    if (contents.get_size() == 0) {
+    // @note: Samples point into the mapping, which stays for as long as the program runs.
+    // Mapping does not allocate pages through the memory module, so sounds can be loaded on any thread.
+    os::mapped_file file = os::map_file(filename);
+    if (file.data == NULL) {
         // @todo: handle error
         return result;
     }
 
-    u8 *data = (u8 *)contents.get_data();
+    wav_header header;
+    bool is_valid = parse_wav_header(file.data, file.size, file.size, &header);
 
-    RIFF_Header riff_header {};
-    WAV_Format wav_format {};
-    WAV_Data wav_data {};
+    if (!is_valid) {
+        os::unmap_file(&file);
+        return result;
+    }
 
-    bool processing_headers = true;
-    while (processing_headers) {
-        u32 header_id = *(u32*)data;
+    result.samples_per_second = header.samples_per_second;
+    result.channels = header.channels;
+    result.samples_count = header.data_size / sizeof(sound_sample_t);
+    result.samples = (sound_sample_t *) (file.data + header.data_offset);
 
-        switch (header_id) {
-            case WAV_RIFF_ID: {
-                RIFF_Header *header = WAV_CONSUME_STRUCT(data, RIFF_Header);
-                riff_header = *header;
-                break;
-            }
-            case WAV_FMT_ID: {
-                WAV_Format *header = WAV_CONSUME_STRUCT(data, WAV_Format);
-                wav_format = *header;
-                break;
-            }
-            case WAV_DATA_ID: {
-                WAV_Data *header = WAV_CONSUME_STRUCT(data, WAV_Data);
-                wav_data = *header;
-                
-                processing_headers = false;
-                break;
-            }
-            default: {
-                // @todo: handle error
-                ASSERT_FAIL("Failed to read WAV chunk.\n");
-                break;
+    return result;
+}
+
+
+//
+// Streams
+//
+
+bool open_wav_stream_range(wav_stream *stream, char const *filename, u64 data_offset, u64 data_size,
+                           i32 samples_per_second, i32 channels, void *buffer, bool is_looping) {
+    *stream = {};
+    if (channels != 1 && channels != 2) return false;
+
+    stream->file = os::open_file(filename);
+    if (!stream->file.is_open) return false;
+
+    if (data_offset > stream->file.size || data_size > stream->file.size - data_offset) {
+        os::close_file(&stream->file);
+        return false;
+    }
+
+    stream->data_offset = data_offset;
+    stream->frame_count = data_size / (channels * sizeof(sound_sample_t));
+    stream->samples_per_second = samples_per_second;
+    stream->channels = channels;
+    stream->buffer = (sound_sample_t *) buffer;
+    stream->is_looping = is_looping;
+    stream->is_finished = (stream->frame_count == 0);
+
+    return true;
+}
+
+
+bool open_wav_stream(wav_stream *stream, char const *filename, void *buffer, bool is_looping) {
+    *stream = {};
+
+    os::opened_file file = os::open_file(filename);
+    if (!file.is_open) return false;
+
+    u8 prefix[WAV_STREAM_HEADER_SIZE];
+    usize prefix_size = os::read_file(&file, 0, prefix, sizeof(prefix));
+
+    wav_header header;
+    bool is_valid = parse_wav_header(prefix, prefix_size, file.size, &header);
+    os::close_file(&file);
+
+    if (!is_valid) return false;
+
+    bool result = open_wav_stream_range(stream, filename, header.data_offset, header.data_size,
+                                        header.samples_per_second, header.channels, buffer, is_looping);
+    return result;
+}
+
+
+void close_wav_stream(wav_stream *stream) {
+    os::close_file(&stream->file);
+    *stream = {};
+}
+
+
+u32 refill_wav_stream(wav_stream *stream) {
+    u32 result = 0;
+    if (!stream->file.is_open) return result;
+
+    u32 const mask = WAV_STREAM_BUFFER_FRAMES - 1;
+    u64 frame_size = stream->channels * sizeof(sound_sample_t);
+
+    while (!stream->is_finished) {
+        u32 write = stream->write_frame;
+        u32 read = ATOMIC_LOAD_U32(&stream->read_frame);
+        if (WAV_STREAM_BUFFER_FRAMES - (write - read) < WAV_STREAM_CHUNK_FRAMES) break;
+
+        u64 frames = stream->frame_count - stream->next_frame;
+        if (frames > WAV_STREAM_CHUNK_FRAMES) frames = WAV_STREAM_CHUNK_FRAMES;
+
+        // @note: Chunk which goes over the end of the ring is read in two pieces.
+        u32 at = write & mask;
+        u64 first = (frames < WAV_STREAM_BUFFER_FRAMES - at) ? frames : WAV_STREAM_BUFFER_FRAMES - at;
+        u64 offset = stream->data_offset + stream->next_frame * frame_size;
+
+        usize bytes = os::read_file(&stream->file, offset, stream->buffer + at * stream->channels, first * frame_size);
+        if (first < frames) {
+            bytes += os::read_file(&stream->file, offset + first * frame_size, stream->buffer, (frames - first) * frame_size);
+        }
+
+        // @note: File got shorter, or can't be read; the stream ends with what it has.
+        if (bytes != frames * frame_size) {
+            ATOMIC_STORE_U32(&stream->is_finished, 1);
+            break;
+        }
+
+        stream->next_frame += frames;
+        result += (u32) frames;
+        ATOMIC_STORE_U32(&stream->write_frame, write + (u32) frames);
+
+        if (stream->next_frame == stream->frame_count) {
+            if (stream->is_looping) {
+                stream->next_frame = 0;
+            } else {
+                ATOMIC_STORE_U32(&stream->is_finished, 1);
             }
         }
     }
 
-    sound_sample_t *samples = (sound_sample_t *) data;
+    return result;
+}
+
 
-    result.samples_per_second = wav_format.SampleRate;
-    result.channels = wav_format.NumChannels;
-    result.samples_count = wav_data.Subchunk2Size * 8 / wav_format.BitsPerSample;
-    result.samples = samples;
+u32 peek_wav_stream(wav_stream *stream, sound_sample_t const **samples) {
+    u32 const mask = WAV_STREAM_BUFFER_FRAMES - 1;
+
+    u32 read = stream->read_frame;
+    u32 write = ATOMIC_LOAD_U32(&stream->write_frame);
+    u32 at = read & mask;
+
+    u32 result = write - read;
+    if (result > WAV_STREAM_BUFFER_FRAMES - at) result = WAV_STREAM_BUFFER_FRAMES - at;
+
+    *samples = stream->buffer + at * stream->channels;
+    return result;
+}
+
+
+void consume_wav_stream(wav_stream *stream, u32 frame_count) {
+    ATOMIC_STORE_U32(&stream->read_frame, stream->read_frame + frame_count);
+}
 
-    ASSERT(result.samples_per_second == 48000);
-    ASSERT(result.channels == 2);
 
+bool is_wav_stream_ended(wav_stream *stream) {
+    bool result = ATOMIC_LOAD_U32(&stream->is_finished) &&
+        (ATOMIC_LOAD_U32(&stream->write_frame) == stream->read_frame);
     return result;
 }
 
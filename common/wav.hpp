@@ -1,6 +1,7 @@
 #pragma once
 
 #include <defines.hpp>
+#include <os/file.hpp>
 
 
 struct wav_file_contents {
@@ -11,9 +12,89 @@ struct wav_file_contents {
 };
 
 
+namespace Asuka {
+
+
+// @note: Where the samples are in the file, and what they are. Only 16-bit PCM, mono or stereo, is supported.
+struct wav_header {
+    i32 samples_per_second;
+    i32 channels;
+    u64 data_offset;
+    u64 data_size;
+};
+
+//
+// Walks the chunks of the beginning of the file, which is in memory, until
+// the data chunk. Data itself does not have to be in memory: its size is
+// only clamped to the size of the file. Chunks other than format and data
+// (LIST, fact, ...) are skipped.
+//
+bool parse_wav_header(void const *data, usize size, u64 file_size, wav_header *header);
+
 wav_file_contents load_wav_file(const char* filename);
 
+
+//
+// Streamed sound: only a ring of frames is in memory, refilled from the
+// file in chunks, while the mixer takes frames out of it:
+//
+//           read_frame             write_frame
+//               v                       v
+//     +---------+-----------------------+-----------------+
+//     | free    | frames to play        | free            |
+//     +---------+-----------------------+-----------------+
+//
+// Both positions only grow, and are taken modulo the size of the ring.
+// There is one thread which refills the stream, and one which plays it;
+// they can be different threads.
+//
+#define WAV_STREAM_BUFFER_FRAMES 32768
+#define WAV_STREAM_CHUNK_FRAMES 4096
+
+// @note: Ring is big enough for stereo, so its memory can be given before the file is opened.
+#define WAV_STREAM_BUFFER_SIZE (WAV_STREAM_BUFFER_FRAMES * 2 * sizeof(sound_sample_t))
+
+
+struct wav_stream {
+    os::opened_file file;
+    u64 data_offset;
+    u64 frame_count;
+    u64 next_frame; // of the file, read by the next refill
+
+    i32 samples_per_second;
+    i32 channels;
+
+    sound_sample_t *buffer;
+    u32 write_frame;
+    u32 read_frame;
+    u32 is_finished; // @note: Nothing is left to be read, the ring has the last frames.
+    b32 is_looping;
+};
+
+
+// @note: Buffer has to be WAV_STREAM_BUFFER_SIZE bytes, and stay until the stream is closed.
+bool open_wav_stream(wav_stream *stream, char const *filename, void *buffer, bool is_looping);
+
+// @note: Samples without the header, like the sounds of an asset pack.
+bool open_wav_stream_range(wav_stream *stream, char const *filename, u64 data_offset, u64 data_size,
+                           i32 samples_per_second, i32 channels, void *buffer, bool is_looping);
+
+void close_wav_stream(wav_stream *stream);
+
+// @note: Reads chunks while there is room for them in the ring. Returns the number of frames read.
+u32 refill_wav_stream(wav_stream *stream);
+
+// @note: Frames which can be taken from the ring in one piece, starting from the read position.
+u32 peek_wav_stream(wav_stream *stream, sound_sample_t const **samples);
+void consume_wav_stream(wav_stream *stream, u32 frame_count);
+
+// @note: True when the file is read to the end and the ring is empty. Looping streams never end.
+bool is_wav_stream_ended(wav_stream *stream);
+
+
+} // namespace Asuka
+
+
 #ifdef UNITY_BUILD
 #include "wav.cpp"
 #endif // UNITY_BUILD
-
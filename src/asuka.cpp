@@ -17,26 +17,28 @@ f32 uniform_real(f32 from, f32 to)
 }
 
 
+// @note: Draws the part of the image from source_tl of source_dims size, like a sprite from an atlas page.
 INTERNAL
 void DrawBitmap(
     OffscreenBuffer* buffer,
     f32 left, f32 top,
     Bitmap *image,
+    v2i source_tl, v2i source_dims,
     f32 c_alpha = 1.0f)
 {
     // @note: Top-down coordinate system.
     v2i tl = round_to_v2i(make_vector2(left, top));
-    v2i br = tl + round_to_v2i(make_vector2(image->width, image->height));
+    v2i br = tl + source_dims;
 
-    v2i image_tl = make_vector2i(0, 0);
-    v2i image_br = make_vector2i(image->width, image->height);
+    v2i image_tl = source_tl;
+    v2i image_br = source_tl + source_dims;
 
     if (tl.x < 0) {
-        image_tl.x = -tl.x;
+        image_tl.x -= tl.x;
         tl.x = 0;
     }
     if (tl.y < 0) {
-        image_tl.y = -tl.y;
+        image_tl.y -= tl.y;
         tl.y = 0;
     }
     if (br.x > buffer->Width) {
@@ -118,6 +120,17 @@ void DrawBitmap(
 }
 
 
+INTERNAL
+void DrawBitmap(
+    OffscreenBuffer* buffer,
+    f32 left, f32 top,
+    Bitmap *image,
+    f32 c_alpha = 1.0f)
+{
+    DrawBitmap(buffer, left, top, image, make_vector2i(0, 0), make_vector2i(image->width, image->height), c_alpha);
+}
+
+
 INTERNAL
 void DrawRectangle(
     OffscreenBuffer* buffer,
@@ -393,7 +406,7 @@ void ui_draw_scene(UiScene *scene, OffscreenBuffer *buffer)
 
 
 INTERNAL
-void push_piece(VisiblePieceGroup *group, v3 offset_in_meters, v2 dim_in_meters, Bitmap *bitmap, color32 color)
+void push_piece(VisiblePieceGroup *group, v3 offset_in_meters, v2 dim_in_meters, Sprite sprite, color32 color)
 {
     // @note offset and dimensions are in world space (in meters, bottom-up coordinate space)
     ASSERT(group->count < ARRAY_COUNT(group->assets));
@@ -403,7 +416,7 @@ void push_piece(VisiblePieceGroup *group, v3 offset_in_meters, v2 dim_in_meters,
 
     asset->offset = make_vector2(offset_in_meters.x, -(offset_in_meters.y + offset_in_meters.z)) * group->pixels_per_meter;
     asset->dimensions = dim_in_meters * group->pixels_per_meter;
-    asset->bitmap = bitmap;
+    asset->sprite = sprite;
     asset->color = color;
 }
 
@@ -411,14 +424,80 @@ void push_piece(VisiblePieceGroup *group, v3 offset_in_meters, v2 dim_in_meters,
 INTERNAL
 void push_rectangle(VisiblePieceGroup *group, v3 offset_in_meters, v2 dim_in_meters, color32 color)
 {
-    push_piece(group, offset_in_meters, dim_in_meters, NULL, color);
+    push_piece(group, offset_in_meters, dim_in_meters, Sprite{}, color);
+}
+
+
+INTERNAL
+void push_asset(VisiblePieceGroup *group, Sprite sprite, v3 offset_in_meters, f32 alpha = 1.0f)
+{
+    push_piece(group, offset_in_meters, make_vector2(0, 0), sprite, make_rgba(0, 0, 0, alpha));
 }
 
 
+// @note: Sprite from the atlas when it is there, or the whole bitmap of the asset, without mips.
 INTERNAL
-void push_asset(VisiblePieceGroup *group, Bitmap *bitmap, v3 offset_in_meters, f32 alpha = 1.0f)
+Sprite get_sprite(GameState *game_state, asset_id id)
 {
-    push_piece(group, offset_in_meters, make_vector2(0, 0), bitmap, make_rgba(0, 0, 0, alpha));
+    Sprite result = {};
+
+    if (game_state->sprite_atlas_is_built) {
+        for (u32 index = 0; index < game_state->sprite_atlas_count; index++) {
+            if (game_state->sprite_atlas_assets[index].index == id.index && game_state->sprite_atlas_sprites[index].page) {
+                result.atlas = game_state->sprite_atlas_sprites[index];
+                result.mips = game_state->sprite_mips + index;
+                return result;
+            }
+        }
+    }
+
+    Bitmap *bitmap = get_bitmap(game_state->assets, id);
+
+    result.atlas.page = bitmap;
+    result.atlas.width = bitmap->width;
+    result.atlas.height = bitmap->height;
+    return result;
+}
+
+
+// @note: Waits for all sprites to load, or fail to, packs them into one atlas and makes their mip levels.
+INTERNAL
+void build_sprite_atlas(GameState *game_state)
+{
+    asset_loader *assets = game_state->assets;
+
+    Bitmap bitmaps[ARRAY_COUNT(game_state->sprite_atlas_assets)] = {};
+    for (u32 index = 0; index < game_state->sprite_atlas_count; index++) {
+        asset_id id = game_state->sprite_atlas_assets[index];
+        asset_state state = get_asset_state(assets, id);
+        if (state == ASSET_STATE_UNLOADED || state == ASSET_STATE_QUEUED) {
+            request_asset(assets, id);
+            return;
+        }
+        if (state == ASSET_STATE_READY) {
+            bitmaps[index] = *get_bitmap(assets, id);
+        }
+    }
+
+    texture_atlas *atlas = &game_state->sprite_atlas;
+    initialize_texture_atlas(atlas, 512, 512);
+
+    atlas_sprite *sprites = game_state->sprite_atlas_sprites;
+    if (pack_texture_atlas(atlas, bitmaps, game_state->sprite_atlas_count, sprites)) {
+        u8 *pages = ALLOCATE_BUFFER(&game_state->world_arena, u8, get_texture_atlas_pages_size(atlas));
+        fill_texture_atlas_pages(atlas, pages, bitmaps, game_state->sprite_atlas_count, sprites);
+    } else {
+        // @note: Sprites are drawn from their own bitmaps then.
+        memory::set(sprites, 0, sizeof(game_state->sprite_atlas_sprites));
+    }
+
+    // @note: Levels are made from the bitmaps, not from the atlas, so small levels do not pick up the neighbours.
+    for (u32 index = 0; index < game_state->sprite_atlas_count; index++) {
+        u8 *levels = ALLOCATE_BUFFER(&game_state->world_arena, u8, get_mip_chain_size(bitmaps + index));
+        build_mip_chain(game_state->sprite_mips + index, bitmaps + index, levels);
+    }
+
+    game_state->sprite_atlas_is_built = true;
 }
 
 
@@ -785,6 +864,7 @@ void move_entity(GameState *game_state, SimRegion *sim_region, SimEntity *entity
     entity->velocity = velocity;
 }
 
+
 } // namespace Game
 
 // Random
@@ -792,6 +872,7 @@ void move_entity(GameState *game_state, SimRegion *sim_region, SimEntity *entity
 #include <stdlib.h>
 
 #if IN_CODE_TEXTURES
+// @note: Written by tools/png_to_c, run from the repository root, so that INCBIN finds data/*.lz from where build.sh compiles.
 #include "../data/character_1.cpp"
 #include "../data/character_2.cpp"
 #include "../data/character_3.cpp"
@@ -828,48 +909,8 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
         // @note: reserve entity slot for the null entity
         game_state->entity_count  = 1;
 
-#if IN_CODE_TEXTURES
-#else
-        game_state->test_wav_file = Asuka::load_wav_file("piano2.wav");
-        game_state->test_current_sound_cursor = 0;
-#endif
-
         // load_entire_file("../resources/train-images.idx3-ubyte");
 
-// @todo: make it load in the exe, not hot loaded dll
-#if IN_CODE_TEXTURES
-        game_state->tree_texture        = get_tree_60x100_png();
-        game_state->shadow_texture      = get_shadow_png();
-        game_state->monster_head        = get_monster_head_png();
-        game_state->monster_left_arm    = get_monster_left_arm_png();
-        game_state->monster_right_arm   = get_monster_right_arm_png();
-        game_state->sword_texture       = get_sword_png();
-        game_state->familiar_texture    = get_familiar_png();
-
-        game_state->player_textures[0]  = get_character_1_png();
-        game_state->player_textures[1]  = get_character_2_png();
-        game_state->player_textures[2]  = get_character_3_png();
-        game_state->player_textures[3]  = get_character_4_png();
-#else
-        game_state->grass_texture       = load_png_file("grass_texture.png");
-        game_state->tree_texture        = load_png_file("tree_60x100.png");
-        game_state->heart_full_texture  = load_png_file("heart_full.png");
-        game_state->heart_empty_texture = load_png_file("heart_empty.png");
-        game_state->monster_head        = load_png_file("monster_head.png");
-        game_state->monster_left_arm    = load_png_file("monster_left_arm.png");
-        game_state->monster_right_arm   = load_png_file("monster_right_arm.png");
-        game_state->familiar_texture    = load_png_file("familiar.png");
-        game_state->shadow_texture      = load_png_file("shadow.png");
-        game_state->fireball_texture    = load_png_file("fireball.png");
-        game_state->sword_texture       = load_png_file("sword.png");
-        game_state->cursor_texture      = load_png_file("sword_cursor.png");
-
-        game_state->player_textures[0]  = load_png_file("character_1.png");
-        game_state->player_textures[1]  = load_png_file("character_2.png");
-        game_state->player_textures[2]  = load_png_file("character_3.png");
-        game_state->player_textures[3]  = load_png_file("character_4.png");
-#endif // IN_CODE_TEXTURES
-
         memory::arena_allocator *arena  = &game_state->world_arena;
         memory::arena_allocator *temp_arena = &game_state->temp_arena;
         memory::arena_allocator *ui_arena = &game_state->ui_arena;
@@ -889,6 +930,111 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
             "ui"
         );
 
+        initialize(temp_arena, (u8 *) Memory->TransientStorage, Memory->TransientStorageSize, "transient");
+
+        // ===================== ASSETS ===================== //
+
+        asset_loader *assets = Memory->AssetLoader;
+        if (assets == NULL)
+        {
+            // @note: Platform does not run asset workers, so the game loads assets itself, at the beginning of frames.
+            assets = ALLOCATE_STRUCT(arena, asset_loader);
+            initialize_asset_loader(assets);
+        }
+        game_state->assets = assets;
+
+// @todo: make it load in the exe, not hot loaded dll
+#if IN_CODE_TEXTURES
+        game_state->tree_texture          = add_ready_bitmap_asset(assets, "tree_60x100.png", get_tree_60x100_png(arena));
+        game_state->shadow_texture        = add_ready_bitmap_asset(assets, "shadow.png", get_shadow_png(arena));
+        game_state->monster_head          = add_ready_bitmap_asset(assets, "monster_head.png", get_monster_head_png(arena));
+        game_state->monster_left_arm      = add_ready_bitmap_asset(assets, "monster_left_arm.png", get_monster_left_arm_png(arena));
+        game_state->monster_right_arm     = add_ready_bitmap_asset(assets, "monster_right_arm.png", get_monster_right_arm_png(arena));
+        game_state->sword_texture         = add_ready_bitmap_asset(assets, "sword.png", get_sword_png(arena));
+        game_state->familiar_texture      = add_ready_bitmap_asset(assets, "familiar.png", get_familiar_png(arena));
+
+        game_state->player_textures[0]    = add_ready_bitmap_asset(assets, "character_1.png", get_character_1_png(arena));
+        game_state->player_textures[1]    = add_ready_bitmap_asset(assets, "character_2.png", get_character_2_png(arena));
+        game_state->player_textures[2]    = add_ready_bitmap_asset(assets, "character_3.png", get_character_3_png(arena));
+        game_state->player_textures[3]    = add_ready_bitmap_asset(assets, "character_4.png", get_character_4_png(arena));
+#else
+        // @note: Without the pack, every asset is loaded and decoded from its own file.
+        open_asset_pack(&game_state->pack, "assets.pack");
+        assets->pack = &game_state->pack;
+
+        game_state->grass_texture         = add_bitmap_asset(assets, "grass_texture.png");
+        game_state->tree_texture          = add_bitmap_asset(assets, "tree_60x100.png");
+        game_state->heart_full_texture    = add_bitmap_asset(assets, "heart_full.png");
+        game_state->heart_empty_texture   = add_bitmap_asset(assets, "heart_empty.png");
+        game_state->monster_head          = add_bitmap_asset(assets, "monster_head.png");
+        game_state->monster_left_arm      = add_bitmap_asset(assets, "monster_left_arm.png");
+        game_state->monster_right_arm     = add_bitmap_asset(assets, "monster_right_arm.png");
+        game_state->familiar_texture      = add_bitmap_asset(assets, "familiar.png");
+        game_state->shadow_texture        = add_bitmap_asset(assets, "shadow.png");
+        game_state->fireball_texture      = add_bitmap_asset(assets, "fireball.png");
+        game_state->sword_texture         = add_bitmap_asset(assets, "sword.png");
+        game_state->cursor_texture        = add_bitmap_asset(assets, "sword_cursor.png");
+
+        game_state->player_textures[0]    = add_bitmap_asset(assets, "character_1.png");
+        game_state->player_textures[1]    = add_bitmap_asset(assets, "character_2.png");
+        game_state->player_textures[2]    = add_bitmap_asset(assets, "character_3.png");
+        game_state->player_textures[3]    = add_bitmap_asset(assets, "character_4.png");
+#endif // IN_CODE_TEXTURES
+
+        // ===================== SOUND ===================== //
+
+        initialize_sound_mixer(&game_state->mixer);
+
+#if !IN_CODE_TEXTURES
+        // @note: Samples of music in the pack are streamed from its file, without the mapping.
+        void *music_buffer = ALLOCATE_BUFFER(arena, u8, WAV_STREAM_BUFFER_SIZE);
+        asset_pack_entry const *music = find_asset(&game_state->pack, "piano2.wav");
+
+        bool is_music_open = false;
+        if (music && music->type == ASSET_TYPE_SOUND) {
+            is_music_open = open_wav_stream_range(&game_state->music_stream, "assets.pack", music->offset, music->size,
+                                                  music->sound.samples_per_second, music->sound.channels, music_buffer, true);
+        } else {
+            is_music_open = open_wav_stream(&game_state->music_stream, "piano2.wav", music_buffer, true);
+        }
+
+        if (is_music_open) {
+            refill_wav_stream(&game_state->music_stream);
+
+            // f32 volume = 0.05f;
+            f32 volume = 0;
+            game_state->music_voice = play_sound_stream(&game_state->mixer, &game_state->music_stream, volume);
+        }
+#endif // !IN_CODE_TEXTURES
+
+        // @note: Everything is asked for right away, not when it is drawn for the first time.
+        for (u32 index = 1; index < assets->slot_count; index++)
+        {
+            request_asset(assets, asset_id{ index });
+        }
+
+        asset_id sprite_atlas_assets[] =
+        {
+            game_state->shadow_texture,
+            game_state->familiar_texture,
+            game_state->monster_head,
+            game_state->monster_left_arm,
+            game_state->monster_right_arm,
+            game_state->tree_texture,
+            game_state->sword_texture,
+            game_state->player_textures[0],
+            game_state->player_textures[1],
+            game_state->player_textures[2],
+            game_state->player_textures[3],
+        };
+        static_assert(ARRAY_COUNT(sprite_atlas_assets) <= ARRAY_COUNT(game_state->sprite_atlas_assets));
+
+        memory::copy(game_state->sprite_atlas_assets, sprite_atlas_assets, sizeof(sprite_atlas_assets));
+        game_state->sprite_atlas_count = ARRAY_COUNT(sprite_atlas_assets);
+        game_state->sprite_atlas_is_built = false;
+
+        game_state->camera_zoom = 1.0f;
+
         f32 tile_side_in_meters = 1.0f;
         i32 chunk_side_in_tiles = 5;
         f32 chunk_side_in_meters = chunk_side_in_tiles * tile_side_in_meters;
@@ -1080,9 +1226,33 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
         Memory->IsInitialized = true;
     }
 
+    // @note: Assets loaded since the last frame become ready here, and only here.
+    asset_loader *assets = game_state->assets;
+    if (Memory->AssetLoader == NULL)
+    {
+        while (run_asset_loader_job(assets)) {}
+    }
+    finish_loaded_assets(assets);
+
+    // @note: Ring of the stream holds more than half a second, refilling it once a frame is plenty.
+    refill_wav_stream(&game_state->music_stream);
+
+    if (!game_state->sprite_atlas_is_built) {
+        build_sprite_atlas(game_state);
+    }
+
     World *world = game_state->world;
 
-    f32 pixels_per_meter = 60.f; // [pixels/m]
+    // @note: Mouse wheel zooms the camera, in steps of 10%. Zoom snaps back to 1, where sprites are not scaled.
+    for (i32 step = 0; step < absolute(Input->mouse.wheel); step++) {
+        game_state->camera_zoom *= (Input->mouse.wheel > 0) ? 1.1f : (1.0f / 1.1f);
+        game_state->camera_zoom = clamp(game_state->camera_zoom, 0.25f, 4.0f);
+        if (::is_equal(game_state->camera_zoom, 1.0f, 0.01f)) {
+            game_state->camera_zoom = 1.0f;
+        }
+    }
+
+    f32 pixels_per_meter = 60.f * game_state->camera_zoom; // [pixels/m]
     f32 character_speed = 2.5f; // [m/s]
     f32 character_mass = 80.0f; // [kg]
 
@@ -1158,11 +1328,12 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
 
     rect3 sim_bounds = rect3::from_min_max(make_vector3(-10, -6, -5), make_vector3(10, 6, 5)); // in meters
 
-    initialize(&game_state->temp_arena, (u8 *) Memory->TransientStorage, Memory->TransientStorageSize, "sim_region");
-
     WorldPosition sim_center = game_state->camera_position;
     sim_center.offset.z = 0;
 
+    // @note: everything sim region allocates is freed right after end_simulation, so the rest of the frame could reuse transient storage.
+    memory::TemporaryMemory sim_memory = begin_temporary(&game_state->temp_arena);
+
     SimRegion *sim_region = begin_simulation(game_state, &game_state->temp_arena,
         sim_center, sim_bounds);
 
@@ -1173,7 +1344,7 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
     DrawRectangle(Buffer, make_vector2(0, 0), make_vector2(Buffer->Width, Buffer->Height), make_rgb(0.5, 0.5, 0.5));
 
     // Background grass
-    // DrawBitmap(Buffer, { 0, 0 }, { (f32)Buffer->Width, (f32)Buffer->Height }, &game_state->grass_texture);
+    // DrawBitmap(Buffer, { 0, 0 }, { (f32)Buffer->Width, (f32)Buffer->Height }, get_bitmap(assets, game_state->grass_texture));
 
     // ===================== RENDERING ENTITIES ===================== //
     VisiblePieceGroup group {};
@@ -1260,10 +1431,10 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
                     }
                 }
 
-                auto *shadow_texture = &game_state->shadow_texture;
+                auto shadow_texture = get_sprite(game_state, game_state->shadow_texture);
                 push_asset(&group, shadow_texture, make_vector3(-0.5f, 0.85f, 0), 1.0f / (1.0f + entity->position.z));
 
-                auto *player_texture = &game_state->player_textures[entity->face_direction];
+                auto player_texture = get_sprite(game_state, game_state->player_textures[entity->face_direction]);
                 push_asset(&group, player_texture, make_vector3(-0.4f, 1.0f, entity->position.z));
 
                 draw_hitpoints(entity, &group);
@@ -1309,10 +1480,10 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
                 f32 t = a * math::sin(3.0f * entity->tBob);
                 f32 h = 2.0f / (2.0f + a + t);
 
-                auto *shadow = &game_state->shadow_texture;
+                auto shadow = get_sprite(game_state, game_state->shadow_texture);
                 push_asset(&group, shadow, make_vector3(-0.5f, 0.85f, 0), h);
 
-                auto *texture = &game_state->familiar_texture;
+                auto texture = get_sprite(game_state, game_state->familiar_texture);
                 push_asset(&group, texture, make_vector3(-0.5f, 0.8f, 0.2f / h));
             }
             break;
@@ -1320,9 +1491,9 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
             case ENTITY_TYPE_MONSTER:
             {
 #if 1 // DRAW MONSTER
-                auto *head = &game_state->monster_head;
-                auto *left_arm  = &game_state->monster_left_arm;
-                auto *right_arm = &game_state->monster_right_arm;
+                auto head = get_sprite(game_state, game_state->monster_head);
+                auto left_arm  = get_sprite(game_state, game_state->monster_left_arm);
+                auto right_arm = get_sprite(game_state, game_state->monster_right_arm);
 
                 push_asset(&group, head, make_vector3(-2.5f, 2.5f, 0));
                 push_asset(&group, left_arm, make_vector3(-2.0f, 2.5f, 0));
@@ -1335,7 +1506,7 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
 
             case ENTITY_TYPE_WALL:
             {
-                auto *texture = &game_state->tree_texture;
+                auto texture = get_sprite(game_state, game_state->tree_texture);
                 push_asset(&group, texture, make_vector3(-0.5f, 1.6f, 0));
             }
             break;
@@ -1350,8 +1521,8 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
                     make_entity_nonspatial(entity);
                 }
 
-                auto *texture = &game_state->sword_texture;
-                auto *shadow_texture = &game_state->shadow_texture;
+                auto texture = get_sprite(game_state, game_state->sword_texture);
+                auto shadow_texture = get_sprite(game_state, game_state->shadow_texture);
 
                 // @todo: If I have to take into account position.z in here, therefore I should
                 push_asset(&group, shadow_texture, make_vector3(-0.5, 0.85, 0), 1.0f / (1.0f + entity->position.z));
@@ -1405,8 +1576,15 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
             ASSERT(asset);
 
             v2 center = make_vector2(x, y) + asset->offset;
-            if (asset->bitmap) {
-                DrawBitmap(Buffer, center.x, center.y, asset->bitmap, asset->color.a);
+            atlas_sprite *sprite = &asset->sprite.atlas;
+            if (sprite->page && (game_state->camera_zoom == 1.0f || asset->sprite.mips == NULL)) {
+                DrawBitmap(Buffer, center.x, center.y, sprite->page,
+                    make_vector2i(sprite->x, sprite->y), make_vector2i(sprite->width, sprite->height), asset->color.a);
+            } else if (sprite->page) {
+                blit_target target = { Buffer->Memory, Buffer->Width, Buffer->Height, Buffer->Pitch };
+                blit_mip_chain(target, center.x, center.y,
+                    sprite->width * game_state->camera_zoom, sprite->height * game_state->camera_zoom,
+                    asset->sprite.mips, asset->color.a);
             } else {
                 v2 half_dim = 0.5f * asset->dimensions;
                 DrawRectangle(Buffer, center - half_dim, center + half_dim, asset->color.rgb);
@@ -1415,6 +1593,7 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
     }
 
     end_simulation(game_state, sim_region);
+    end_temporary(sim_memory);
 
     StoredEntity *followed_entity = get_stored_entity(game_state, game_state->index_of_entity_for_camera_to_follow);
     if (followed_entity)
@@ -1512,14 +1691,14 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
         auto *allocator_to_draw = &game_state->world_arena;
         {
             void* start_p = allocator_to_draw->memory;
-            for (uint64 hash_entry_index = 0 ; hash_entry_index < ARRAY_COUNT(allocator_to_draw->hash_table); hash_entry_index++)
+            for (uint64 hash_entry_index = 0 ; hash_entry_index < allocator_to_draw->log.capacity; hash_entry_index++)
             {
-                AllocationLogEntry *entry = allocator_to_draw->hash_table + hash_entry_index;
-                if (entry->pointer == NULL) continue;
+                AllocationLogEntry *entry = allocator_to_draw->log.hash_table + hash_entry_index;
+                if (!is_live_allocation_entry(entry)) continue;
 
                 color24 color = {};
-                color.g = (f32) hash_entry_index / ARRAY_COUNT(allocator_to_draw->hash_table);
-                color.b = (f32) hash_entry_index / ARRAY_COUNT(allocator_to_draw->hash_table);
+                color.g = (f32) hash_entry_index / allocator_to_draw->log.capacity;
+                color.b = (f32) hash_entry_index / allocator_to_draw->log.capacity;
                 debug_draw_wrapped_rectangle(start_p, entry->pointer, entry->size, strip_user_offset, color, true);
             }
         }
@@ -1563,14 +1742,14 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
 
         {
             void* start_p = allocator_to_draw->memory;
-            for (uint64 hash_entry_index = 0 ; hash_entry_index < ARRAY_COUNT(allocator_to_draw->log.hash_table); hash_entry_index++)
+            for (uint64 hash_entry_index = 0 ; hash_entry_index < allocator_to_draw->log.capacity; hash_entry_index++)
             {
                 AllocationLogEntry *entry = allocator_to_draw->log.hash_table + hash_entry_index;
-                if (entry->pointer == NULL) continue;
+                if (!is_live_allocation_entry(entry)) continue;
 
                 color24 color = {};
-                color.g = (f32) hash_entry_index / ARRAY_COUNT(allocator_to_draw->log.hash_table);
-                color.b = (f32) hash_entry_index / ARRAY_COUNT(allocator_to_draw->log.hash_table);
+                color.g = (f32) hash_entry_index / allocator_to_draw->log.capacity;
+                color.b = (f32) hash_entry_index / allocator_to_draw->log.capacity;
                 debug_draw_wrapped_rectangle(start_p, entry->pointer, entry->size, 0, color, false);
             }
         }
@@ -1671,17 +1850,17 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
         }
 
         for (uint64 hash_entry_index = 0;
-            hash_entry_index < ARRAY_COUNT(allocator_to_draw->log.hash_table);
+            hash_entry_index < allocator_to_draw->log.capacity;
             hash_entry_index++)
         {
             AllocationLogEntry *entry = allocator_to_draw->log.hash_table + hash_entry_index;
 
-            if ((entry->pointer != 0) &&
+            if (is_live_allocation_entry(entry) &&
                 (game_state->start_p == NULL))
             {
                 game_state->start_p = entry->pointer;
             }
-            else if (entry->pointer != NULL && entry->pointer < game_state->start_p)
+            else if (is_live_allocation_entry(entry) && entry->pointer < game_state->start_p)
             {
                 game_state->start_p = entry->pointer;
             }
@@ -1689,14 +1868,14 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
 
         {
             void* start_p = game_state->start_p;
-            for (uint64 hash_entry_index = 0 ; hash_entry_index < ARRAY_COUNT(allocator_to_draw->log.hash_table); hash_entry_index++)
+            for (uint64 hash_entry_index = 0 ; hash_entry_index < allocator_to_draw->log.capacity; hash_entry_index++)
             {
                 AllocationLogEntry *entry = allocator_to_draw->log.hash_table + hash_entry_index;
-                if (entry->pointer == NULL) continue;
+                if (!is_live_allocation_entry(entry)) continue;
 
                 color24 color = {};
-                color.g = (f32) hash_entry_index / ARRAY_COUNT(allocator_to_draw->log.hash_table);
-                color.b = (f32) hash_entry_index / ARRAY_COUNT(allocator_to_draw->log.hash_table);
+                color.g = (f32) hash_entry_index / allocator_to_draw->log.capacity;
+                color.b = (f32) hash_entry_index / allocator_to_draw->log.capacity;
                 debug_draw_wrapped_rectangle(start_p, entry->pointer, entry->size, strip_user_offset, color, true);
             }
         }
@@ -1748,7 +1927,11 @@ GAME_UPDATE_AND_RENDER(Game_UpdateAndRender)
 #endif // UI_EDITOR_ENABLED
 
     // ===================== RENDERING MOUSE CURSOR ================= //
-    DrawBitmap(Buffer, Input->mouse.position.x, Input->mouse.position.y, &game_state->cursor_texture);
+    // @note: Textures compiled into the executable have no cursor, and the placeholder is no cursor either.
+    if (get_asset_state(assets, game_state->cursor_texture) == ASSET_STATE_READY)
+    {
+        DrawBitmap(Buffer, Input->mouse.position.x, Input->mouse.position.y, get_bitmap(assets, game_state->cursor_texture));
+    }
 }
 
 
@@ -1757,25 +1940,8 @@ namespace Game
 
 INTERNAL
 void Game_OutputSound_(SoundOutputBuffer *SoundBuffer, GameState* game_state) {
-#if IN_CODE_TEXTURES
-    // @todo: Embed sound into executable
-#else
-    sound_sample_t* SampleOut = SoundBuffer->Samples;
-
-    for (i32 SampleIndex = 0; SampleIndex < SoundBuffer->SampleCount; SampleIndex++) {
-        u64 left_idx = (game_state->test_current_sound_cursor++) % game_state->test_wav_file.samples_count;
-        u64 right_idx = (game_state->test_current_sound_cursor++) % game_state->test_wav_file.samples_count;
-
-        sound_sample_t LeftSample =  game_state->test_wav_file.samples[left_idx];
-        sound_sample_t RightSample = game_state->test_wav_file.samples[right_idx];
-
-        // f32 volume = 0.05f;
-        f32 volume = 0;
-
-        *SampleOut++ = (sound_sample_t)(LeftSample  * volume);
-        *SampleOut++ = (sound_sample_t)(RightSample * volume);
-    }
-#endif // IN_CODE_TEXTURES
+    // @todo: Embed sound into executable, with IN_CODE_TEXTURES nothing is played.
+    mix_sound(&game_state->mixer, SoundBuffer->Samples, SoundBuffer->SampleCount);
 }
 
 }
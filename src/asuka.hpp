@@ -6,6 +6,12 @@
 #include <sim_region.hpp>
 #include <bitmap.hpp>
 #include <wav.hpp>
+#include <mixer.hpp>
+#include <asset_pack.hpp>
+#include <asset_loader.hpp>
+#include <atlas.hpp>
+#include <mipmap.hpp>
+#include <lz4.hpp>
 #include <array.hpp>
 #include <ui/ui.hpp>
 
@@ -346,16 +352,26 @@ struct Memory {
     usize CustomHeapStorageSize;
     void *CustomHeapStorage;
 
+    // @note: Platform runs the workers of the loader, the game may get NULL, then it loads assets itself.
+    asset_loader *AssetLoader;
+
     b32 IsInitialized;
 };
 
 
+// @note: Drawn from the atlas at 1:1, and from its mip levels when the camera is zoomed.
+struct Sprite {
+    atlas_sprite atlas; // @note: Rectangle of the color, if the sprite has no page.
+    mip_chain const *mips;
+};
+
+
 struct VisiblePiece {
     // @note: offset and dimenstions in pixel, top-down screen space
     v2 offset;
     v2 dimensions;
 
-    Bitmap *bitmap;
+    Sprite sprite;
     color32 color;
 };
 
@@ -407,28 +423,42 @@ struct GameState {
     memory::arena_allocator temp_arena;
     memory::arena_allocator ui_arena;
 
-    wav_file_contents test_wav_file;
+    asset_pack pack;
+    asset_loader *assets;
 
-    byte_array training_set;
-
-    Bitmap wall_texture;
-    Bitmap tree_texture;
-    Bitmap grass_texture;
-    Bitmap heart_full_texture;
-    Bitmap heart_empty_texture;
-    Bitmap familiar_texture;
-    Bitmap shadow_texture;
-    Bitmap fireball_texture;
-    Bitmap sword_texture;
-    Bitmap cursor_texture;
+    // @note: Music is streamed, the ring of the stream is in the world arena.
+    sound_mixer mixer;
+    Asuka::wav_stream music_stream;
+    sound_voice_id music_voice;
 
-    Bitmap monster_head;
-    Bitmap monster_left_arm;
-    Bitmap monster_right_arm;
-
-    Bitmap player_textures[4];
+    byte_array training_set;
 
-    u32 test_current_sound_cursor;
+    asset_id wall_texture;
+    asset_id tree_texture;
+    asset_id grass_texture;
+    asset_id heart_full_texture;
+    asset_id heart_empty_texture;
+    asset_id familiar_texture;
+    asset_id shadow_texture;
+    asset_id fireball_texture;
+    asset_id sword_texture;
+    asset_id cursor_texture;
+
+    asset_id monster_head;
+    asset_id monster_left_arm;
+    asset_id monster_right_arm;
+
+    asset_id player_textures[4];
+
+    f32 camera_zoom;
+
+    // @note: Sprites of entities, put into one atlas once all of them are loaded.
+    texture_atlas sprite_atlas;
+    asset_id sprite_atlas_assets[16];
+    atlas_sprite sprite_atlas_sprites[16];
+    mip_chain sprite_mips[16];
+    u32 sprite_atlas_count;
+    b32 sprite_atlas_is_built;
 
     UiScene *game_hud;
 
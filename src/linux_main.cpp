@@ -12,6 +12,7 @@
 #include <os/memory.hpp>
 #include <os/time.hpp>
 #include <time.h>
+#include <pthread.h>
 
 #if SOUND_ALSA
 #include <alsa/asoundlib.h>
@@ -64,6 +65,11 @@
 
 
 GLOBAL bool global_running;
+
+#define ASSET_WORKER_COUNT 2
+
+// @note: The loader lives in the executable, so it survives reloads of the game code and restores of the game memory.
+GLOBAL asset_loader global_asset_loader;
 GLOBAL v2i  global_resolution_presets[12] =
 {
     { 800, 600 },
@@ -408,6 +414,22 @@ static void linux_send_sound_buffer(snd_pcm_t* sound_device, linux_sound_output*
 }
 #endif // SOUND_ALSA
 
+INTERNAL
+void *asset_worker_thread(void *parameter)
+{
+    asset_loader *loader = (asset_loader *) parameter;
+    loop
+    {
+        if (!run_asset_loader_job(loader))
+        {
+            usleep(1000);
+        }
+    }
+
+    return NULL;
+}
+
+
 int32 main(int32 argc, char** argv)
 {
     Display* display = XOpenDisplay(NULL);
@@ -497,6 +519,18 @@ int32 main(int32 argc, char** argv)
     game_memory.CustomHeapStorageSize = MEGABYTES(10);
     game_memory.CustomHeapStorage = memory::allocate_pages((void *)TERABYTES(2), game_memory.CustomHeapStorageSize);
 
+    initialize_asset_loader(&global_asset_loader);
+    game_memory.AssetLoader = &global_asset_loader;
+
+    for (u32 worker_index = 0; worker_index < ASSET_WORKER_COUNT; worker_index++)
+    {
+        pthread_t asset_worker;
+        if (pthread_create(&asset_worker, NULL, asset_worker_thread, &global_asset_loader) == 0)
+        {
+            pthread_detach(asset_worker);
+        }
+    }
+
     Game::Input Input = {};
     Input.dt = target_seconds_per_frame;
 
@@ -515,6 +549,7 @@ int32 main(int32 argc, char** argv)
     {
         auto *mouse = &Input.mouse;
         mouse->previous_position = mouse->position;
+        mouse->wheel = 0;
         for (i32 button_index = 0; button_index < ARRAY_COUNT(mouse->buttons); button_index++)
         {
             mouse->buttons[button_index].HalfTransitionCount = 0;
@@ -619,6 +654,14 @@ int32 main(int32 argc, char** argv)
                     {
                         linux_process_key_event(&mouse->RMB, is_down);
                     }
+                    else if (event.xbutton.button == MOUSE_WHEEL_UP && is_down)
+                    {
+                        mouse->wheel += 1;
+                    }
+                    else if (event.xbutton.button == MOUSE_WHEEL_DOWN && is_down)
+                    {
+                        mouse->wheel -= 1;
+                    }
                 }
                 break;
 
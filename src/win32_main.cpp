@@ -555,7 +555,12 @@ void Win32_ProcessPendingMessages(HWND Window, Game::ControllerInput *Controller
             // case WM_XBUTTONDBLCLK:
 
             // case WM_MOUSEHWHEEL:
-            // case WM_MOUSEWHEEL:
+            case WM_MOUSEWHEEL:
+            {
+                Mouse->wheel += GET_WHEEL_DELTA_WPARAM(Message.wParam) / WHEEL_DELTA;
+            }
+            break;
+
             // case WM_NCLBUTTONUP:
 
             // case WM_NCLBUTTONDOWN:
@@ -1012,6 +1017,26 @@ THREAD_FUNCTION(ThreadTest)
 }
 
 
+#define ASSET_WORKER_COUNT 2
+
+// @note: The loader lives in the executable, so it survives reloads of the game code and restores of the game memory.
+GLOBAL asset_loader Global_AssetLoader;
+
+THREAD_FUNCTION(AssetWorkerThread)
+{
+    asset_loader *Loader = (asset_loader *) Parameter;
+    while (true)
+    {
+        if (!run_asset_loader_job(Loader))
+        {
+            Sleep(1);
+        }
+    }
+
+    return 0;
+}
+
+
 int WINAPI WinMain(
     HINSTANCE Instance,
     HINSTANCE PrevInstance,
@@ -1193,6 +1218,15 @@ int WINAPI WinMain(
     GameMemory.PermanentStorage = Platform::AllocateMemory(BaseAddress, TotalSize);
     GameMemory.TransientStorage = (u8*)GameMemory.PermanentStorage + GameMemory.PermanentStorageSize;
 
+    initialize_asset_loader(&Global_AssetLoader);
+    GameMemory.AssetLoader = &Global_AssetLoader;
+
+    for (u32 WorkerIndex = 0; WorkerIndex < ASSET_WORKER_COUNT; WorkerIndex++)
+    {
+        Platform::Thread AssetWorker = Platform::CreateThread(AssetWorkerThread, &Global_AssetLoader);
+        Platform::DetatchThread(AssetWorker);
+    }
+
 #if ASUKA_PLAYBACK_LOOP
     u64 InitialGameMemorySize = GameMemory.PermanentStorageSize;
 
@@ -1282,6 +1316,7 @@ int WINAPI WinMain(
         Game::ControllerInput* OldKeyboardController = &OldInput->KeyboardInput;
         Game::ControllerInput* NewKeyboardController = &NewInput->KeyboardInput;
         NewInput->mouse.previous_position = NewInput->mouse.position;
+        NewInput->mouse.wheel = 0;
         NewInput->mouse.position = Win32_GetMousePosition(Window);
 
         NewInput->keyboard = OldInput->keyboard;
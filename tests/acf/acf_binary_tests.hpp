@@ -0,0 +1,270 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <os/file.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_binary.hpp>
+
+#include "acf_document_tests.hpp"
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+// @note: Blob is in malloc'd memory, which is aligned enough.
+INTERNAL
+void *write_acf_binary_to_memory(acf_document const *document, usize *size)
+{
+    *size = write_acf_binary(document, NULL, 0);
+
+    void *result = malloc(*size);
+    usize written = write_acf_binary(document, result, *size);
+    ASSERT(written == *size);
+
+    return result;
+}
+
+
+// @note: Text -> document -> binary -> document has to give the same tree.
+bool run_acf_binary_test(char const *filename, void *memory, usize memory_size)
+{
+    printf("%s (binary): ", filename);
+
+    usize source_size = 0;
+    char *source = load_acf_test_file(filename, &source_size);
+
+    bool successfull = false;
+    if (source)
+    {
+        void *expected_memory = malloc(memory_size);
+
+        acf_document expected;
+        initialize_acf_document(&expected, expected_memory, memory_size);
+        successfull = parse_acf_document(&expected, source, source_size);
+
+        usize blob_size = 0;
+        void *blob = write_acf_binary_to_memory(&expected, &blob_size);
+
+        acf_binary binary;
+        successfull = successfull && verify_acf_binary(blob, blob_size) && open_acf_binary(&binary, blob, blob_size);
+
+        if (successfull)
+        {
+            acf_document document;
+            initialize_acf_document(&document, memory, memory_size);
+
+            successfull = load_acf_binary_document(&document, &binary) &&
+                are_acf_nodes_equal(document.root, expected.root) &&
+                (document.newtype_count == expected.newtype_count);
+
+            for (u32 i = 0; successfull && i < expected.newtype_count; i++)
+            {
+                successfull = (*document.newtypes[i].name == *expected.newtypes[i].name) &&
+                    (document.newtypes[i].argument_count == expected.newtypes[i].argument_count);
+            }
+
+            release_acf_document(&document);
+        }
+
+        release_acf_document(&expected);
+        free(blob);
+        free(expected_memory);
+        free(source);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_acf_binary_views_test(void *memory, usize memory_size)
+{
+    printf("binary views: ");
+
+    char const source[] =
+        "#newtype color(float, float, float, float)\n"
+        "window = { width = 1920; height = 1080; fullscreen = false; title = \"Asuka\"; }\n"
+        "tint = color(1, 0.5, 0.25, 1)\n"
+        "layers = [ \"background\", \"world\", \"ui\" ]\n"
+        "nothing = null\n"
+        "kind = int\n";
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+
+    bool successfull = parse_acf_document(&document, source, sizeof(source) - 1);
+
+    usize blob_size = 0;
+    void *blob = write_acf_binary_to_memory(&document, &blob_size);
+
+    acf_binary binary;
+    successfull = successfull && open_acf_binary(&binary, blob, blob_size);
+    if (successfull)
+    {
+        acf_binary_value root = binary.root;
+        successfull =
+            (root.size() == 5) && (root.get_key(2).name() == "layers") &&
+            (root["window"]["width"].get_int() == 1920) &&
+            (root[ACF_KEY("window")]["fullscreen"].get_bool() == false) &&
+            (root["window"]["title"].get_string() == "Asuka") &&
+            (root["tint"].get_custom_type_name() == "color") &&
+            (root["tint"][1].get_float() == 0.5) &&
+            (root["layers"][2].get_string() == "ui") &&
+            root["layers"][3].is_null() &&
+            root["nothing"].is_null() &&
+            (root["kind"].get_type() == acf_type_t::integer) &&
+            root["missing"]["deeper"].is_null() &&
+            (root["window"]["height"].get_int_or(0) == 1080);
+
+        // @note: Strings are views into the blob, nothing is copied.
+        char const *title = root["window"]["title"].get_string().data;
+        successfull = successfull && (title > (char const *) blob) && (title < (char const *) blob + blob_size) && (title[5] == 0);
+    }
+
+    // @note: Every truncation and single byte corruption has to be rejected or stay in bounds.
+    if (successfull)
+    {
+        for (usize size = 0; successfull && size < blob_size; size += 4)
+        {
+            successfull = !verify_acf_binary(blob, size);
+        }
+
+        u8 *bytes = (u8 *) blob;
+        for (usize i = 0; i < blob_size; i++)
+        {
+            u8 original = bytes[i];
+            bytes[i] ^= 0xA5;
+            if (verify_acf_binary(blob, blob_size))
+            {
+                acf_document corrupted;
+                initialize_acf_document(&corrupted, memory, memory_size);
+
+                acf_binary corrupted_binary;
+                open_acf_binary(&corrupted_binary, blob, blob_size);
+                load_acf_binary_document(&corrupted, &corrupted_binary);
+                release_acf_document(&corrupted);
+            }
+            bytes[i] = original;
+        }
+    }
+
+    // @note: Same through the mapped file.
+    if (successfull)
+    {
+        char const *filepath = "acf_binary_test.acfb";
+
+        byte_array contents = {};
+        contents.data = (memory::byte *) blob;
+        contents.size = blob_size;
+        successfull = os::write_file(filepath, contents);
+
+        os::mapped_file file = os::map_file(filepath);
+        successfull = successfull && (file.size == blob_size) && open_acf_binary(&binary, file.data, file.size);
+        successfull = successfull && (binary.root["window"]["height"].get_int() == 1080);
+
+        os::unmap_file(&file);
+        remove(filepath);
+    }
+
+    release_acf_document(&document);
+    free(blob);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_acf_binary_wide_object_test(void *memory, usize memory_size)
+{
+    printf("binary wide object lookup: ");
+
+    u32 const key_count = 300;
+    usize source_capacity = key_count * 32;
+    char *source = (char *) malloc(source_capacity);
+
+    usize source_size = 0;
+    for (u32 i = 0; i < key_count; i++)
+    {
+        source_size += snprintf(source + source_size, source_capacity - source_size, "key_%u = %u;\n", i, i * 7);
+    }
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+
+    bool successfull = parse_acf_document(&document, source, source_size);
+
+    usize blob_size = 0;
+    void *blob = write_acf_binary_to_memory(&document, &blob_size);
+
+    acf_binary binary;
+    successfull = successfull && verify_acf_binary(blob, blob_size) && open_acf_binary(&binary, blob, blob_size);
+    for (u32 i = 0; successfull && i < key_count; i++)
+    {
+        char key[32];
+        snprintf(key, sizeof(key), "key_%u", i);
+
+        successfull = (binary.root[key].get_int() == i * 7) && (binary.root.get_key(i).name() == key);
+    }
+    successfull = successfull && (binary.root[ACF_KEY("key_123")].get_int() == 123 * 7) && binary.root["key_300"].is_null();
+
+    release_acf_document(&document);
+    free(blob);
+    free(source);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_binary_tests()
+{
+    char const *filenames[] =
+    {
+        "001_empty_object.acf",
+        "002_null_value.acf",
+        "003_boolean_value.acf",
+        "004_integer_value.acf",
+        "005_floating_value.acf",
+        "006_string_value.acf",
+        "007_comments.acf",
+        "008_many_types.acf",
+        "009_optional_semicolons.acf",
+        "010_trailing_comma.acf",
+        "011_optional_commas.acf",
+        "012_optional_top_braces.acf",
+        "013_newtype_0_args.acf",
+        "014_newtype_1_null_arg.acf",
+        "015_newtype_1_bool_arg.acf",
+        "016_newtype_1_int_arg.acf",
+        "017_newtype_1_float_arg.acf",
+        "018_newtype_1_string_arg.acf",
+        "019_newtype_1_array_arg.acf",
+        "020_newtype_1_object_arg.acf",
+        "021_newtype_2_args.acf",
+        "022_newtype_3_args.acf",
+        "023_newtype_4_args.acf",
+        "024_type_value.acf",
+        "025_int_to_float_conversion.acf",
+        "026_type_type_value.acf",
+    };
+
+    usize memory_size = KILOBYTES(64);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+    for (u32 test_index = 0; test_index < ARRAY_COUNT(filenames); test_index++)
+    {
+        record_test_result(&result, run_acf_binary_test(filenames[test_index], memory, memory_size));
+    }
+
+    record_test_result(&result, run_acf_binary_views_test(memory, memory_size));
+    record_test_result(&result, run_acf_binary_wide_object_test(memory, memory_size));
+
+    free(memory);
+    return result;
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_document.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#ifndef ACF_TESTS_DIRECTORY
+#define ACF_TESTS_DIRECTORY "tests/acf/positive/"
+#endif
+
+
+struct acf_document_test
+{
+    char const *filename;
+    bool (*check)(acf_node const& root);
+};
+
+
+INTERNAL
+char *load_acf_test_file(char const *filename, usize *size)
+{
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s%s", ACF_TESTS_DIRECTORY, filename);
+
+    char *result = NULL;
+    *size = 0;
+
+    FILE *file = fopen(filepath, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        *size = (usize) ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        result = (char *) malloc(*size + 1);
+        *size = fread(result, 1, *size, file);
+        result[*size] = 0;
+
+        fclose(file);
+    }
+
+    return result;
+}
+
+
+bool run_acf_document_test(acf_document_test test, void *memory, usize memory_size)
+{
+    printf("%s: ", test.filename);
+
+    usize source_size = 0;
+    char *source = load_acf_test_file(test.filename, &source_size);
+
+    bool successfull = false;
+    if (source)
+    {
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        successfull = parse_acf_document(&document, source, source_size);
+        if (successfull)
+        {
+            successfull = test.check(document.root);
+        }
+        else
+        {
+            printf("\n%s", document.error_buffer);
+        }
+
+        release_acf_document(&document);
+        free(source);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Objects this wide go through the hash index instead of the linear scan.
+bool run_acf_document_wide_object_test(void *memory, usize memory_size)
+{
+    printf("wide object lookup: ");
+
+    u32 const key_count = 300;
+    usize source_capacity = key_count * 32;
+    char *source = (char *) malloc(source_capacity);
+
+    usize source_size = 0;
+    for (u32 i = 0; i < key_count; i++)
+    {
+        source_size += snprintf(source + source_size, source_capacity - source_size, "key_%u = %u;\n", i, i * 7);
+    }
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+
+    bool successfull = parse_acf_document(&document, source, source_size);
+    if (successfull)
+    {
+        acf_node const& root = document.root;
+        successfull = (root.size() == key_count);
+
+        for (u32 i = 0; i < key_count && successfull; i++)
+        {
+            char key[32];
+            snprintf(key, sizeof(key), "key_%u", i);
+
+            successfull = (root[key].get_int() == i * 7) && (root.get_key(i) == key);
+        }
+
+        successfull = successfull && (root[ACF_KEY("key_123")].get_int() == 123 * 7);
+        successfull = successfull && root["key_300"].is_null() && root[ACF_KEY("key")].is_null();
+    }
+
+    // @note: Duplicate far from the beginning of the object is found by the index.
+    if (successfull)
+    {
+        source_size += snprintf(source + source_size, source_capacity - source_size, "key_250 = 0;\n");
+
+        reset_acf_document(&document);
+        successfull = !parse_acf_document(&document, source, source_size) && (document.error_line == key_count + 1);
+    }
+
+    release_acf_document(&document);
+    free(source);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Mantissas of more than 19 digits do not fit in u64, they must not wrap around, or be cut short.
+bool run_acf_document_numbers_test(void *memory, usize memory_size)
+{
+    printf("long numbers: ");
+
+    char const source[] =
+        "a = 18446744073709551616.5; b = 36893488147419103232.0; c = 12345678901234567890123.0;"
+        "d = 9223372036854775807; e = -9223372036854775808; f = 000000000000000000000042; g = 0.1234567890123456789012";
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+
+    bool successfull = parse_acf_document(&document, source, sizeof(source) - 1);
+    if (successfull)
+    {
+        acf_node const& root = document.root;
+        successfull = (root["a"].get_float() == 18446744073709551616.5) &&
+            (root["b"].get_float() == 36893488147419103232.0) &&
+            (root["c"].get_float() == 12345678901234567890123.0) &&
+            (root["d"].get_int() == INT64_MAX) &&
+            (root["e"].get_int() == (int64) INT64_MIN) &&
+            (root["f"].get_int() == 42) &&
+            (root["g"].get_float() == 0.1234567890123456789012);
+    }
+
+    char const *out_of_range[] = { "a = 18446744073709551617", "a = 18446744073709551616", "a = 9223372036854775808", "a = -9223372036854775809" };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(out_of_range); i++)
+    {
+        reset_acf_document(&document);
+        successfull = !parse_acf_document(&document, out_of_range[i], strlen(out_of_range[i])) &&
+            (document.error_line == 1) && (document.error_column == 5) &&
+            (strstr(document.error_buffer, "Integer does not fit in 64 bits.") != NULL);
+        if (!successfull)
+        {
+            printf("\n'%s': %s", out_of_range[i], document.error_buffer);
+        }
+    }
+
+    // @note: Numbers longer than any buffer; digits past the 768th only tell if the rest is nonzero.
+    usize long_source_capacity = 4096;
+    char *long_source = (char *) malloc(long_source_capacity);
+    usize n = 0;
+    n += snprintf(long_source + n, long_source_capacity - n, "a = 1%0150d.0; b = 0.%0150d1e160; c = 1%01000d.0e-1000; d = 0.1%01000d1;", 0, 0, 0, 0);
+    n += snprintf(long_source + n, long_source_capacity - n, "e = -0.%0150d", 0);
+
+    reset_acf_document(&document);
+    successfull = successfull && parse_acf_document(&document, long_source, n);
+    if (successfull)
+    {
+        acf_node const& root = document.root;
+        successfull = (root["a"].get_float() == 1e150) &&
+            (root["b"].get_float() == 1e9) &&
+            (root["c"].get_float() == 1.0) &&
+            (root["d"].get_float() == 0.1) &&
+            (root["e"].get_float() == 0.0);
+        if (!successfull)
+        {
+            printf("\n%.17g %.17g %.17g %.17g", root["a"].get_float(), root["b"].get_float(), root["c"].get_float(), root["d"].get_float());
+        }
+    }
+    free(long_source);
+
+    release_acf_document(&document);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Root object takes the first level, so ACF_MAX_DEPTH - 1 arrays fit, deeper sources fail with an error instead of running out of stack.
+bool run_acf_document_depth_test(void *memory, usize memory_size)
+{
+    printf("nesting depth: ");
+
+    u32 const deep_count = 100000;
+    char *source = (char *) malloc(2 * deep_count + 16);
+
+    u32 const depths[] = { ACF_MAX_DEPTH - 1, ACF_MAX_DEPTH, deep_count };
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(depths); i++)
+    {
+        usize source_size = 0;
+        source_size += snprintf(source, 16, "a = ");
+        memset(source + source_size, '[', depths[i]);
+        memset(source + source_size + depths[i], ']', depths[i]);
+        source_size += 2 * depths[i];
+
+        reset_acf_document(&document);
+        bool parsed = parse_acf_document(&document, source, source_size);
+        if (depths[i] < ACF_MAX_DEPTH)
+        {
+            acf_node const *node = &document.root["a"];
+            for (u32 k = 1; parsed && k < depths[i]; k++)
+            {
+                parsed = node->is_array() && (node->size() == 1);
+                node = &(*node)[0];
+            }
+            successfull = parsed && node->is_array() && (node->size() == 0);
+        }
+        else
+        {
+            successfull = !parsed && (document.error_line == 1) && (document.error_column == 5 + ACF_MAX_DEPTH - 1) &&
+                (strstr(document.error_buffer, "Nesting is too deep") != NULL);
+        }
+
+        if (!successfull)
+        {
+            printf("\n%u: %s", depths[i], document.error_buffer);
+        }
+    }
+
+    // @note: Objects and constructor calls count the same way.
+    char const object_source[] = "#newtype box(int)\na = { b = { c = box(1) } }";
+    reset_acf_document(&document);
+    successfull = successfull && parse_acf_document(&document, object_source, sizeof(object_source) - 1) &&
+        (document.root["a"]["b"]["c"][0].get_int() == 1);
+
+    release_acf_document(&document);
+    free(source);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_document_tests()
+{
+    acf_document_test tests[] =
+    {
+        { "001_empty_object.acf", [](acf_node const& root) { return root.is_object() && root.size() == 0; } },
+        { "002_null_value.acf", [](acf_node const& root) { return root.size() == 1 && root["null_value"].is_null(); } },
+        { "003_boolean_value.acf", [](acf_node const& root) { return root["boolean_true_value"].get_bool() && !root["boolean_false_value"].get_bool(); } },
+        { "004_integer_value.acf", [](acf_node const& root) { return root["integer_value"].get_int() == 1042; } },
+        { "005_floating_value.acf", [](acf_node const& root) { return root["floating_point_value"].get_float() == 0.03; } },
+        { "006_string_value.acf", [](acf_node const& root) { return root["string_value"].get_string() == "doge wow so awesome!"; } },
+        { "007_comments.acf", [](acf_node const& root) { return root.is_object() && root.size() == 0; } },
+        { "008_many_types.acf", [](acf_node const& root) { return root.size() == 7 && root["v"][2].get_int() == 3 && root["o"]["b"].get_int() == 2; } },
+        { "009_optional_semicolons.acf", [](acf_node const& root) { return root.size() == 7 && root["s"].get_string() == "Strings are supported" && root["o"].size() == 2; } },
+        { "010_trailing_comma.acf", [](acf_node const& root) { return root["a"].size() == 5 && root["a"][4].get_int() == 5; } },
+        { "011_optional_commas.acf", [](acf_node const& root) { return root["a"].size() == 5 && root["a"][0].get_int() == 1; } },
+        { "012_optional_top_braces.acf", [](acf_node const& root) { return root.size() == 7 && root["z"].is_boolean() && root.get_key(6) == "o"; } },
+        { "013_newtype_0_args.acf", [](acf_node const& root) { return root["unit_value"].is_custom() && root["unit_value"].size() == 0; } },
+        { "014_newtype_1_null_arg.acf", [](acf_node const& root) { return root["void_value"].get_custom_type_name() == "void" && root["void_value"][0].is_null(); } },
+        { "015_newtype_1_bool_arg.acf", [](acf_node const& root) { return !root["resolution_is_dynamic"][0].get_bool() && root["windows_size_is_dynamic"][0].get_bool(); } },
+        { "016_newtype_1_int_arg.acf", [](acf_node const& root) { return root["weight"][0].get_int() == 10; } },
+        { "017_newtype_1_float_arg.acf", [](acf_node const& root) { return root["weight"][0].get_float() == 10.0; } },
+        { "018_newtype_1_string_arg.acf", [](acf_node const& root) { return root["identity"][0].get_string() == "Peter Parker"; } },
+        { "019_newtype_1_array_arg.acf", [](acf_node const& root) { return root["xs"][0].size() == 9 && root["ys"][0][8].get_int() == 9; } },
+        { "020_newtype_1_object_arg.acf", [](acf_node const& root) { return root["info"][0]["species"].get_string() == "cat" && root["info"][0]["weight"].get_int() == 4; } },
+        { "021_newtype_2_args.acf", [](acf_node const& root) { return root["position"][0].get_int() == 32 && root["position"][1].get_int() == 42; } },
+        { "022_newtype_3_args.acf", [](acf_node const& root) { return root["velocity"].size() == 3 && root["velocity"][2].get_int() == 30; } },
+        { "023_newtype_4_args.acf", [](acf_node const& root) { return root["color"].size() == 4 && root["color"][0].get_float() == 0.1 && root["color"][3].get_float() == 1.0; } },
+        { "024_type_value.acf", [](acf_node const& root) { return root["a"].get_type() == acf_type_t::integer; } },
+        { "025_int_to_float_conversion.acf", [](acf_node const& root) { return root["v"][0].is_floating() && root["v"][1].get_float() == 0.0; } },
+        { "026_type_type_value.acf", [](acf_node const& root) { return root["t"][0].get_type() == acf_type_t::integer; } },
+    };
+
+    usize memory_size = KILOBYTES(64);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+    for (u32 test_index = 0; test_index < ARRAY_COUNT(tests); test_index++)
+    {
+        record_test_result(&result, run_acf_document_test(tests[test_index], memory, memory_size));
+    }
+
+    record_test_result(&result, run_acf_document_wide_object_test(memory, memory_size));
+    record_test_result(&result, run_acf_document_numbers_test(memory, memory_size));
+    record_test_result(&result, run_acf_document_depth_test(memory, memory_size));
+
+    free(memory);
+    return result;
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_parallel.hpp>
+
+#include "acf_document_tests.hpp"
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+
+// @note: Runs every job on its own thread, as a work queue would.
+INTERNAL
+bool parse_acf_document_in_parallel(acf_document *document, char const *source, usize source_size, u32 thread_count, u32 *job_count)
+{
+    acf_parallel_parse *parse = (acf_parallel_parse *) malloc(sizeof(acf_parallel_parse));
+
+    *job_count = begin_acf_parallel_parse(parse, document, source, source_size, thread_count);
+
+    std::thread threads[ACF_PARALLEL_MAX_JOBS];
+    for (u32 i = 0; i < *job_count; i++)
+    {
+        threads[i] = std::thread(run_acf_parallel_parse_job, parse, i);
+    }
+    for (u32 i = 0; i < *job_count; i++)
+    {
+        threads[i].join();
+    }
+
+    bool result = finish_acf_parallel_parse(parse);
+    free(parse);
+    return result;
+}
+
+
+// @note: Records with everything the structural pass has to see through: brackets and commas
+// in strings and comments, nested containers and constructor calls.
+INTERNAL
+char *generate_acf_parallel_source(u32 record_count, usize *size)
+{
+    usize capacity = record_count * 256 + 1024;
+    char *result = (char *) malloc(capacity);
+
+    usize n = snprintf(result, capacity,
+        "#newtype vec2(float, float)\n"
+        "{\n"
+        "    version = 3; small = [ 1, 2, 3 ];\n"
+        "    records = [\n");
+
+    for (u32 i = 0; i < record_count; i++)
+    {
+        n += snprintf(result + n, capacity - n,
+            "        { id = %u; text = \"a, [b] {c}\"; position = vec2(%u, 0.5); tags = [ \"x\", [ %u ] ] } %s // ], } [\n",
+            i, i, i * 3, (i % 7 == 3) ? "" : ",");
+    }
+
+    n += snprintf(result + n, capacity - n, "    ]\n    after = { ok = true }\n}\n");
+
+    *size = n;
+    return result;
+}
+
+
+bool run_acf_parallel_equality_test(void *memory, usize memory_size)
+{
+    printf("parallel parse equality: ");
+
+    usize source_size = 0;
+    char *source = generate_acf_parallel_source(20000, &source_size);
+
+    void *expected_memory = malloc(memory_size);
+
+    acf_document expected;
+    initialize_acf_document(&expected, expected_memory, memory_size);
+    bool successfull = parse_acf_document(&expected, source, source_size) && (expected.root["records"].size() == 20000);
+
+    u32 thread_counts[] = { 1, 2, 3, 8, 64 };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(thread_counts); i++)
+    {
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        u32 job_count = 0;
+        successfull = parse_acf_document_in_parallel(&document, source, source_size, thread_counts[i], &job_count) &&
+            are_acf_nodes_equal(document.root, expected.root) &&
+            ((thread_counts[i] == 1) ? (job_count == 0) : (job_count > 1));
+
+        // @note: Unused tails of the job slices are given back, only the top-level nodes of the jobs stay twice.
+        usize overhead = 20000 * sizeof(acf_node) + job_count * 16;
+        successfull = successfull && (document.arena.used <= expected.arena.used + overhead);
+
+        if (!successfull)
+        {
+            printf("\n%u threads, %u jobs: %s", thread_counts[i], job_count, document.error_buffer);
+        }
+
+        release_acf_document(&document);
+    }
+
+    release_acf_document(&expected);
+    free(expected_memory);
+    free(source);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Errors anywhere, also inside of a job, are reported as the sequential parser reports them.
+bool run_acf_parallel_errors_test(void *memory, usize memory_size)
+{
+    printf("parallel parse errors: ");
+
+    usize source_size = 0;
+    char *source = generate_acf_parallel_source(20000, &source_size);
+
+    char const *breakages[] =
+    {
+        "id = 1000;",    // inside of a job
+        "version = 3",   // before the array
+        "ok = true",     // after the array
+        "tags = [",      // structure
+    };
+    char const *replacements[] =
+    {
+        "id = 1000,,",
+        "version = }",
+        "ok = tru ",
+        "tags = (",
+    };
+
+    void *expected_memory = malloc(memory_size);
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(breakages); i++)
+    {
+        char *broken = (char *) malloc(source_size + 1);
+        memcpy(broken, source, source_size);
+        broken[source_size] = 0;
+
+        char *at = strstr(broken, breakages[i]);
+        memcpy(at, replacements[i], strlen(replacements[i]));
+
+        acf_document expected;
+        initialize_acf_document(&expected, expected_memory, memory_size);
+        bool expected_result = parse_acf_document(&expected, broken, source_size);
+
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        u32 job_count = 0;
+        bool result = parse_acf_document_in_parallel(&document, broken, source_size, 8, &job_count);
+
+        successfull = !expected_result && !result && (strcmp(document.error_buffer, expected.error_buffer) == 0);
+        if (!successfull)
+        {
+            printf("\nexpected: %s\ngot: %s", expected.error_buffer, document.error_buffer);
+        }
+
+        release_acf_document(&document);
+        release_acf_document(&expected);
+        free(broken);
+    }
+
+    // @note: Not enough memory for the jobs is not an error, the sequential parse needs less.
+    if (successfull)
+    {
+        acf_document expected;
+        initialize_acf_document(&expected, expected_memory, memory_size);
+        parse_acf_document(&expected, source, source_size);
+        usize needed = expected.arena.used + 20000 * sizeof(acf_document_parser::scratch_entry) + KILOBYTES(4);
+
+        acf_document document;
+        initialize_acf_document(&document, memory, needed);
+
+        u32 job_count = 0;
+        successfull = parse_acf_document_in_parallel(&document, source, source_size, 8, &job_count) &&
+            (job_count > 1) && are_acf_nodes_equal(document.root, expected.root);
+
+        release_acf_document(&document);
+        release_acf_document(&expected);
+    }
+
+    free(expected_memory);
+    free(source);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_parallel_tests()
+{
+    usize memory_size = MEGABYTES(64);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+
+    record_test_result(&result, run_acf_parallel_equality_test(memory, memory_size));
+    record_test_result(&result, run_acf_parallel_errors_test(memory, memory_size));
+
+    free(memory);
+    return result;
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_reflect.hpp>
+
+#include "acf_document_tests.hpp"
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct reflect_test_vec2
+{
+    float32 x;
+    float32 y;
+};
+ACF_STRUCT(reflect_test_vec2, ACF_FIELD(x), ACF_FIELD(y));
+
+
+struct reflect_test_window
+{
+    int32 width;
+    uint32 height;
+    bool fullscreen;
+    char title[16];
+    reflect_test_vec2 position;
+    reflect_test_vec2 size;
+    float64 tint[4];
+    int64 seed;
+    reflect_test_vec2 points[3];
+    char layers[3][8];
+};
+ACF_STRUCT(reflect_test_window,
+    ACF_FIELD(width),
+    ACF_FIELD(height),
+    ACF_FIELD(fullscreen),
+    ACF_FIELD(title),
+    ACF_FIELD_NAMED(position, "pos"),
+    ACF_FIELD(size),
+    ACF_FIELD(tint),
+    ACF_FIELD(seed),
+    ACF_FIELD(points),
+    ACF_FIELD(layers));
+
+
+// @note: Descriptors are built by the compiler, nothing runs at startup.
+static_assert(get_acf_struct<reflect_test_window>()->field_count == 10, "");
+static_assert(get_acf_struct<reflect_test_window>()->fields[4].key.hash == hash_acf_key("pos", 3), "");
+static_assert(get_acf_struct<reflect_test_window>()->fields[6].count == 4, "");
+static_assert(get_acf_struct<reflect_test_window>()->fields[9].kind == acf_field_kind::string, "");
+
+
+GLOBAL char const reflect_test_source[] =
+    "#newtype reflect_test_vec2(float, float)\n"
+    "width = 1920; height = 1080; fullscreen = true; title = \"Asuka\";\n"
+    "pos = reflect_test_vec2(10, 20.5);\n"
+    "size = { x = 640; y = 480; unknown = [ { deep = 1 } ] };\n"
+    "tint = [ 1, 0.5, 0.25 ];\n"
+    "comment = \"not bound\";\n"
+    "seed = 123456789012345;\n"
+    "points = [ { x = 1 }, reflect_test_vec2(2, 3) ];\n"
+    "layers = [ \"ui\", \"world\" ];\n";
+
+
+INTERNAL
+bool check_reflect_test_window(reflect_test_window const& w)
+{
+    return (w.width == 1920) && (w.height == 1080) && w.fullscreen && (strcmp(w.title, "Asuka") == 0) &&
+        (w.position.x == 10.0f) && (w.position.y == 20.5f) &&
+        (w.size.x == 640.0f) && (w.size.y == 480.0f) &&
+        (w.tint[0] == 1.0) && (w.tint[1] == 0.5) && (w.tint[2] == 0.25) && (w.tint[3] == -1.0) &&
+        (w.seed == 123456789012345ll) &&
+        (w.points[0].x == 1.0f) && (w.points[0].y == -1.0f) && (w.points[1].x == 2.0f) && (w.points[1].y == 3.0f) &&
+        (w.points[2].x == -1.0f) &&
+        (strcmp(w.layers[0], "ui") == 0) && (strcmp(w.layers[1], "world") == 0) && (w.layers[2][0] == 0);
+}
+
+
+// @note: Fields which are not in the source have to keep their values.
+INTERNAL
+reflect_test_window make_reflect_test_window()
+{
+    reflect_test_window result = {};
+    result.tint[3] = -1.0;
+    result.points[0].y = -1.0f;
+    result.points[2].x = -1.0f;
+    return result;
+}
+
+
+INTERNAL
+bool bind_reflect_test_in_chunks(acf_struct const *structure, void *result, char const *source, usize source_size, usize chunk_size, bool register_vec2)
+{
+    acf_struct_binder *binder = (acf_struct_binder *) malloc(sizeof(acf_struct_binder));
+    begin_acf_struct_bind(binder, structure, result);
+    if (register_vec2) register_acf_stream_struct(&binder->stream, get_acf_struct<reflect_test_vec2>());
+
+    bool successfull = true;
+    for (usize offset = 0; successfull && offset < source_size; offset += chunk_size)
+    {
+        usize size = (source_size - offset < chunk_size) ? source_size - offset : chunk_size;
+        successfull = feed_acf_struct_bind(binder, source + offset, size);
+    }
+    successfull = successfull && finish_acf_struct_bind(binder);
+
+    free(binder);
+    return successfull;
+}
+
+
+bool run_acf_reflect_document_test(void *memory, usize memory_size)
+{
+    printf("reflect bind document: ");
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+
+    reflect_test_window window = make_reflect_test_window();
+    bool successfull = parse_acf_document(&document, reflect_test_source, sizeof(reflect_test_source) - 1) &&
+        bind_acf(document.root, &window) && check_reflect_test_window(window);
+
+    // @note: Newtype is registered from the descriptor, the source does not declare it.
+    if (successfull)
+    {
+        char const source[] = "x = 1; y = reflect_test_vec2(3, 4.5)";
+
+        reset_acf_document(&document);
+        successfull = register_acf_document_struct(&document, get_acf_struct<reflect_test_vec2>()) &&
+            parse_acf_document(&document, source, sizeof(source) - 1);
+
+        reflect_test_vec2 v = {};
+        successfull = successfull && bind_acf(document.root["y"], &v) && (v.x == 3.0f) && (v.y == 4.5f);
+    }
+
+    release_acf_document(&document);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_acf_reflect_stream_test()
+{
+    printf("reflect bind stream: ");
+
+    bool successfull = true;
+
+    usize chunk_sizes[] = { 1, 3, 7, 64, sizeof(reflect_test_source) };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(chunk_sizes); i++)
+    {
+        reflect_test_window window = make_reflect_test_window();
+        successfull = bind_reflect_test_in_chunks(get_acf_struct<reflect_test_window>(), &window,
+            reflect_test_source, sizeof(reflect_test_source) - 1, chunk_sizes[i], false) &&
+            check_reflect_test_window(window);
+    }
+
+    if (successfull)
+    {
+        char const source[] = "pos = reflect_test_vec2(5, 6)";
+
+        reflect_test_window window = {};
+        successfull = bind_reflect_test_in_chunks(get_acf_struct<reflect_test_window>(), &window, source, sizeof(source) - 1, 4, true) &&
+            (window.position.x == 5.0f) && (window.position.y == 6.0f);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_acf_reflect_errors_test(void *memory, usize memory_size)
+{
+    printf("reflect errors: ");
+
+    char const *sources[] =
+    {
+        "width = 1.5",
+        "width = 3000000000",
+        "height = -1",
+        "fullscreen = 1",
+        "title = \"this title is too long\"",
+        "tint = [ 1, 2, 3, 4, 5 ]",
+        "tint = 1",
+        "pos = 5",
+        "size = [ 1, 2 ]",
+        "layers = [ \"a\", \"b\", \"c\", \"d\" ]",
+        "#newtype other(float, float)\n pos = other(1, 2)",
+        "points = [ { x = \"a\" } ]",
+    };
+
+    bool successfull = true;
+    for (u32 i = 0; i < ARRAY_COUNT(sources); i++)
+    {
+        usize size = strlen(sources[i]);
+
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        reflect_test_window window = {};
+        if (!parse_acf_document(&document, sources[i], size) || bind_acf(document.root, &window))
+        {
+            printf("\n'%s' was bound from the document", sources[i]);
+            successfull = false;
+        }
+
+        if (bind_reflect_test_in_chunks(get_acf_struct<reflect_test_window>(), &window, sources[i], size, 2, false))
+        {
+            printf("\n'%s' was bound from the stream", sources[i]);
+            successfull = false;
+        }
+
+        release_acf_document(&document);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_reflect_tests()
+{
+    usize memory_size = KILOBYTES(64);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+
+    record_test_result(&result, run_acf_reflect_document_test(memory, memory_size));
+    record_test_result(&result, run_acf_reflect_stream_test());
+    record_test_result(&result, run_acf_reflect_errors_test(memory, memory_size));
+
+    free(memory);
+    return result;
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_serialize.hpp>
+
+#include "acf_document_tests.hpp"
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// @note: Text -> document -> text -> document has to give the same tree, in every layout.
+bool run_acf_serialize_test(char const *filename, void *memory, usize memory_size)
+{
+    printf("%s (serialize): ", filename);
+
+    usize source_size = 0;
+    char *source = load_acf_test_file(filename, &source_size);
+
+    bool successfull = false;
+    if (source)
+    {
+        void *expected_memory = malloc(memory_size);
+
+        acf_document expected;
+        initialize_acf_document(&expected, expected_memory, memory_size);
+        successfull = parse_acf_document(&expected, source, source_size);
+
+        acf_serialize_options layouts[4];
+        layouts[1].multiline = acf_serialize_options::multiline_t::enabled;
+        layouts[2].multiline = acf_serialize_options::multiline_t::disabled;
+        layouts[2].print_spaces = false;
+        layouts[3].multiline = acf_serialize_options::multiline_t::disabled;
+        layouts[3].print_spaces = false;
+        layouts[3].print_commas = false;
+        layouts[3].print_semicolons = false;
+
+        for (u32 i = 0; successfull && i < ARRAY_COUNT(layouts); i++)
+        {
+            acf_buffer buffer = {};
+            successfull = acf_serialize_document(&expected, &buffer, layouts[i]);
+
+            acf_document document;
+            initialize_acf_document(&document, memory, memory_size);
+            successfull = successfull && parse_acf_document(&document, buffer.data, buffer.size) &&
+                are_acf_nodes_equal(document.root, expected.root) &&
+                (document.newtype_count == expected.newtype_count);
+
+            if (!successfull)
+            {
+                printf("\n%.*s\n%s\n", (int) buffer.size, buffer.data, document.error_buffer);
+            }
+
+            free_acf_buffer(&buffer);
+            release_acf_document(&document);
+        }
+
+        release_acf_document(&expected);
+        free(expected_memory);
+        free(source);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+INTERNAL
+bool check_acf_float_round_trip(float64 value)
+{
+    char text[ACF_FLOAT_BUFFER_SIZE];
+    u32 size = format_acf_float(value, text);
+
+    acf_document_token token = acf_document_lex(text, text + size);
+
+    bool result = (token.type == acf_document_token_type::floating) && (token.size == size) &&
+        (memcmp(&token.floating_value, &value, sizeof(value)) == 0);
+    if (!result)
+    {
+        printf("\n%.17g -> '%.*s'", value, (int) size, text);
+    }
+    return result;
+}
+
+
+// @note: Digits without the sign, the leading and the trailing zeros. No shorter digits may read back as the value, the
+// closest ones of each length from printf are the reference (the next ones up can be in the interval too, when the value
+// is a power of two, so formatted digits may be even shorter than that).
+INTERNAL
+bool check_acf_float_shortest(float64 value)
+{
+    char text[ACF_FLOAT_BUFFER_SIZE];
+    u32 size = format_acf_float(value, text);
+
+    u32 first = 0;
+    u32 digit_count = 0;
+    u32 zero_count = 0;
+    for (u32 i = 0; i < size && text[i] != 'e'; i++)
+    {
+        if (text[i] < '0' || text[i] > '9') continue;
+        if (text[i] == '0' && first == 0) continue;
+
+        first = 1;
+        zero_count = (text[i] == '0') ? zero_count + 1 : 0;
+        digit_count += 1;
+    }
+    digit_count -= zero_count;
+
+    u32 shortest_count = 17;
+    for (u32 precision = 1; precision < 17; precision++)
+    {
+        char reference[ACF_FLOAT_BUFFER_SIZE];
+        snprintf(reference, sizeof(reference), "%.*e", (int) precision - 1, value);
+        if (strtod(reference, NULL) == value)
+        {
+            shortest_count = precision;
+            break;
+        }
+    }
+
+    bool result = (digit_count <= shortest_count);
+    if (!result)
+    {
+        printf("\n%.17g -> '%.*s', %u digits are enough", value, (int) size, text, shortest_count);
+    }
+    return result;
+}
+
+
+bool run_acf_serialize_numbers_test()
+{
+    printf("serialize numbers: ");
+
+    struct float_case
+    {
+        float64 value;
+        char const *text;
+    };
+
+    float_case float_cases[] =
+    {
+        { 0.0, "0.0" },
+        { -0.0, "-0.0" },
+        { 1.0, "1.0" },
+        { 0.1, "0.1" },
+        { -2.5, "-2.5" },
+        { 100.0, "100.0" },
+        { 0.001, "0.001" },
+        { 1e14, "100000000000000.0" },
+        { 1e15, "1e15" },
+        { 1.5e-7, "1.5e-7" },
+        { 1e300, "1e300" },
+        { 5e-324, "5e-324" },
+        { 1.7976931348623157e308, "1.7976931348623157e308" },
+        { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+        { 0.30000000000000004, "0.30000000000000004" },
+        { 5.0283511171145743e132, "5.028351117114574e132" },
+        { 2.3829193053854568e16, "2.382919305385457e16" },
+    };
+
+    bool successfull = true;
+    for (u32 i = 0; i < ARRAY_COUNT(float_cases); i++)
+    {
+        char text[ACF_FLOAT_BUFFER_SIZE];
+        u32 size = format_acf_float(float_cases[i].value, text);
+        if ((size != strlen(float_cases[i].text)) || (memcmp(text, float_cases[i].text, size) != 0))
+        {
+            printf("\nexpected '%s', got '%.*s'", float_cases[i].text, (int) size, text);
+            successfull = false;
+        }
+        successfull = check_acf_float_round_trip(float_cases[i].value) && successfull;
+    }
+
+    // @note: Random bit patterns cover every exponent, including subnormals.
+    u64 state = 0x2545F4914F6CDD1Dull;
+    for (u32 i = 0; i < 100000; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        float64 value;
+        memcpy(&value, &state, sizeof(value));
+        if (value == value && value - value == 0) // @note: Skips infinities and NaNs.
+        {
+            successfull = check_acf_float_round_trip(value) && check_acf_float_shortest(value) && successfull;
+        }
+    }
+
+    for (int32 exponent = -1074; exponent < 1024; exponent++)
+    {
+        float64 value = ldexp(1.0, exponent);
+        successfull = check_acf_float_round_trip(value) && check_acf_float_shortest(value) && successfull;
+    }
+
+    char text[ACF_FLOAT_BUFFER_SIZE];
+    float64 infinity = 1e308 * 10;
+    successfull = successfull && (format_acf_float(infinity, text) == 0) && (format_acf_float(infinity - infinity, text) == 0);
+
+    int64 int_cases[] = { 0, 7, -7, 10, 99, 100, 123456789, -1000000, (int64) INT64_MAX, (int64) INT64_MIN };
+    for (u32 i = 0; i < ARRAY_COUNT(int_cases); i++)
+    {
+        char expected[ACF_FLOAT_BUFFER_SIZE];
+        snprintf(expected, sizeof(expected), "%lld", (long long) int_cases[i]);
+
+        u32 size = format_acf_int(int_cases[i], text);
+        if ((size != strlen(expected)) || (memcmp(text, expected, size) != 0))
+        {
+            printf("\nexpected '%s', got '%.*s'", expected, (int) size, text);
+            successfull = false;
+        }
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_acf_serialize_layout_test(void *memory, usize memory_size)
+{
+    printf("serialize layout: ");
+
+    char const source[] =
+        "#newtype vec2(float, float)\n"
+        "a = 1; b = [ 1, 2 ]; c = { x = vec2(1, 0.5) }; d = [ 1, 2, 3, 4 ]; e = []";
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+    bool successfull = parse_acf_document(&document, source, sizeof(source) - 1);
+
+    acf_serialize_options compact;
+    compact.multiline = acf_serialize_options::multiline_t::disabled;
+    compact.print_spaces = false;
+
+    struct layout_case
+    {
+        acf_serialize_options options;
+        char const *text;
+    };
+
+    layout_case cases[] =
+    {
+        {
+            acf_serialize_options(),
+            "#newtype vec2(float, float)\n"
+            "{\n"
+            "  a = 1;\n"
+            "  b = [ 1, 2 ];\n"
+            "  c = {\n"
+            "    x = vec2(1.0, 0.5);\n"
+            "  };\n"
+            "  d = [\n"
+            "    1,\n"
+            "    2,\n"
+            "    3,\n"
+            "    4\n"
+            "  ];\n"
+            "  e = [];\n"
+            "}\n"
+        },
+        {
+            compact,
+            "#newtype vec2(float, float)\n"
+            "{a=1;b=[1,2];c={x=vec2(1.0,0.5);};d=[1,2,3,4];e=[];}\n"
+        },
+    };
+
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(cases); i++)
+    {
+        acf_buffer buffer = {};
+        successfull = acf_serialize_document(&document, &buffer, cases[i].options) &&
+            (buffer.size == strlen(cases[i].text)) && (memcmp(buffer.data, cases[i].text, buffer.size) == 0);
+        if (!successfull)
+        {
+            printf("\n%.*s", (int) buffer.size, buffer.data);
+        }
+        free_acf_buffer(&buffer);
+    }
+
+    // @note: Strings the format can not express are refused instead of written broken.
+    if (successfull)
+    {
+        acf_node string = {};
+        string.type = acf_type_t::string;
+        string.string_value = "say \"hi\"";
+        string.count = 8;
+
+        acf_buffer buffer = {};
+        successfull = !acf_serialize(string, &buffer);
+        free_acf_buffer(&buffer);
+    }
+
+    release_acf_document(&document);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_serialize_tests()
+{
+    char const *filenames[] =
+    {
+        "001_empty_object.acf",
+        "002_null_value.acf",
+        "003_boolean_value.acf",
+        "004_integer_value.acf",
+        "005_floating_value.acf",
+        "006_string_value.acf",
+        "007_comments.acf",
+        "008_many_types.acf",
+        "009_optional_semicolons.acf",
+        "010_trailing_comma.acf",
+        "011_optional_commas.acf",
+        "012_optional_top_braces.acf",
+        "013_newtype_0_args.acf",
+        "014_newtype_1_null_arg.acf",
+        "015_newtype_1_bool_arg.acf",
+        "016_newtype_1_int_arg.acf",
+        "017_newtype_1_float_arg.acf",
+        "018_newtype_1_string_arg.acf",
+        "019_newtype_1_array_arg.acf",
+        "020_newtype_1_object_arg.acf",
+        "021_newtype_2_args.acf",
+        "022_newtype_3_args.acf",
+        "023_newtype_4_args.acf",
+        "024_type_value.acf",
+        "025_int_to_float_conversion.acf",
+        "026_type_type_value.acf",
+    };
+
+    usize memory_size = KILOBYTES(64);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+    for (u32 test_index = 0; test_index < ARRAY_COUNT(filenames); test_index++)
+    {
+        record_test_result(&result, run_acf_serialize_test(filenames[test_index], memory, memory_size));
+    }
+
+    record_test_result(&result, run_acf_serialize_numbers_test());
+    record_test_result(&result, run_acf_serialize_layout_test(memory, memory_size));
+
+    free(memory);
+    return result;
+}
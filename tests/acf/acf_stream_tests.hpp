@@ -0,0 +1,417 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_stream.hpp>
+
+#include "acf_document_tests.hpp"
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+INTERNAL
+bool build_acf_document_in_chunks(acf_document *document, char const *source, usize source_size, usize chunk_size)
+{
+    acf_document_builder *builder = (acf_document_builder *) malloc(sizeof(acf_document_builder));
+    begin_acf_document_build(builder, document);
+
+    bool result = true;
+    for (usize offset = 0; result && offset < source_size; offset += chunk_size)
+    {
+        usize size = (source_size - offset < chunk_size) ? source_size - offset : chunk_size;
+        result = feed_acf_document_build(builder, source + offset, size);
+    }
+    result = result && finish_acf_document_build(builder);
+
+    free(builder);
+    return result;
+}
+
+
+// @note: Document built from chunks of any size has to be the same as the parsed one.
+bool run_acf_stream_test(char const *filename, void *memory, usize memory_size)
+{
+    printf("%s (chunked): ", filename);
+
+    usize source_size = 0;
+    char *source = load_acf_test_file(filename, &source_size);
+
+    bool successfull = false;
+    if (source)
+    {
+        void *expected_memory = malloc(memory_size);
+
+        acf_document expected;
+        initialize_acf_document(&expected, expected_memory, memory_size);
+        successfull = parse_acf_document(&expected, source, source_size);
+
+        usize chunk_sizes[] = { 1, 2, 3, 7, 64, source_size + 1 };
+        for (u32 i = 0; successfull && i < ARRAY_COUNT(chunk_sizes); i++)
+        {
+            acf_document document;
+            initialize_acf_document(&document, memory, memory_size);
+
+            successfull = build_acf_document_in_chunks(&document, source, source_size, chunk_sizes[i]);
+            if (successfull)
+            {
+                successfull = are_acf_nodes_equal(document.root, expected.root);
+            }
+            else
+            {
+                printf("\n%s\n", document.error_buffer);
+            }
+
+            release_acf_document(&document);
+        }
+
+        release_acf_document(&expected);
+        free(expected_memory);
+        free(source);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_acf_stream_errors_test(void *memory, usize memory_size)
+{
+    printf("stream errors: ");
+
+    struct error_case
+    {
+        char const *source;
+        u32 line;
+        u32 column;
+    };
+
+    error_case cases[] =
+    {
+        { "{ a = 1; a = 2 }", 1, 10 },
+        { "{ a = }", 1, 7 },
+        { "{\n  a = 1\n  b = foo(1)\n}", 3, 7 },
+        { "#newtype v(int)\n x = v(1.5)", 2, 8 },
+        { "{ a = \"unterminated\n }", 1, 7 },
+        { "[1]", 1, 1 },
+        { "{ a = 1 } x", 1, 11 },
+        { "a = [1, 2", 1, 10 },
+        { "a = 1 / 2", 1, 7 },
+        { "// comment\n  very_long_identifier_is_here = !", 2, 34 },
+    };
+
+    bool successfull = true;
+    for (u32 case_index = 0; case_index < ARRAY_COUNT(cases); case_index++)
+    {
+        error_case c = cases[case_index];
+
+        usize chunk_sizes[] = { 1, 4, 1024 };
+        for (u32 i = 0; i < ARRAY_COUNT(chunk_sizes); i++)
+        {
+            acf_document document;
+            initialize_acf_document(&document, memory, memory_size);
+
+            bool built = build_acf_document_in_chunks(&document, c.source, strlen(c.source), chunk_sizes[i]);
+            if (built || (document.error_line != c.line) || (document.error_column != c.column) || document.root.is_object())
+            {
+                printf("\n'%s' in chunks of %llu: %s", c.source, (unsigned long long) chunk_sizes[i], built ? "no error\n" : document.error_buffer);
+                successfull = false;
+            }
+
+            release_acf_document(&document);
+        }
+    }
+
+    // @note: Zero byte is an error in the stream, also when it is the last byte of a chunk.
+    char const zero_source[] = "{\n}\0";
+    for (usize chunk_size = 1; chunk_size <= sizeof(zero_source) - 1; chunk_size++)
+    {
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        bool built = build_acf_document_in_chunks(&document, zero_source, sizeof(zero_source) - 1, chunk_size);
+        if (built || (document.error_line != 2) || (document.error_column != 2))
+        {
+            printf("\nzero byte in chunks of %llu: %s", (unsigned long long) chunk_size, built ? "no error\n" : document.error_buffer);
+            successfull = false;
+        }
+
+        release_acf_document(&document);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Exponent can be split anywhere between chunks, "1e" alone is not a finished token.
+bool run_acf_stream_exponents_test(void *memory, usize memory_size)
+{
+    printf("stream exponents: ");
+
+    char const source[] = "a = 1.5e10; b = -2E-3; c = 7e+2; d = 1.0e308; e = 4.9e-324; f = [ 1e5, 2.5e1 ]";
+
+    void *expected_memory = malloc(memory_size);
+
+    acf_document expected;
+    initialize_acf_document(&expected, expected_memory, memory_size);
+    bool successfull = parse_acf_document(&expected, source, sizeof(source) - 1) &&
+        (expected.root["a"].get_float() == 1.5e10) && (expected.root["b"].get_float() == -2e-3) &&
+        (expected.root["c"].get_float() == 700.0) && (expected.root["e"].get_float() == 4.9e-324);
+
+    usize chunk_sizes[] = { 1, 2, 3, 5 };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(chunk_sizes); i++)
+    {
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        successfull = build_acf_document_in_chunks(&document, source, sizeof(source) - 1, chunk_sizes[i]) &&
+            are_acf_nodes_equal(document.root, expected.root);
+
+        release_acf_document(&document);
+    }
+
+    // @note: "1e" at the end of a chunk looks like the beginning of an exponent, and turns out to be "1" and "e".
+    char const *broken_sources[] = { "a = [ 1e, 2 ]", "a = [ 1ex 2 ]", "a = [ 2e+ ]", "a = 1e" };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(broken_sources); i++)
+    {
+        usize size = strlen(broken_sources[i]);
+
+        reset_acf_document(&expected);
+        successfull = !parse_acf_document(&expected, broken_sources[i], size);
+
+        for (u32 j = 0; successfull && j < ARRAY_COUNT(chunk_sizes); j++)
+        {
+            acf_document document;
+            initialize_acf_document(&document, memory, memory_size);
+
+            // @note: Stream errors do not quote the source, only the first lines are the same.
+            usize message_size = strcspn(expected.error_buffer, "\n");
+            successfull = !build_acf_document_in_chunks(&document, broken_sources[i], size, chunk_sizes[j]) &&
+                (strncmp(document.error_buffer, expected.error_buffer, message_size) == 0);
+
+            release_acf_document(&document);
+        }
+    }
+
+    release_acf_document(&expected);
+    free(expected_memory);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: All newtypes the stream can hold, looked up in a different order than declared, and one too many.
+bool run_acf_stream_newtypes_test(void *memory, usize memory_size)
+{
+    printf("stream newtypes: ");
+
+    char source[4096];
+    usize size = 0;
+    for (u32 i = 0; i < ACF_MAX_NEWTYPES; i++)
+    {
+        size += snprintf(source + size, sizeof(source) - size, "#newtype type_%u(int)\n", i);
+    }
+    usize declarations_size = size;
+    for (u32 i = 0; i < ACF_MAX_NEWTYPES; i++)
+    {
+        u32 k = (i * 7) % ACF_MAX_NEWTYPES;
+        size += snprintf(source + size, sizeof(source) - size, "value_%u = type_%u(%u);\n", i, k, k);
+    }
+
+    void *expected_memory = malloc(memory_size);
+
+    acf_document expected;
+    initialize_acf_document(&expected, expected_memory, memory_size);
+    bool successfull = parse_acf_document(&expected, source, size) &&
+        (expected.root["value_1"].get_custom_type_name() == "type_7");
+
+    usize chunk_sizes[] = { 1, 7, 4096 };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(chunk_sizes); i++)
+    {
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        successfull = build_acf_document_in_chunks(&document, source, size, chunk_sizes[i]) &&
+            are_acf_nodes_equal(document.root, expected.root);
+
+        release_acf_document(&document);
+    }
+
+    // @note: Names are already taken, or there is no place for another one.
+    char const *extra_declarations[] = { "#newtype type_0(int)\n", "#newtype type_31(float)\n", "#newtype type_32(int)\n" };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(extra_declarations); i++)
+    {
+        size = declarations_size + snprintf(source + declarations_size, sizeof(source) - declarations_size, "%s", extra_declarations[i]);
+
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+
+        successfull = !build_acf_document_in_chunks(&document, source, size, 7);
+
+        release_acf_document(&document);
+    }
+
+    release_acf_document(&expected);
+    free(expected_memory);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+struct acf_stream_counter
+{
+    u64 value_count;
+    u64 key_count;
+    int64 integer_sum;
+    u32 depth;
+    u32 max_depth;
+};
+
+
+INTERNAL
+bool acf_stream_count_event(void *user_data, acf_event const *event)
+{
+    acf_stream_counter *counter = (acf_stream_counter *) user_data;
+    switch (event->type)
+    {
+        case acf_event_type::key: counter->key_count += 1; break;
+        case acf_event_type::value:
+        {
+            counter->value_count += 1;
+            counter->integer_sum += event->value.get_int_or(0);
+        }
+        break;
+
+        case acf_event_type::begin_object:
+        case acf_event_type::begin_array:
+        case acf_event_type::begin_custom:
+        {
+            counter->depth += 1;
+            if (counter->depth > counter->max_depth) counter->max_depth = counter->depth;
+        }
+        break;
+
+        case acf_event_type::end_object:
+        case acf_event_type::end_array:
+        case acf_event_type::end_custom:
+            counter->depth -= 1;
+            break;
+
+        default: break;
+    }
+    return true;
+}
+
+
+// @note: The source is generated piece by piece and is never held in memory as a whole.
+bool run_acf_stream_large_input_test()
+{
+    printf("stream large input: ");
+
+    acf_stream *stream = (acf_stream *) malloc(sizeof(acf_stream));
+    acf_stream_counter counter = {};
+    initialize_acf_stream(stream, acf_stream_count_event, &counter);
+
+    char const header[] = "#newtype vec2(float, float)\n{\n";
+    bool successfull = feed_acf_stream(stream, header, sizeof(header) - 1);
+
+    u32 const item_count = 100000;
+    char chunk[1000];
+    usize chunk_size = 0;
+    for (u32 i = 0; successfull && i < item_count; i++)
+    {
+        char item[128];
+        int n = snprintf(item, sizeof(item), "    item_%u = { id = %u; position = vec2(%u, 0.5); tags = [ \"a\", \"b\" ] } // %u\n", i, i, i, i);
+
+        for (int k = 0; successfull && k < n; k++)
+        {
+            chunk[chunk_size++] = item[k];
+            if (chunk_size == sizeof(chunk))
+            {
+                successfull = feed_acf_stream(stream, chunk, chunk_size);
+                chunk_size = 0;
+            }
+        }
+    }
+
+    successfull = successfull && feed_acf_stream(stream, chunk, chunk_size);
+    successfull = successfull && feed_acf_stream(stream, "}\n", 2);
+    successfull = successfull && finish_acf_stream(stream);
+
+    if (!successfull)
+    {
+        printf("\n%s\n", stream->error_buffer);
+    }
+
+    int64 expected_sum = (int64) item_count * (item_count - 1) / 2;
+    successfull = successfull &&
+        (counter.key_count == item_count * 4) &&
+        (counter.value_count == item_count * 5) &&
+        (counter.integer_sum == expected_sum) &&
+        (counter.max_depth == 3) && (counter.depth == 0);
+
+    free(stream);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_stream_tests()
+{
+    char const *filenames[] =
+    {
+        "001_empty_object.acf",
+        "002_null_value.acf",
+        "003_boolean_value.acf",
+        "004_integer_value.acf",
+        "005_floating_value.acf",
+        "006_string_value.acf",
+        "007_comments.acf",
+        "008_many_types.acf",
+        "009_optional_semicolons.acf",
+        "010_trailing_comma.acf",
+        "011_optional_commas.acf",
+        "012_optional_top_braces.acf",
+        "013_newtype_0_args.acf",
+        "014_newtype_1_null_arg.acf",
+        "015_newtype_1_bool_arg.acf",
+        "016_newtype_1_int_arg.acf",
+        "017_newtype_1_float_arg.acf",
+        "018_newtype_1_string_arg.acf",
+        "019_newtype_1_array_arg.acf",
+        "020_newtype_1_object_arg.acf",
+        "021_newtype_2_args.acf",
+        "022_newtype_3_args.acf",
+        "023_newtype_4_args.acf",
+        "024_type_value.acf",
+        "025_int_to_float_conversion.acf",
+        "026_type_type_value.acf",
+    };
+
+    usize memory_size = KILOBYTES(64);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+    for (u32 test_index = 0; test_index < ARRAY_COUNT(filenames); test_index++)
+    {
+        record_test_result(&result, run_acf_stream_test(filenames[test_index], memory, memory_size));
+    }
+
+    record_test_result(&result, run_acf_stream_errors_test(memory, memory_size));
+    record_test_result(&result, run_acf_stream_exponents_test(memory, memory_size));
+    record_test_result(&result, run_acf_stream_newtypes_test(memory, memory_size));
+    record_test_result(&result, run_acf_stream_large_input_test());
+
+    free(memory);
+    return result;
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_stream.hpp>
+#include <acf/acf_binary.hpp>
+#include <acf/acf_serialize.hpp>
+
+#include "acf_binary_tests.hpp"
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+bool run_acf_string_table_test()
+{
+    printf("string table: ");
+
+    acf_string_table table = {};
+
+    u32 const string_count = 5000;
+    u32 ids[string_count];
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < string_count; i++)
+    {
+        char buffer[32];
+        int size = snprintf(buffer, sizeof(buffer), "string_%u", i);
+
+        ids[i] = intern_acf_string(&table, make_acf_key(buffer, (u32) size));
+        successfull = (ids[i] == i + 1);
+    }
+
+    // @note: Ids and pointers stay the same while the table grows.
+    char const *first = get_acf_string(&table, ids[0]).data;
+    for (u32 i = 0; successfull && i < string_count; i++)
+    {
+        char buffer[32];
+        int size = snprintf(buffer, sizeof(buffer), "string_%u", i);
+        acf_key key = make_acf_key(buffer, (u32) size);
+
+        acf_key interned = get_acf_string(&table, ids[i]);
+        successfull = (intern_acf_string(&table, key) == ids[i]) && (find_acf_string(&table, key) == ids[i]) &&
+            (interned == key) && (interned.data != buffer) && (interned.data[interned.size] == 0);
+    }
+    successfull = successfull && (get_acf_string(&table, ids[0]).data == first) && (table.count == string_count);
+    successfull = successfull && (find_acf_string(&table, ACF_KEY("string_5000")) == 0) && (table.count == string_count);
+
+    // @note: Long strings go to blocks of their own, and the empty string is a string too.
+    usize long_size = ACF_STRING_BLOCK_SIZE + 100;
+    char *long_string = (char *) malloc(long_size);
+    memset(long_string, 'x', long_size);
+
+    u32 long_id = intern_acf_string(&table, make_acf_key(long_string, (u32) long_size));
+    u32 empty_id = intern_acf_string(&table, make_acf_key("", 0));
+    successfull = successfull && (long_id == string_count + 1) && (empty_id == string_count + 2) &&
+        (get_acf_string(&table, long_id).size == long_size) && (memcmp(get_acf_string(&table, long_id).data, long_string, long_size) == 0) &&
+        (intern_acf_string(&table, make_acf_key(long_string, (u32) long_size)) == long_id) &&
+        (intern_acf_string(&table, ACF_KEY("string_1")) == ids[1]);
+
+    free(long_string);
+    free_acf_string_table(&table);
+    successfull = successfull && (table.count == 0) && (find_acf_string(&table, ACF_KEY("string_1")) == 0);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+INTERNAL
+char *generate_acf_strings_source(u32 record_count, usize *size)
+{
+    usize capacity = record_count * 256 + 1024;
+    char *result = (char *) malloc(capacity);
+
+    usize n = snprintf(result, capacity, "#newtype vec2(float, float)\n{\n    records = [\n");
+    for (u32 i = 0; i < record_count; i++)
+    {
+        n += snprintf(result + n, capacity - n,
+            "        { id = %u; name = \"record\"; position = vec2(%u, 1); a = 1; b = 2; c = 3; d = 4; e = 5; f = 6 }\n",
+            i, i);
+    }
+    n += snprintf(result + n, capacity - n, "    ]\n    small = { id = 1 }\n}\n");
+
+    *size = n;
+    return result;
+}
+
+
+// @note: Interned documents are the same trees, but records share one key list, which is found through its index.
+bool run_acf_interned_document_test(void *memory, usize memory_size)
+{
+    printf("interned document: ");
+
+    u32 const record_count = 1000;
+    usize source_size = 0;
+    char *source = generate_acf_strings_source(record_count, &source_size);
+
+    void *expected_memory = malloc(memory_size);
+    acf_document expected;
+    initialize_acf_document(&expected, expected_memory, memory_size);
+    bool successfull = parse_acf_document(&expected, source, source_size);
+
+    acf_string_table table = {};
+
+    acf_document document;
+    initialize_acf_document(&document, memory, memory_size);
+    document.strings = &table;
+    successfull = successfull && parse_acf_document(&document, source, source_size) && are_acf_nodes_equal(document.root, expected.root);
+    successfull = successfull && (document.arena.used < expected.arena.used);
+
+    acf_node const& records = document.root["records"];
+    for (u32 i = 0; successfull && i < record_count; i++)
+    {
+        acf_node const& record = records[i];
+        successfull = (record.keys == records[0].keys) && (record["id"].get_int() == i) && (record["f"].get_int() == 6) &&
+            (record["position"].get_custom_type_name() == "vec2") && record["g"].is_null();
+    }
+
+    u32 id = find_acf_string(&table, ACF_KEY("position"));
+    successfull = successfull && (id != 0) && (records[0].keys[2].data == get_acf_string(&table, id).data);
+    successfull = successfull && (document.root["small"].keys[0].data == records[0].keys[0].data);
+    successfull = successfull && (document.newtypes[0].name->data == get_acf_string(&table, find_acf_string(&table, ACF_KEY("vec2"))).data);
+
+    // @note: The builder interns its keys as well.
+    acf_document_builder *builder = (acf_document_builder *) malloc(sizeof(acf_document_builder));
+    reset_acf_document(&document);
+    begin_acf_document_build(builder, &document);
+
+    u32 const table_count = table.count;
+    for (usize offset = 0; successfull && offset < source_size; offset += 100)
+    {
+        successfull = feed_acf_document_build(builder, source + offset, (source_size - offset < 100) ? source_size - offset : 100);
+    }
+    successfull = successfull && finish_acf_document_build(builder) && are_acf_nodes_equal(document.root, expected.root);
+    successfull = successfull && (document.root["records"][0].keys == document.root["records"][999].keys) && (table.count == table_count);
+    free(builder);
+
+    // @note: Serialized and binary documents do not depend on where the keys are. The expected document is not needed anymore.
+    acf_buffer buffer = {};
+    successfull = successfull && acf_serialize_document(&document, &buffer, {});
+    release_acf_document(&expected);
+
+    acf_document reparsed;
+    initialize_acf_document(&reparsed, expected_memory, memory_size);
+    successfull = successfull && parse_acf_document(&reparsed, buffer.data, buffer.size) && are_acf_nodes_equal(reparsed.root, document.root);
+    free_acf_buffer(&buffer);
+
+    usize blob_size = 0;
+    void *blob = write_acf_binary_to_memory(&document, &blob_size);
+
+    acf_binary binary;
+    reset_acf_document(&reparsed);
+    reparsed.strings = &table;
+    successfull = successfull && verify_acf_binary(blob, blob_size) && open_acf_binary(&binary, blob, blob_size) &&
+        load_acf_binary_document(&reparsed, &binary) && are_acf_nodes_equal(reparsed.root, document.root) &&
+        (reparsed.root["small"].keys[0].data == get_acf_string(&table, find_acf_string(&table, ACF_KEY("id"))).data);
+    free(blob);
+
+    release_acf_document(&reparsed);
+    release_acf_document(&document);
+    free_acf_string_table(&table);
+    free(expected_memory);
+    free(source);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Shared key lists must not hide the errors of the objects which would share them.
+bool run_acf_interned_errors_test(void *memory, usize memory_size)
+{
+    printf("interned document errors: ");
+
+    char const *sources[] =
+    {
+        "{ a = { x = 1; y = 2 }; b = { x = 1; x = 2 } }",
+        "{ a = { k0 = 0; k1 = 1; k2 = 2; k3 = 3; k4 = 4; k5 = 5; k6 = 6; k7 = 7; k8 = 8 }; "
+        "b = { k0 = 0; k1 = 1; k2 = 2; k3 = 3; k4 = 4; k5 = 5; k6 = 6; k7 = 7; k0 = 8 } }",
+        "#newtype v(int)\n#newtype v(int)\n{}",
+        "#newtype v(int)\n{ a = w(1) }",
+    };
+
+    acf_string_table table = {};
+    void *expected_memory = malloc(memory_size);
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(sources); i++)
+    {
+        usize size = strlen(sources[i]);
+
+        acf_document expected;
+        initialize_acf_document(&expected, expected_memory, memory_size);
+        bool expected_result = parse_acf_document(&expected, sources[i], size);
+
+        acf_document document;
+        initialize_acf_document(&document, memory, memory_size);
+        document.strings = &table;
+        bool result = parse_acf_document(&document, sources[i], size);
+
+        successfull = !expected_result && !result && (strcmp(document.error_buffer, expected.error_buffer) == 0);
+        if (!successfull)
+        {
+            printf("\nexpected: %s\ngot: %s", expected.error_buffer, document.error_buffer);
+        }
+
+        release_acf_document(&document);
+        release_acf_document(&expected);
+    }
+
+    free(expected_memory);
+    free_acf_string_table(&table);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_acf_strings_tests()
+{
+    usize memory_size = MEGABYTES(4);
+    void *memory = malloc(memory_size);
+
+    test_stats result = {};
+
+    record_test_result(&result, run_acf_string_table_test());
+    record_test_result(&result, run_acf_interned_document_test(memory, memory_size));
+    record_test_result(&result, run_acf_interned_errors_test(memory, memory_size));
+
+    free(memory);
+    return result;
+}
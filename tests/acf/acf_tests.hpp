@@ -7,6 +7,7 @@
 // ACF implementation
 #define ACF_LIB_IMPLEMENTATION
 #include <acf/acf.hpp>
+#include "../test_stats.hpp"
 
 // Standard headers
 #include <stdio.h>
@@ -21,12 +22,6 @@ struct test_pair
     acf correct;
 };
 
-struct test_stats
-{
-    uint32 successfull;
-    uint32 failed;
-};
-
 
 bool run_acf_test(test_pair test)
 {
@@ -104,14 +99,7 @@ test_stats run_acf_tests()
     test_stats result = {};
     for (int test_index = 0; test_index < ARRAY_COUNT(tests); test_index++)
     {
-        if (run_acf_test(tests[test_index]))
-        {
-            result.successfull += 1;
-        }
-        else
-        {
-            result.failed += 1;
-        }
+        record_test_result(&result, run_acf_test(tests[test_index]));
     }
 
     return result;
@@ -0,0 +1,364 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <png.hpp>
+#include <asset_pack.hpp>
+#include <asset_loader.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+
+/*
+    Asset loader tests.
+
+    Jobs are run on this thread first, step by step, to see the states an
+    asset goes through. Then worker threads load a few hundred assets while
+    this thread plays the game: asks for all of them every frame and takes
+    the completions, until everything is either ready or failed. Ready
+    bitmaps have to be the same as the ones loaded directly.
+
+    Files are from tests/png/images; the WAV file is written by the test
+    and removed after.
+*/
+
+#ifndef ASSET_LOADER_TESTS_DIRECTORY
+#define ASSET_LOADER_TESTS_DIRECTORY "tests/png/images/"
+#endif
+
+#define ASSET_LOADER_TESTS_WAV_FILENAME "asset_loader_test.wav"
+
+
+INTERNAL
+bool is_same_bitmap(Bitmap const *a, Bitmap const *b)
+{
+    bool result = (a->width == b->width) && (a->height == b->height) &&
+        (a->bytes_per_pixel == b->bytes_per_pixel) && (a->size == b->size) &&
+        (memcmp(a->pixels, b->pixels, a->size) == 0);
+    return result;
+}
+
+
+// @note: 48 kHz stereo, as load_wav_file wants it.
+INTERNAL
+bool write_asset_loader_test_wav(u32 frame_count)
+{
+    FILE *file = fopen(ASSET_LOADER_TESTS_WAV_FILENAME, "wb");
+    if (file == NULL) return false;
+
+    u32 data_size = frame_count * 2 * sizeof(sound_sample_t);
+    u32 riff_size = 4 + (8 + 16) + (8 + data_size);
+    u32 format_size = 16;
+    u16 audio_format = 1;
+    u16 channels = 2;
+    u32 sample_rate = 48000;
+    u32 byte_rate = sample_rate * channels * sizeof(sound_sample_t);
+    u16 block_align = channels * sizeof(sound_sample_t);
+    u16 bits_per_sample = 16;
+
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riff_size, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&format_size, 4, 1, file);
+    fwrite(&audio_format, 2, 1, file);
+    fwrite(&channels, 2, 1, file);
+    fwrite(&sample_rate, 4, 1, file);
+    fwrite(&byte_rate, 4, 1, file);
+    fwrite(&block_align, 2, 1, file);
+    fwrite(&bits_per_sample, 2, 1, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&data_size, 4, 1, file);
+    for (u32 i = 0; i < frame_count * 2; i++)
+    {
+        sound_sample_t sample = (sound_sample_t) (i * 37);
+        fwrite(&sample, sizeof(sample), 1, file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+
+bool run_asset_loader_steps_test()
+{
+    printf("asset loader steps: ");
+
+    asset_loader *loader = (asset_loader *) malloc(sizeof(asset_loader));
+    initialize_asset_loader(loader);
+
+    asset_id rgba = add_bitmap_asset(loader, ASSET_LOADER_TESTS_DIRECTORY "rgba_8.png");
+    asset_id missing = add_bitmap_asset(loader, ASSET_LOADER_TESTS_DIRECTORY "missing.png");
+
+    bool successfull = (rgba.index != 0) && (missing.index != 0) && (rgba.index != missing.index);
+
+    // @note: Same name, same asset.
+    successfull = successfull && (add_bitmap_asset(loader, ASSET_LOADER_TESTS_DIRECTORY "rgba_8.png").index == rgba.index);
+
+    // @note: Nothing happens before somebody asks.
+    successfull = successfull && (get_asset_state(loader, rgba) == ASSET_STATE_UNLOADED) && !run_asset_loader_job(loader);
+
+    successfull = successfull && (get_bitmap(loader, rgba) == &loader->placeholder) &&
+        (get_asset_state(loader, rgba) == ASSET_STATE_QUEUED);
+
+    // @note: Loaded, but not ready before the game takes the completion.
+    successfull = successfull && run_asset_loader_job(loader) && !run_asset_loader_job(loader) &&
+        (get_bitmap(loader, rgba) == &loader->placeholder) &&
+        (finish_loaded_assets(loader) == 1) && (finish_loaded_assets(loader) == 0) &&
+        (get_asset_state(loader, rgba) == ASSET_STATE_READY);
+
+    Bitmap expected = load_png_file(ASSET_LOADER_TESTS_DIRECTORY "rgba_8.png");
+    successfull = successfull && (expected.pixels != NULL) && is_same_bitmap(get_bitmap(loader, rgba), &expected);
+
+    // @note: Failed asset gives the placeholder, and is not asked for again.
+    request_asset(loader, missing);
+    successfull = successfull && run_asset_loader_job(loader) && (finish_loaded_assets(loader) == 1) &&
+        (get_asset_state(loader, missing) == ASSET_STATE_FAILED) &&
+        (get_bitmap(loader, missing) == &loader->placeholder) && !run_asset_loader_job(loader);
+
+    // @note: Invalid ids, and a bitmap asked for as a sound.
+    asset_id invalid = {};
+    asset_id past_the_end = { loader->slot_count };
+    successfull = successfull && (get_bitmap(loader, invalid) == &loader->placeholder) &&
+        (get_bitmap(loader, past_the_end) == &loader->placeholder) &&
+        (get_sound(loader, invalid) == NULL) && (get_sound(loader, rgba) == NULL) &&
+        (get_asset_state(loader, invalid) == ASSET_STATE_FAILED);
+
+    // @note: Name does not fit.
+    char long_name[ASSET_PACK_NAME_SIZE + 1] = {};
+    memset(long_name, 'a', ASSET_PACK_NAME_SIZE);
+    successfull = successfull && (add_bitmap_asset(loader, long_name).index == 0);
+
+    // @note: Bitmaps the game has already are ready right away.
+    asset_id ready = add_ready_bitmap_asset(loader, "ready", expected);
+    successfull = successfull && (get_asset_state(loader, ready) == ASSET_STATE_READY) &&
+        (get_bitmap(loader, ready)->pixels == expected.pixels);
+
+    // @note: Sounds are loaded the same way.
+    if (write_asset_loader_test_wav(1000))
+    {
+        asset_id sound = add_sound_asset(loader, ASSET_LOADER_TESTS_WAV_FILENAME);
+        successfull = successfull && (get_sound(loader, sound) == NULL) && run_asset_loader_job(loader) &&
+            (finish_loaded_assets(loader) == 1);
+
+        wav_file_contents *contents = get_sound(loader, sound);
+        successfull = successfull && (contents != NULL) && (contents->samples_count == 2000) &&
+            (contents->samples_per_second == 48000) && (contents->channels == 2) &&
+            (contents->samples[1999] == (sound_sample_t) (1999 * 37));
+
+        remove(ASSET_LOADER_TESTS_WAV_FILENAME);
+    }
+    else
+    {
+        successfull = false;
+    }
+
+    free(expected.pixels);
+    // @note: Pixels of the placeholder live in the loader.
+    if (get_asset_state(loader, rgba) == ASSET_STATE_READY)
+    {
+        free(get_bitmap(loader, rgba)->pixels);
+    }
+    free(loader);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_asset_loader_pack_test()
+{
+    printf("asset loader pack: ");
+
+    Bitmap bitmap = {};
+    bitmap.width = 3;
+    bitmap.height = 2;
+    bitmap.bytes_per_pixel = 4;
+    bitmap.size = 24;
+    bitmap.pixels = malloc(bitmap.size);
+    memset(bitmap.pixels, 0x5A, bitmap.size);
+
+    asset_pack_source source = {};
+    source.name = "packed.png";
+    source.type = ASSET_TYPE_BITMAP;
+    source.bitmap = bitmap;
+
+    usize capacity = get_asset_pack_size(&source, 1);
+    u8 *pack_data = (u8 *) malloc(capacity);
+    usize pack_size = write_asset_pack(&source, 1, pack_data, capacity);
+
+    asset_pack pack = {};
+    bool successfull = parse_asset_pack(&pack, pack_data, pack_size);
+
+    asset_loader *loader = (asset_loader *) malloc(sizeof(asset_loader));
+    initialize_asset_loader(loader, &pack);
+
+    // @note: Assets from the pack are ready on the first call, without any job.
+    asset_id packed = add_bitmap_asset(loader, "packed.png");
+    Bitmap *result = get_bitmap(loader, packed);
+    successfull = successfull && (result != &loader->placeholder) && is_same_bitmap(result, &bitmap) &&
+        !run_asset_loader_job(loader) && (get_asset_state(loader, packed) == ASSET_STATE_READY);
+
+    // @note: Assets which are not in the pack are loaded from their files.
+    asset_id unpacked = add_bitmap_asset(loader, ASSET_LOADER_TESTS_DIRECTORY "rgb_8.png");
+    successfull = successfull && (get_bitmap(loader, unpacked) == &loader->placeholder) &&
+        run_asset_loader_job(loader) && (finish_loaded_assets(loader) == 1) &&
+        (get_bitmap(loader, unpacked) != &loader->placeholder);
+
+    if (get_asset_state(loader, unpacked) == ASSET_STATE_READY)
+    {
+        free(get_bitmap(loader, unpacked)->pixels);
+    }
+    free(loader);
+    free(pack_data);
+    free(bitmap.pixels);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+struct asset_loader_test_worker
+{
+    asset_loader *loader;
+    u32 volatile *running;
+};
+
+
+INTERNAL
+void run_asset_loader_test_worker(asset_loader_test_worker worker)
+{
+    while (ATOMIC_LOAD_U32(worker.running))
+    {
+        if (!run_asset_loader_job(worker.loader))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+bool run_asset_loader_threads_test(u32 worker_count)
+{
+    printf("asset loader, %u workers: ", worker_count);
+
+    char const *files[] =
+    {
+        "gray_8.png", "gray_16.png", "gray_alpha_8.png", "rgb_8.png", "rgb_16.png", "rgba_8.png", "rgba_16.png",
+        "rgba_8_interlaced.png", "rgba_8_1x1.png", "palette_4.png", "palette_8_trns.png",
+        "deflate_fixed.png", "deflate_fast.png", "long_codes.png", "long_codes_gray.png",
+    };
+
+    asset_loader *loader = (asset_loader *) malloc(sizeof(asset_loader));
+    initialize_asset_loader(loader);
+
+    // @note: More assets than fit into the queues, most of them missing files, which fail fast.
+    u32 const asset_count = ASSET_LOADER_MAX_ASSETS - 1;
+    asset_id ids[asset_count];
+    for (u32 i = 0; i < asset_count; i++)
+    {
+        char name[ASSET_PACK_NAME_SIZE];
+        if (i < ARRAY_COUNT(files))
+        {
+            snprintf(name, sizeof(name), "%s%s", ASSET_LOADER_TESTS_DIRECTORY, files[i]);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "missing_%u.png", i);
+        }
+        ids[i] = add_bitmap_asset(loader, name);
+    }
+
+    bool successfull = (ids[asset_count - 1].index == asset_count) &&
+        (add_bitmap_asset(loader, "one_too_many.png").index == 0);
+
+    u32 volatile running = 1;
+    std::thread threads[8];
+    for (u32 i = 0; i < worker_count; i++)
+    {
+        threads[i] = std::thread(run_asset_loader_test_worker, asset_loader_test_worker{ loader, &running });
+    }
+
+    // @note: Frames of the game: ask for everything, take what is loaded.
+    u32 frame_count = 0;
+    u32 done_count = 0;
+    while (successfull && done_count < asset_count)
+    {
+        done_count = 0;
+        for (u32 i = 0; i < asset_count; i++)
+        {
+            get_bitmap(loader, ids[i]);
+            asset_state state = get_asset_state(loader, ids[i]);
+            done_count += (state == ASSET_STATE_READY || state == ASSET_STATE_FAILED);
+        }
+        successfull = successfull && (loader->in_flight_count <= ASSET_LOADER_QUEUE_SIZE);
+
+        finish_loaded_assets(loader);
+        frame_count += 1;
+        std::this_thread::yield();
+    }
+
+    ATOMIC_STORE_U32(&running, 0);
+    for (u32 i = 0; i < worker_count; i++)
+    {
+        threads[i].join();
+    }
+
+    successfull = successfull && (loader->in_flight_count == 0) && (frame_count > 1);
+
+    for (u32 i = 0; successfull && i < asset_count; i++)
+    {
+        asset_state state = get_asset_state(loader, ids[i]);
+        if (i < ARRAY_COUNT(files))
+        {
+            char filepath[256];
+            snprintf(filepath, sizeof(filepath), "%s%s", ASSET_LOADER_TESTS_DIRECTORY, files[i]);
+            Bitmap expected = load_png_file(filepath);
+
+            successfull = (state == ASSET_STATE_READY) && is_same_bitmap(get_bitmap(loader, ids[i]), &expected);
+            free(expected.pixels);
+        }
+        else
+        {
+            successfull = (state == ASSET_STATE_FAILED);
+        }
+
+        if (!successfull)
+        {
+            printf("\nasset %u, state %u", i, state);
+        }
+    }
+
+    for (u32 i = 0; i < ARRAY_COUNT(files); i++)
+    {
+        if (get_asset_state(loader, ids[i]) == ASSET_STATE_READY)
+        {
+            free(get_bitmap(loader, ids[i])->pixels);
+        }
+    }
+    free(loader);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_asset_loader_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_asset_loader_steps_test());
+    record_test_result(&result, run_asset_loader_pack_test());
+
+    u32 worker_counts[] = { 1, 2, 8 };
+    for (u32 i = 0; i < ARRAY_COUNT(worker_counts); i++)
+    {
+        record_test_result(&result, run_asset_loader_threads_test(worker_counts[i]));
+    }
+
+    return result;
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <asset_pack.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Asset pack tests.
+
+    Packs are written in memory from made up bitmaps and sounds, and read
+    back with parse_asset_pack, which is what open_asset_pack does with the
+    mapping. Everything has to come back the same, aligned, and broken
+    packs have to be refused before anything points into them.
+*/
+
+
+struct asset_pack_test_data
+{
+    asset_pack_source sources[4];
+    u32 source_count;
+
+    u8 *pack_data;
+    usize pack_size;
+};
+
+
+INTERNAL
+void fill_asset_pack_test_bytes(void *data, usize size, u64 seed)
+{
+    u8 *bytes = (u8 *) data;
+    u64 state = seed;
+    for (usize i = 0; i < size; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        bytes[i] = (u8) state;
+    }
+}
+
+
+INTERNAL
+Bitmap make_asset_pack_test_bitmap(u32 width, u32 height, u32 bytes_per_pixel, u64 seed)
+{
+    Bitmap result = {};
+    result.width = width;
+    result.height = height;
+    result.bytes_per_pixel = bytes_per_pixel;
+    result.size = (usize) width * height * bytes_per_pixel;
+    result.pixels = malloc(result.size + 1);
+    fill_asset_pack_test_bytes(result.pixels, result.size, seed);
+    return result;
+}
+
+
+// @note: Sources are in no particular order, the writer sorts the directory.
+INTERNAL
+asset_pack_test_data make_asset_pack_test_data()
+{
+    asset_pack_test_data result = {};
+
+    result.sources[0].name = "tree_60x100.png";
+    result.sources[0].type = ASSET_TYPE_BITMAP;
+    result.sources[0].bitmap = make_asset_pack_test_bitmap(60, 100, 4, 1);
+
+    result.sources[1].name = "piano2.wav";
+    result.sources[1].type = ASSET_TYPE_SOUND;
+    result.sources[1].sound.samples_per_second = 48000;
+    result.sources[1].sound.channels = 2;
+    result.sources[1].sound.samples_count = 4801;
+    result.sources[1].sound.samples = (sound_sample_t *) malloc(4801 * sizeof(sound_sample_t));
+    fill_asset_pack_test_bytes(result.sources[1].sound.samples, 4801 * sizeof(sound_sample_t), 2);
+
+    result.sources[2].name = "empty.png";
+    result.sources[2].type = ASSET_TYPE_BITMAP;
+    result.sources[2].bitmap = make_asset_pack_test_bitmap(0, 0, 4, 3);
+
+    // @note: Last one is not padded, so the file ends with its data.
+    result.sources[3].name = "character_1.png";
+    result.sources[3].type = ASSET_TYPE_BITMAP;
+    result.sources[3].bitmap = make_asset_pack_test_bitmap(17, 5, 3, 4);
+
+    result.source_count = 4;
+
+    usize capacity = get_asset_pack_size(result.sources, result.source_count);
+    result.pack_data = (u8 *) malloc(capacity);
+    result.pack_size = write_asset_pack(result.sources, result.source_count, result.pack_data, capacity);
+
+    return result;
+}
+
+
+INTERNAL
+void free_asset_pack_test_data(asset_pack_test_data *data)
+{
+    for (u32 i = 0; i < data->source_count; i++)
+    {
+        free(data->sources[i].bitmap.pixels);
+        free(data->sources[i].sound.samples);
+    }
+    free(data->pack_data);
+    *data = {};
+}
+
+
+bool run_asset_pack_round_trip_test()
+{
+    printf("asset pack round trip: ");
+
+    asset_pack_test_data data = make_asset_pack_test_data();
+
+    asset_pack pack = {};
+    bool successfull = (data.pack_size > 0) && parse_asset_pack(&pack, data.pack_data, data.pack_size) && verify_asset_pack(&pack);
+
+    for (u32 i = 0; successfull && i < data.source_count; i++)
+    {
+        asset_pack_source const *source = data.sources + i;
+        if (source->type == ASSET_TYPE_BITMAP)
+        {
+            Bitmap bitmap = get_asset_bitmap(&pack, source->name);
+            successfull = (bitmap.pixels != NULL) &&
+                (bitmap.width == source->bitmap.width) &&
+                (bitmap.height == source->bitmap.height) &&
+                (bitmap.bytes_per_pixel == source->bitmap.bytes_per_pixel) &&
+                (bitmap.size == source->bitmap.size) &&
+                (memcmp(bitmap.pixels, source->bitmap.pixels, bitmap.size) == 0) &&
+                (((u8 *) bitmap.pixels - data.pack_data) % ASSET_PACK_ALIGNMENT == 0);
+
+            // @note: Asking for a bitmap as a sound gives nothing.
+            successfull = successfull && (get_asset_sound(&pack, source->name).samples == NULL);
+        }
+        else
+        {
+            wav_file_contents sound = get_asset_sound(&pack, source->name);
+            successfull = (sound.samples != NULL) &&
+                (sound.samples_per_second == source->sound.samples_per_second) &&
+                (sound.channels == source->sound.channels) &&
+                (sound.samples_count == source->sound.samples_count) &&
+                (memcmp(sound.samples, source->sound.samples, sound.samples_count * sizeof(sound_sample_t)) == 0) &&
+                (((u8 *) sound.samples - data.pack_data) % ASSET_PACK_ALIGNMENT == 0);
+        }
+
+        if (!successfull)
+        {
+            printf("\n%s", source->name);
+        }
+    }
+
+    successfull = successfull && (find_asset(&pack, "grass_texture.png") == NULL) && (find_asset(&pack, "") == NULL) &&
+        (get_asset_bitmap(&pack, "zzz.png").pixels == NULL);
+
+    // @note: Lookups in the empty pack, which the game has when there is no pack file, find nothing.
+    asset_pack empty = {};
+    successfull = successfull && (find_asset(&empty, "tree_60x100.png") == NULL) && !verify_asset_pack(&empty);
+
+    free_asset_pack_test_data(&data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_asset_pack_writer_errors_test()
+{
+    printf("asset pack writer errors: ");
+
+    asset_pack_test_data data = make_asset_pack_test_data();
+    usize capacity = data.pack_size;
+
+    bool successfull = (capacity > 0);
+
+    // @note: Does not fit.
+    successfull = successfull && (write_asset_pack(data.sources, data.source_count, data.pack_data, capacity - 1) == 0);
+
+    // @note: Two assets with the same name.
+    char const *name = data.sources[2].name;
+    data.sources[2].name = data.sources[0].name;
+    successfull = successfull && (write_asset_pack(data.sources, data.source_count, data.pack_data, capacity) == 0);
+
+    // @note: Name does not fit into the entry with its terminating zero.
+    char long_name[ASSET_PACK_NAME_SIZE + 1] = {};
+    memset(long_name, 'a', ASSET_PACK_NAME_SIZE);
+    data.sources[2].name = long_name;
+    successfull = successfull && (write_asset_pack(data.sources, data.source_count, data.pack_data, capacity) == 0);
+    long_name[ASSET_PACK_NAME_SIZE - 1] = 0;
+    successfull = successfull && (write_asset_pack(data.sources, data.source_count, data.pack_data, capacity) == capacity);
+
+    // @note: Bitmap which size does not match its dimensions.
+    data.sources[2].name = name;
+    data.sources[3].bitmap.height -= 1;
+    successfull = successfull && (write_asset_pack(data.sources, data.source_count, data.pack_data, capacity) == 0);
+    data.sources[3].bitmap.height += 1;
+
+    successfull = successfull && (write_asset_pack(data.sources, data.source_count, data.pack_data, capacity) == capacity);
+
+    free_asset_pack_test_data(&data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_asset_pack_corruption_test()
+{
+    printf("asset pack corruption: ");
+
+    asset_pack_test_data data = make_asset_pack_test_data();
+
+    u8 *copy = (u8 *) malloc(data.pack_size);
+    asset_pack pack = {};
+
+    bool successfull = (data.pack_size > 0);
+
+    // @note: Every truncation is refused, the size of the file is in the header.
+    for (usize size = 0; successfull && size < data.pack_size; size += (size < 1024) ? 1 : 97)
+    {
+        memcpy(copy, data.pack_data, size);
+        successfull = !parse_asset_pack(&pack, copy, size) && (pack.header == NULL);
+    }
+
+    // @note: Flipping any bit of the header or of the directory is caught, the directory has its CRC.
+    usize directory_end = sizeof(asset_pack_header) + data.source_count * sizeof(asset_pack_entry);
+    for (usize bit = 0; successfull && bit < directory_end * 8; bit++)
+    {
+        memcpy(copy, data.pack_data, data.pack_size);
+        copy[bit / 8] ^= (u8) (1 << (bit % 8));
+
+        successfull = !parse_asset_pack(&pack, copy, data.pack_size);
+        if (!successfull)
+        {
+            printf("\nbit %u", (u32) bit);
+        }
+    }
+
+    // @note: Data is not checked by parsing, only by the verification.
+    memcpy(copy, data.pack_data, data.pack_size);
+    copy[data.pack_size - 1] ^= 1;
+    successfull = successfull && parse_asset_pack(&pack, copy, data.pack_size) && !verify_asset_pack(&pack);
+
+    free(copy);
+    free_asset_pack_test_data(&data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_asset_pack_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_asset_pack_round_trip_test());
+    record_test_result(&result, run_asset_pack_writer_errors_test());
+    record_test_result(&result, run_asset_pack_corruption_test());
+
+    return result;
+}
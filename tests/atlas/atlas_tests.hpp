@@ -0,0 +1,261 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <atlas.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Texture atlas tests.
+
+    Rectangles of made up sizes are packed, and every one of them has to
+    end up inside its page without overlapping any other. Bitmaps put into
+    the pages have to come back the same, with their transparent borders
+    around them.
+*/
+
+
+INTERNAL
+u32 next_atlas_test_random(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (u32) (*state >> 16);
+}
+
+
+INTERNAL
+bool atlas_test_rectangles_overlap(u32 ax, u32 ay, u32 aw, u32 ah, u32 bx, u32 by, u32 bw, u32 bh)
+{
+    bool result = (ax < bx + bw) && (bx < ax + aw) && (ay < by + bh) && (by < ay + ah);
+    return result;
+}
+
+
+// @note: Nodes are sorted, they cover the width with no gaps, and no two neighbours have the same height.
+INTERNAL
+bool check_skyline(skyline_packer const *packer)
+{
+    u32 x = 0;
+    for (u32 i = 0; i < packer->node_count; i++)
+    {
+        skyline_node const *node = packer->nodes + i;
+        if (node->x != x || node->width == 0 || node->y > packer->height) return false;
+        if (i > 0 && packer->nodes[i - 1].y == node->y) return false;
+        x += node->width;
+    }
+    return (x == packer->width);
+}
+
+
+bool run_skyline_packer_test()
+{
+    printf("skyline packer: ");
+
+    u32 const width = 256;
+    u32 const height = 256;
+    u32 const count = 200;
+
+    skyline_packer packer;
+    initialize_skyline_packer(&packer, width, height);
+
+    u32 xs[count], ys[count], widths[count], heights[count];
+    u32 packed_count = 0;
+    u32 packed_area = 0;
+
+    u64 random = 0x243f6a8885a308d3;
+    bool successfull = check_skyline(&packer);
+
+    for (u32 i = 0; successfull && i < count; i++)
+    {
+        u32 w = 1 + next_atlas_test_random(&random) % 40;
+        u32 h = 1 + next_atlas_test_random(&random) % 40;
+
+        u32 x = 0, y = 0;
+        if (!skyline_pack(&packer, w, h, &x, &y)) continue;
+
+        successfull = (x + w <= width) && (y + h <= height) && check_skyline(&packer);
+        for (u32 j = 0; successfull && j < packed_count; j++)
+        {
+            successfull = !atlas_test_rectangles_overlap(x, y, w, h, xs[j], ys[j], widths[j], heights[j]);
+        }
+
+        xs[packed_count] = x;
+        ys[packed_count] = y;
+        widths[packed_count] = w;
+        heights[packed_count] = h;
+        packed_count += 1;
+        packed_area += w * h;
+    }
+
+    // @note: Random sizes in random order still fill most of the page.
+    successfull = successfull && (packed_area > width * height / 2);
+
+    // @note: Exactly the whole page fits, and then nothing does.
+    initialize_skyline_packer(&packer, width, height);
+    u32 x = 0, y = 0;
+    successfull = successfull && skyline_pack(&packer, width, height, &x, &y) && (x == 0) && (y == 0);
+    successfull = successfull && !skyline_pack(&packer, 1, 1, &x, &y);
+
+    // @note: Same sized squares tile the page with no waste.
+    initialize_skyline_packer(&packer, width, height);
+    for (u32 i = 0; successfull && i < (width / 32) * (height / 32); i++)
+    {
+        successfull = skyline_pack(&packer, 32, 32, &x, &y) && (x % 32 == 0) && (y % 32 == 0);
+    }
+    successfull = successfull && !skyline_pack(&packer, 1, 1, &x, &y) && (packer.node_count == 1);
+
+    // @note: Empty and too big rectangles do not fit.
+    initialize_skyline_packer(&packer, width, height);
+    successfull = successfull && !skyline_pack(&packer, 0, 10, &x, &y) && !skyline_pack(&packer, 10, 0, &x, &y);
+    successfull = successfull && !skyline_pack(&packer, width + 1, 1, &x, &y) && !skyline_pack(&packer, 1, height + 1, &x, &y);
+    successfull = successfull && check_skyline(&packer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+INTERNAL
+Bitmap make_atlas_test_bitmap(u32 width, u32 height, u32 bytes_per_pixel, u64 *random)
+{
+    Bitmap result = {};
+    result.width = width;
+    result.height = height;
+    result.bytes_per_pixel = bytes_per_pixel;
+    result.size = (usize) width * height * bytes_per_pixel;
+    result.pixels = malloc(result.size + 1);
+
+    // @note: No zero bytes, so the borders, which are zeros, can be told apart.
+    u8 *bytes = (u8 *) result.pixels;
+    for (usize i = 0; i < result.size; i++)
+    {
+        bytes[i] = (u8) (1 + next_atlas_test_random(random) % 255);
+    }
+    return result;
+}
+
+
+bool run_texture_atlas_test()
+{
+    printf("texture atlas: ");
+
+    u32 const count = 40;
+    Bitmap bitmaps[count] = {};
+    atlas_sprite sprites[count] = {};
+
+    u64 random = 0x13198a2e03707344;
+    for (u32 i = 0; i < count; i++)
+    {
+        u32 w = 1 + next_atlas_test_random(&random) % 60;
+        u32 h = 1 + next_atlas_test_random(&random) % 60;
+        bitmaps[i] = make_atlas_test_bitmap(w, h, 4, &random);
+    }
+
+    // @note: These three stay out of the atlas.
+    free(bitmaps[3].pixels);
+    bitmaps[3] = make_atlas_test_bitmap(10, 10, 3, &random);
+    free(bitmaps[7].pixels);
+    bitmaps[7] = make_atlas_test_bitmap(200, 10, 4, &random);
+    free(bitmaps[11].pixels);
+    bitmaps[11] = make_atlas_test_bitmap(0, 0, 4, &random);
+
+    texture_atlas atlas;
+    initialize_texture_atlas(&atlas, 128, 128, 2);
+
+    bool successfull = pack_texture_atlas(&atlas, bitmaps, count, sprites) && (atlas.page_count > 1);
+
+    usize pages_size = get_texture_atlas_pages_size(&atlas);
+    u8 *pages = (u8 *) malloc(pages_size);
+    if (successfull)
+    {
+        fill_texture_atlas_pages(&atlas, pages, bitmaps, count, sprites);
+    }
+
+    successfull = successfull && (sprites[3].page == NULL) && (sprites[7].page == NULL) && (sprites[11].page == NULL);
+
+    u32 padding = atlas.padding;
+    for (u32 i = 0; successfull && i < count; i++)
+    {
+        atlas_sprite const *sprite = sprites + i;
+        Bitmap const *bitmap = bitmaps + i;
+
+        successfull = (sprite->width == bitmap->width) && (sprite->height == bitmap->height);
+        if (!successfull || sprite->page == NULL) continue;
+
+        Bitmap const *page = sprite->page;
+        successfull = (page >= atlas.pages) && (page < atlas.pages + atlas.page_count) &&
+            (sprite->x >= padding) && (sprite->y >= padding) &&
+            (sprite->x + sprite->width + padding <= page->width) &&
+            (sprite->y + sprite->height + padding <= page->height);
+
+        // @note: Padded rectangles of sprites on the same page do not overlap.
+        for (u32 j = 0; successfull && j < i; j++)
+        {
+            atlas_sprite const *other = sprites + j;
+            if (other->page != page) continue;
+            successfull = !atlas_test_rectangles_overlap(
+                sprite->x - padding, sprite->y - padding, sprite->width + 2 * padding, sprite->height + 2 * padding,
+                other->x - padding, other->y - padding, other->width + 2 * padding, other->height + 2 * padding);
+        }
+
+        usize pitch = (usize) page->width * 4;
+        u8 const *page_pixels = (u8 const *) page->pixels;
+        for (u32 y = 0; successfull && y < sprite->height; y++)
+        {
+            u8 const *row = page_pixels + (sprite->y + y) * pitch + (usize) sprite->x * 4;
+            successfull = (memcmp(row, (u8 const *) bitmap->pixels + (usize) y * bitmap->width * 4, (usize) bitmap->width * 4) == 0);
+        }
+
+        // @note: Pixels right around the sprite are transparent.
+        for (u32 x = sprite->x - padding; successfull && x < sprite->x + sprite->width + padding; x++)
+        {
+            u32 above = *(u32 const *) (page_pixels + (sprite->y - 1) * pitch + (usize) x * 4);
+            u32 below = *(u32 const *) (page_pixels + (sprite->y + sprite->height) * pitch + (usize) x * 4);
+            successfull = (above == 0) && (below == 0);
+        }
+        for (u32 y = sprite->y; successfull && y < sprite->y + sprite->height; y++)
+        {
+            u32 left = *(u32 const *) (page_pixels + y * pitch + (usize) (sprite->x - 1) * 4);
+            u32 right = *(u32 const *) (page_pixels + y * pitch + (usize) (sprite->x + sprite->width) * 4);
+            successfull = (left == 0) && (right == 0);
+        }
+
+        if (!successfull)
+        {
+            printf("\nsprite %u", i);
+        }
+    }
+
+    // @note: Pages run out.
+    texture_atlas small;
+    initialize_texture_atlas(&small, 64, 64, 1);
+    successfull = successfull && !pack_texture_atlas(&small, bitmaps, count, sprites);
+
+    free(pages);
+    for (u32 i = 0; i < count; i++)
+    {
+        free(bitmaps[i].pixels);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_atlas_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_skyline_packer_test());
+    record_test_result(&result, run_texture_atlas_test());
+
+    return result;
+}
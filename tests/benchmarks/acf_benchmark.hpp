@@ -0,0 +1,655 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_stream.hpp>
+#include <acf/acf_binary.hpp>
+#include <acf/acf_serialize.hpp>
+#include <acf/acf_reflect.hpp>
+#include <acf/acf_parallel.hpp>
+
+#include "benchmark.hpp"
+
+// Standard headers
+#include <thread>
+
+
+/*
+    Throughput of the ACF document lexer and parser on a flat config: one big
+    object of simple key-value pairs, with comments, strings and numbers, as
+    in the game's settings files.
+
+    The stream is fed in 64 KB chunks, as it would be read from a file.
+
+    Binary startup is measured as open plus a few lookups, which is what
+    loading the config from the mapped file costs, besides the page faults.
+
+    The serializer is compared with acf_print, ported to the document tree:
+    one printf per token into a FILE, as acf_print_impl does it.
+
+    Reflection binding is compared with reading the same settings by hand,
+    with operator[] and get_* for every field.
+
+    Every other shape stresses a different part of the parser, each one is
+    lexed, parsed, looked up and serialized:
+
+        deep     objects nested 32 levels down, lookups walk all the way
+        wide     objects of 256 keys, lookups hit the hash index
+        numbers  arrays of 1024 integers and floats, lookups index them
+        strings  long quoted strings with few other tokens
+
+    Parallel parsing is measured on a log: one array of small records, every
+    job on its own std::thread, as many as the machine has hardware threads.
+    On a machine with one core it is only the overhead of the split.
+*/
+
+struct acf_benchmark_source
+{
+    char *data;
+    usize size;
+};
+
+
+INTERNAL
+acf_benchmark_source generate_flat_acf(usize target_size)
+{
+    acf_benchmark_source result = {};
+    result.data = (char *) malloc(target_size + 256);
+
+    for (u32 i = 0; result.size < target_size; i++)
+    {
+        char *at = result.data + result.size;
+        int n = 0;
+        switch (i % 5)
+        {
+            case 0: n = sprintf(at, "// Settings block number %u.\n", i); break;
+            case 1: n = sprintf(at, "window_width_%u = %u;\n", i, i * 13); break;
+            case 2: n = sprintf(at, "render_scale_%u = %u.%03u;\n", i, i % 7, i % 1000); break;
+            case 3: n = sprintf(at, "asset_path_%u = \"assets/sprites/character_%u.png\";\n", i, i); break;
+            case 4: n = sprintf(at, "    enable_feature_%u = true\n", i); break;
+        }
+        result.size += n;
+    }
+
+    return result;
+}
+
+
+INTERNAL
+acf_benchmark_source generate_log_acf(usize target_size)
+{
+    acf_benchmark_source result = {};
+    result.data = (char *) malloc(target_size + 256);
+    result.size = sprintf(result.data, "#newtype vec2(float, float)\nversion = 3\nrecords = [\n");
+
+    for (u32 i = 0; result.size < target_size; i++)
+    {
+        result.size += sprintf(result.data + result.size,
+            "    { time = %u.%03u; event = \"event_%u\"; position = vec2(%u, %u.5); tags = [ %u, %u ] },\n",
+            i / 60, i % 1000, i % 17, i % 640, i % 480, i, i * 7);
+    }
+
+    result.size += sprintf(result.data + result.size, "]\n");
+    return result;
+}
+
+
+#define ACF_BENCHMARK_DEEP_DEPTH 32
+
+
+INTERNAL
+acf_benchmark_source generate_deep_acf(usize target_size)
+{
+    acf_benchmark_source result = {};
+    result.data = (char *) malloc(target_size + 4096);
+
+    for (u32 i = 0; result.size < target_size; i++)
+    {
+        result.size += sprintf(result.data + result.size, "block_%u = ", i);
+        for (u32 depth = 0; depth < ACF_BENCHMARK_DEEP_DEPTH; depth++)
+        {
+            result.size += sprintf(result.data + result.size, "{ level = %u; child = ", depth);
+        }
+        result.size += sprintf(result.data + result.size, "%u", i);
+        for (u32 depth = 0; depth < ACF_BENCHMARK_DEEP_DEPTH; depth++)
+        {
+            result.data[result.size++] = ' ';
+            result.data[result.size++] = '}';
+        }
+        result.data[result.size++] = '\n';
+    }
+
+    return result;
+}
+
+
+INTERNAL
+acf_benchmark_source generate_wide_acf(usize target_size)
+{
+    acf_benchmark_source result = {};
+    result.data = (char *) malloc(target_size + 16384);
+
+    for (u32 i = 0; result.size < target_size; i++)
+    {
+        result.size += sprintf(result.data + result.size, "object_%u = {\n", i);
+        for (u32 key = 0; key < 256; key++)
+        {
+            result.size += sprintf(result.data + result.size, "    property_%u = %u;\n", key, key * i);
+        }
+        result.size += sprintf(result.data + result.size, "}\n");
+    }
+
+    return result;
+}
+
+
+INTERNAL
+acf_benchmark_source generate_numbers_acf(usize target_size)
+{
+    acf_benchmark_source result = {};
+    result.data = (char *) malloc(target_size + 32768);
+
+    u64 state = 0x2545F4914F6CDD1Dull;
+    for (u32 i = 0; result.size < target_size; i++)
+    {
+        result.size += sprintf(result.data + result.size, "samples_%u = [", i);
+        for (u32 index = 0; index < 1024; index++)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            if (index % 2)
+            {
+                result.size += sprintf(result.data + result.size, " %.17g,", (f64) (int64) (state >> 11) / 1e12);
+            }
+            else
+            {
+                result.size += sprintf(result.data + result.size, " %lld,", (long long) (int32) state);
+            }
+        }
+        result.size += sprintf(result.data + result.size, " 0 ]\n");
+    }
+
+    return result;
+}
+
+
+INTERNAL
+acf_benchmark_source generate_strings_acf(usize target_size)
+{
+    acf_benchmark_source result = {};
+    result.data = (char *) malloc(target_size + 4096);
+
+    for (u32 i = 0; result.size < target_size; i++)
+    {
+        result.size += sprintf(result.data + result.size, "text_%u = \"", i);
+        for (u32 sentence = 0; sentence < 1 + i % 16; sentence++)
+        {
+            result.size += sprintf(result.data + result.size, "The quick brown fox number %u jumps over the lazy dog, [again] {and again}. ", sentence);
+        }
+        result.size += sprintf(result.data + result.size, "\";\n");
+    }
+
+    return result;
+}
+
+
+INTERNAL
+usize acf_lex_all(char const *source, usize size)
+{
+    acf_document document = {};
+    document.source = source;
+
+    acf_document_parser parser = {};
+    parser.document = &document;
+    parser.at = source;
+    parser.end = source + size;
+
+    usize token_count = 0;
+    while (eat_token(&parser).type != acf_document_token_type::end_of_file)
+    {
+        token_count += 1;
+    }
+    return token_count;
+}
+
+
+// @note: acf_print_impl from acf.hpp, on acf_node and printing into a file instead of the debug output.
+INTERNAL
+void acf_print_to_file(FILE *file, acf_node const& value, int depth = 0)
+{
+    char const *spaces = "                                                            ";
+    int32 const indent = 2;
+    u32 const max_elements_in_line = 3;
+
+    switch (value.type)
+    {
+        case acf_type_t::null: fprintf(file, "null"); break;
+        case acf_type_t::boolean: fprintf(file, "%s", value.boolean_value ? "true" : "false"); break;
+        case acf_type_t::integer: fprintf(file, "%lld", (long long) value.integer_value); break;
+        case acf_type_t::floating: fprintf(file, "%lf", value.floating_value); break;
+        case acf_type_t::string: fprintf(file, "\"%.*s\"", (int) value.count, value.string_value); break;
+        case acf_type_t::type: fprintf(file, "%s", get_acf_type_string(value.type_value)); break;
+
+        case acf_type_t::object:
+        case acf_type_t::array:
+        {
+            bool in_one_line = count_acf_serialize_elements(value, max_elements_in_line) <= max_elements_in_line;
+
+            fprintf(file, "%c%s", value.is_object() ? '{' : '[', in_one_line ? " " : "\n");
+            for (u32 i = 0; i < value.count; i++)
+            {
+                if (!in_one_line) { fprintf(file, "%.*s", indent * (depth + 1), spaces); }
+                if (value.is_object()) { fprintf(file, "%.*s = ", (int) value.keys[i].size, value.keys[i].data); }
+                acf_print_to_file(file, value.children[i], depth + 1);
+                fprintf(file, "%s%s", value.is_object() ? ";" : (i + 1 < value.count ? "," : ""), in_one_line ? " " : "\n");
+            }
+            fprintf(file, "%.*s%c", in_one_line ? 0 : indent * depth, spaces, value.is_object() ? '}' : ']');
+        }
+        break;
+
+        case acf_type_t::custom:
+        {
+            fprintf(file, "%.*s(", (int) value.newtype_name->size, value.newtype_name->data);
+            for (u32 i = 0; i < value.count; i++)
+            {
+                acf_print_to_file(file, value.children[i], depth);
+                if (i + 1 < value.count) { fprintf(file, ", "); }
+            }
+            fprintf(file, ")");
+        }
+        break;
+    }
+}
+
+
+struct acf_benchmark_settings
+{
+    int32 window_width;
+    int32 window_height;
+    bool fullscreen;
+    bool vsync;
+    float32 render_scale;
+    float32 gamma;
+    int32 shadow_quality;
+    int32 texture_quality;
+    float32 master_volume;
+    float32 music_volume;
+    char language[8];
+    int64 seed;
+};
+ACF_STRUCT(acf_benchmark_settings,
+    ACF_FIELD(window_width),
+    ACF_FIELD(window_height),
+    ACF_FIELD(fullscreen),
+    ACF_FIELD(vsync),
+    ACF_FIELD(render_scale),
+    ACF_FIELD(gamma),
+    ACF_FIELD(shadow_quality),
+    ACF_FIELD(texture_quality),
+    ACF_FIELD(master_volume),
+    ACF_FIELD(music_volume),
+    ACF_FIELD(language),
+    ACF_FIELD(seed));
+
+
+GLOBAL char const acf_benchmark_settings_source[] =
+    "window_width = 1920; window_height = 1080; fullscreen = false; vsync = true;\n"
+    "render_scale = 1.0; gamma = 2.2; shadow_quality = 3; texture_quality = 2;\n"
+    "master_volume = 0.8; music_volume = 0.5; language = \"en\"; seed = 42;\n";
+
+
+INTERNAL
+void read_acf_benchmark_settings_by_hand(acf_node const& root, acf_benchmark_settings *settings)
+{
+    settings->window_width = (int32) root["window_width"].get_int();
+    settings->window_height = (int32) root["window_height"].get_int();
+    settings->fullscreen = root["fullscreen"].get_bool();
+    settings->vsync = root["vsync"].get_bool();
+    settings->render_scale = (float32) root["render_scale"].get_float();
+    settings->gamma = (float32) root["gamma"].get_float();
+    settings->shadow_quality = (int32) root["shadow_quality"].get_int();
+    settings->texture_quality = (int32) root["texture_quality"].get_int();
+    settings->master_volume = (float32) root["master_volume"].get_float();
+    settings->music_volume = (float32) root["music_volume"].get_float();
+
+    acf_string_view language = root["language"].get_string();
+    memory::copy(settings->language, language.data, language.size);
+    settings->language[language.size] = 0;
+
+    settings->seed = root["seed"].get_int();
+}
+
+
+// @note: Keys are made before the measurement, so only the lookups themselves are measured.
+struct acf_benchmark_keys
+{
+    char names[1000][32];
+    acf_key keys[1000];
+};
+
+
+INTERNAL
+void make_acf_benchmark_keys(acf_benchmark_keys *keys, char const *prefix, u32 key_count)
+{
+    for (u32 i = 0; i < 1000; i++)
+    {
+        u32 size = (u32) snprintf(keys->names[i], sizeof(keys->names[i]), "%s%u", prefix, (i * 7919) % key_count);
+        keys->keys[i] = make_acf_key(keys->names[i], size);
+    }
+}
+
+
+// @note: Lookup is called 1000 times per iteration, so it is measured per 1000 lookups.
+template <typename Lookup>
+INTERNAL
+void run_acf_shape_benchmarks(char const *shape, acf_benchmark_source source, acf_document *document, acf_buffer *buffer, Lookup lookup)
+{
+    char name[128];
+
+    snprintf(name, sizeof(name), "acf lex / %s %llu MB", shape, (unsigned long long) (source.size >> 20));
+    print_benchmark_result(run_benchmark(name, source.size, [&]()
+    {
+        consume_benchmark_value(acf_lex_all(source.data, source.size));
+    }));
+
+    snprintf(name, sizeof(name), "acf parse / %s %llu MB", shape, (unsigned long long) (source.size >> 20));
+    print_benchmark_result(run_benchmark(name, source.size, [&]()
+    {
+        reset_acf_document(document);
+        bool success = parse_acf_document(document, source.data, source.size);
+        BENCHMARK_CHECK(success);
+    }));
+
+    // @note: Lookups which miss would be measured as much faster than they are.
+    BENCHMARK_CHECK(lookup(document->root, 1) != 0);
+
+    snprintf(name, sizeof(name), "acf lookup x1000 / %s", shape);
+    print_benchmark_result(run_benchmark(name, 0, [&]()
+    {
+        usize sum = 0;
+        for (u32 i = 0; i < 1000; i++)
+        {
+            sum += lookup(document->root, i);
+        }
+        consume_benchmark_value(sum);
+    }));
+
+    snprintf(name, sizeof(name), "acf serialize / %s %llu MB", shape, (unsigned long long) (source.size >> 20));
+    print_benchmark_result(run_benchmark(name, source.size, [&]()
+    {
+        buffer->size = 0;
+        bool success = acf_serialize(document->root, buffer);
+        BENCHMARK_CHECK(success);
+    }));
+}
+
+
+void run_acf_benchmarks()
+{
+    printf("\n=== ACF document: flat config ===\n");
+
+    acf_benchmark_source source = generate_flat_acf(MEGABYTES(16));
+
+    usize memory_size = MEGABYTES(256);
+    void *memory = malloc(memory_size);
+
+    acf_document *document = (acf_document *) malloc(sizeof(acf_document));
+    initialize_acf_document(document, memory, memory_size);
+
+    print_benchmark_result(run_benchmark("acf lex / flat 16 MB", source.size, [&]()
+    {
+        consume_benchmark_value(acf_lex_all(source.data, source.size));
+    }));
+
+    print_benchmark_result(run_benchmark("acf parse / flat 16 MB", source.size, [&]()
+    {
+        reset_acf_document(document);
+        bool success = parse_acf_document(document, source.data, source.size);
+        BENCHMARK_CHECK(success);
+    }));
+
+    GLOBAL u64 volatile event_count;
+    print_benchmark_result(run_benchmark("acf stream events / 64 KB chunks", source.size, [&]()
+    {
+        acf_stream *stream = (acf_stream *) malloc(sizeof(acf_stream));
+        initialize_acf_stream(stream, [](void *, acf_event const *) { event_count += 1; return true; }, NULL);
+
+        bool success = true;
+        for (usize offset = 0; success && offset < source.size; offset += KILOBYTES(64))
+        {
+            usize size = (source.size - offset < KILOBYTES(64)) ? source.size - offset : KILOBYTES(64);
+            success = feed_acf_stream(stream, source.data + offset, size);
+        }
+        success = success && finish_acf_stream(stream);
+        BENCHMARK_CHECK(success);
+
+        free(stream);
+    }));
+
+    print_benchmark_result(run_benchmark("acf stream build / 64 KB chunks", source.size, [&]()
+    {
+        reset_acf_document(document);
+
+        acf_document_builder *builder = (acf_document_builder *) malloc(sizeof(acf_document_builder));
+        begin_acf_document_build(builder, document);
+
+        bool success = true;
+        for (usize offset = 0; success && offset < source.size; offset += KILOBYTES(64))
+        {
+            usize size = (source.size - offset < KILOBYTES(64)) ? source.size - offset : KILOBYTES(64);
+            success = feed_acf_document_build(builder, source.data + offset, size);
+        }
+        success = success && finish_acf_document_build(builder);
+        BENCHMARK_CHECK(success);
+
+        free(builder);
+    }));
+
+    reset_acf_document(document);
+    parse_acf_document(document, source.data, source.size);
+
+    usize blob_size = write_acf_binary(document, NULL, 0);
+    void *blob = malloc(blob_size);
+
+    print_benchmark_result(run_benchmark("acf binary write / flat 16 MB", source.size, [&]()
+    {
+        consume_benchmark_value(write_acf_binary(document, blob, blob_size));
+    }));
+
+    print_benchmark_result(run_benchmark("acf binary verify / flat 16 MB", blob_size, [&]()
+    {
+        bool success = verify_acf_binary(blob, blob_size);
+        BENCHMARK_CHECK(success);
+    }));
+
+    print_benchmark_result(run_benchmark("acf binary open + 3 lookups", 0, [&]()
+    {
+        acf_binary binary;
+        open_acf_binary(&binary, blob, blob_size);
+        consume_benchmark_value(binary.root["window_width_1"].get_int_or(0) +
+                                (usize) binary.root["render_scale_2"].get_float_or(0) +
+                                binary.root["asset_path_3"].get_string().size);
+    }));
+
+    free(blob);
+
+#if ASUKA_OS_WINDOWS
+    FILE *null_file = fopen("NUL", "wb");
+#else
+    FILE *null_file = fopen("/dev/null", "wb");
+#endif
+    print_benchmark_result(run_benchmark("acf print (printf per token) / flat 16 MB", source.size, [&]()
+    {
+        acf_print_to_file(null_file, document->root);
+    }));
+    fclose(null_file);
+
+    acf_buffer buffer = {};
+    print_benchmark_result(run_benchmark("acf serialize pretty / flat 16 MB", source.size, [&]()
+    {
+        buffer.size = 0;
+        bool success = acf_serialize(document->root, &buffer);
+        BENCHMARK_CHECK(success);
+    }));
+
+    acf_serialize_options compact;
+    compact.multiline = acf_serialize_options::multiline_t::disabled;
+    compact.print_spaces = false;
+    print_benchmark_result(run_benchmark("acf serialize compact / flat 16 MB", source.size, [&]()
+    {
+        buffer.size = 0;
+        bool success = acf_serialize(document->root, &buffer, compact);
+        BENCHMARK_CHECK(success);
+    }));
+    free_acf_buffer(&buffer);
+
+    printf("\n=== ACF reflection: settings struct ===\n");
+
+    usize settings_source_size = sizeof(acf_benchmark_settings_source) - 1;
+    reset_acf_document(document);
+    parse_acf_document(document, acf_benchmark_settings_source, settings_source_size);
+
+    acf_benchmark_settings settings = {};
+    print_benchmark_result(run_benchmark("acf settings by hand (12 lookups)", 0, [&]()
+    {
+        read_acf_benchmark_settings_by_hand(document->root, &settings);
+        consume_benchmark_value(settings.seed);
+    }));
+
+    print_benchmark_result(run_benchmark("acf settings bind", 0, [&]()
+    {
+        bool success = bind_acf(document->root, &settings);
+        BENCHMARK_CHECK(success);
+        consume_benchmark_value(settings.seed);
+    }));
+
+    print_benchmark_result(run_benchmark("acf settings parse + bind", settings_source_size, [&]()
+    {
+        reset_acf_document(document);
+        bool success = parse_acf_document(document, acf_benchmark_settings_source, settings_source_size) && bind_acf(document->root, &settings);
+        BENCHMARK_CHECK(success);
+    }));
+
+    acf_struct_binder *binder = (acf_struct_binder *) malloc(sizeof(acf_struct_binder));
+    print_benchmark_result(run_benchmark("acf settings stream bind", settings_source_size, [&]()
+    {
+        begin_acf_bind(binder, &settings);
+        bool success = feed_acf_struct_bind(binder, acf_benchmark_settings_source, settings_source_size) && finish_acf_struct_bind(binder);
+        BENCHMARK_CHECK(success);
+    }));
+    free(binder);
+
+    printf("\n=== ACF document: shapes ===\n");
+
+    acf_buffer shape_buffer = {};
+    acf_benchmark_keys *keys = (acf_benchmark_keys *) malloc(sizeof(acf_benchmark_keys));
+    acf_benchmark_keys *inner_keys = (acf_benchmark_keys *) malloc(sizeof(acf_benchmark_keys));
+
+    acf_benchmark_source deep = generate_deep_acf(MEGABYTES(8));
+    make_acf_benchmark_keys(keys, "block_", 1000);
+    run_acf_shape_benchmarks("deep", deep, document, &shape_buffer, [&](acf_node const& root, u32 i)
+    {
+        acf_node const *node = &root[keys->keys[i]];
+        for (u32 depth = 0; depth < ACF_BENCHMARK_DEEP_DEPTH; depth++)
+        {
+            node = &(*node)[ACF_KEY("child")];
+        }
+        return (usize) node->get_int_or(0);
+    });
+    free(deep.data);
+
+    acf_benchmark_source wide = generate_wide_acf(MEGABYTES(8));
+    make_acf_benchmark_keys(keys, "object_", 1000);
+    make_acf_benchmark_keys(inner_keys, "property_", 256);
+    run_acf_shape_benchmarks("wide", wide, document, &shape_buffer, [&](acf_node const& root, u32 i)
+    {
+        return (usize) root[keys->keys[i]][inner_keys->keys[i]].get_int_or(0);
+    });
+    free(wide.data);
+
+    acf_benchmark_source numbers = generate_numbers_acf(MEGABYTES(8));
+    make_acf_benchmark_keys(keys, "samples_", 512);
+    run_acf_shape_benchmarks("numbers", numbers, document, &shape_buffer, [&](acf_node const& root, u32 i)
+    {
+        return (usize) root[keys->keys[i]][(int32) ((i * 7919) % 1024)].get_float_or(0);
+    });
+    free(numbers.data);
+
+    acf_benchmark_source strings = generate_strings_acf(MEGABYTES(8));
+    make_acf_benchmark_keys(keys, "text_", 1000);
+    run_acf_shape_benchmarks("strings", strings, document, &shape_buffer, [&](acf_node const& root, u32 i)
+    {
+        return (usize) root[keys->keys[i]].get_string().size;
+    });
+    free(strings.data);
+
+    free(inner_keys);
+    free(keys);
+    free_acf_buffer(&shape_buffer);
+
+    printf("\n=== ACF parallel parse: log ===\n");
+
+    acf_benchmark_source log = generate_log_acf(MEGABYTES(32));
+    u32 thread_count = std::thread::hardware_concurrency();
+    printf("hardware threads: %u\n", thread_count);
+
+    print_benchmark_result(run_benchmark("acf parse / log 32 MB", log.size, [&]()
+    {
+        reset_acf_document(document);
+        bool success = parse_acf_document(document, log.data, log.size);
+        BENCHMARK_CHECK(success);
+    }));
+
+    acf_parallel_parse *parse = (acf_parallel_parse *) malloc(sizeof(acf_parallel_parse));
+    print_benchmark_result(run_benchmark("acf parallel parse / log 32 MB", log.size, [&]()
+    {
+        reset_acf_document(document);
+        u32 job_count = begin_acf_parallel_parse(parse, document, log.data, log.size, thread_count);
+
+        std::thread threads[ACF_PARALLEL_MAX_JOBS];
+        for (u32 i = 0; i < job_count; i++)
+        {
+            threads[i] = std::thread(run_acf_parallel_parse_job, parse, i);
+        }
+        for (u32 i = 0; i < job_count; i++)
+        {
+            threads[i].join();
+        }
+
+        bool success = finish_acf_parallel_parse(parse);
+        BENCHMARK_CHECK(success);
+    }));
+    free(parse);
+
+    printf("\n=== ACF string interning: log ===\n");
+
+    reset_acf_document(document);
+    parse_acf_document(document, log.data, log.size);
+    usize plain_used = document->arena.used;
+
+    // @note: The table is filled by the first run, the rest only look the keys up.
+    acf_string_table string_table = {};
+    document->strings = &string_table;
+    print_benchmark_result(run_benchmark("acf parse interned / log 32 MB", log.size, [&]()
+    {
+        reset_acf_document(document);
+        bool success = parse_acf_document(document, log.data, log.size);
+        BENCHMARK_CHECK(success);
+    }));
+    printf("arena used: %llu KB plain, %llu KB interned (%u strings)\n",
+           (unsigned long long) (plain_used / 1024), (unsigned long long) (document->arena.used / 1024), string_table.count);
+
+    document->strings = NULL;
+    free_acf_string_table(&string_table);
+    free(log.data);
+
+    release_acf_document(document);
+    free(document);
+    free(memory);
+    free(source.data);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+
+#include "benchmark.hpp"
+
+
+/*
+    Replays allocation traffic of the ACF parser on the given allocator:
+
+      - every object allocates arrays of keys and values of capacity 4, which
+        grow to (capacity + 1) * 2 by allocate-copy-deallocate on overflow;
+      - every key is copied into its own small string;
+      - leaves are arrays of numbers, which grow the same way;
+      - at the end the whole tree is disposed node by node.
+
+    Node size matches sizeof(acf), so size classes are hit the same way.
+*/
+
+struct acf_workload_node
+{
+    u64 type;
+    acf_workload_node *children;
+    char **keys;
+    usize size;
+    usize capacity;
+    u64 padding[4];
+};
+
+
+template <typename Allocator>
+void acf_workload_push(Allocator *allocator, acf_workload_node *node, acf_workload_node child, char const *key)
+{
+    if (node->size == node->capacity)
+    {
+        usize new_capacity = node->capacity ? (node->capacity + 1) * 2 : 4;
+
+        acf_workload_node *new_children = ALLOCATE_BUFFER_(allocator, acf_workload_node, new_capacity);
+        if (node->children)
+        {
+            memory::copy(new_children, node->children, node->size * sizeof(acf_workload_node));
+            DEALLOCATE_BUFFER(allocator, node->children);
+        }
+        node->children = new_children;
+
+        if (key)
+        {
+            char **new_keys = ALLOCATE_BUFFER_(allocator, char *, new_capacity);
+            if (node->keys)
+            {
+                memory::copy(new_keys, node->keys, node->size * sizeof(char *));
+                DEALLOCATE_BUFFER(allocator, node->keys);
+            }
+            node->keys = new_keys;
+        }
+
+        node->capacity = new_capacity;
+    }
+
+    if (key)
+    {
+        usize key_size = 0;
+        while (key[key_size]) key_size += 1;
+
+        char *key_copy = ALLOCATE_BUFFER_(allocator, char, key_size + 1);
+        memory::copy(key_copy, key, key_size + 1);
+        node->keys[node->size] = key_copy;
+    }
+
+    node->children[node->size++] = child;
+}
+
+
+template <typename Allocator>
+acf_workload_node acf_workload_build(Allocator *allocator, u32 depth)
+{
+    GLOBAL char const *keys[] = { "name", "position", "velocity", "sprite_name", "hitpoints", "children", "flags", "tint_color" };
+
+    acf_workload_node result = {};
+    if (depth == 0)
+    {
+        for (u32 i = 0; i < 16; i++)
+        {
+            acf_workload_node number = {};
+            number.type = i;
+            acf_workload_push(allocator, &result, number, NULL);
+        }
+    }
+    else
+    {
+        for (u32 i = 0; i < ARRAY_COUNT(keys); i++)
+        {
+            acf_workload_push(allocator, &result, acf_workload_build(allocator, depth - 1), keys[i]);
+        }
+    }
+
+    return result;
+}
+
+
+template <typename Allocator>
+void acf_workload_dispose(Allocator *allocator, acf_workload_node *node)
+{
+    for (usize i = 0; i < node->size; i++)
+    {
+        acf_workload_dispose(allocator, node->children + i);
+        if (node->keys)
+        {
+            DEALLOCATE_BUFFER(allocator, node->keys[i]);
+        }
+    }
+
+    if (node->children) DEALLOCATE_BUFFER(allocator, node->children);
+    if (node->keys) DEALLOCATE_BUFFER(allocator, node->keys);
+}
+
+
+template <typename Allocator>
+void acf_workload(Allocator *allocator)
+{
+    acf_workload_node root = acf_workload_build(allocator, 4);
+    acf_workload_dispose(allocator, &root);
+}
+
+
+void run_allocator_benchmarks()
+{
+    printf("\n=== Allocators: ACF parse allocation pattern ===\n");
+
+    GLOBAL memory::mallocator mallocator = { "benchmark mallocator" };
+
+    usize slab_memory_size = MEGABYTES(64);
+    void *slab_memory = malloc(slab_memory_size);
+
+    GLOBAL memory::slab_allocator slab;
+    memory::initialize(&slab, slab_memory, slab_memory_size);
+
+    print_benchmark_result(run_benchmark("acf workload / mallocator", 0, [&]() { acf_workload(&mallocator); }));
+    print_benchmark_result(run_benchmark("acf workload / slab_allocator", 0, [&]() { acf_workload(&slab); }));
+
+    memory::release(&slab);
+    memory::release(&mallocator);
+    free(slab_memory);
+}
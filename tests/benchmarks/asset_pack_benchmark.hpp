@@ -0,0 +1,130 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <png.hpp>
+#include <asset_pack.hpp>
+
+#include "benchmark.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    Startup of the game: sixteen bitmaps loaded one by one with
+    load_png_file, decoded on the spot, against the same bitmaps from an
+    asset pack, which is mapped and looked up.
+
+    The pack hands out pointers into the mapping without reading the
+    pixels, so it is also measured with reading all of them once, by the
+    verification, which is the most the first frame could touch.
+
+    The PNG files are from tests/png/images, the pack is written next to
+    the benchmark executable and removed after.
+*/
+
+#ifndef ASSET_PACK_BENCHMARK_DIRECTORY
+#define ASSET_PACK_BENCHMARK_DIRECTORY "tests/png/images/"
+#endif
+
+#define ASSET_PACK_BENCHMARK_FILENAME "asset_pack_benchmark.pack"
+
+
+GLOBAL char const *asset_pack_benchmark_files[] =
+{
+    "benchmark_rgba.png",
+    "long_codes.png",
+    "deflate_stored_many_idat.png",
+    "deflate_fast.png",
+    "deflate_fixed.png",
+    "rgba_8.png",
+    "rgb_8.png",
+    "rgba_16.png",
+    "rgb_16.png",
+    "gray_alpha_8.png",
+    "gray_8.png",
+    "palette_8.png",
+    "palette_8_trns.png",
+    "palette_4.png",
+    "rgba_8_interlaced.png",
+    "long_codes_gray.png",
+};
+
+
+void run_asset_pack_benchmarks()
+{
+    u32 const file_count = ARRAY_COUNT(asset_pack_benchmark_files);
+
+    char filepaths[file_count][256];
+    asset_pack_source sources[file_count] = {};
+
+    u64 pixels_size = 0;
+    for (u32 i = 0; i < file_count; i++)
+    {
+        snprintf(filepaths[i], sizeof(filepaths[i]), "%s%s", ASSET_PACK_BENCHMARK_DIRECTORY, asset_pack_benchmark_files[i]);
+
+        sources[i].name = asset_pack_benchmark_files[i];
+        sources[i].type = ASSET_TYPE_BITMAP;
+        sources[i].bitmap = load_png_file(filepaths[i]);
+        if (sources[i].bitmap.pixels == NULL)
+        {
+            printf("Could not open %s\n", filepaths[i]);
+            return;
+        }
+        pixels_size += sources[i].bitmap.size;
+    }
+
+    usize capacity = get_asset_pack_size(sources, file_count);
+    u8 *pack_data = (u8 *) malloc(capacity);
+    usize pack_size = write_asset_pack(sources, file_count, pack_data, capacity);
+
+    FILE *file = fopen(ASSET_PACK_BENCHMARK_FILENAME, "wb");
+    bool written = file && (fwrite(pack_data, 1, pack_size, file) == pack_size);
+    if (file) fclose(file);
+
+    for (u32 i = 0; i < file_count; i++)
+    {
+        free(sources[i].bitmap.pixels);
+    }
+    free(pack_data);
+
+    if (!written)
+    {
+        printf("Could not write %s\n", ASSET_PACK_BENCHMARK_FILENAME);
+        return;
+    }
+
+    print_benchmark_result(run_benchmark("asset startup / png files", pixels_size, [&]()
+    {
+        for (u32 i = 0; i < file_count; i++)
+        {
+            Bitmap bitmap = load_png_file(filepaths[i]);
+            consume_benchmark_value(bitmap.size);
+            free(bitmap.pixels);
+        }
+    }));
+
+    print_benchmark_result(run_benchmark("asset startup / pack", pixels_size, [&]()
+    {
+        asset_pack pack = {};
+        open_asset_pack(&pack, ASSET_PACK_BENCHMARK_FILENAME);
+        for (u32 i = 0; i < file_count; i++)
+        {
+            Bitmap bitmap = get_asset_bitmap(&pack, asset_pack_benchmark_files[i]);
+            consume_benchmark_value(bitmap.size);
+        }
+        close_asset_pack(&pack);
+    }));
+
+    print_benchmark_result(run_benchmark("asset startup / pack, reading pixels", pixels_size, [&]()
+    {
+        asset_pack pack = {};
+        open_asset_pack(&pack, ASSET_PACK_BENCHMARK_FILENAME);
+        BENCHMARK_CHECK(verify_asset_pack(&pack));
+        close_asset_pack(&pack);
+    }));
+
+    remove(ASSET_PACK_BENCHMARK_FILENAME);
+}
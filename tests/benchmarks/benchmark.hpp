@@ -0,0 +1,119 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <os/time.hpp>
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    Tiny benchmark harness.
+
+    The callback is run in batches until at least BENCHMARK_MIN_SECONDS
+    passed, and the best batch is reported, so one-time effects like page
+    faults on the first run do not spoil the numbers.
+
+    Benchmarks are run in release builds, where ASSERT is compiled out, so
+    results are checked with BENCHMARK_CHECK, and values which are computed
+    only to be thrown away go into the benchmark sink, so they are not
+    optimized out.
+*/
+
+#define BENCHMARK_MIN_SECONDS 0.25
+#define BENCHMARK_BATCH_COUNT 5
+
+#define BENCHMARK_CHECK(COND) check_benchmark_result((COND), #COND, __FILE__, __LINE__)
+
+
+struct benchmark_result
+{
+    char const *name;
+    u64 iterations;
+    f64 seconds_per_iteration;
+    u64 bytes_per_iteration;
+};
+
+
+GLOBAL u64 volatile benchmark_sink;
+
+
+INLINE
+void check_benchmark_result(bool success, char const *condition, char const *filename, int line)
+{
+    if (!success)
+    {
+        fprintf(stderr, "%s:%d Benchmark check failed: %s\n", filename, line, condition);
+        exit(1);
+    }
+}
+
+
+INLINE
+void consume_benchmark_value(u64 value)
+{
+    benchmark_sink = value;
+}
+
+
+INLINE
+f64 get_benchmark_seconds(os::timepoint start, os::timepoint end)
+{
+    f64 result = (f64) (end.us - start.us) / 1'000'000.0;
+    return result;
+}
+
+
+template <typename Callback>
+benchmark_result run_benchmark(char const *name, u64 bytes_per_iteration, Callback callback)
+{
+    benchmark_result result = {};
+    result.name = name;
+    result.bytes_per_iteration = bytes_per_iteration;
+    result.seconds_per_iteration = 1e30;
+
+    // @note: Find out how many iterations fit into one batch.
+    u64 iterations_in_batch = 1;
+    loop
+    {
+        os::timepoint start = os::get_wall_clock();
+        for (u64 i = 0; i < iterations_in_batch; i++) { callback(); }
+        os::timepoint end = os::get_wall_clock();
+
+        if (get_benchmark_seconds(start, end) * BENCHMARK_BATCH_COUNT >= BENCHMARK_MIN_SECONDS) break;
+        iterations_in_batch *= 2;
+    }
+
+    for (u32 batch = 0; batch < BENCHMARK_BATCH_COUNT; batch++)
+    {
+        os::timepoint start = os::get_wall_clock();
+        for (u64 i = 0; i < iterations_in_batch; i++) { callback(); }
+        os::timepoint end = os::get_wall_clock();
+
+        f64 seconds = get_benchmark_seconds(start, end) / iterations_in_batch;
+        if (seconds < result.seconds_per_iteration)
+        {
+            result.seconds_per_iteration = seconds;
+        }
+        result.iterations += iterations_in_batch;
+    }
+
+    return result;
+}
+
+
+INLINE
+void print_benchmark_result(benchmark_result result)
+{
+    if (result.bytes_per_iteration > 0)
+    {
+        f64 megabytes_per_second = (f64) result.bytes_per_iteration / result.seconds_per_iteration / (1024.0 * 1024.0);
+        printf("%-48s %12.3f us %12.1f MB/s\n", result.name, result.seconds_per_iteration * 1e6, megabytes_per_second);
+    }
+    else
+    {
+        printf("%-48s %12.3f us\n", result.name, result.seconds_per_iteration * 1e6);
+    }
+}
@@ -0,0 +1,8 @@
+#!/bin/bash
+
+CXX_STANDARD=17
+
+BUILD_SETTING="-DASUKA_DEBUG=0 -DUNITY_BUILD=1 -std=c++$CXX_STANDARD"
+
+mkdir -p build
+g++ tests/benchmarks/main.cpp -o build/benchmarks -O2 -g $BUILD_SETTING -DASUKA_OS_LINUX -Icommon -Isrc
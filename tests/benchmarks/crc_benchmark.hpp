@@ -0,0 +1,84 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <crc.hpp>
+
+#include "benchmark.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    CRC-32, every implementation on the same bytes:
+
+        bytewise     one table lookup per byte, what PNG chunks used to
+                     be checked with
+        slicing-by-8 eight tables, eight bytes per step
+        pclmul       carry-less multiplication, 64 bytes per step
+        compute_crc  what callers get, the best of them for the size
+
+    Big buffers are like a stored PNG or an asset file, small ones like
+    the chunk headers and short chunks.
+*/
+
+
+INTERNAL
+void run_crc_size_benchmarks(u8 const *buffer, usize size, char const *size_name)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "crc bytewise / %s", size_name);
+    print_benchmark_result(run_benchmark(name, size, [&]()
+    {
+        consume_benchmark_value(update_crc_bytewise(0xffffffffu, buffer, size));
+    }));
+
+    snprintf(name, sizeof(name), "crc slicing-by-8 / %s", size_name);
+    print_benchmark_result(run_benchmark(name, size, [&]()
+    {
+        consume_benchmark_value(update_crc_slicing_by_8(0xffffffffu, buffer, size));
+    }));
+
+#if CRC_PCLMUL
+    if (is_pclmul_supported() && size >= 64 && size % 16 == 0)
+    {
+        snprintf(name, sizeof(name), "crc pclmul / %s", size_name);
+        print_benchmark_result(run_benchmark(name, size, [&]()
+        {
+            consume_benchmark_value(update_crc_pclmul(0xffffffffu, buffer, size));
+        }));
+    }
+#endif // CRC_PCLMUL
+
+    snprintf(name, sizeof(name), "crc compute_crc / %s", size_name);
+    print_benchmark_result(run_benchmark(name, size, [&]()
+    {
+        consume_benchmark_value(compute_crc(buffer, size));
+    }));
+}
+
+
+void run_crc_benchmarks()
+{
+    usize size = MEGABYTES(1);
+    u8 *buffer = (u8 *) malloc(size);
+
+    u64 state = 0x2545F4914F6CDD1Dull;
+    for (usize i = 0; i < size; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        buffer[i] = (u8) state;
+    }
+
+    run_crc_size_benchmarks(buffer, size, "1 MB");
+    run_crc_size_benchmarks(buffer, 4096, "4 KB");
+    run_crc_size_benchmarks(buffer, 256, "256 B");
+    run_crc_size_benchmarks(buffer, 17, "17 B");
+
+    free(buffer);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <lz4.hpp>
+
+#include "benchmark.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    LZ4 blocks, as png_to_c embeds them: pixels of a 512x512 sprite, runs
+    of a few colors over transparent background, and noise, which does not
+    compress and is decompressed as literals. Bytes are of the
+    decompressed pixels, so the throughputs compare with plain memcpy of
+    the same bytes, which is what the game would do without compression.
+*/
+
+
+INTERNAL
+void run_lz4_data_benchmarks(u8 const *data, usize size, char const *data_name)
+{
+    char name[64];
+
+    usize capacity = get_lz4_compress_bound(size);
+    u8 *compressed = (u8 *) malloc(capacity);
+    u8 *output = (u8 *) malloc(size);
+    usize compressed_size = lz4_compress(data, size, compressed, capacity);
+
+    printf("lz4 / %s: %llu bytes -> %llu bytes\n", data_name, (unsigned long long) size, (unsigned long long) compressed_size);
+
+    snprintf(name, sizeof(name), "lz4 compress / %s", data_name);
+    print_benchmark_result(run_benchmark(name, size, [&]()
+    {
+        lz4_compress(data, size, compressed, capacity);
+    }));
+
+    snprintf(name, sizeof(name), "lz4 decompress / %s", data_name);
+    print_benchmark_result(run_benchmark(name, size, [&]()
+    {
+        lz4_decompress(compressed, compressed_size, output, size);
+    }));
+
+    snprintf(name, sizeof(name), "memcpy / %s", data_name);
+    print_benchmark_result(run_benchmark(name, size, [&]()
+    {
+        memcpy(output, data, size);
+    }));
+
+    free(output);
+    free(compressed);
+}
+
+
+void run_lz4_benchmarks()
+{
+    usize const size = 512 * 512 * 4;
+    u8 *data = (u8 *) malloc(size);
+
+    u64 state = 0x9e3779b97f4a7c15;
+    auto next_random = [&]() -> u32
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (u32) (state >> 16);
+    };
+
+    u32 const colors[] = { 0x00000000, 0x00000000, 0xff2040c0, 0xff2848c8, 0xff3050d0, 0xff101010 };
+    for (usize i = 0; i < size / 4; )
+    {
+        u32 color = colors[next_random() % ARRAY_COUNT(colors)];
+        u32 run = 1 + next_random() % 64;
+        for (u32 r = 0; r < run && i < size / 4; r++, i++) memcpy(data + i * 4, &color, 4);
+    }
+    run_lz4_data_benchmarks(data, size, "sprite 512x512");
+
+    for (usize i = 0; i < size; i++) data[i] = (u8) next_random();
+    run_lz4_data_benchmarks(data, size, "noise 1MB");
+
+    free(data);
+}
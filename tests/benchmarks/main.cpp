@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "allocator_benchmark.hpp"
+#include "memory_benchmark.hpp"
+#include "acf_benchmark.hpp"
+#include "png_benchmark.hpp"
+#include "crc_benchmark.hpp"
+#include "asset_pack_benchmark.hpp"
+#include "mipmap_benchmark.hpp"
+#include "lz4_benchmark.hpp"
+#include "mixer_benchmark.hpp"
+
+
+int main()
+{
+    run_allocator_benchmarks();
+    run_memory_benchmarks();
+    run_acf_benchmarks();
+    run_png_benchmarks();
+    run_crc_benchmarks();
+    run_asset_pack_benchmarks();
+    run_mipmap_benchmarks();
+    run_lz4_benchmarks();
+    run_mixer_benchmarks();
+
+    return 0;
+}
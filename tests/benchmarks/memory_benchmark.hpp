@@ -0,0 +1,69 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <os/memory.hpp>
+
+#include "benchmark.hpp"
+
+
+/*
+    Throughput of memory::set and memory::copy from 16 bytes to 64 megabytes,
+    compared to the plain byte-at-a-time loop they used to be.
+*/
+
+INTERNAL
+void byte_loop_set(void *memory, u8 value, usize size)
+{
+    u8 volatile *m = (u8 volatile *) memory;
+    for (usize i = 0; i < size; i++) { m[i] = value; }
+}
+
+
+INTERNAL
+void byte_loop_copy(void *destination, void const *source, usize size)
+{
+    u8 volatile *d = (u8 volatile *) destination;
+    u8 const *s = (u8 const *) source;
+    for (usize i = 0; i < size; i++) { d[i] = s[i]; }
+}
+
+
+void run_memory_benchmarks()
+{
+    printf("\n=== memory::set / memory::copy ===\n");
+
+    usize max_size = MEGABYTES(64);
+    void *source = memory::allocate_pages(max_size);
+    void *destination = memory::allocate_pages(max_size);
+
+    // @note: Touch all pages, so page faults are not measured.
+    memory::set(source, 1, max_size);
+    memory::set(destination, 2, max_size);
+
+    char name[64];
+    for (usize size = 16; size <= max_size; size *= 4)
+    {
+        // @note: Byte loops are too slow to wait for on big sizes.
+        if (size <= MEGABYTES(1))
+        {
+            sprintf(name, "byte loop set     %10llu B", (unsigned long long) size);
+            print_benchmark_result(run_benchmark(name, size, [&]() { byte_loop_set(destination, 3, size); }));
+        }
+
+        sprintf(name, "memory::set       %10llu B", (unsigned long long) size);
+        print_benchmark_result(run_benchmark(name, size, [&]() { memory::set(destination, 3, size); }));
+
+        if (size <= MEGABYTES(1))
+        {
+            sprintf(name, "byte loop copy    %10llu B", (unsigned long long) size);
+            print_benchmark_result(run_benchmark(name, size, [&]() { byte_loop_copy(destination, source, size); }));
+        }
+
+        sprintf(name, "memory::copy      %10llu B", (unsigned long long) size);
+        print_benchmark_result(run_benchmark(name, size, [&]() { memory::copy(destination, source, size); }));
+    }
+
+    memory::free_pages(source);
+    memory::free_pages(destination);
+}
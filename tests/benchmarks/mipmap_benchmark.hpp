@@ -0,0 +1,121 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <mipmap.hpp>
+
+#include "benchmark.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    Sprites drawn zoomed: 48 copies of a 256x256 bitmap, blitted into a
+    1280x720 target at scales up to 1.5, all of them inside. Bytes are of
+    the pixels drawn, so the throughputs tell the cost of one pixel on the
+    screen.
+
+    Zoomed out without mips, samples skip over the bitmap, and every one
+    of them is a cache miss; the mip level is read sequentially, like the
+    bitmap at 1:1.
+*/
+
+#define MIPMAP_BENCHMARK_SPRITES 48
+
+
+INTERNAL
+void blit_mipmap_benchmark_sprites(blit_target target, Bitmap const *bitmap, mip_chain const *chain, f32 scale, bool scalar)
+{
+    f32 size = 256.0f * scale;
+    for (u32 i = 0; i < MIPMAP_BENCHMARK_SPRITES; i++)
+    {
+        f32 left = (f32) ((i * 173) % 896);
+        f32 top = (f32) ((i * 97) % 336);
+        if (chain)
+        {
+            blit_mip_chain(target, left, top, size, size, chain);
+        }
+        else if (scalar)
+        {
+            blit_bitmap_scaled_scalar(target, left, top, size, size, bitmap);
+        }
+        else
+        {
+            blit_bitmap_scaled(target, left, top, size, size, bitmap);
+        }
+    }
+}
+
+
+void run_mipmap_benchmarks()
+{
+    i32 const width = 1280;
+    i32 const height = 720;
+
+    u32 *pixels = (u32 *) calloc(width * height, sizeof(u32));
+    blit_target target = { pixels, width, height, width * 4 };
+
+    Bitmap bitmap = {};
+    bitmap.width = 256;
+    bitmap.height = 256;
+    bitmap.bytes_per_pixel = 4;
+    bitmap.size = 256 * 256 * 4;
+    bitmap.pixels = malloc(bitmap.size);
+
+    u64 state = 0x9e3779b97f4a7c15;
+    u8 *bytes = (u8 *) bitmap.pixels;
+    for (usize i = 0; i < bitmap.size; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        bytes[i] = (u8) state;
+    }
+
+    void *levels = malloc(get_mip_chain_size(&bitmap));
+    mip_chain chain = {};
+    build_mip_chain(&chain, &bitmap, levels);
+
+    f32 const scales[] = { 1.0f, 0.5f, 0.3f, 0.125f, 1.5f };
+    char const *names[][3] =
+    {
+        { "blit 1:1 / scalar",    "blit 1:1 / sse2",    "blit 1:1 / mips"    },
+        { "blit 0.5x / scalar",   "blit 0.5x / sse2",   "blit 0.5x / mips"   },
+        { "blit 0.3x / scalar",   "blit 0.3x / sse2",   "blit 0.3x / mips"   },
+        { "blit 0.125x / scalar", "blit 0.125x / sse2", "blit 0.125x / mips" },
+        { "blit 1.5x / scalar",   "blit 1.5x / sse2",   "blit 1.5x / mips"   },
+    };
+
+    for (u32 s = 0; s < ARRAY_COUNT(scales); s++)
+    {
+        f32 scale = scales[s];
+        u64 side = (u64) (256.0f * scale);
+        u64 drawn_bytes = side * side * 4 * MIPMAP_BENCHMARK_SPRITES;
+
+        print_benchmark_result(run_benchmark(names[s][0], drawn_bytes, [&]()
+        {
+            blit_mipmap_benchmark_sprites(target, &bitmap, NULL, scale, true);
+        }));
+
+        print_benchmark_result(run_benchmark(names[s][1], drawn_bytes, [&]()
+        {
+            blit_mipmap_benchmark_sprites(target, &bitmap, NULL, scale, false);
+        }));
+
+        print_benchmark_result(run_benchmark(names[s][2], drawn_bytes, [&]()
+        {
+            blit_mipmap_benchmark_sprites(target, &bitmap, &chain, scale, false);
+        }));
+    }
+
+    print_benchmark_result(run_benchmark("build mip chain 256x256", bitmap.size, [&]()
+    {
+        build_mip_chain(&chain, &bitmap, levels);
+    }));
+
+    free(levels);
+    free(bitmap.pixels);
+    free(pixels);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <mixer.hpp>
+
+#include "benchmark.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    One block of SOUND_MIXER_BLOCK_FRAMES frames, with every voice
+    playing: half of them mono, half stereo, all of them looping, with
+    different pans. Bytes are of the output, so the throughput divided by
+    the output rate (192000 bytes per second of stereo at 48 kHz) tells how
+    many times faster than real time the mixer is.
+
+    Scalar and sse2 mix the same voices with the kernels alone; mix_sound
+    also ramps the gains and converts the block to the output. Sounds at
+    44.1 and 96 kHz go through the resampler, which is where most of the
+    time goes then.
+*/
+
+#define MIXER_BENCHMARK_SOUND_FRAMES 48000
+
+
+INTERNAL
+void mix_mixer_benchmark_voices(f32 *block, wav_file_contents const *sounds, bool scalar)
+{
+    for (u32 i = 0; i < SOUND_MIXER_MAX_VOICES; i++)
+    {
+        wav_file_contents const *sound = &sounds[i % 2];
+        sound_sample_t const *samples = sound->samples + (i * 997 % 40000) * sound->channels;
+        f32 left = 0.01f * (i % 100);
+        f32 right = 1.0f - left;
+        if (scalar)
+        {
+            mix_voice_samples_scalar(block, samples, sound->channels, 0, SOUND_MIXER_BLOCK_FRAMES, left, right, 0.0f, 0.0f);
+        }
+        else
+        {
+            mix_voice_samples(block, samples, sound->channels, SOUND_MIXER_BLOCK_FRAMES, left, right, 0.0f, 0.0f);
+        }
+    }
+}
+
+
+void run_mixer_benchmarks()
+{
+    sound_sample_t *mono_samples = (sound_sample_t *) malloc(MIXER_BENCHMARK_SOUND_FRAMES * sizeof(sound_sample_t));
+    sound_sample_t *stereo_samples = (sound_sample_t *) malloc(MIXER_BENCHMARK_SOUND_FRAMES * 2 * sizeof(sound_sample_t));
+
+    u64 state = 0x243f6a8885a308d3;
+    for (u32 i = 0; i < MIXER_BENCHMARK_SOUND_FRAMES * 2; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if (i < MIXER_BENCHMARK_SOUND_FRAMES) mono_samples[i] = (sound_sample_t) (state >> 52);
+        stereo_samples[i] = (sound_sample_t) (state >> 40);
+    }
+
+    wav_file_contents sounds[2] =
+    {
+        { 48000, 1, mono_samples, MIXER_BENCHMARK_SOUND_FRAMES },
+        { 48000, 2, stereo_samples, MIXER_BENCHMARK_SOUND_FRAMES * 2 },
+    };
+
+    sound_mixer *mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    initialize_sound_mixer(mixer);
+    for (u32 i = 0; i < SOUND_MIXER_MAX_VOICES; i++)
+    {
+        play_sound(mixer, &sounds[i % 2], 0.1f, -1.0f + (f32) i / 32.0f, true);
+    }
+
+    sound_sample_t output[SOUND_MIXER_BLOCK_FRAMES * 2];
+    u64 block_bytes = sizeof(output);
+
+    print_benchmark_result(run_benchmark("mix 64 voices / scalar", block_bytes, [&]()
+    {
+        memset(mixer->block, 0, sizeof(mixer->block));
+        mix_mixer_benchmark_voices(mixer->block, sounds, true);
+        convert_mix_block_scalar(output, mixer->block, 0, SOUND_MIXER_BLOCK_FRAMES * 2, 1.0f);
+    }));
+
+    print_benchmark_result(run_benchmark("mix 64 voices / sse2", block_bytes, [&]()
+    {
+        memset(mixer->block, 0, sizeof(mixer->block));
+        mix_mixer_benchmark_voices(mixer->block, sounds, false);
+        convert_mix_block(output, mixer->block, SOUND_MIXER_BLOCK_FRAMES * 2, 1.0f);
+    }));
+
+    print_benchmark_result(run_benchmark("mix_sound 64 voices", block_bytes, [&]()
+    {
+        mix_sound(mixer, output, SOUND_MIXER_BLOCK_FRAMES);
+    }));
+
+    i32 const rates[] = { 44100, 96000 };
+    char const *names[][2] =
+    {
+        { "resample 64 voices 44.1 kHz / scalar", "mix_sound 64 voices 44.1 kHz" },
+        { "resample 64 voices 96 kHz / scalar",   "mix_sound 64 voices 96 kHz"   },
+    };
+
+    for (u32 r = 0; r < ARRAY_COUNT(rates); r++)
+    {
+        sounds[0].samples_per_second = rates[r];
+        sounds[1].samples_per_second = rates[r];
+
+        initialize_sound_mixer(mixer);
+        for (u32 i = 0; i < SOUND_MIXER_MAX_VOICES; i++)
+        {
+            play_sound(mixer, &sounds[i % 2], 0.1f, -1.0f + (f32) i / 32.0f, true);
+        }
+
+        resampler_filter const *filter = mixer->voices[0].filter;
+        u64 step = mixer->voices[0].step;
+        for (u32 i = 0; i < ARRAY_COUNT(mixer->source[0]); i++)
+        {
+            mixer->source[0][i] = (f32) mono_samples[i];
+            mixer->source[1][i] = (f32) stereo_samples[i];
+        }
+
+        print_benchmark_result(run_benchmark(names[r][0], block_bytes, [&]()
+        {
+            memset(mixer->block, 0, sizeof(mixer->block));
+            for (u32 i = 0; i < SOUND_MIXER_MAX_VOICES; i++)
+            {
+                u32 channels = 1 + (i % 2);
+                resample_frames_scalar(mixer->block, mixer->source[0], mixer->source[channels - 1], channels, filter,
+                                       0, step, 0, SOUND_MIXER_BLOCK_FRAMES, 0.5f, 0.5f, 0.0f, 0.0f);
+            }
+            convert_mix_block_scalar(output, mixer->block, 0, SOUND_MIXER_BLOCK_FRAMES * 2, 1.0f);
+        }));
+
+        print_benchmark_result(run_benchmark(names[r][1], block_bytes, [&]()
+        {
+            mix_sound(mixer, output, SOUND_MIXER_BLOCK_FRAMES);
+        }));
+    }
+
+    free(mixer);
+    free(stereo_samples);
+    free(mono_samples);
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <png.hpp>
+
+#include "benchmark.hpp"
+
+// Reference decoder
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include <external/stb_image.h>
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    PNG decoding from memory, decode_png against stb_image, which the game
+    used to load its textures with. Both flip the rows and give 8-bit
+    samples, so they do the same work.
+
+    The files are from tests/png/images:
+
+        benchmark_rgba  512x512 RGBA, smooth with a little noise, every
+                        filter type, like the game art
+        long_codes      256x128 RGBA, half of it noise, so long Huffman
+                        codes and their subtables are hot
+        stored          300x300 RGB of stored blocks, only unfiltering
+                        and copying
+
+    Inflate is measured on its own as well, on the IDAT stream of the first
+    one. Throughput is of the decoded pixels.
+
+    Unfiltering is measured per filter, on 1 MB of noise in rows of 1024
+    RGB and RGBA pixels, with the vector kernels and with the scalar loops
+    they replace.
+*/
+
+#ifndef PNG_BENCHMARK_DIRECTORY
+#define PNG_BENCHMARK_DIRECTORY "tests/png/images/"
+#endif
+
+
+struct png_benchmark_file
+{
+    u8 *data;
+    usize size;
+};
+
+
+INTERNAL
+png_benchmark_file load_png_benchmark_file(char const *filename)
+{
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s%s", PNG_BENCHMARK_DIRECTORY, filename);
+
+    png_benchmark_file result = {};
+
+    FILE *file = fopen(filepath, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        result.size = (usize) ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        result.data = (u8 *) malloc(result.size);
+        result.size = fread(result.data, 1, result.size, file);
+
+        fclose(file);
+    }
+
+    return result;
+}
+
+
+INTERNAL
+void run_png_file_benchmarks(char const *shape, char const *filename)
+{
+    png_benchmark_file file = load_png_benchmark_file(filename);
+    if (file.data == NULL)
+    {
+        printf("Could not open %s%s\n", PNG_BENCHMARK_DIRECTORY, filename);
+        return;
+    }
+
+    Bitmap bitmap = decode_png(file.data, file.size);
+    u64 pixels_size = bitmap.size;
+    free(bitmap.pixels);
+
+    char name[64];
+
+    snprintf(name, sizeof(name), "png decode / %s", shape);
+    print_benchmark_result(run_benchmark(name, pixels_size, [&]()
+    {
+        Bitmap result = decode_png(file.data, file.size);
+        free(result.pixels);
+    }));
+
+    stbi_set_flip_vertically_on_load(true);
+
+    snprintf(name, sizeof(name), "png stb_image / %s", shape);
+    print_benchmark_result(run_benchmark(name, pixels_size, [&]()
+    {
+        int width, height, channels;
+        u8 *pixels = stbi_load_from_memory(file.data, (int) file.size, &width, &height, &channels, 0);
+        stbi_image_free(pixels);
+    }));
+
+    free(file.data);
+}
+
+
+INTERNAL
+void run_png_inflate_benchmark(char const *filename)
+{
+    png_benchmark_file file = load_png_benchmark_file(filename);
+    if (file.data == NULL) return;
+
+    // @note: Benchmark files are written with one IDAT chunk, right after IHDR and sRGB.
+    u8 const *at = file.data + 8;
+    u8 const *end = file.data + file.size;
+    u8 const *stream = NULL;
+    u32 stream_size = 0;
+    while (at + 12 <= end)
+    {
+        u32 chunk_size = (at[0] << 24) | (at[1] << 16) | (at[2] << 8) | at[3];
+        if (memcmp(at + 4, "IDAT", 4) == 0)
+        {
+            stream = at + 8;
+            stream_size = chunk_size;
+            break;
+        }
+        at += 12 + (usize) chunk_size;
+    }
+
+    usize capacity = MEGABYTES(16);
+    u8 *output = (u8 *) malloc(capacity);
+
+    usize output_size = 0;
+    if (stream && inflate_zlib(stream, stream_size, output, capacity, &output_size))
+    {
+        print_benchmark_result(run_benchmark("png inflate / benchmark_rgba", output_size, [&]()
+        {
+            usize size = 0;
+            inflate_zlib(stream, stream_size, output, capacity, &size);
+        }));
+    }
+
+    free(output);
+    free(file.data);
+}
+
+
+INTERNAL
+void run_png_unfilter_benchmarks(u32 bpp)
+{
+    usize row_size = 1024 * bpp;
+    u32 row_count = (u32) (MEGABYTES(1) / row_size);
+    usize size = row_size * row_count;
+
+    u8 *rows = (u8 *) malloc(size + row_size);
+    u64 state = 0x2545F4914F6CDD1Dull;
+    for (usize i = 0; i < size + row_size; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        rows[i] = (u8) state;
+    }
+
+    char const *filter_names[] = { "none", "sub", "up", "average", "paeth" };
+
+    // @note: Rows are unfiltered in place again and again, noise stays noise.
+    for (u8 filter = PNG_FILTER_SUB; filter <= PNG_FILTER_PAETH; filter++)
+    {
+        char name[64];
+
+        snprintf(name, sizeof(name), "png unfilter %s / %u bpp", filter_names[filter], bpp);
+        print_benchmark_result(run_benchmark(name, size, [&]()
+        {
+            for (u32 y = 0; y < row_count; y++)
+            {
+                unfilter_png_row(filter, rows + (y + 1) * row_size, rows + y * row_size, row_size, bpp);
+            }
+        }));
+
+        snprintf(name, sizeof(name), "png unfilter %s scalar / %u bpp", filter_names[filter], bpp);
+        print_benchmark_result(run_benchmark(name, size, [&]()
+        {
+            for (u32 y = 0; y < row_count; y++)
+            {
+                unfilter_png_row_scalar(filter, rows + (y + 1) * row_size, rows + y * row_size, row_size, bpp);
+            }
+        }));
+    }
+
+    free(rows);
+}
+
+
+void run_png_benchmarks()
+{
+    run_png_file_benchmarks("benchmark_rgba", "benchmark_rgba.png");
+    run_png_file_benchmarks("long_codes", "long_codes.png");
+    run_png_file_benchmarks("stored", "deflate_stored_many_idat.png");
+
+    run_png_inflate_benchmark("benchmark_rgba.png");
+
+    run_png_unfilter_benchmarks(3);
+    run_png_unfilter_benchmarks(4);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <crc.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    CRC-32 tests.
+
+    Known values first, then every implementation against the byte-at-a-time
+    loop on buffers of every size up to a few folding blocks, from every
+    alignment, and crc_combine against the CRC of the whole buffer at every
+    split.
+*/
+
+
+bool run_crc_known_values_test()
+{
+    printf("crc known values: ");
+
+    u8 const check[] = "123456789";
+    u8 const iend[] = "IEND";
+
+    u8 zeros[4096] = {};
+    u8 ones[4096];
+    memset(ones, 0xFF, sizeof(ones));
+
+    // @note: 0xCBF43926 is the check value of CRC-32, 0xAE426082 ends every PNG file.
+    bool successfull = (compute_crc(check, 9) == 0xCBF43926) && (compute_crc(iend, 4) == 0xAE426082) &&
+        (compute_crc(check, 0) == 0) && (compute_crc(zeros, sizeof(zeros)) == 0xC71C0011) &&
+        (compute_crc(ones, sizeof(ones)) == 0xF154670A);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_crc_implementations_test()
+{
+    printf("crc implementations: ");
+
+    usize const capacity = 1024 + 64;
+    u8 *buffer = (u8 *) malloc(capacity);
+
+    u64 state = 0x9E3779B97F4A7C15ull;
+    for (usize i = 0; i < capacity; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        buffer[i] = (u8) state;
+    }
+
+    bool successfull = true;
+    for (usize offset = 0; successfull && offset < 16; offset++)
+    {
+        for (usize size = 0; successfull && size <= 1024; size++)
+        {
+            // @note: Separate allocation of the exact size, so the sanitizer catches reads past the end.
+            u8 *data = (u8 *) malloc(size + 1);
+            memcpy(data, buffer + offset, size);
+
+            u32 init = (u32) (state >> (size % 32));
+            u32 expected = update_crc_bytewise(init, data, size);
+
+            successfull = (update_crc_slicing_by_8(init, data, size) == expected) && (update_crc(init, data, size) == expected);
+#if CRC_PCLMUL
+            if (is_pclmul_supported() && size >= 64 && size % 16 == 0)
+            {
+                successfull = successfull && (update_crc_pclmul(init, data, size) == expected);
+            }
+#endif // CRC_PCLMUL
+
+            if (!successfull)
+            {
+                printf("\nsize %u, offset %u", (u32) size, (u32) offset);
+            }
+            free(data);
+        }
+    }
+
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_crc_combine_test()
+{
+    printf("crc combine: ");
+
+    usize const size = 3000;
+    u8 *buffer = (u8 *) malloc(size);
+    for (usize i = 0; i < size; i++)
+    {
+        buffer[i] = (u8) (i * 7 + (i >> 5));
+    }
+
+    u32 whole = compute_crc(buffer, size);
+
+    bool successfull = true;
+    for (usize split = 0; successfull && split <= size; split++)
+    {
+        u32 first = compute_crc(buffer, split);
+        u32 second = compute_crc(buffer + split, size - split);
+        successfull = (crc_combine(first, second, size - split) == whole);
+    }
+
+    // @note: Pieces of different sizes, merged one by one, as threads would.
+    usize const pieces[] = { 1, 17, 64, 0, 333, 1000, 585, 1000 };
+    u32 crc = compute_crc(NULL, 0);
+    usize at = 0;
+    for (u32 i = 0; i < ARRAY_COUNT(pieces); i++)
+    {
+        crc = crc_combine(crc, compute_crc(buffer + at, pieces[i]), pieces[i]);
+        at += pieces[i];
+    }
+    successfull = successfull && (at == size) && (crc == whole);
+
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_crc_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_crc_known_values_test());
+    record_test_result(&result, run_crc_implementations_test());
+    record_test_result(&result, run_crc_combine_test());
+
+    return result;
+}
@@ -0,0 +1,416 @@
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+
+// ACF implementation
+#define ACF_LIB_IMPLEMENTATION
+#include <acf/acf_stream.hpp>
+#include <acf/acf_binary.hpp>
+#include <acf/acf_serialize.hpp>
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    ACF fuzz harness, in the libFuzzer interface.
+
+    Every input is parsed as a document, and when it parses, it has to
+    survive the round-trips without changing:
+
+        text ─→ document ─→ text (every layout) ─→ document   same tree
+                         └→ binary ─→ verify ─→ document       same tree
+
+    The document builder is fed the same input in small chunks and has to
+    agree with parse_acf_document on success and on the tree, unless there
+    are zero bytes in it. So does the parser with a string table, which
+    shares key lists between objects. The input is
+    also given to the binary verifier as is, it must reject garbage without
+    reading out of bounds.
+
+    Any disagreement aborts, so the fuzzer saves the input.
+
+    With libFuzzer (clang):
+
+        clang++ tests/fuzz/acf_fuzz.cpp -fsanitize=fuzzer,address,undefined ...
+        ./acf_fuzz -dict=tests/fuzz/acf.dict corpus tests/acf/positive
+
+    Without it, build with ACF_FUZZ_STANDALONE=1: sources nested around
+    ACF_MAX_DEPTH and far deeper are run first, then every file from the
+    command line is run, and then mutated a number of times with a fixed seed.
+*/
+
+#define ACF_FUZZ_MEMORY_SIZE MEGABYTES(16)
+#define ACF_FUZZ_CHUNK_SIZE 7
+
+
+struct acf_fuzz_context
+{
+    u8 const *input;
+    usize input_size;
+
+    void *memory[2];
+    void *binary;
+    usize binary_capacity;
+};
+
+GLOBAL acf_fuzz_context acf_fuzz;
+
+
+INTERNAL
+void acf_fuzz_fail(char const *what, char const *data, usize size)
+{
+    fprintf(stderr, "acf fuzz: %s\n%.*s\n", what, (int) (size < 4096 ? size : 4096), data);
+
+#if ACF_FUZZ_STANDALONE
+    // @note: libFuzzer saves the input by itself.
+    FILE *file = fopen("acf_fuzz_failure.acf", "wb");
+    if (file)
+    {
+        fwrite(acf_fuzz.input, 1, acf_fuzz.input_size, file);
+        fclose(file);
+        fprintf(stderr, "Input is saved to acf_fuzz_failure.acf\n");
+    }
+#endif // ACF_FUZZ_STANDALONE
+
+    abort();
+}
+
+
+INTERNAL
+void acf_fuzz_check_serialize(acf_document *expected, acf_serialize_options options)
+{
+    acf_buffer buffer = {};
+
+    // @note: Strings with quotes or new lines, and infinities, can not be written, it is not an error.
+    if (acf_serialize_document(expected, &buffer, options))
+    {
+        acf_document document;
+        initialize_acf_document(&document, acf_fuzz.memory[1], ACF_FUZZ_MEMORY_SIZE);
+
+        if (!parse_acf_document(&document, buffer.data, buffer.size))
+        {
+            acf_fuzz_fail(document.error_buffer, buffer.data, buffer.size);
+        }
+        if (!are_acf_nodes_equal(document.root, expected->root) || (document.newtype_count != expected->newtype_count))
+        {
+            acf_fuzz_fail("serialized document is different", buffer.data, buffer.size);
+        }
+
+        release_acf_document(&document);
+    }
+
+    free_acf_buffer(&buffer);
+}
+
+
+INTERNAL
+void acf_fuzz_check_binary(acf_document *expected)
+{
+    usize size = write_acf_binary(expected, acf_fuzz.binary, acf_fuzz.binary_capacity);
+    if (size > acf_fuzz.binary_capacity)
+    {
+        free(acf_fuzz.binary);
+        acf_fuzz.binary_capacity = size;
+        acf_fuzz.binary = malloc(size);
+        write_acf_binary(expected, acf_fuzz.binary, acf_fuzz.binary_capacity);
+    }
+
+    if (!verify_acf_binary(acf_fuzz.binary, size))
+    {
+        acf_fuzz_fail("written binary does not verify", expected->source, expected->source_size);
+    }
+
+    acf_binary binary;
+    acf_document document;
+    initialize_acf_document(&document, acf_fuzz.memory[1], ACF_FUZZ_MEMORY_SIZE);
+
+    if (!open_acf_binary(&binary, acf_fuzz.binary, size) || !load_acf_binary_document(&document, &binary) ||
+        !are_acf_nodes_equal(document.root, expected->root))
+    {
+        acf_fuzz_fail("binary document is different", expected->source, expected->source_size);
+    }
+
+    release_acf_document(&document);
+}
+
+
+INTERNAL
+void acf_fuzz_check_builder(acf_document *expected, bool expected_result, char const *data, usize size)
+{
+    acf_document document;
+    initialize_acf_document(&document, acf_fuzz.memory[1], ACF_FUZZ_MEMORY_SIZE);
+
+    acf_document_builder *builder = (acf_document_builder *) malloc(sizeof(acf_document_builder));
+    begin_acf_document_build(builder, &document);
+
+    bool result = true;
+    for (usize offset = 0; result && offset < size; offset += ACF_FUZZ_CHUNK_SIZE)
+    {
+        usize chunk_size = (size - offset < ACF_FUZZ_CHUNK_SIZE) ? size - offset : ACF_FUZZ_CHUNK_SIZE;
+        result = feed_acf_document_build(builder, data + offset, chunk_size);
+    }
+    result = result && finish_acf_document_build(builder);
+
+    free(builder);
+
+    if (result != expected_result)
+    {
+        acf_fuzz_fail(result ? "builder accepts what parser rejects" : document.error_buffer, data, size);
+    }
+    if (result && !are_acf_nodes_equal(document.root, expected->root))
+    {
+        acf_fuzz_fail("builder document is different", data, size);
+    }
+
+    release_acf_document(&document);
+}
+
+
+INTERNAL
+void acf_fuzz_check_interned(acf_document *expected, bool expected_result, char const *data, usize size)
+{
+    acf_string_table table = {};
+
+    acf_document document;
+    initialize_acf_document(&document, acf_fuzz.memory[1], ACF_FUZZ_MEMORY_SIZE);
+    document.strings = &table;
+
+    bool result = parse_acf_document(&document, data, size);
+    if (result != expected_result)
+    {
+        acf_fuzz_fail(result ? "interned parse accepts what parser rejects" : document.error_buffer, data, size);
+    }
+    if (result ? !are_acf_nodes_equal(document.root, expected->root) : (strcmp(document.error_buffer, expected->error_buffer) != 0))
+    {
+        acf_fuzz_fail("interned document is different", data, size);
+    }
+
+    release_acf_document(&document);
+    free_acf_string_table(&table);
+}
+
+
+extern "C" int LLVMFuzzerTestOneInput(u8 const *data, usize size)
+{
+    if (acf_fuzz.memory[0] == NULL)
+    {
+        acf_fuzz.memory[0] = malloc(ACF_FUZZ_MEMORY_SIZE);
+        acf_fuzz.memory[1] = malloc(ACF_FUZZ_MEMORY_SIZE);
+    }
+
+    acf_fuzz.input = data;
+    acf_fuzz.input_size = size;
+
+    char const *source = (char const *) data;
+
+    acf_document expected;
+    initialize_acf_document(&expected, acf_fuzz.memory[0], ACF_FUZZ_MEMORY_SIZE);
+    bool parsed = parse_acf_document(&expected, source, size);
+
+    // @note: Zero byte ends the source for the parser, as in C strings, but the stream reports it as an error.
+    if (memchr(source, 0, size) == NULL)
+    {
+        acf_fuzz_check_builder(&expected, parsed, source, size);
+    }
+
+    acf_fuzz_check_interned(&expected, parsed, source, size);
+
+    if (parsed)
+    {
+        acf_serialize_options layouts[4];
+        layouts[1].multiline = acf_serialize_options::multiline_t::enabled;
+        layouts[2].multiline = acf_serialize_options::multiline_t::disabled;
+        layouts[2].print_spaces = false;
+        layouts[3].multiline = acf_serialize_options::multiline_t::disabled;
+        layouts[3].print_spaces = false;
+        layouts[3].print_commas = false;
+        layouts[3].print_semicolons = false;
+
+        for (u32 i = 0; i < ARRAY_COUNT(layouts); i++)
+        {
+            acf_fuzz_check_serialize(&expected, layouts[i]);
+        }
+
+        acf_fuzz_check_binary(&expected);
+    }
+
+    // @note: The same bytes as a binary blob.
+    if (verify_acf_binary(data, size))
+    {
+        acf_binary binary;
+        acf_document document;
+        initialize_acf_document(&document, acf_fuzz.memory[1], ACF_FUZZ_MEMORY_SIZE);
+        if (open_acf_binary(&binary, data, size))
+        {
+            load_acf_binary_document(&document, &binary);
+        }
+        release_acf_document(&document);
+    }
+
+    release_acf_document(&expected);
+    return 0;
+}
+
+
+#if ACF_FUZZ_STANDALONE
+
+#ifndef ACF_FUZZ_MUTATIONS
+#define ACF_FUZZ_MUTATIONS 2000
+#endif
+
+// @note: Same tokens as in acf.dict, mutations splice them in.
+GLOBAL char const *acf_fuzz_tokens[] =
+{
+    "{", "}", "[", "]", "(", ")", "=", ",", ";", "\"", "//", "\n", " ",
+    "#newtype", "vec2(float, float)", "true", "false", "null",
+    "0", "-1", "1.5", "1e308", "1e-400", "9223372036854775808", "0.000001",
+};
+
+
+INTERNAL
+u64 acf_fuzz_random(u64 *state)
+{
+    u64 x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+
+INTERNAL
+usize mutate_acf_fuzz_input(u8 *data, usize size, usize capacity, u64 *state)
+{
+    u32 mutation_count = 1 + acf_fuzz_random(state) % 4;
+    for (u32 i = 0; i < mutation_count; i++)
+    {
+        usize at = size ? acf_fuzz_random(state) % size : 0;
+        switch (acf_fuzz_random(state) % 4)
+        {
+            case 0: // flip a byte
+            {
+                if (size) data[at] = (u8) acf_fuzz_random(state);
+            }
+            break;
+
+            case 1: // erase a range
+            {
+                usize count = acf_fuzz_random(state) % 8;
+                if (at + count > size) count = size - at;
+                memmove(data + at, data + at + count, size - at - count);
+                size -= count;
+            }
+            break;
+
+            case 2: // insert a token
+            {
+                char const *token = acf_fuzz_tokens[acf_fuzz_random(state) % ARRAY_COUNT(acf_fuzz_tokens)];
+                usize count = strlen(token);
+                if (size + count <= capacity)
+                {
+                    memmove(data + at + count, data + at, size - at);
+                    memcpy(data + at, token, count);
+                    size += count;
+                }
+            }
+            break;
+
+            case 3: // duplicate a range
+            {
+                usize count = acf_fuzz_random(state) % 64;
+                if (at + count > size) count = size - at;
+                if (size + count <= capacity)
+                {
+                    memmove(data + at + count, data + at, size - at);
+                    size += count;
+                }
+            }
+            break;
+        }
+    }
+    return size;
+}
+
+
+// @note: "a = " and 'depth' opens, then as many closes. Parsers have to agree on where the limit is, and must not run out of stack past it.
+INTERNAL
+void run_acf_fuzz_nested_input(u32 depth, char const *open, char const *close)
+{
+    usize open_size = strlen(open);
+    usize close_size = strlen(close);
+    u8 *data = (u8 *) malloc(4 + depth * (open_size + close_size));
+
+    usize size = 0;
+    memcpy(data, "a = ", 4);
+    size += 4;
+    for (u32 i = 0; i < depth; i++)
+    {
+        memcpy(data + size, open, open_size);
+        size += open_size;
+    }
+    for (u32 i = 0; i < depth; i++)
+    {
+        memcpy(data + size, close, close_size);
+        size += close_size;
+    }
+
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+}
+
+
+int main(int argc, char **argv)
+{
+    u64 state = 0x9E3779B97F4A7C15ull;
+    u32 input_count = 0;
+
+    u32 const depths[] = { ACF_MAX_DEPTH - 2, ACF_MAX_DEPTH - 1, ACF_MAX_DEPTH, 100000 };
+    for (u32 i = 0; i < ARRAY_COUNT(depths); i++)
+    {
+        run_acf_fuzz_nested_input(depths[i], "[", "]");
+        run_acf_fuzz_nested_input(depths[i], "{ b = ", "}");
+        run_acf_fuzz_nested_input(depths[i], "[{ b = ", "}]");
+        input_count += 3;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Could not open %s\n", argv[i]);
+            continue;
+        }
+
+        fseek(file, 0, SEEK_END);
+        usize size = (usize) ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        usize capacity = size + 4096;
+        u8 *seed = (u8 *) malloc(size);
+        u8 *data = (u8 *) malloc(capacity);
+        size = fread(seed, 1, size, file);
+        fclose(file);
+
+        LLVMFuzzerTestOneInput(seed, size);
+        for (u32 mutation = 0; mutation < ACF_FUZZ_MUTATIONS; mutation++)
+        {
+            memcpy(data, seed, size);
+            usize mutated_size = mutate_acf_fuzz_input(data, size, capacity, &state);
+            LLVMFuzzerTestOneInput(data, mutated_size);
+        }
+        input_count += 1 + ACF_FUZZ_MUTATIONS;
+
+        free(data);
+        free(seed);
+    }
+
+    printf("acf fuzz: %u inputs Ok\n", input_count);
+    return 0;
+}
+
+#endif // ACF_FUZZ_STANDALONE
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+CXX_STANDARD=17
+
+BUILD_SETTING="-DASUKA_DEBUG=1 -DUNITY_BUILD=1 -std=c++$CXX_STANDARD"
+
+mkdir -p build
+
+if command -v clang++ > /dev/null; then
+    # ./build/acf_fuzz -dict=tests/fuzz/acf.dict build/acf_corpus tests/acf/positive
+    mkdir -p build/acf_corpus
+    clang++ tests/fuzz/acf_fuzz.cpp -o build/acf_fuzz -O1 -g -fsanitize=fuzzer,address,undefined $BUILD_SETTING -DASUKA_OS_LINUX -Icommon
+else
+    # ./build/acf_fuzz tests/acf/positive/*.acf
+    g++ tests/fuzz/acf_fuzz.cpp -o build/acf_fuzz -O1 -g -fsanitize=address,undefined $BUILD_SETTING -DASUKA_OS_LINUX -DACF_FUZZ_STANDALONE=1 -Icommon
+fi
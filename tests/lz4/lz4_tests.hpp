@@ -0,0 +1,237 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <lz4.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    LZ4 tests.
+
+    Blocks made here have to decompress back into their input, for data
+    which compresses well and which does not at all, and for all the small
+    sizes around the limits of the format. Reference block was made by the
+    lz4 command line tool (v1.9.4, -12), so both ways are compatible with
+    it. Broken blocks have to be refused, and have no way to touch memory
+    outside of the buffers, which the address sanitizer tells.
+*/
+
+
+INTERNAL
+u32 next_lz4_test_random(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (u32) (*state >> 16);
+}
+
+
+// @note: Compresses, and decompresses into the buffer of exactly the size of the input.
+INTERNAL
+bool run_lz4_round_trip(u8 const *input, usize size)
+{
+    usize capacity = get_lz4_compress_bound(size);
+    u8 *compressed = (u8 *) malloc(capacity);
+    u8 *output = (u8 *) malloc(size + 1);
+
+    usize compressed_size = lz4_compress(input, size, compressed, capacity);
+    bool result = (compressed_size > 0) && (compressed_size <= capacity) &&
+        lz4_decompress(compressed, compressed_size, output, size) &&
+        (memcmp(input, output, size) == 0);
+
+    // @note: One byte less and one byte more of the output are both wrong sizes.
+    if (result && size > 0)
+    {
+        result = !lz4_decompress(compressed, compressed_size, output, size - 1);
+    }
+    result = result && !lz4_decompress(compressed, compressed_size, output, size + 1);
+
+    free(compressed);
+    free(output);
+    return result;
+}
+
+
+bool run_lz4_round_trip_test()
+{
+    printf("lz4 round trip: ");
+
+    usize const size = 300000;
+    u8 *data = (u8 *) malloc(size);
+    u64 random = 0x6a09e667f3bcc908;
+
+    bool successfull = true;
+
+    // @note: Noise, which does not compress.
+    for (usize i = 0; i < size; i++) data[i] = (u8) next_lz4_test_random(&random);
+    successfull = successfull && run_lz4_round_trip(data, size);
+
+    // @note: Zeros, one match over the whole block, repeating at offset 1.
+    memset(data, 0, size);
+    successfull = successfull && run_lz4_round_trip(data, size);
+
+    // @note: Sprite-like pixels: runs of a few colors, with transparent background.
+    u32 const colors[] = { 0x00000000, 0xff2040c0, 0xff2848c8, 0xff101010, 0x80ffffff };
+    for (usize i = 0; i < size / 4; )
+    {
+        u32 color = colors[next_lz4_test_random(&random) % ARRAY_COUNT(colors)];
+        u32 run = 1 + next_lz4_test_random(&random) % 40;
+        for (u32 r = 0; r < run && i < size / 4; r++, i++) memcpy(data + i * 4, &color, 4);
+    }
+    successfull = successfull && run_lz4_round_trip(data, size);
+
+    // @note: Short periods, for the matches closer than 8 bytes.
+    for (usize period = 1; successfull && period < 20; period++)
+    {
+        for (usize i = 0; i < 1000; i++) data[i] = (u8) ('a' + i % period);
+        successfull = run_lz4_round_trip(data, 1000);
+        if (!successfull) printf("\nperiod %u", (u32) period);
+    }
+
+    // @note: Matches at the furthest offset, and just past it.
+    for (usize i = 0; i < size; i++) data[i] = (u8) next_lz4_test_random(&random);
+    memcpy(data + LZ4_MAX_OFFSET + 100, data + 100, 1000);
+    memcpy(data + 200000, data + 200000 - LZ4_MAX_OFFSET - 1, 1000);
+    successfull = successfull && run_lz4_round_trip(data, size);
+
+    // @note: All small sizes, around the 12 and 5 bytes at the end, which have to be literals.
+    for (usize length = 0; successfull && length < 64; length++)
+    {
+        for (usize i = 0; i < length; i++) data[i] = (u8) ((i % 3 == 0) ? 'x' : 'y');
+        successfull = run_lz4_round_trip(data, length);
+        if (!successfull) printf("\nlength %u", (u32) length);
+    }
+
+    free(data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_lz4_reference_test()
+{
+    printf("lz4 reference block: ");
+
+    char const *expected =
+        "Asuka, the game. ----------------------------------------"
+        " Asuka, the game engine. abababababababababababab"
+        " 0123456789ABCDEF0123456789ABCDEF end.";
+    usize expected_size = strlen(expected);
+
+    // @note: Long literals, and matches at offsets 1, 2, 16 and 58.
+    u8 const block[] =
+    {
+        0xff, 0x03, 0x41, 0x73, 0x75, 0x6b, 0x61, 0x2c, 0x20, 0x74, 0x68, 0x65, 0x20, 0x67, 0x61, 0x6d,
+        0x65, 0x2e, 0x20, 0x2d, 0x01, 0x00, 0x14, 0x1b, 0x20, 0x3a, 0x00, 0xbf, 0x20, 0x65, 0x6e, 0x67,
+        0x69, 0x6e, 0x65, 0x2e, 0x20, 0x61, 0x62, 0x02, 0x00, 0x03, 0xfc, 0x02, 0x20, 0x30, 0x31, 0x32,
+        0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x10, 0x00, 0x50,
+        0x20, 0x65, 0x6e, 0x64, 0x2e,
+    };
+
+    u8 output[256] = {};
+    bool successfull = (expected_size == 144) &&
+        lz4_decompress(block, sizeof(block), output, expected_size) &&
+        (memcmp(output, expected, expected_size) == 0);
+
+    successfull = successfull && run_lz4_round_trip((u8 const *) expected, expected_size);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_lz4_malformed_test()
+{
+    printf("lz4 malformed blocks: ");
+
+    bool successfull = true;
+
+    // @note: Empty block, offset of zero, offset before the beginning, and the input ending inside of a length or an offset.
+    u8 const offset_zero[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+    u8 const offset_before[] = { 0x10, 'a', 0x02, 0x00, 0x00 };
+    u8 const unfinished_length[] = { 0xf0, 0xff, 0xff };
+    u8 const missing_offset[] = { 0x10, 'a', 0x01 };
+    u8 output[64] = {};
+
+    successfull = successfull && !lz4_decompress(offset_zero, 0, output, 0);
+    successfull = successfull && !lz4_decompress(offset_zero, sizeof(offset_zero), output, 5);
+    successfull = successfull && !lz4_decompress(offset_before, sizeof(offset_before), output, 5);
+    successfull = successfull && !lz4_decompress(unfinished_length, sizeof(unfinished_length), output, sizeof(output));
+    successfull = successfull && !lz4_decompress(missing_offset, sizeof(missing_offset), output, sizeof(output));
+
+    // @note: Match longer than the output.
+    u8 const long_match[] = { 0x1f, 'a', 0x01, 0x00, 0xff, 0x10, 0x00 };
+    successfull = successfull && !lz4_decompress(long_match, sizeof(long_match), output, sizeof(output));
+
+    // @note: Truncated and bit-flipped blocks, decompressed into the buffer of the original size, must stay inside of it.
+    usize const size = 5000;
+    u8 *data = (u8 *) malloc(size);
+    u64 random = 0x3c6ef372fe94f82b;
+    for (usize i = 0; i < size; i++)
+    {
+        data[i] = (i % 7 < 4) ? (u8) ('a' + (i / 64) % 4) : (u8) next_lz4_test_random(&random);
+    }
+
+    usize capacity = get_lz4_compress_bound(size);
+    u8 *compressed = (u8 *) malloc(capacity);
+    usize compressed_size = lz4_compress(data, size, compressed, capacity);
+    successfull = successfull && (compressed_size > 0);
+
+    for (usize length = 0; successfull && length < compressed_size; length++)
+    {
+        // @note: Copy of just the truncated bytes, so reading past them is caught.
+        u8 *truncated = (u8 *) malloc(length + 1);
+        memcpy(truncated, compressed, length);
+        u8 *out = (u8 *) malloc(size);
+
+        successfull = !lz4_decompress(truncated, length, out, size);
+        if (!successfull) printf("\ntruncated to %u", (u32) length);
+
+        free(out);
+        free(truncated);
+    }
+
+    u8 *broken = (u8 *) malloc(compressed_size);
+    u8 *out = (u8 *) malloc(size);
+    for (u32 i = 0; successfull && i < 2000; i++)
+    {
+        memcpy(broken, compressed, compressed_size);
+        u32 flips = 1 + next_lz4_test_random(&random) % 4;
+        for (u32 f = 0; f < flips; f++)
+        {
+            usize at = next_lz4_test_random(&random) % compressed_size;
+            broken[at] ^= (u8) (1 << (next_lz4_test_random(&random) % 8));
+        }
+
+        // @note: Result does not matter, some flips only change literals.
+        lz4_decompress(broken, compressed_size, out, size);
+    }
+
+    free(out);
+    free(broken);
+    free(compressed);
+    free(data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_lz4_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_lz4_round_trip_test());
+    record_test_result(&result, run_lz4_reference_test());
+    record_test_result(&result, run_lz4_malformed_test());
+
+    return result;
+}
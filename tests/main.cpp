@@ -1,5 +1,26 @@
 #include <stdio.h>
 #include "acf/acf_tests.hpp"
+#include "acf/acf_document_tests.hpp"
+#include "acf/acf_stream_tests.hpp"
+#include "acf/acf_binary_tests.hpp"
+#include "acf/acf_serialize_tests.hpp"
+#include "acf/acf_reflect_tests.hpp"
+#include "acf/acf_parallel_tests.hpp"
+#include "acf/acf_strings_tests.hpp"
+#include "png/png_tests.hpp"
+#include "png/png_unfilter_tests.hpp"
+#include "crc/crc_tests.hpp"
+#include "asset_pack/asset_pack_tests.hpp"
+#include "asset_loader/asset_loader_tests.hpp"
+#include "atlas/atlas_tests.hpp"
+#include "mipmap/mipmap_tests.hpp"
+#include "lz4/lz4_tests.hpp"
+#include "mixer/mixer_tests.hpp"
+#include "resampler/resampler_tests.hpp"
+#include "memory/arena_allocator_tests.hpp"
+#include "memory/allocation_log_tests.hpp"
+#include "memory/slab_allocator_tests.hpp"
+#include "memory/concurrent_arena_tests.hpp"
 #include "../common/tprint.hpp"
 #include <math/quaternion.hpp>
 #include <math/complex.hpp>
@@ -41,5 +62,27 @@ int main()
            tests_result.failed);
 #endif
 
+    print_test_stats("ACF document tests", run_acf_document_tests());
+    print_test_stats("ACF stream tests", run_acf_stream_tests());
+    print_test_stats("ACF binary tests", run_acf_binary_tests());
+    print_test_stats("ACF serialize tests", run_acf_serialize_tests());
+    print_test_stats("ACF reflect tests", run_acf_reflect_tests());
+    print_test_stats("ACF parallel tests", run_acf_parallel_tests());
+    print_test_stats("ACF strings tests", run_acf_strings_tests());
+    print_test_stats("PNG tests", run_png_tests());
+    print_test_stats("PNG unfilter tests", run_png_unfilter_tests());
+    print_test_stats("CRC tests", run_crc_tests());
+    print_test_stats("Asset pack tests", run_asset_pack_tests());
+    print_test_stats("Asset loader tests", run_asset_loader_tests());
+    print_test_stats("Atlas tests", run_atlas_tests());
+    print_test_stats("Mipmap tests", run_mipmap_tests());
+    print_test_stats("LZ4 tests", run_lz4_tests());
+    print_test_stats("Mixer tests", run_mixer_tests());
+    print_test_stats("Resampler tests", run_resampler_tests());
+    print_test_stats("Arena allocator tests", run_arena_allocator_tests());
+    print_test_stats("Allocation log tests", run_allocation_log_tests());
+    print_test_stats("Slab allocator tests", run_slab_allocator_tests());
+    print_test_stats("Concurrent arena tests", run_concurrent_arena_tests());
+
     return 0;
 }
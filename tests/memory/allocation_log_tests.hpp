@@ -0,0 +1,263 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+    Allocation log tests.
+
+    Pointers here are made up, the log never touches the memory behind
+    them. Tables have to grow and give the old ones back, tombstones have to
+    be cleared in place without new pages, however long the log lives, and
+    sites have to keep their counts, bytes and peaks through all of that.
+*/
+
+#ifdef ASUKA_DEBUG
+
+INTERNAL
+void *get_allocation_log_test_pointer(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (void *) (usize) ((*state & 0xffffffffff) | 0x10000);
+}
+
+
+INTERNAL
+u32 get_allocation_log_block_count(AllocationLog *log)
+{
+    u32 result = 0;
+    for (AllocationLogBlock *block = log->blocks; block; block = block->next)
+    {
+        result += 1;
+    }
+    return result;
+}
+
+
+bool run_allocation_log_growth_test()
+{
+    printf("allocation log growth: ");
+
+    u32 const pointer_count = 5000;
+    void **pointers = (void **) malloc(pointer_count * sizeof(void *));
+    u64 random = 0x9e3779b97f4a7c15;
+
+    AllocationLog log = {};
+    CodeLocation cl = CODE_LOCATION_FUNC;
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < pointer_count; i++)
+    {
+        pointers[i] = get_allocation_log_test_pointer(&random);
+        push_allocation_entry(&log, {cl, pointers[i], i});
+
+        // @note: Hash table, site hash table and sites, outgrown tables are freed.
+        successfull = (log.allocation_count == i + 1) && (get_allocation_log_block_count(&log) == 3);
+    }
+
+    successfull = successfull && (log.capacity * 3 >= pointer_count * 4) && (log.capacity < pointer_count * 4);
+    for (u32 i = 0; successfull && i < pointer_count; i++)
+    {
+        AllocationLogEntry *entry = get_allocation_entry(&log, pointers[i]);
+        successfull = (entry != NULL) && (entry->size == i);
+    }
+
+    release_allocation_log(&log);
+    successfull = successfull && (log.blocks == NULL) && (log.capacity == 0);
+    free(pointers);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Few live allocations, which are freed and made again for a long time, like a per-frame temporary scope does.
+bool run_allocation_log_tombstones_test()
+{
+    printf("allocation log tombstones: ");
+
+    u32 const live_count = 8;
+    void *live[live_count];
+    u64 random = 0x243f6a8885a308d3;
+
+    AllocationLog log = {};
+    CodeLocation cl = CODE_LOCATION_FUNC;
+
+    for (u32 i = 0; i < live_count; i++)
+    {
+        live[i] = get_allocation_log_test_pointer(&random);
+        push_allocation_entry(&log, {cl, live[i], 16});
+    }
+
+    usize capacity = log.capacity;
+    AllocationLogEntry *hash_table = log.hash_table;
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < 200000; i++)
+    {
+        u32 k = i % live_count;
+        pop_allocation_entry(&log, live[k]);
+        live[k] = get_allocation_log_test_pointer(&random);
+        push_allocation_entry(&log, {cl, live[k], 16});
+
+        successfull = (log.allocation_count == live_count) && (log.tombstone_count < capacity) &&
+            (log.capacity == capacity) && (log.hash_table == hash_table) && (get_allocation_log_block_count(&log) == 3);
+    }
+
+    for (u32 i = 0; successfull && i < live_count; i++)
+    {
+        successfull = (get_allocation_entry(&log, live[i]) != NULL);
+    }
+    successfull = successfull && (log.sites[0].count == live_count) && (log.sites[0].bytes == live_count * 16);
+
+    release_allocation_log(&log);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Table filled up to growing with long probe chains, most of it tombstones, and rehashed in place.
+bool run_allocation_log_rehash_test()
+{
+    printf("allocation log rehash: ");
+
+    u32 const pointer_count = ALLOCATION_LOG_INITIAL_CAPACITY / 2 - 8;
+    void *pointers[pointer_count];
+    u64 random = 0x6a09e667f3bcc908;
+
+    AllocationLog log = {};
+    CodeLocation cl = CODE_LOCATION_FUNC;
+
+    bool successfull = true;
+    for (u32 round = 0; successfull && round < 100; round++)
+    {
+        for (u32 i = 0; i < pointer_count; i++)
+        {
+            pointers[i] = get_allocation_log_test_pointer(&random);
+            push_allocation_entry(&log, {cl, pointers[i], i});
+        }
+
+        // @note: Every third entry stays, the rest become tombstones.
+        for (u32 i = 0; i < pointer_count; i++)
+        {
+            if (i % 3) pop_allocation_entry(&log, pointers[i]);
+        }
+
+        successfull = (log.capacity == ALLOCATION_LOG_INITIAL_CAPACITY);
+        rehash_allocation_log_in_place(&log);
+        successfull = successfull && (log.tombstone_count == 0);
+
+        usize live_count = 0;
+        for (usize index = 0; successfull && index < log.capacity; index++)
+        {
+            AllocationLogEntry *entry = log.hash_table + index;
+            successfull = (entry->pointer != ALLOCATION_LOG_TOMBSTONE) && ((entry->index & ALLOCATION_LOG_PENDING_INDEX) == 0);
+            live_count += (entry->pointer != NULL);
+        }
+        successfull = successfull && (live_count == log.allocation_count);
+
+        for (u32 i = 0; successfull && i < pointer_count; i++)
+        {
+            AllocationLogEntry *entry = get_allocation_entry(&log, pointers[i]);
+            successfull = (i % 3) ? (entry == NULL) : (entry != NULL && entry->size == i);
+        }
+
+        for (u32 i = 0; i < pointer_count; i += 3)
+        {
+            pop_allocation_entry(&log, pointers[i]);
+        }
+        successfull = successfull && (log.allocation_count == 0);
+
+        if (!successfull) printf("\nround %u", round);
+    }
+
+    release_allocation_log(&log);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_allocation_log_sites_test()
+{
+    printf("allocation log sites: ");
+
+    AllocationLog log = {};
+    CodeLocation first = CODE_LOCATION_FUNC;
+    CodeLocation second = CODE_LOCATION_FUNC;
+
+    void *a = (void *) 0x1000;
+    void *b = (void *) 0x2000;
+    void *c = (void *) 0x3000;
+
+    push_allocation_entry(&log, {first, a, 100});
+    push_allocation_entry(&log, {first, b, 50});
+    push_allocation_entry(&log, {second, c, 10});
+
+    AllocationSite *sites = log.sites;
+    bool successfull = (log.site_count == 2) &&
+        (sites[0].count == 2) && (sites[0].bytes == 150) && (sites[0].peak_bytes == 150) && (sites[0].total_count == 2) &&
+        (sites[1].count == 1) && (sites[1].bytes == 10) && (sites[1].peak_bytes == 10) && (sites[1].total_count == 1);
+
+    // @note: In-place reallocation moves the bytes and the peak, but not the counts.
+    resize_allocation_entry(&log, a, 300);
+    successfull = successfull && (get_allocation_entry(&log, a)->size == 300) &&
+        (sites[0].count == 2) && (sites[0].bytes == 350) && (sites[0].peak_bytes == 350) && (sites[0].total_count == 2);
+
+    resize_allocation_entry(&log, a, 20);
+    successfull = successfull && (sites[0].bytes == 70) && (sites[0].peak_bytes == 350);
+
+    pop_allocation_entry(&log, a);
+    pop_allocation_entry(&log, c);
+    successfull = successfull &&
+        (sites[0].count == 1) && (sites[0].bytes == 50) && (sites[0].peak_bytes == 350) && (sites[0].total_count == 2) &&
+        (sites[1].count == 0) && (sites[1].bytes == 0) && (sites[1].peak_bytes == 10) && (sites[1].total_count == 1);
+
+    push_allocation_entry(&log, {second, a, 5});
+    successfull = successfull && (log.site_count == 2) &&
+        (sites[1].count == 1) && (sites[1].bytes == 5) && (sites[1].peak_bytes == 10) && (sites[1].total_count == 2);
+
+    // @note: Many sites, so the site tables grow and keep what was counted.
+    for (i32 line = 0; line < 1000; line++)
+    {
+        push_allocation_entry(&log, {make_code_location(__FILE__, line), (void *) (usize) (0x10000 + line * 16), 1});
+    }
+    successfull = successfull && (log.site_count == 1002) && (get_allocation_log_block_count(&log) == 3) &&
+        (log.sites[0].bytes == 50) && (log.sites[0].peak_bytes == 350) && (log.sites[1].total_count == 2);
+    for (usize i = 2; successfull && i < log.site_count; i++)
+    {
+        successfull = (log.sites[i].count == 1) && (log.sites[i].bytes == 1) && (log.sites[i].cl.line == (i32) (i - 2));
+    }
+
+    release_allocation_log(&log);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+#endif // ASUKA_DEBUG
+
+
+test_stats run_allocation_log_tests()
+{
+    test_stats result = {};
+
+#ifdef ASUKA_DEBUG
+    record_test_result(&result, run_allocation_log_growth_test());
+    record_test_result(&result, run_allocation_log_tombstones_test());
+    record_test_result(&result, run_allocation_log_rehash_test());
+    record_test_result(&result, run_allocation_log_sites_test());
+#endif // ASUKA_DEBUG
+
+    return result;
+}
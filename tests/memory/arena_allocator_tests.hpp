@@ -0,0 +1,196 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+
+#if ASUKA_DEBUG && ASUKA_OS_LINUX
+#include <unistd.h>
+#include <sys/wait.h>
+#endif // ASUKA_DEBUG && ASUKA_OS_LINUX
+
+
+/*
+    Arena temporary scope tests.
+
+    Scopes have to give back exactly what was allocated in them, 'used',
+    the last allocation (which reallocate grows in place) and the debug log,
+    whether they are closed by hand, by the guard, or committed into the
+    scope around them.
+*/
+
+#define ARENA_TEST_MEMORY_SIZE KILOBYTES(4)
+
+
+INTERNAL
+bool check_arena_test_state(memory::arena_allocator *arena, usize used, usize last_allocation_size, u32 temporary_count, usize allocation_count)
+{
+    bool result = (arena->used == used) && (arena->last_allocation_size == last_allocation_size) && (arena->temporary_count == temporary_count);
+#if ASUKA_DEBUG
+    result = result && (arena->log.allocation_count == allocation_count);
+#endif // ASUKA_DEBUG
+    return result;
+}
+
+
+bool run_arena_temporary_rollback_test()
+{
+    printf("arena temporary rollback: ");
+
+    void *buffer = malloc(ARENA_TEST_MEMORY_SIZE);
+    memory::arena_allocator arena = {};
+    memory::initialize(&arena, buffer, ARENA_TEST_MEMORY_SIZE);
+
+    void *block = ALLOCATE(&arena, 100, 8);
+    usize used = arena.used;
+    bool successfull = check_arena_test_state(&arena, used, 100, 0, 1);
+
+    memory::TemporaryMemory temporary = memory::begin_temporary(&arena);
+    void *first = ALLOCATE(&arena, 30, 16);
+    ALLOCATE(&arena, 200, 8);
+    successfull = successfull && check_arena_test_state(&arena, arena.used, 200, 1, 3) && (arena.used > used + 230);
+
+    memory::end_temporary(temporary);
+    successfull = successfull && check_arena_test_state(&arena, used, 100, 0, 1);
+
+    // @note: Same place is given again in the next scope.
+    temporary = memory::begin_temporary(&arena);
+    void *again = ALLOCATE(&arena, 30, 16);
+    successfull = successfull && (again == first);
+    memory::end_temporary(temporary);
+
+    // @note: Allocation before the scope is the last one again, so it grows in place.
+    void *grown = memory::reallocate(&arena, block, 120, 8, CODE_LOCATION_FUNC);
+    successfull = successfull && (grown == block) && check_arena_test_state(&arena, used + 20, 120, 0, 1);
+
+    memory::release(&arena);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_arena_temporary_nested_test()
+{
+    printf("arena temporary nested: ");
+
+    void *buffer = malloc(ARENA_TEST_MEMORY_SIZE);
+    memory::arena_allocator arena = {};
+    memory::initialize(&arena, buffer, ARENA_TEST_MEMORY_SIZE);
+
+    memory::TemporaryMemory outer = memory::begin_temporary(&arena);
+    ALLOCATE(&arena, 64, 8);
+    usize outer_used = arena.used;
+
+    memory::TemporaryMemory inner = memory::begin_temporary(&arena);
+    ALLOCATE(&arena, 128, 8);
+    bool successfull = check_arena_test_state(&arena, outer_used + 128, 128, 2, 2);
+
+    memory::end_temporary(inner);
+    successfull = successfull && check_arena_test_state(&arena, outer_used, 64, 1, 1);
+
+    // @note: Committed scope keeps its allocations, until the scope around it ends.
+    memory::TemporaryMemory committed = memory::begin_temporary(&arena);
+    ALLOCATE(&arena, 32, 8);
+    memory::commit_temporary(committed);
+    successfull = successfull && check_arena_test_state(&arena, outer_used + 32, 32, 1, 2);
+
+    memory::end_temporary(outer);
+    successfull = successfull && check_arena_test_state(&arena, 0, 0, 0, 0);
+
+    memory::release(&arena);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_arena_temporary_scope_test()
+{
+    printf("arena temporary scope guard: ");
+
+    void *buffer = malloc(ARENA_TEST_MEMORY_SIZE);
+    memory::arena_allocator arena = {};
+    memory::initialize(&arena, buffer, ARENA_TEST_MEMORY_SIZE);
+
+    ALLOCATE(&arena, 10, 1);
+
+    bool successfull = true;
+    {
+        memory::temporary_scope scratch(&arena);
+        ALLOCATE(&arena, 500, 8);
+        {
+            memory::temporary_scope inner(&arena);
+            ALLOCATE(&arena, 500, 8);
+            successfull = check_arena_test_state(&arena, arena.used, 500, 2, 3);
+        }
+        successfull = successfull && check_arena_test_state(&arena, arena.used, 500, 1, 2);
+
+        // @note: Allocations which do not fit fail in the scope as outside of it.
+        successfull = successfull && (ALLOCATE(&arena, ARENA_TEST_MEMORY_SIZE, 8) == NULL);
+    }
+    successfull = successfull && check_arena_test_state(&arena, 10, 10, 0, 1);
+
+    memory::release(&arena);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+#if ASUKA_DEBUG && ASUKA_OS_LINUX
+// @note: Closing the outer scope before the inner one has to stop in the debugger. It is run in a child process,
+// which is killed by the trap.
+bool run_arena_temporary_order_test()
+{
+    printf("arena temporary order assert: ");
+
+    bool successfull = false;
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+        u8 buffer[256];
+        memory::arena_allocator arena = {};
+        memory::initialize(&arena, buffer, sizeof(buffer));
+
+        memory::TemporaryMemory outer = memory::begin_temporary(&arena);
+        memory::begin_temporary(&arena);
+        memory::end_temporary(outer);
+
+        _exit(0);
+    }
+    else if (child > 0)
+    {
+        int status = 0;
+        successfull = (waitpid(child, &status, 0) == child) && WIFSIGNALED(status);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+#endif // ASUKA_DEBUG && ASUKA_OS_LINUX
+
+
+test_stats run_arena_allocator_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_arena_temporary_rollback_test());
+    record_test_result(&result, run_arena_temporary_nested_test());
+    record_test_result(&result, run_arena_temporary_scope_test());
+#if ASUKA_DEBUG && ASUKA_OS_LINUX
+    record_test_result(&result, run_arena_temporary_order_test());
+#endif // ASUKA_DEBUG && ASUKA_OS_LINUX
+
+    return result;
+}
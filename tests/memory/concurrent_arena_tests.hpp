@@ -0,0 +1,217 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+
+/*
+    Concurrent arena and thread scratch tests.
+
+    Threads allocate at the same time and fill their blocks with their own
+    byte, so blocks which overlap show up as the wrong bytes, and in debug
+    builds the logs of all threads have to hold every block once. There are
+    more threads than logs, so the last ones share the locked log, and the
+    arena is initialized again between rounds, which the logs of the
+    previous threads have to be given back for.
+*/
+
+#define CONCURRENT_ARENA_TEST_BLOCKS  1000
+#define CONCURRENT_ARENA_TEST_ROUNDS  3
+#define CONCURRENT_ARENA_TEST_THREADS (CONCURRENT_ARENA_MAX_THREADS + 4)
+
+
+struct concurrent_arena_test_block
+{
+    u8 *pointer;
+    usize size;
+};
+
+
+INTERNAL
+int compare_concurrent_arena_test_blocks(void const *a, void const *b)
+{
+    u8 *pointer_a = ((concurrent_arena_test_block const *) a)->pointer;
+    u8 *pointer_b = ((concurrent_arena_test_block const *) b)->pointer;
+    return (pointer_a < pointer_b) ? -1 : (pointer_a > pointer_b);
+}
+
+
+INTERNAL
+void allocate_concurrent_arena_test_blocks(memory::concurrent_arena_allocator *arena, concurrent_arena_test_block *blocks, u8 fill)
+{
+    for (u32 i = 0; i < CONCURRENT_ARENA_TEST_BLOCKS; i++)
+    {
+        usize size = 1 + (i * 7 + fill) % 60;
+        usize alignment = (usize) 1 << (i % 4);
+        u8 *pointer = (u8 *) ALLOCATE(arena, size, alignment);
+        if (pointer) memset(pointer, fill, size);
+        blocks[i] = { pointer, size };
+    }
+}
+
+
+bool run_concurrent_arena_test()
+{
+    printf("concurrent arena: ");
+
+    usize const thread_block_count = CONCURRENT_ARENA_TEST_THREADS * CONCURRENT_ARENA_TEST_BLOCKS;
+    usize const buffer_size = thread_block_count * 64 + 4096;
+    u8 *buffer = (u8 *) malloc(buffer_size);
+    auto *blocks = (concurrent_arena_test_block *) malloc(thread_block_count * sizeof(concurrent_arena_test_block));
+
+    memory::concurrent_arena_allocator arena = {};
+    bool successfull = true;
+
+    for (u32 round = 0; successfull && round < CONCURRENT_ARENA_TEST_ROUNDS; round++)
+    {
+        memory::initialize(&arena, buffer, buffer_size);
+
+        std::thread threads[CONCURRENT_ARENA_TEST_THREADS];
+        for (u32 i = 0; i < CONCURRENT_ARENA_TEST_THREADS; i++)
+        {
+            u8 fill = (u8) (round * CONCURRENT_ARENA_TEST_THREADS + i + 1);
+            threads[i] = std::thread(allocate_concurrent_arena_test_blocks, &arena, blocks + i * CONCURRENT_ARENA_TEST_BLOCKS, fill);
+        }
+        for (u32 i = 0; i < CONCURRENT_ARENA_TEST_THREADS; i++)
+        {
+            threads[i].join();
+        }
+
+        usize total_size = 0;
+        for (u32 i = 0; successfull && i < thread_block_count; i++)
+        {
+            u8 fill = (u8) (round * CONCURRENT_ARENA_TEST_THREADS + i / CONCURRENT_ARENA_TEST_BLOCKS + 1);
+            usize alignment = (usize) 1 << (i % CONCURRENT_ARENA_TEST_BLOCKS % 4);
+            concurrent_arena_test_block block = blocks[i];
+
+            successfull = (block.pointer != NULL) &&
+                (buffer <= block.pointer) && (block.pointer + block.size <= buffer + buffer_size) &&
+                (((uintptr_t) block.pointer & (alignment - 1)) == 0);
+            for (usize k = 0; successfull && k < block.size; k++)
+            {
+                successfull = (block.pointer[k] == fill);
+            }
+            total_size += block.size;
+        }
+
+        qsort(blocks, thread_block_count, sizeof(concurrent_arena_test_block), compare_concurrent_arena_test_blocks);
+        for (u32 i = 1; successfull && i < thread_block_count; i++)
+        {
+            successfull = (blocks[i - 1].pointer + blocks[i - 1].size <= blocks[i].pointer);
+        }
+
+#if ASUKA_DEBUG
+        successfull = successfull && (memory::get_allocation_count(&arena) == thread_block_count);
+
+        usize logged_count = 0;
+        usize logged_size = 0;
+        memory::for_each_allocation_entry(&arena, [&](AllocationLogEntry *entry)
+        {
+            concurrent_arena_test_block key = { (u8 *) entry->pointer, 0 };
+            auto *block = (concurrent_arena_test_block *) bsearch(&key, blocks, thread_block_count,
+                                                                  sizeof(concurrent_arena_test_block), compare_concurrent_arena_test_blocks);
+            if (block && block->size == entry->size)
+            {
+                logged_count += 1;
+                logged_size += entry->size;
+            }
+        });
+        successfull = successfull && (logged_count == thread_block_count) && (logged_size == total_size);
+#endif // ASUKA_DEBUG
+
+        if (!successfull) printf("\nround %u", round);
+    }
+
+    memory::release(&arena);
+    free(blocks);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+INTERNAL
+void run_thread_scratch_test_thread(bool *successfull, u8 fill)
+{
+    usize const buffer_size = 1 << 16;
+    u8 *buffer = (u8 *) malloc(buffer_size);
+
+    memory::arena_allocator *scratch = memory::initialize_thread_scratch(buffer, buffer_size);
+    bool result = (scratch == memory::get_thread_scratch());
+
+    u8 *blocks[100];
+    for (u32 i = 0; result && i < ARRAY_COUNT(blocks); i++)
+    {
+        blocks[i] = (u8 *) ALLOCATE(memory::get_thread_scratch(), 100, 8);
+        result = (buffer <= blocks[i]) && (blocks[i] + 100 <= buffer + buffer_size);
+        if (result) memset(blocks[i], fill, 100);
+    }
+
+    // @note: Yield, so other threads run in between and would overwrite shared memory.
+    std::this_thread::yield();
+
+    for (u32 i = 0; result && i < ARRAY_COUNT(blocks); i++)
+    {
+        for (u32 k = 0; result && k < 100; k++)
+        {
+            result = (blocks[i][k] == fill);
+        }
+    }
+
+#if ASUKA_DEBUG
+    result = result && (scratch->log.allocation_count == ARRAY_COUNT(blocks));
+#endif // ASUKA_DEBUG
+
+    memory::release(memory::get_thread_scratch());
+    free(buffer);
+
+    *successfull = result;
+}
+
+
+bool run_thread_scratch_test()
+{
+    printf("thread scratch: ");
+
+    u32 const thread_count = 16;
+    bool results[thread_count] = {};
+
+    std::thread threads[thread_count];
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i] = std::thread(run_thread_scratch_test_thread, results + i, (u8) (i + 1));
+    }
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i].join();
+    }
+
+    bool successfull = true;
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        successfull = successfull && results[i];
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_concurrent_arena_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_concurrent_arena_test());
+    record_test_result(&result, run_thread_scratch_test());
+
+    return result;
+}
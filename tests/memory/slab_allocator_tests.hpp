@@ -0,0 +1,334 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <allocator.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Slab allocator tests.
+
+    Every test gets its own slab over a few pages, so running out of pages
+    is easy to reach. Blocks are filled with a pattern before they move, and
+    have to keep it after every reallocation.
+*/
+
+#define SLAB_TEST_PAGE_COUNT 4
+
+
+INTERNAL
+void fill_slab_test_block(void *block, usize size, u8 seed)
+{
+    for (usize i = 0; i < size; i++)
+    {
+        ((u8 *) block)[i] = (u8) (seed + i);
+    }
+}
+
+
+INTERNAL
+bool check_slab_test_block(void *block, usize size, u8 seed)
+{
+    for (usize i = 0; i < size; i++)
+    {
+        if (((u8 *) block)[i] != (u8) (seed + i)) return false;
+    }
+    return true;
+}
+
+
+INTERNAL
+bool is_slab_test_aligned(void *pointer, usize alignment)
+{
+    return ((usize) pointer & (alignment - 1)) == 0;
+}
+
+
+bool run_slab_size_class_test()
+{
+    printf("slab size classes: ");
+
+    struct size_class_case
+    {
+        usize size;
+        usize alignment;
+        u32 size_class;
+    };
+
+    size_class_case cases[] =
+    {
+        { 1, 1, 0 },
+        { 16, 8, 0 },
+        { 17, 8, 1 },
+        { 32, 4, 1 },
+        { 100, 8, 3 },
+        { 8, 64, 2 },       // @note: Alignment bigger than the size picks the class.
+        { 1024, 16, 6 },
+        { 2048, 16, 7 },
+        { 2049, 16, SLAB_SIZE_CLASS_COUNT },
+    };
+
+    // @note: Page for every class.
+    usize const memory_size = SLAB_SIZE_CLASS_COUNT * SLAB_PAGE_SIZE + KILOBYTES(4);
+    void *buffer = malloc(memory_size);
+
+    memory::slab_allocator slab = {};
+    memory::initialize(&slab, buffer, memory_size);
+
+    bool successfull = (slab.page_count == SLAB_SIZE_CLASS_COUNT);
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(cases); i++)
+    {
+        successfull = (memory::get_slab_size_class(cases[i].size, cases[i].alignment) == cases[i].size_class);
+
+        void *pointer = ALLOCATE(&slab, cases[i].size, cases[i].alignment);
+        successfull = successfull && (pointer != NULL) && is_slab_test_aligned(pointer, cases[i].alignment);
+        if (successfull && cases[i].size_class < SLAB_SIZE_CLASS_COUNT)
+        {
+            // @note: Chunks are aligned to their size, and the page keeps the class.
+            usize chunk_size = memory::get_slab_chunk_size(cases[i].size_class);
+            usize page_index = ((memory::byte *) pointer - slab.pages) / SLAB_PAGE_SIZE;
+            successfull = memory::is_slab_pointer(&slab, pointer) && is_slab_test_aligned(pointer, chunk_size) &&
+                (slab.page_classes[page_index] == cases[i].size_class);
+        }
+        DEALLOCATE(&slab, pointer);
+
+        if (!successfull) printf("\nsize %u, alignment %u", (u32) cases[i].size, (u32) cases[i].alignment);
+    }
+
+    memory::release(&slab);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_slab_free_list_test()
+{
+    printf("slab free list: ");
+
+    usize const memory_size = SLAB_TEST_PAGE_COUNT * SLAB_PAGE_SIZE + KILOBYTES(4);
+    void *buffer = malloc(memory_size);
+
+    memory::slab_allocator slab = {};
+    memory::initialize(&slab, buffer, memory_size);
+
+    void *blocks[8];
+    for (u32 i = 0; i < ARRAY_COUNT(blocks); i++)
+    {
+        blocks[i] = ALLOCATE(&slab, 40, 8);
+    }
+    bool successfull = (slab.used == ARRAY_COUNT(blocks) * 64) && (slab.next_page_index == 1);
+
+    // @note: Freed chunks come back last in, first out, before the page is bumped any further.
+    memory::byte *bump = slab.classes[2].bump;
+    DEALLOCATE(&slab, blocks[2]);
+    DEALLOCATE(&slab, blocks[5]);
+    successfull = successfull && (slab.used == (ARRAY_COUNT(blocks) - 2) * 64);
+
+    void *first = ALLOCATE(&slab, 64, 8);
+    void *second = ALLOCATE(&slab, 33, 8);
+    void *third = ALLOCATE(&slab, 50, 8);
+    successfull = successfull && (first == blocks[5]) && (second == blocks[2]) &&
+        (third == bump) && (slab.classes[2].bump == bump + 64);
+
+    // @note: Other classes do not take these chunks.
+    DEALLOCATE(&slab, first);
+    void *other = ALLOCATE(&slab, 16, 8);
+    successfull = successfull && (other != first) && (slab.next_page_index == 2);
+
+    DEALLOCATE(&slab, other);
+    DEALLOCATE(&slab, second);
+    DEALLOCATE(&slab, third);
+    for (u32 i = 0; i < ARRAY_COUNT(blocks); i++)
+    {
+        if (i != 2 && i != 5) DEALLOCATE(&slab, blocks[i]);
+    }
+    successfull = successfull && (slab.used == 0);
+
+#if ASUKA_DEBUG
+    successfull = successfull && (slab.log.allocation_count == 0);
+#endif // ASUKA_DEBUG
+
+    memory::release(&slab);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_slab_reallocate_test()
+{
+    printf("slab reallocate: ");
+
+    usize const memory_size = SLAB_TEST_PAGE_COUNT * SLAB_PAGE_SIZE + KILOBYTES(4);
+    void *buffer = malloc(memory_size);
+
+    memory::slab_allocator slab = {};
+    memory::initialize(&slab, buffer, memory_size);
+
+    // @note: Growing inside of the chunk keeps the pointer.
+    void *block = ALLOCATE(&slab, 20, 8);
+    fill_slab_test_block(block, 20, 1);
+    void *grown = memory::reallocate(&slab, block, 32, 8, CODE_LOCATION_FUNC);
+    bool successfull = (grown == block) && check_slab_test_block(grown, 20, 1) && (slab.used == 32);
+
+    // @note: Past the chunk it moves to the next class, and the old chunk is free again.
+    fill_slab_test_block(grown, 32, 2);
+    void *moved = memory::reallocate(&slab, grown, 100, 8, CODE_LOCATION_FUNC);
+    successfull = successfull && (moved != grown) && memory::is_slab_pointer(&slab, moved) &&
+        check_slab_test_block(moved, 32, 2) && (slab.used == 128) && (slab.classes[1].free_list == grown);
+
+    // @note: Past the largest class it moves to the heap, and back.
+    fill_slab_test_block(moved, 100, 3);
+    void *large = memory::reallocate(&slab, moved, 5000, 8, CODE_LOCATION_FUNC);
+    successfull = successfull && (large != NULL) && !memory::is_slab_pointer(&slab, large) &&
+        check_slab_test_block(large, 100, 3) && (slab.used == 0);
+
+    fill_slab_test_block(large, 5000, 4);
+    void *shrunk = memory::reallocate(&slab, large, 3000, 8, CODE_LOCATION_FUNC);
+    successfull = successfull && (shrunk == large) && check_slab_test_block(shrunk, 3000, 4);
+
+    // @note: Asking for more alignment than the chunk has moves it too. First chunk of a page is aligned to the page.
+    void *first = ALLOCATE(&slab, 16, 16);
+    void *second = ALLOCATE(&slab, 16, 16);
+    void *aligned = memory::reallocate(&slab, second, 16, 256, CODE_LOCATION_FUNC);
+    successfull = successfull && !is_slab_test_aligned(second, 256) && is_slab_test_aligned(aligned, 256) && (aligned != second);
+
+    DEALLOCATE(&slab, first);
+    DEALLOCATE(&slab, aligned);
+    DEALLOCATE(&slab, shrunk);
+    successfull = successfull && (slab.used == 0);
+
+#if ASUKA_DEBUG
+    successfull = successfull && (slab.log.allocation_count == 0);
+#endif // ASUKA_DEBUG
+
+    memory::release(&slab);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Small requests go to the heap when all pages are taken, they do not fail while malloc does not.
+bool run_slab_page_exhaustion_test()
+{
+    printf("slab page exhaustion: ");
+
+    usize const memory_size = SLAB_TEST_PAGE_COUNT * SLAB_PAGE_SIZE + KILOBYTES(4);
+    void *buffer = malloc(memory_size);
+
+    memory::slab_allocator slab = {};
+    memory::initialize(&slab, buffer, memory_size);
+
+    u32 const chunks_per_page = SLAB_PAGE_SIZE / SLAB_MAX_CHUNK_SIZE;
+    u32 const block_count = (SLAB_TEST_PAGE_COUNT + 1) * chunks_per_page;
+    void **blocks = (void **) malloc(block_count * sizeof(void *));
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < block_count; i++)
+    {
+        blocks[i] = ALLOCATE(&slab, SLAB_MAX_CHUNK_SIZE, 8);
+        bool in_pages = (i < SLAB_TEST_PAGE_COUNT * chunks_per_page);
+        successfull = (blocks[i] != NULL) && (memory::is_slab_pointer(&slab, blocks[i]) == in_pages);
+        if (successfull) fill_slab_test_block(blocks[i], SLAB_MAX_CHUNK_SIZE, (u8) i);
+    }
+    successfull = successfull && (slab.next_page_index == SLAB_TEST_PAGE_COUNT) &&
+        (slab.used == SLAB_TEST_PAGE_COUNT * SLAB_PAGE_SIZE);
+
+    // @note: Other classes have no pages either.
+    void *other = ALLOCATE(&slab, 16, 64);
+    successfull = successfull && (other != NULL) && !memory::is_slab_pointer(&slab, other) && is_slab_test_aligned(other, 64);
+    DEALLOCATE(&slab, other);
+
+    for (u32 i = 0; successfull && i < block_count; i++)
+    {
+        successfull = check_slab_test_block(blocks[i], SLAB_MAX_CHUNK_SIZE, (u8) i);
+    }
+
+    // @note: Freed chunks in pages are taken again before the heap.
+    DEALLOCATE(&slab, blocks[7]);
+    void *reused = ALLOCATE(&slab, SLAB_MAX_CHUNK_SIZE, 8);
+    successfull = successfull && (reused == blocks[7]);
+
+    for (u32 i = 0; i < block_count; i++)
+    {
+        DEALLOCATE(&slab, blocks[i]);
+    }
+    successfull = successfull && (slab.used == 0);
+
+#if ASUKA_DEBUG
+    successfull = successfull && (slab.log.allocation_count == 0);
+#endif // ASUKA_DEBUG
+
+    free(blocks);
+    memory::release(&slab);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_slab_large_test()
+{
+    printf("slab large blocks: ");
+
+    usize const memory_size = SLAB_TEST_PAGE_COUNT * SLAB_PAGE_SIZE + KILOBYTES(4);
+    void *buffer = malloc(memory_size);
+
+    memory::slab_allocator slab = {};
+    memory::initialize(&slab, buffer, memory_size);
+
+    usize const alignments[] = { 1, 8, 16, 64, 256, 4096 };
+
+    bool successfull = true;
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(alignments); i++)
+    {
+        usize size = 3000 + i * 1000;
+        void *block = ALLOCATE(&slab, size, alignments[i]);
+        successfull = (block != NULL) && !memory::is_slab_pointer(&slab, block) && is_slab_test_aligned(block, alignments[i]);
+
+        // @note: Growing keeps the alignment, which realloc would not.
+        fill_slab_test_block(block, size, (u8) i);
+        void *grown = memory::reallocate(&slab, block, size * 10, alignments[i], CODE_LOCATION_FUNC);
+        successfull = successfull && (grown != NULL) && is_slab_test_aligned(grown, alignments[i]) && check_slab_test_block(grown, size, (u8) i);
+
+        DEALLOCATE(&slab, grown);
+        if (!successfull) printf("\nalignment %u", (u32) alignments[i]);
+    }
+    successfull = successfull && (slab.used == 0) && (slab.next_page_index == 0);
+
+#if ASUKA_DEBUG
+    successfull = successfull && (slab.log.allocation_count == 0);
+#endif // ASUKA_DEBUG
+
+    memory::release(&slab);
+    free(buffer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_slab_allocator_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_slab_size_class_test());
+    record_test_result(&result, run_slab_free_list_test());
+    record_test_result(&result, run_slab_reallocate_test());
+    record_test_result(&result, run_slab_page_exhaustion_test());
+    record_test_result(&result, run_slab_large_test());
+
+    return result;
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <mipmap.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Mipmap tests.
+
+    Mip levels are checked against the plain box filter of the level
+    before, computed here pixel by pixel. Scaled blits go through the
+    vector and scalar kernels into two targets, which have to come out the
+    same to the bit, for all kinds of scales, positions and clipping.
+*/
+
+
+INTERNAL
+u32 next_mipmap_test_random(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (u32) (*state >> 16);
+}
+
+
+INTERNAL
+Bitmap make_mipmap_test_bitmap(u32 width, u32 height, u64 *random)
+{
+    Bitmap result = {};
+    result.width = width;
+    result.height = height;
+    result.bytes_per_pixel = 4;
+    result.size = (usize) width * height * 4;
+    result.pixels = malloc(result.size + 1);
+
+    u8 *bytes = (u8 *) result.pixels;
+    for (usize i = 0; i < result.size; i++)
+    {
+        bytes[i] = (u8) next_mipmap_test_random(random);
+    }
+
+    // @note: Some pixels fully transparent and some opaque, they take different ways through the blend.
+    for (usize i = 3; i < result.size; i += 4 * 5)
+    {
+        bytes[i] = (i % 3 == 0) ? 0 : 255;
+    }
+    return result;
+}
+
+
+bool run_mip_chain_test()
+{
+    printf("mip chain: ");
+
+    u32 const sizes[][2] = { { 60, 100 }, { 64, 64 }, { 17, 5 }, { 1, 9 }, { 33, 1 }, { 1, 1 }, { 2, 3 } };
+
+    u64 random = 0xa4093822299f31d0;
+    bool successfull = true;
+
+    for (u32 s = 0; successfull && s < ARRAY_COUNT(sizes); s++)
+    {
+        Bitmap bitmap = make_mipmap_test_bitmap(sizes[s][0], sizes[s][1], &random);
+
+        usize chain_size = get_mip_chain_size(&bitmap);
+        u8 *memory = (u8 *) malloc(chain_size + 1);
+
+        mip_chain chain = {};
+        build_mip_chain(&chain, &bitmap, memory);
+
+        successfull = (chain.levels[0].pixels == bitmap.pixels);
+
+        usize levels_size = 0;
+        for (u32 level = 1; successfull && level < chain.level_count; level++)
+        {
+            Bitmap const *previous = chain.levels + level - 1;
+            Bitmap const *current = chain.levels + level;
+
+            successfull = (current->width == ((previous->width > 1) ? previous->width / 2 : 1)) &&
+                (current->height == ((previous->height > 1) ? previous->height / 2 : 1)) &&
+                (current->pixels == memory + levels_size);
+            levels_size += current->size;
+
+            u8 const *source = (u8 const *) previous->pixels;
+            u8 const *pixels = (u8 const *) current->pixels;
+            for (u32 y = 0; successfull && y < current->height; y++)
+            {
+                u32 y1 = (2 * y + 1 < previous->height) ? 2 * y + 1 : 2 * y;
+                for (u32 x = 0; successfull && x < current->width; x++)
+                {
+                    u32 x1 = (2 * x + 1 < previous->width) ? 2 * x + 1 : 2 * x;
+                    for (u32 c = 0; successfull && c < 4; c++)
+                    {
+                        u32 sum = source[(2 * y * previous->width + 2 * x) * 4 + c] +
+                                  source[(2 * y * previous->width + x1) * 4 + c] +
+                                  source[(y1 * previous->width + 2 * x) * 4 + c] +
+                                  source[(y1 * previous->width + x1) * 4 + c];
+                        successfull = (pixels[(y * current->width + x) * 4 + c] == (sum + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        // @note: Chain goes down to 1x1, and takes all of its memory.
+        Bitmap const *last = chain.levels + chain.level_count - 1;
+        successfull = successfull && (last->width == 1) && (last->height == 1) && (levels_size == chain_size);
+
+        if (!successfull)
+        {
+            printf("\n%ux%u", sizes[s][0], sizes[s][1]);
+        }
+
+        free(memory);
+        free(bitmap.pixels);
+    }
+
+    // @note: Levels are picked so that none is shrunk more than twice.
+    Bitmap bitmap = make_mipmap_test_bitmap(64, 64, &random);
+    u8 *memory = (u8 *) malloc(get_mip_chain_size(&bitmap));
+    mip_chain chain = {};
+    build_mip_chain(&chain, &bitmap, memory);
+
+    successfull = successfull && (chain.level_count == 7) &&
+        (select_mip_level(&chain, 4.0f) == 0) &&
+        (select_mip_level(&chain, 1.0f) == 0) &&
+        (select_mip_level(&chain, 0.51f) == 0) &&
+        (select_mip_level(&chain, 0.5f) == 1) &&
+        (select_mip_level(&chain, 0.3f) == 1) &&
+        (select_mip_level(&chain, 0.25f) == 2) &&
+        (select_mip_level(&chain, 0.001f) == 6);
+
+    free(memory);
+    free(bitmap.pixels);
+
+    // @note: Bitmaps which are not RGBA have just themselves.
+    Bitmap rgb = {};
+    rgb.width = 4;
+    rgb.height = 4;
+    rgb.bytes_per_pixel = 3;
+    rgb.size = 48;
+    rgb.pixels = malloc(rgb.size);
+
+    chain = {};
+    successfull = successfull && (get_mip_chain_size(&rgb) == 0);
+    build_mip_chain(&chain, &rgb, NULL);
+    successfull = successfull && (chain.level_count == 1) && (select_mip_level(&chain, 0.1f) == 0);
+
+    free(rgb.pixels);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_scaled_blit_test()
+{
+    printf("scaled blit: ");
+
+    i32 const width = 97;
+    i32 const height = 61;
+    i32 const pitch = width * 4 + 12;
+
+    u8 *background = (u8 *) malloc(pitch * height);
+    u8 *vector_target = (u8 *) malloc(pitch * height);
+    u8 *scalar_target = (u8 *) malloc(pitch * height);
+
+    u64 random = 0x082efa98ec4e6c89;
+    for (i32 i = 0; i < pitch * height; i++)
+    {
+        background[i] = (u8) next_mipmap_test_random(&random);
+    }
+
+    blit_target vector_blit = { vector_target, width, height, pitch };
+    blit_target scalar_blit = { scalar_target, width, height, pitch };
+
+    Bitmap bitmap = make_mipmap_test_bitmap(23, 14, &random);
+
+    bool successfull = true;
+
+    // @note: At 1:1, opaque pixels are copied exactly, with red and blue swapped, transparent ones are not drawn.
+    memcpy(vector_target, background, pitch * height);
+    blit_bitmap_scaled(vector_blit, 5.0f, 7.0f, (f32) bitmap.width, (f32) bitmap.height, &bitmap);
+    for (u32 y = 0; successfull && y < bitmap.height; y++)
+    {
+        for (u32 x = 0; successfull && x < bitmap.width; x++)
+        {
+            u8 const *source = (u8 const *) bitmap.pixels + (y * bitmap.width + x) * 4;
+            u8 const *back = background + (7 + y) * pitch + (5 + x) * 4;
+            u8 const *out = vector_target + (7 + y) * pitch + (5 + x) * 4;
+            if (source[3] == 255)
+            {
+                successfull = (out[0] == source[2]) && (out[1] == source[1]) && (out[2] == source[0]) && (out[3] == 0);
+            }
+            else if (source[3] == 0)
+            {
+                successfull = (out[0] == back[0]) && (out[1] == back[1]) && (out[2] == back[2]);
+            }
+        }
+    }
+
+    // @note: Pixels around the rectangle are not touched.
+    for (i32 y = 0; successfull && y < height; y++)
+    {
+        for (i32 x = 0; successfull && x < pitch; x++)
+        {
+            bool inside = (y >= 7) && (y < 7 + (i32) bitmap.height) && (x >= 5 * 4) && (x < (5 + (i32) bitmap.width) * 4);
+            if (!inside)
+            {
+                successfull = (vector_target[y * pitch + x] == background[y * pitch + x]);
+            }
+        }
+    }
+
+    for (u32 i = 0; successfull && i < 500; i++)
+    {
+        f32 left = (f32) ((i32) (next_mipmap_test_random(&random) % 160) - 50) + (next_mipmap_test_random(&random) % 100) / 100.0f;
+        f32 top = (f32) ((i32) (next_mipmap_test_random(&random) % 100) - 30) + (next_mipmap_test_random(&random) % 100) / 100.0f;
+        f32 w = 0.5f + (next_mipmap_test_random(&random) % 1500) / 10.0f;
+        f32 h = 0.5f + (next_mipmap_test_random(&random) % 1000) / 10.0f;
+        f32 alpha = (i % 4 == 0) ? 1.0f : (next_mipmap_test_random(&random) % 101) / 100.0f;
+
+        memcpy(vector_target, background, pitch * height);
+        memcpy(scalar_target, background, pitch * height);
+
+        blit_bitmap_scaled(vector_blit, left, top, w, h, &bitmap, alpha);
+        blit_bitmap_scaled_scalar(scalar_blit, left, top, w, h, &bitmap, alpha);
+
+        successfull = (memcmp(vector_target, scalar_target, pitch * height) == 0);
+        if (!successfull)
+        {
+            printf("\n%f %f %f %f %f", left, top, w, h, alpha);
+        }
+    }
+
+    free(bitmap.pixels);
+    free(background);
+    free(vector_target);
+    free(scalar_target);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_mipmap_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_mip_chain_test());
+    record_test_result(&result, run_scaled_blit_test());
+
+    return result;
+}
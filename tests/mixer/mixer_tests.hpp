@@ -0,0 +1,483 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <wav.hpp>
+#include <mixer.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Mixer tests.
+
+    Kernels go through the vector and scalar paths, which have to come out
+    the same to the bit. Voices are mixed from sounds of known samples, to
+    see the gains, the ends, the loops and the ramps. Streams are read from
+    a WAV file written by the test, and have to play the same samples as
+    the file loaded at once.
+*/
+
+#define MIXER_TESTS_WAV_FILENAME "mixer_test.wav"
+#define MIXER_TESTS_44100_WAV_FILENAME "mixer_test_44100.wav"
+
+
+INTERNAL
+u32 next_mixer_test_random(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (u32) (*state >> 16);
+}
+
+
+INTERNAL
+sound_sample_t get_mixer_test_sample(u32 index)
+{
+    return (sound_sample_t) ((index * 7919) % 20000 - 10000);
+}
+
+
+// @note: With a LIST chunk before the data, which readers have to skip.
+INTERNAL
+bool write_mixer_test_wav(char const *filename, u32 frame_count, u16 channels, u32 sample_rate)
+{
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) return false;
+
+    char const list[] = "INFOISFT\x06\0\0\0asuka\0";
+    u32 list_size = sizeof(list) - 1;
+    u32 data_size = frame_count * channels * sizeof(sound_sample_t);
+    u32 riff_size = 4 + (8 + 16) + (8 + list_size) + (8 + data_size);
+    u32 format_size = 16;
+    u16 audio_format = 1;
+    u32 byte_rate = sample_rate * channels * sizeof(sound_sample_t);
+    u16 block_align = channels * sizeof(sound_sample_t);
+    u16 bits_per_sample = 16;
+
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riff_size, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&format_size, 4, 1, file);
+    fwrite(&audio_format, 2, 1, file);
+    fwrite(&channels, 2, 1, file);
+    fwrite(&sample_rate, 4, 1, file);
+    fwrite(&byte_rate, 4, 1, file);
+    fwrite(&block_align, 2, 1, file);
+    fwrite(&bits_per_sample, 2, 1, file);
+    fwrite("LIST", 1, 4, file);
+    fwrite(&list_size, 4, 1, file);
+    fwrite(list, 1, list_size, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&data_size, 4, 1, file);
+    for (u32 i = 0; i < frame_count * channels; i++)
+    {
+        sound_sample_t sample = get_mixer_test_sample(i);
+        fwrite(&sample, sizeof(sample), 1, file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+
+bool run_mixer_kernels_test()
+{
+    printf("mixer kernels: ");
+
+    u32 const max_count = 77;
+    sound_sample_t samples[max_count * 2];
+    f32 vector_block[max_count * 2];
+    f32 scalar_block[max_count * 2];
+    sound_sample_t vector_output[max_count * 2];
+    sound_sample_t scalar_output[max_count * 2];
+
+    u64 random = 0x510e527fade682d1;
+    bool successfull = true;
+
+    for (u32 i = 0; successfull && i < 2000; i++)
+    {
+        u32 channels = 1 + (i % 2);
+        u32 count = next_mixer_test_random(&random) % max_count;
+        for (u32 s = 0; s < max_count * 2; s++)
+        {
+            samples[s] = (sound_sample_t) next_mixer_test_random(&random);
+            vector_block[s] = scalar_block[s] = (f32) ((i32) (next_mixer_test_random(&random) % 60000) - 30000);
+        }
+
+        f32 left = (next_mixer_test_random(&random) % 1000) / 500.0f;
+        f32 right = (next_mixer_test_random(&random) % 1000) / 500.0f;
+        f32 left_step = ((i32) (next_mixer_test_random(&random) % 1000) - 500) / 100000.0f;
+        f32 right_step = ((i32) (next_mixer_test_random(&random) % 1000) - 500) / 100000.0f;
+
+        mix_voice_samples(vector_block, samples, channels, count, left, right, left_step, right_step);
+        mix_voice_samples_scalar(scalar_block, samples, channels, 0, count, left, right, left_step, right_step);
+        successfull = (memcmp(vector_block, scalar_block, sizeof(vector_block)) == 0);
+
+        // @note: Volume over 1 for some, so that the block gets out of range, and saturates.
+        f32 volume = (next_mixer_test_random(&random) % 300) / 100.0f;
+        convert_mix_block(vector_output, vector_block, count * 2, volume);
+        convert_mix_block_scalar(scalar_output, scalar_block, 0, count * 2, volume);
+        successfull = successfull && (memcmp(vector_output, scalar_output, count * 2 * sizeof(sound_sample_t)) == 0);
+
+        if (!successfull)
+        {
+            printf("\nchannels %u, count %u", channels, count);
+        }
+    }
+
+    // @note: Saturated, and rounded to the nearest even.
+    f32 const block[16] = { 1e9f, -1e9f, 32767.4f, -32768.6f, 40000.0f, -40000.0f, 0.5f, 1.5f, -2.5f, -0.4f, 3.0f, 0.0f, 1e30f, -1e30f, 100.49f, -7.5f };
+    sound_sample_t const expected[16] = { 32767, -32768, 32767, -32768, 32767, -32768, 0, 2, -2, 0, 3, 0, 32767, -32768, 100, -8 };
+    sound_sample_t output[16] = {};
+    convert_mix_block(output, block, 16, 1.0f);
+    successfull = successfull && (memcmp(output, expected, sizeof(expected)) == 0);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_mixer_voices_test()
+{
+    printf("mixer voices: ");
+
+    sound_mixer *mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    initialize_sound_mixer(mixer);
+
+    u32 const frame_count = 1000;
+    sound_sample_t *mono_samples = (sound_sample_t *) malloc(frame_count * sizeof(sound_sample_t));
+    sound_sample_t *stereo_samples = (sound_sample_t *) malloc(frame_count * 2 * sizeof(sound_sample_t));
+    for (u32 i = 0; i < frame_count; i++)
+    {
+        mono_samples[i] = 1000;
+        stereo_samples[2 * i] = 2000;
+        stereo_samples[2 * i + 1] = -3000;
+    }
+
+    wav_file_contents mono = { 48000, 1, mono_samples, frame_count };
+    wav_file_contents stereo = { 48000, 2, stereo_samples, frame_count * 2 };
+
+    sound_sample_t *output = (sound_sample_t *) malloc(4000 * 2 * sizeof(sound_sample_t));
+
+    // @note: Mono in the center is -3 dB on both sides, and stops after its last frame.
+    sound_voice_id first = play_sound(mixer, &mono);
+    bool successfull = (first.generation != 0) && is_sound_playing(mixer, first);
+
+    mix_sound(mixer, output, 600);
+    for (u32 i = 0; successfull && i < 600; i++)
+    {
+        successfull = (output[2 * i] == 707) && (output[2 * i + 1] == 707);
+    }
+    successfull = successfull && is_sound_playing(mixer, first);
+
+    mix_sound(mixer, output, 600);
+    for (u32 i = 0; successfull && i < 600; i++)
+    {
+        sound_sample_t value = (i < 400) ? 707 : 0;
+        successfull = (output[2 * i] == value) && (output[2 * i + 1] == value);
+    }
+    successfull = successfull && !is_sound_playing(mixer, first) && (get_playing_voice_count(mixer) == 0);
+
+    // @note: Next sound in the same voice has a new id, the old one does not touch it.
+    sound_voice_id second = play_sound(mixer, &stereo, 1.0f, 0.5f, true);
+    successfull = successfull && (second.index == first.index) && (second.generation != first.generation);
+    stop_sound(mixer, first);
+    set_sound_volume(mixer, first, 0.0f, 0.0f);
+    successfull = successfull && is_sound_playing(mixer, second);
+
+    // @note: Stereo, balanced to the right: left at half, right as it is. Looping goes on past the end.
+    mix_sound(mixer, output, 2500);
+    for (u32 i = 0; successfull && i < 2500; i++)
+    {
+        successfull = (output[2 * i] == 1000) && (output[2 * i + 1] == -3000);
+    }
+    successfull = successfull && is_sound_playing(mixer, second);
+
+    // @note: Volume goes down over one block, evenly, and stays at zero.
+    set_sound_volume(mixer, second, 0.0f, 0.5f);
+    mix_sound(mixer, output, 2 * SOUND_MIXER_BLOCK_FRAMES);
+    for (u32 i = 1; successfull && i < SOUND_MIXER_BLOCK_FRAMES; i++)
+    {
+        successfull = (output[2 * i] <= output[2 * (i - 1)]) && (output[2 * i + 1] >= output[2 * (i - 1) + 1]);
+    }
+    successfull = successfull && (output[0] == 1000) && (absolute(output[2 * (SOUND_MIXER_BLOCK_FRAMES / 2)] - 500) <= 2);
+    for (u32 i = SOUND_MIXER_BLOCK_FRAMES; successfull && i < 2 * SOUND_MIXER_BLOCK_FRAMES; i++)
+    {
+        successfull = (output[2 * i] == 0) && (output[2 * i + 1] == 0);
+    }
+    stop_sound(mixer, second);
+    successfull = successfull && !is_sound_playing(mixer, second);
+
+    // @note: All voices taken, the next sound is not played. All of them together saturate.
+    for (u32 i = 0; successfull && i < SOUND_MIXER_MAX_VOICES; i++)
+    {
+        successfull = (play_sound(mixer, &stereo, 1.0f, 0.0f, true).generation != 0);
+    }
+    successfull = successfull && (play_sound(mixer, &mono).generation == 0);
+    successfull = successfull && (get_playing_voice_count(mixer) == SOUND_MIXER_MAX_VOICES);
+
+    mix_sound(mixer, output, 100);
+    for (u32 i = 0; successfull && i < 100; i++)
+    {
+        successfull = (output[2 * i] == 32767) && (output[2 * i + 1] == -32768);
+    }
+
+    // @note: Sounds which are not mono or stereo are not played.
+    wav_file_contents surround = { 48000, 6, stereo_samples, 300 };
+    initialize_sound_mixer(mixer);
+    successfull = successfull && (play_sound(mixer, &surround).generation == 0) && (play_sound(mixer, NULL).generation == 0);
+
+    free(output);
+    free(stereo_samples);
+    free(mono_samples);
+    free(mixer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_mixer_stream_test()
+{
+    printf("mixer streams: ");
+
+    using namespace Asuka;
+
+    // @note: Not a multiple of the chunk, so the last one is short, and a loop does not start at the beginning of the ring.
+    u32 const frame_count = 3 * WAV_STREAM_BUFFER_FRAMES + 1234;
+    bool successfull = write_mixer_test_wav(MIXER_TESTS_WAV_FILENAME, frame_count, 2, 48000);
+
+    wav_file_contents loaded = load_wav_file(MIXER_TESTS_WAV_FILENAME);
+    successfull = successfull && (loaded.samples != NULL) && (loaded.channels == 2) && (loaded.samples_count == frame_count * 2);
+    for (u32 i = 0; successfull && i < frame_count * 2; i++)
+    {
+        successfull = (loaded.samples[i] == get_mixer_test_sample(i));
+    }
+
+    void *buffer = malloc(WAV_STREAM_BUFFER_SIZE);
+    wav_stream *stream = (wav_stream *) malloc(sizeof(wav_stream));
+    successfull = successfull && open_wav_stream(stream, MIXER_TESTS_WAV_FILENAME, buffer, false);
+    successfull = successfull && (stream->frame_count == frame_count) && (stream->channels == 2);
+
+    // @note: Read piece by piece, in odd amounts, refilled in between; nothing is lost or repeated.
+    u32 read = 0;
+    u64 random = 0x9b05688c2b3e6c1f;
+    for (u32 step = 0; successfull && !is_wav_stream_ended(stream) && step < 100000; step++)
+    {
+        refill_wav_stream(stream);
+
+        sound_sample_t const *samples = NULL;
+        u32 available = peek_wav_stream(stream, &samples);
+        u32 take = next_mixer_test_random(&random) % 5000;
+        if (take > available) take = available;
+
+        for (u32 i = 0; successfull && i < take * 2; i++)
+        {
+            successfull = (samples[i] == get_mixer_test_sample(read * 2 + i));
+        }
+        consume_wav_stream(stream, take);
+        read += take;
+    }
+    successfull = successfull && (read == frame_count);
+    close_wav_stream(stream);
+
+    // @note: Streamed voice plays what the loaded one does, as long as it is refilled every block.
+    sound_mixer *loaded_mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    sound_mixer *stream_mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    initialize_sound_mixer(loaded_mixer);
+    initialize_sound_mixer(stream_mixer);
+
+    successfull = successfull && open_wav_stream(stream, MIXER_TESTS_WAV_FILENAME, buffer, true);
+    refill_wav_stream(stream);
+
+    sound_voice_id loaded_voice = play_sound(loaded_mixer, &loaded, 0.8f, -0.25f, true);
+    sound_voice_id stream_voice = play_sound_stream(stream_mixer, stream, 0.8f, -0.25f);
+    successfull = successfull && (loaded_voice.generation != 0) && (stream_voice.generation != 0);
+
+    u32 const piece = 800;
+    sound_sample_t *loaded_output = (sound_sample_t *) malloc(piece * 2 * sizeof(sound_sample_t));
+    sound_sample_t *stream_output = (sound_sample_t *) malloc(piece * 2 * sizeof(sound_sample_t));
+    for (u32 played = 0; successfull && played < 2 * frame_count + 5000; played += piece)
+    {
+        mix_sound(loaded_mixer, loaded_output, piece);
+        mix_sound(stream_mixer, stream_output, piece);
+        refill_wav_stream(stream);
+        successfull = (memcmp(loaded_output, stream_output, piece * 2 * sizeof(sound_sample_t)) == 0);
+    }
+    successfull = successfull && is_sound_playing(stream_mixer, stream_voice);
+
+    // @note: Stream which was not refilled plays silence, and goes on when it is.
+    initialize_sound_mixer(stream_mixer);
+    close_wav_stream(stream);
+    successfull = successfull && open_wav_stream(stream, MIXER_TESTS_WAV_FILENAME, buffer, false);
+    stream_voice = play_sound_stream(stream_mixer, stream);
+
+    mix_sound(stream_mixer, stream_output, piece);
+    for (u32 i = 0; successfull && i < piece * 2; i++)
+    {
+        successfull = (stream_output[i] == 0);
+    }
+    successfull = successfull && is_sound_playing(stream_mixer, stream_voice);
+
+    refill_wav_stream(stream);
+    mix_sound(stream_mixer, stream_output, piece);
+    for (u32 i = 0; successfull && i < piece * 2; i++)
+    {
+        successfull = (stream_output[i] == get_mixer_test_sample(i));
+    }
+
+    // @note: Range of samples, like in the asset pack: the data chunk without the header.
+    close_wav_stream(stream);
+    wav_header header;
+    u8 prefix[256];
+    FILE *file = fopen(MIXER_TESTS_WAV_FILENAME, "rb");
+    usize prefix_size = file ? fread(prefix, 1, sizeof(prefix), file) : 0;
+    if (file) fclose(file);
+
+    successfull = successfull && parse_wav_header(prefix, prefix_size, 70 + frame_count * 4, &header) &&
+        (header.data_offset == 70) && (header.data_size == frame_count * 4);
+    successfull = successfull && open_wav_stream_range(stream, MIXER_TESTS_WAV_FILENAME, header.data_offset + 400, 4000, 48000, 1, buffer, false);
+    refill_wav_stream(stream);
+
+    sound_sample_t const *samples = NULL;
+    successfull = successfull && (peek_wav_stream(stream, &samples) == 2000);
+    for (u32 i = 0; successfull && i < 2000; i++)
+    {
+        successfull = (samples[i] == get_mixer_test_sample(200 + i));
+    }
+    consume_wav_stream(stream, 2000);
+    successfull = successfull && is_wav_stream_ended(stream);
+    close_wav_stream(stream);
+
+    // @note: Out of the file.
+    successfull = successfull && !open_wav_stream_range(stream, MIXER_TESTS_WAV_FILENAME, header.data_offset, frame_count * 4 + 2, 48000, 2, buffer, false);
+    successfull = successfull && !open_wav_stream(stream, "missing.wav", buffer, false);
+
+    // @note: Sound at another rate is resampled from the stream the same way as from memory, across the loops too.
+    successfull = successfull && write_mixer_test_wav(MIXER_TESTS_44100_WAV_FILENAME, frame_count, 2, 44100);
+    wav_file_contents loaded_44100 = load_wav_file(MIXER_TESTS_44100_WAV_FILENAME);
+    successfull = successfull && (loaded_44100.samples != NULL) && (loaded_44100.samples_per_second == 44100);
+    successfull = successfull && open_wav_stream(stream, MIXER_TESTS_44100_WAV_FILENAME, buffer, true);
+    refill_wav_stream(stream);
+
+    initialize_sound_mixer(loaded_mixer);
+    initialize_sound_mixer(stream_mixer);
+    successfull = successfull && (play_sound(loaded_mixer, &loaded_44100, 0.5f, 0.25f, true).generation != 0);
+    successfull = successfull && (play_sound_stream(stream_mixer, stream, 0.5f, 0.25f).generation != 0);
+    successfull = successfull && (stream_mixer->filter_count == 1);
+
+    for (u32 played = 0; successfull && played < 2 * frame_count + 5000; played += piece)
+    {
+        mix_sound(loaded_mixer, loaded_output, piece);
+        mix_sound(stream_mixer, stream_output, piece);
+        refill_wav_stream(stream);
+        successfull = (memcmp(loaded_output, stream_output, piece * 2 * sizeof(sound_sample_t)) == 0);
+    }
+    close_wav_stream(stream);
+
+    free(stream_output);
+    free(loaded_output);
+    free(stream_mixer);
+    free(loaded_mixer);
+    free(stream);
+    free(buffer);
+    remove(MIXER_TESTS_WAV_FILENAME);
+    remove(MIXER_TESTS_44100_WAV_FILENAME);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_wav_header_test()
+{
+    printf("wav headers: ");
+
+    using namespace Asuka;
+
+    u8 wav[64] = {};
+    u32 riff_size = 36 + 8;
+    u32 format_size = 16;
+    u16 audio_format = 1;
+    u16 channels = 1;
+    u32 sample_rate = 22050;
+    u32 byte_rate = 44100;
+    u16 block_align = 2;
+    u16 bits_per_sample = 16;
+    u32 data_size = 8;
+
+    memcpy(wav, "RIFF", 4);
+    memcpy(wav + 4, &riff_size, 4);
+    memcpy(wav + 8, "WAVEfmt ", 8);
+    memcpy(wav + 16, &format_size, 4);
+    memcpy(wav + 20, &audio_format, 2);
+    memcpy(wav + 22, &channels, 2);
+    memcpy(wav + 24, &sample_rate, 4);
+    memcpy(wav + 28, &byte_rate, 4);
+    memcpy(wav + 32, &block_align, 2);
+    memcpy(wav + 34, &bits_per_sample, 2);
+    memcpy(wav + 36, "data", 4);
+    memcpy(wav + 40, &data_size, 4);
+
+    wav_header header;
+    bool successfull = parse_wav_header(wav, 52, 52, &header) &&
+        (header.samples_per_second == 22050) && (header.channels == 1) &&
+        (header.data_offset == 44) && (header.data_size == 8);
+
+    // @note: Data chunk longer than the file is cut at its end, to whole frames.
+    successfull = successfull && parse_wav_header(wav, 52, 49, &header) && (header.data_size == 4);
+
+    // @note: Only 16-bit PCM, of one or two channels, with the format before the data.
+    u16 const eight_bits = 8;
+    u16 const three_channels = 3;
+    u16 const float_format = 3;
+    u8 broken[64];
+
+    memcpy(broken, wav, 64);
+    memcpy(broken + 34, &eight_bits, 2);
+    successfull = successfull && !parse_wav_header(broken, 52, 52, &header);
+
+    memcpy(broken, wav, 64);
+    memcpy(broken + 22, &three_channels, 2);
+    successfull = successfull && !parse_wav_header(broken, 52, 52, &header);
+
+    memcpy(broken, wav, 64);
+    memcpy(broken + 20, &float_format, 2);
+    successfull = successfull && !parse_wav_header(broken, 52, 52, &header);
+
+    memcpy(broken, wav, 64);
+    memcpy(broken + 12, "junk", 4);
+    successfull = successfull && !parse_wav_header(broken, 52, 52, &header);
+
+    memcpy(broken, wav, 64);
+    memcpy(broken + 8, "AVI ", 4);
+    successfull = successfull && !parse_wav_header(broken, 52, 52, &header);
+
+    for (usize size = 0; successfull && size < 44; size++)
+    {
+        successfull = !parse_wav_header(wav, size, 52, &header);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_mixer_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_mixer_kernels_test());
+    record_test_result(&result, run_mixer_voices_test());
+    record_test_result(&result, run_mixer_stream_test());
+    record_test_result(&result, run_wav_header_test());
+
+    return result;
+}
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+#
+# Writes the PNG files for tests/png/png_tests.hpp into tests/png/images/.
+# Only the standard library is used: zlib compresses, filters and chunks
+# are written here, so every filter type, color type, bit depth, Adam7
+# and every kind of DEFLATE block (stored, fixed, dynamic) is covered.
+#
+# Run from the root of the repository:
+#
+#     python3 tests/png/generate_png_tests.py
+#
+
+import os
+import random
+import struct
+import zlib
+
+OUTPUT_DIRECTORY = os.path.join(os.path.dirname(os.path.abspath(__file__)), "images")
+
+CHANNELS = { 0: 1, 2: 3, 3: 1, 4: 2, 6: 4 }
+
+ADAM7 = [
+    (0, 0, 8, 8), (4, 0, 8, 8), (0, 4, 4, 8), (2, 0, 4, 4),
+    (0, 2, 2, 4), (1, 0, 2, 2), (0, 1, 1, 2),
+]
+
+
+def chunk(kind, data):
+    body = kind + data
+    return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body) & 0xFFFFFFFF)
+
+
+def pack_row(samples, depth):
+    if depth == 8:
+        return bytes(samples)
+    if depth == 16:
+        return b"".join(struct.pack(">H", s) for s in samples)
+    result = bytearray()
+    per_byte = 8 // depth
+    for i in range(0, len(samples), per_byte):
+        byte = 0
+        group = samples[i:i + per_byte]
+        for k, s in enumerate(group):
+            byte |= s << (8 - depth * (k + 1))
+        result.append(byte)
+    return bytes(result)
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def filter_row(kind, row, previous, bpp):
+    result = bytearray([kind])
+    for i, x in enumerate(row):
+        a = row[i - bpp] if i >= bpp else 0
+        b = previous[i]
+        c = previous[i - bpp] if i >= bpp else 0
+        predictor = [0, a, b, (a + b) // 2, paeth(a, b, c)][kind]
+        result.append((x - predictor) & 0xFF)
+    return bytes(result)
+
+
+def encode_pass(pixels, width, height, channels, depth, first_filter):
+    bpp = max(1, channels * depth // 8)
+    data = bytearray()
+    previous = None
+    for y in range(height):
+        samples = [s for x in range(width) for s in pixels[y][x]]
+        row = pack_row(samples, depth)
+        if previous is None:
+            previous = bytes(len(row))
+        data += filter_row((first_filter + y) % 5, row, previous, bpp)
+        previous = row
+    return bytes(data)
+
+
+def compress(data, mode):
+    if mode == "stored":
+        return zlib.compress(data, 0)
+    if mode == "fixed":
+        compressor = zlib.compressobj(9, zlib.DEFLATED, 15, 9, zlib.Z_FIXED)
+        return compressor.compress(data) + compressor.flush()
+    if mode == "fast":
+        return zlib.compress(data, 1)
+    return zlib.compress(data, 9)
+
+
+def write_png(name, pixels, color_type, depth, interlace=False, compression="best",
+              palette=None, transparency=None, idat_size=None, first_filter=0):
+    height = len(pixels)
+    width = len(pixels[0])
+    channels = CHANNELS[color_type]
+
+    if interlace:
+        raw = bytearray()
+        for pass_index, (x0, y0, dx, dy) in enumerate(ADAM7):
+            sub = [row[x0::dx] for row in pixels[y0::dy]]
+            if sub and sub[0]:
+                raw += encode_pass(sub, len(sub[0]), len(sub), channels, depth, first_filter + pass_index)
+    else:
+        raw = encode_pass(pixels, width, height, channels, depth, first_filter)
+
+    compressed = compress(bytes(raw), compression)
+
+    png = b"\x89PNG\r\n\x1a\n"
+    png += chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, depth, color_type, 0, 0, 1 if interlace else 0))
+    png += chunk(b"sRGB", b"\x00")
+    if palette is not None:
+        png += chunk(b"PLTE", b"".join(bytes(entry) for entry in palette))
+    if transparency is not None:
+        png += chunk(b"tRNS", transparency)
+    if idat_size is None:
+        png += chunk(b"IDAT", compressed)
+    else:
+        for i in range(0, len(compressed), idat_size):
+            png += chunk(b"IDAT", compressed[i:i + idat_size])
+    png += chunk(b"IEND", b"")
+
+    with open(os.path.join(OUTPUT_DIRECTORY, name), "wb") as file:
+        file.write(png)
+
+
+def make_pixels(width, height, channels, maximum, seed, noise=0):
+    generator = random.Random(seed)
+    pixels = []
+    for y in range(height):
+        row = []
+        for x in range(width):
+            pixel = []
+            for k in range(channels):
+                value = (x * (k + 3) + y * (5 - k) + (x * y) // 7) % (maximum + 1)
+                if noise and generator.random() < noise:
+                    value = generator.randint(0, maximum)
+                pixel.append(value)
+            row.append(tuple(pixel))
+        pixels.append(row)
+    return pixels
+
+
+def main():
+    os.makedirs(OUTPUT_DIRECTORY, exist_ok=True)
+
+    # Grayscale of every bit depth, with odd widths so rows end in the middle of a byte.
+    for depth in (1, 2, 4, 8, 16):
+        write_png("gray_%d.png" % depth, make_pixels(37, 23, 1, (1 << depth) - 1, depth), 0, depth)
+        write_png("gray_%d_interlaced.png" % depth, make_pixels(37, 23, 1, (1 << depth) - 1, depth), 0, depth, interlace=True)
+
+    write_png("gray_alpha_8.png", make_pixels(33, 17, 2, 255, 1), 4, 8)
+    write_png("gray_alpha_16.png", make_pixels(33, 17, 2, 65535, 2), 4, 16)
+    write_png("rgb_8.png", make_pixels(45, 31, 3, 255, 3), 2, 8)
+    write_png("rgb_16.png", make_pixels(45, 31, 3, 65535, 4), 2, 16)
+    write_png("rgba_8.png", make_pixels(45, 31, 4, 255, 5), 6, 8)
+    write_png("rgba_16.png", make_pixels(45, 31, 4, 65535, 6), 6, 16, interlace=True)
+    write_png("rgba_8_interlaced.png", make_pixels(61, 47, 4, 255, 7), 6, 8, interlace=True)
+    write_png("rgb_8_interlaced_tiny.png", make_pixels(3, 2, 3, 255, 8), 2, 8, interlace=True)
+    write_png("rgba_8_1x1.png", make_pixels(1, 1, 4, 255, 9), 6, 8)
+
+    # Palettes of every bit depth, with and without transparency.
+    palette = [((i * 37) % 256, (i * 91) % 256, (i * 13) % 256) for i in range(256)]
+    for depth in (1, 2, 4, 8):
+        count = 1 << depth
+        pixels = make_pixels(29, 19, 1, count - 1, 10 + depth)
+        write_png("palette_%d.png" % depth, pixels, 3, depth, palette=palette[:count])
+        alpha = bytes((i * 71) % 256 for i in range(count // 2 + 1))
+        write_png("palette_%d_trns.png" % depth, pixels, 3, depth, palette=palette[:count], transparency=alpha, interlace=(depth == 4))
+
+    # Transparent color of grayscale and truecolor images.
+    gray = make_pixels(27, 13, 1, 255, 20)
+    write_png("gray_8_trns.png", gray, 0, 8, transparency=struct.pack(">H", gray[3][4][0]))
+    gray2 = make_pixels(27, 13, 1, 3, 21)
+    write_png("gray_2_trns.png", gray2, 0, 2, transparency=struct.pack(">H", 2))
+    rgb = make_pixels(27, 13, 3, 255, 22)
+    write_png("rgb_8_trns.png", rgb, 2, 8, transparency=struct.pack(">HHH", *rgb[5][6]))
+    rgb16 = make_pixels(27, 13, 3, 65535, 23)
+    write_png("rgb_16_trns.png", rgb16, 2, 16, transparency=struct.pack(">HHH", *rgb16[2][2]))
+
+    # Every kind of DEFLATE block, and the stream split into many IDAT chunks.
+    blocks = make_pixels(80, 40, 4, 255, 30, noise=0.2)
+    write_png("deflate_stored.png", blocks, 6, 8, compression="stored")
+    write_png("deflate_fixed.png", blocks, 6, 8, compression="fixed")
+    write_png("deflate_fast.png", blocks, 6, 8, compression="fast", first_filter=2)
+    write_png("deflate_many_idat.png", blocks, 6, 8, idat_size=97, first_filter=4)
+    write_png("deflate_stored_many_idat.png", make_pixels(300, 300, 3, 255, 31, noise=1.0), 2, 8, compression="stored", idat_size=5000)
+
+    # Noisy picture has long Huffman codes, which go through subtables.
+    write_png("long_codes.png", make_pixels(256, 128, 4, 255, 40, noise=0.5), 6, 8)
+    write_png("long_codes_gray.png", make_pixels(200, 150, 1, 255, 41, noise=0.9), 0, 8, first_filter=1)
+
+    # Bigger picture for tests/benchmarks/png_benchmark.hpp, mostly smooth like the game art.
+    write_png("benchmark_rgba.png", make_pixels(512, 512, 4, 255, 50, noise=0.02), 6, 8, first_filter=4)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,288 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <png.hpp>
+#include <crc.hpp>
+
+// Reference decoder
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include <external/stb_image.h>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    PNG decoder tests.
+
+    Every file in tests/png/images is decoded with decode_png and with
+    stb_image, flipped the same way, and the pixels have to be the same.
+    The files are written by generate_png_tests.py, which covers every
+    color type, bit depth, filter, Adam7 and every kind of DEFLATE block.
+
+    Then the files are cut short and corrupted: the decoder has to fail
+    without reading or writing out of bounds (run under the address
+    sanitizer to see it), and when it does not fail, the bitmap has to be
+    whole.
+*/
+
+#ifndef PNG_TESTS_DIRECTORY
+#define PNG_TESTS_DIRECTORY "tests/png/images/"
+#endif
+
+
+INTERNAL
+u8 *load_png_test_file(char const *filename, usize *size)
+{
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s%s", PNG_TESTS_DIRECTORY, filename);
+
+    u8 *result = NULL;
+    *size = 0;
+
+    FILE *file = fopen(filepath, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        *size = (usize) ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        result = (u8 *) malloc(*size);
+        *size = fread(result, 1, *size, file);
+
+        fclose(file);
+    }
+
+    return result;
+}
+
+
+bool run_png_decode_test(char const *filename)
+{
+    printf("%s: ", filename);
+
+    usize size = 0;
+    u8 *data = load_png_test_file(filename, &size);
+
+    bool successfull = false;
+    if (data)
+    {
+        Bitmap bitmap = decode_png(data, size);
+
+        stbi_set_flip_vertically_on_load(true);
+
+        int width, height, channels;
+        u8 *expected = stbi_load_from_memory(data, (int) size, &width, &height, &channels, 0);
+
+        successfull = (bitmap.pixels != NULL) && (expected != NULL) &&
+            (bitmap.width == (u32) width) && (bitmap.height == (u32) height) && (bitmap.bytes_per_pixel == (u32) channels) &&
+            (bitmap.size == (usize) width * height * channels) && (memcmp(bitmap.pixels, expected, bitmap.size) == 0);
+
+        if (!successfull && bitmap.pixels && expected)
+        {
+            printf("\n%ux%ux%u, expected %dx%dx%d", bitmap.width, bitmap.height, bitmap.bytes_per_pixel, width, height, channels);
+        }
+
+        stbi_image_free(expected);
+        free(bitmap.pixels);
+        free(data);
+    }
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Returns offset of the first chunk of the type, or 0 if there is none.
+INTERNAL
+usize find_png_test_chunk(u8 const *data, usize size, char const *type)
+{
+    usize at = 8;
+    while (at + 12 <= size)
+    {
+        u32 chunk_size = (data[at] << 24) | (data[at + 1] << 16) | (data[at + 2] << 8) | data[at + 3];
+        if (memcmp(data + at + 4, type, 4) == 0)
+        {
+            return at;
+        }
+        at += 12 + (usize) chunk_size;
+    }
+    return 0;
+}
+
+
+INTERNAL
+bool is_png_test_bitmap_whole(Bitmap bitmap)
+{
+    return (bitmap.pixels == NULL) ||
+        ((bitmap.width > 0) && (bitmap.height > 0) && (bitmap.size == (usize) bitmap.width * bitmap.height * bitmap.bytes_per_pixel));
+}
+
+
+// @note: Every prefix of the file is a broken file, and it has to be rejected.
+bool run_png_truncation_test(char const *filename)
+{
+    printf("%s truncated: ", filename);
+
+    usize size = 0;
+    u8 *data = load_png_test_file(filename, &size);
+
+    bool successfull = (data != NULL);
+    for (usize cut = 0; successfull && cut < size; cut += (size > 4096) ? 97 : 1)
+    {
+        // @note: Separate allocation, so the sanitizer catches reads past the cut.
+        u8 *prefix = (u8 *) malloc(cut + 1);
+        memcpy(prefix, data, cut);
+
+        Bitmap bitmap = decode_png(prefix, cut);
+        successfull = (bitmap.pixels == NULL);
+
+        free(bitmap.pixels);
+        free(prefix);
+    }
+
+    free(data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Bytes of the compressed stream are changed and the chunk CRC is fixed, so the corruption goes all the way into inflate.
+bool run_png_corruption_test(char const *filename, u32 corruption_count)
+{
+    printf("%s corrupted: ", filename);
+
+    usize size = 0;
+    u8 *data = load_png_test_file(filename, &size);
+    usize idat = data ? find_png_test_chunk(data, size, "IDAT") : 0;
+
+    bool successfull = (idat != 0);
+    if (successfull)
+    {
+        u8 *copy = (u8 *) malloc(size);
+        u32 idat_size = (data[idat] << 24) | (data[idat + 1] << 16) | (data[idat + 2] << 8) | data[idat + 3];
+
+        u64 state = 0x2545F4914F6CDD1Dull;
+        for (u32 i = 0; successfull && i < corruption_count; i++)
+        {
+            memcpy(copy, data, size);
+
+            u32 change_count = 1 + i % 3;
+            for (u32 k = 0; k < change_count; k++)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+
+                // @note: Header bytes of the stream are hit more often, they hold the block types and the code lengths.
+                u32 at = (u32) (state % ((i % 2) ? idat_size : (idat_size < 64 ? idat_size : 64)));
+                copy[idat + 8 + at] ^= (u8) (1 << ((state >> 32) % 8));
+            }
+
+            u32 crc = compute_crc(copy + idat + 4, idat_size + 4);
+            copy[idat + 8 + idat_size + 0] = (u8) (crc >> 24);
+            copy[idat + 8 + idat_size + 1] = (u8) (crc >> 16);
+            copy[idat + 8 + idat_size + 2] = (u8) (crc >> 8);
+            copy[idat + 8 + idat_size + 3] = (u8) (crc);
+
+            Bitmap bitmap = decode_png(copy, size);
+            successfull = is_png_test_bitmap_whole(bitmap);
+            free(bitmap.pixels);
+        }
+
+        free(copy);
+    }
+
+    free(data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+// @note: Output buffer which is one byte short must be reported, not overrun.
+bool run_png_inflate_capacity_test(char const *filename)
+{
+    printf("%s inflate capacity: ", filename);
+
+    usize size = 0;
+    u8 *data = load_png_test_file(filename, &size);
+    usize idat = data ? find_png_test_chunk(data, size, "IDAT") : 0;
+
+    bool successfull = (idat != 0);
+    if (successfull)
+    {
+        u32 idat_size = (data[idat] << 24) | (data[idat + 1] << 16) | (data[idat + 2] << 8) | data[idat + 3];
+        u8 *stream = (u8 *) malloc(idat_size);
+        memcpy(stream, data + idat + 8, idat_size);
+
+        usize capacity = MEGABYTES(1);
+        u8 *output = (u8 *) malloc(capacity);
+
+        usize output_size = 0;
+        successfull = inflate_zlib(stream, idat_size, output, capacity, &output_size) && (output_size > 0);
+
+        usize inflated_size = output_size;
+        u8 *exact = (u8 *) malloc(inflated_size);
+        successfull = successfull && inflate_zlib(stream, idat_size, exact, inflated_size, &output_size) &&
+            (output_size == inflated_size) && (memcmp(exact, output, inflated_size) == 0);
+        free(exact);
+
+        u8 *short_output = (u8 *) malloc(inflated_size - 1);
+        successfull = successfull && !inflate_zlib(stream, idat_size, short_output, inflated_size - 1, &output_size);
+        free(short_output);
+
+        free(output);
+        free(stream);
+    }
+
+    free(data);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_png_tests()
+{
+    char const *filenames[] =
+    {
+        "gray_1.png", "gray_2.png", "gray_4.png", "gray_8.png", "gray_16.png",
+        "gray_1_interlaced.png", "gray_2_interlaced.png", "gray_4_interlaced.png", "gray_8_interlaced.png", "gray_16_interlaced.png",
+        "gray_alpha_8.png", "gray_alpha_16.png",
+        "rgb_8.png", "rgb_16.png", "rgba_8.png", "rgba_16.png",
+        "rgba_8_interlaced.png", "rgb_8_interlaced_tiny.png", "rgba_8_1x1.png",
+        "palette_1.png", "palette_2.png", "palette_4.png", "palette_8.png",
+        "palette_1_trns.png", "palette_2_trns.png", "palette_4_trns.png", "palette_8_trns.png",
+        "gray_8_trns.png", "gray_2_trns.png", "rgb_8_trns.png", "rgb_16_trns.png",
+        "deflate_stored.png", "deflate_fixed.png", "deflate_fast.png", "deflate_many_idat.png", "deflate_stored_many_idat.png",
+        "long_codes.png", "long_codes_gray.png",
+    };
+
+    test_stats result = {};
+    for (u32 test_index = 0; test_index < ARRAY_COUNT(filenames); test_index++)
+    {
+        record_test_result(&result, run_png_decode_test(filenames[test_index]));
+    }
+
+    char const *broken_filenames[] =
+    {
+        "rgba_8_interlaced.png", "palette_4_trns.png", "deflate_fixed.png", "deflate_many_idat.png", "long_codes.png",
+    };
+
+    for (u32 test_index = 0; test_index < ARRAY_COUNT(broken_filenames); test_index++)
+    {
+        record_test_result(&result, run_png_truncation_test(broken_filenames[test_index]));
+        record_test_result(&result, run_png_corruption_test(broken_filenames[test_index], 500));
+    }
+
+    record_test_result(&result, run_png_inflate_capacity_test("long_codes.png"));
+
+    return result;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <png.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Unfilter kernels against the scalar loops.
+
+    Rows are filtered here, from known pixels, and then unfiltered by
+    unfilter_png_row, which takes the vector kernels where there are some,
+    and by unfilter_png_row_scalar. Both have to give the pixels back.
+
+    Paeth and Average are tested exhaustively: every (a, b, c) and every
+    (a, b) is put into some byte of some pixel, for every pixel size with a
+    kernel. The byte left of it and the ones above are set up by the pixel
+    before, which is filtered too:
+
+        previous:  c  b
+        row:       a  x      x is predicted from a, b, c
+
+    Random rows of every length up to a few vectors check the tails and the
+    other filters.
+*/
+
+
+// @note: Filtering, as the encoder does it, the reverse of unfilter_png_row.
+INTERNAL
+void filter_png_test_row(u8 filter, u8 const *row, u8 const *previous, usize row_size, u32 bpp, u8 *out)
+{
+    for (usize i = 0; i < row_size; i++)
+    {
+        i32 a = (i >= bpp) ? row[i - bpp] : 0;
+        i32 b = previous[i];
+        i32 c = (i >= bpp) ? previous[i - bpp] : 0;
+
+        i32 predictor = 0;
+        switch (filter)
+        {
+            case PNG_FILTER_SUB:     predictor = a; break;
+            case PNG_FILTER_UP:      predictor = b; break;
+            case PNG_FILTER_AVERAGE: predictor = (a + b) >> 1; break;
+            case PNG_FILTER_PAETH:   predictor = paeth_predictor(a, b, c); break;
+        }
+        out[i] = (u8) (row[i] - predictor);
+    }
+}
+
+
+// @note: Filters the row and checks that both the dispatching and the scalar unfilter give it back.
+INTERNAL
+bool check_png_unfilter_row(u8 filter, u8 const *row, u8 const *previous, usize row_size, u32 bpp, u8 *filtered, u8 *unfiltered)
+{
+    filter_png_test_row(filter, row, previous, row_size, bpp, filtered);
+
+    memcpy(unfiltered, filtered, row_size);
+    bool result = unfilter_png_row(filter, unfiltered, previous, row_size, bpp) && (memcmp(unfiltered, row, row_size) == 0);
+
+    memcpy(unfiltered, filtered, row_size);
+    result = result && unfilter_png_row_scalar(filter, unfiltered, previous, row_size, bpp) && (memcmp(unfiltered, row, row_size) == 0);
+
+    return result;
+}
+
+
+bool run_png_unfilter_random_test()
+{
+    printf("unfilter random rows: ");
+
+    u32 const bpps[] = { 1, 2, 3, 4, 6, 8 };
+    usize const capacity = 128 * 8;
+
+    u8 *row = (u8 *) malloc(capacity);
+    u8 *previous = (u8 *) malloc(capacity);
+    u8 *filtered = (u8 *) malloc(capacity);
+    u8 *unfiltered = (u8 *) malloc(capacity);
+
+    u64 state = 0x9E3779B97F4A7C15ull;
+    bool successfull = true;
+    for (u32 bpp_index = 0; successfull && bpp_index < ARRAY_COUNT(bpps); bpp_index++)
+    {
+        u32 bpp = bpps[bpp_index];
+        for (u32 filter = PNG_FILTER_NONE; successfull && filter <= PNG_FILTER_PAETH; filter++)
+        {
+            for (usize pixel_count = 0; successfull && pixel_count <= 128; pixel_count++)
+            {
+                usize row_size = pixel_count * bpp;
+                for (usize i = 0; i < row_size; i++)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    row[i] = (u8) state;
+                    previous[i] = (u8) (state >> 8);
+                }
+
+                successfull = check_png_unfilter_row((u8) filter, row, previous, row_size, bpp, filtered, unfiltered);
+                if (!successfull)
+                {
+                    printf("\nfilter %u, %u bytes per pixel, %u pixels", filter, bpp, (u32) pixel_count);
+                }
+            }
+        }
+    }
+
+    // @note: Unknown filter type is an error.
+    successfull = successfull && !unfilter_png_row(5, row, previous, 16, 4) && !unfilter_png_row_scalar(5, row, previous, 16, 4);
+
+    free(unfiltered);
+    free(filtered);
+    free(previous);
+    free(row);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+//
+// Every pair of pixels tests 'bpp' combinations, one in every byte:
+//
+//     previous:  c c c c  b b b b
+//     row:       a a a a  x x x x
+//                setup    tested
+//
+// With 'use_c' false, c is not a part of the combination (Average).
+//
+bool run_png_unfilter_exhaustive_test(u8 filter, u32 bpp, bool use_c)
+{
+    printf("unfilter %s, %u bytes per pixel, exhaustive: ", (filter == PNG_FILTER_PAETH) ? "paeth" : "average", bpp);
+
+    u32 const combination_count = use_c ? (1u << 24) : (1u << 16);
+    u32 const pairs_per_row = 512;
+    usize const row_size = 2 * pairs_per_row * bpp;
+
+    u8 *row = (u8 *) malloc(row_size);
+    u8 *previous = (u8 *) malloc(row_size);
+    u8 *filtered = (u8 *) malloc(row_size);
+    u8 *unfiltered = (u8 *) malloc(row_size);
+
+    bool successfull = true;
+    for (u32 first = 0; successfull && first < combination_count; first += pairs_per_row * bpp)
+    {
+        for (u32 pair = 0; pair < pairs_per_row; pair++)
+        {
+            for (u32 k = 0; k < bpp; k++)
+            {
+                // @note: Past the last combination, the first ones are tested again.
+                u32 combination = (first + pair * bpp + k) % combination_count;
+                u8 a = (u8) combination;
+                u8 b = (u8) (combination >> 8);
+                u8 c = (u8) (combination >> 16);
+
+                usize setup = (2 * pair) * bpp + k;
+                usize tested = (2 * pair + 1) * bpp + k;
+
+                row[setup] = a;
+                previous[setup] = c;
+                row[tested] = (u8) (a ^ b ^ c ^ 0x5A);
+                previous[tested] = b;
+            }
+        }
+
+        successfull = check_png_unfilter_row(filter, row, previous, row_size, bpp, filtered, unfiltered);
+    }
+
+    free(unfiltered);
+    free(filtered);
+    free(previous);
+    free(row);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_png_unfilter_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_png_unfilter_random_test());
+
+    u32 const bpps[] = { 3, 4, 6, 8 };
+    for (u32 i = 0; i < ARRAY_COUNT(bpps); i++)
+    {
+        record_test_result(&result, run_png_unfilter_exhaustive_test(PNG_FILTER_PAETH, bpps[i], true));
+        record_test_result(&result, run_png_unfilter_exhaustive_test(PNG_FILTER_AVERAGE, bpps[i], false));
+    }
+
+    return result;
+}
@@ -0,0 +1,370 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+#include <resampler.hpp>
+#include <mixer.hpp>
+#include "../test_stats.hpp"
+
+// Standard headers
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+    Resampler tests.
+
+    Kernels go through the vector and scalar paths, which have to come out
+    the same to the bit. Tones are played through the mixer from sounds at
+    other rates, and what comes out has to be the same tone at 48 kHz, with
+    everything else (images, aliases, errors of the phases) more than 80 dB
+    below it. Tones above the Nyquist frequency of the output have to be
+    taken out.
+*/
+
+
+struct resampler_tone_result
+{
+    f64 gain;  // of the tone, from the sound to the output
+    f64 noise; // everything else, in dB below the tone
+};
+
+
+INTERNAL
+u32 next_resampler_test_random(u64 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (u32) (*state >> 16);
+}
+
+
+INTERNAL
+sound_sample_t *make_resampler_test_tone(u32 samples_per_second, f64 frequency, f64 amplitude, u32 frame_count)
+{
+    sound_sample_t *result = (sound_sample_t *) malloc(frame_count * 2 * sizeof(sound_sample_t));
+    for (u32 i = 0; i < frame_count; i++)
+    {
+        f64 angle = 2.0 * 3.14159265358979323846 * frequency * i / samples_per_second;
+        result[2 * i] = (sound_sample_t) lrint(amplitude * sin(angle));
+        result[2 * i + 1] = (sound_sample_t) lrint(amplitude * cos(angle));
+    }
+    return result;
+}
+
+
+//
+// Plays a second of a looping stereo tone, and fits the sine of its
+// frequency to the left channel of the output, after the filter settled:
+// what the fit does not explain is the noise.
+//
+INTERNAL
+resampler_tone_result measure_resampler_tone(u32 samples_per_second, f64 frequency)
+{
+    resampler_tone_result result = {};
+
+    // @note: Whole number of periods in the sound, so it loops without a step.
+    u32 frame_count = samples_per_second;
+    f64 const amplitude = 16000.0;
+    sound_sample_t *samples = make_resampler_test_tone(samples_per_second, frequency, amplitude, frame_count);
+    wav_file_contents sound = { (i32) samples_per_second, 2, samples, (u64) frame_count * 2 };
+
+    sound_mixer *mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    initialize_sound_mixer(mixer);
+
+    u32 const output_frames = 48000;
+    sound_sample_t *output = (sound_sample_t *) malloc(output_frames * 2 * sizeof(sound_sample_t));
+    if (play_sound(mixer, &sound, 1.0f, 0.0f, true).generation != 0)
+    {
+        mix_sound(mixer, output, output_frames);
+
+        u32 const begin = 4096;
+        f64 omega = 2.0 * 3.14159265358979323846 * frequency / 48000.0;
+        f64 ss = 0.0, sc = 0.0, cc = 0.0, sy = 0.0, cy = 0.0;
+        for (u32 i = begin; i < output_frames; i++)
+        {
+            f64 s = sin(omega * i);
+            f64 c = cos(omega * i);
+            f64 y = output[2 * i];
+            ss += s * s; sc += s * c; cc += c * c;
+            sy += s * y; cy += c * y;
+        }
+
+        f64 determinant = ss * cc - sc * sc;
+        f64 a = (sy * cc - cy * sc) / determinant;
+        f64 b = (cy * ss - sy * sc) / determinant;
+
+        f64 tone_power = 0.0, noise_power = 0.0;
+        for (u32 i = begin; i < output_frames; i++)
+        {
+            f64 fit = a * sin(omega * i) + b * cos(omega * i);
+            f64 error = output[2 * i] - fit;
+            tone_power += fit * fit;
+            noise_power += error * error;
+        }
+
+        result.gain = sqrt(a * a + b * b) / amplitude;
+        result.noise = 10.0 * log10(tone_power / noise_power);
+    }
+
+    free(output);
+    free(mixer);
+    free(samples);
+
+    return result;
+}
+
+
+bool run_resampler_kernels_test()
+{
+    printf("resampler kernels: ");
+
+    resampler_filter *filter = (resampler_filter *) malloc(sizeof(resampler_filter));
+    build_resampler_filter(filter, get_resampler_cutoff(44100, 48000));
+
+    u32 const max_count = 67;
+    u32 const source_size = RESAMPLER_TAPS + RESAMPLER_MAX_STEP * max_count + 1;
+    f32 left[source_size];
+    f32 right[source_size];
+    f32 vector_block[max_count * 2];
+    f32 scalar_block[max_count * 2];
+
+    u64 random = 0x3c6ef372fe94f82b;
+    bool successfull = true;
+
+    for (u32 i = 0; successfull && i < 2000; i++)
+    {
+        u32 channels = 1 + (i % 2);
+        u32 count = next_resampler_test_random(&random) % max_count;
+        u64 step = ((u64) (next_resampler_test_random(&random) % (RESAMPLER_MAX_STEP << 16)) << 16) | next_resampler_test_random(&random) % 65536;
+        u64 position = next_resampler_test_random(&random);
+
+        for (u32 s = 0; s < source_size; s++)
+        {
+            left[s] = (f32) ((i32) (next_resampler_test_random(&random) % 65536) - 32768);
+            right[s] = (f32) ((i32) (next_resampler_test_random(&random) % 65536) - 32768);
+        }
+        for (u32 s = 0; s < max_count * 2; s++)
+        {
+            vector_block[s] = scalar_block[s] = (f32) ((i32) (next_resampler_test_random(&random) % 60000) - 30000);
+        }
+
+        f32 left_gain = (next_resampler_test_random(&random) % 1000) / 500.0f;
+        f32 right_gain = (next_resampler_test_random(&random) % 1000) / 500.0f;
+        f32 left_step = ((i32) (next_resampler_test_random(&random) % 1000) - 500) / 100000.0f;
+        f32 right_step = ((i32) (next_resampler_test_random(&random) % 1000) - 500) / 100000.0f;
+        f32 const *other = (channels == 2) ? right : left;
+
+        // @note: Source has to reach RESAMPLER_TAPS frames past the last position.
+        if (((position + step * count) >> 32) + RESAMPLER_TAPS > source_size) continue;
+
+        resample_frames(vector_block, left, other, channels, filter, position, step, count, left_gain, right_gain, left_step, right_step);
+        resample_frames_scalar(scalar_block, left, other, channels, filter, position, step, 0, count, left_gain, right_gain, left_step, right_step);
+        successfull = (memcmp(vector_block, scalar_block, sizeof(vector_block)) == 0);
+
+        if (!successfull)
+        {
+            printf("\nchannels %u, count %u", channels, count);
+        }
+    }
+
+    free(filter);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_resampler_filter_test()
+{
+    printf("resampler filter: ");
+
+    resampler_filter *filter = (resampler_filter *) malloc(sizeof(resampler_filter));
+    bool successfull = true;
+
+    u32 const rates[] = { 22050, 44100, 96000, 192000 };
+    for (u32 r = 0; r < ARRAY_COUNT(rates); r++)
+    {
+        build_resampler_filter(filter, get_resampler_cutoff(rates[r], 48000));
+
+        // @note: Constant goes through as it is, at every fraction, phases in between included.
+        for (u32 phase = 0; successfull && phase < RESAMPLER_PHASES; phase++)
+        {
+            for (u32 half = 0; half < 2; half++)
+            {
+                f64 sum = 0.0;
+                for (u32 k = 0; k < RESAMPLER_TAPS; k++)
+                {
+                    sum += filter->coefficients[phase][k] + 0.5f * half * filter->deltas[phase][k];
+                }
+                successfull = successfull && (fabs(sum - 1.0) < 1e-5);
+            }
+        }
+
+        // @note: Filter at fraction 0 is symmetric around its center, and the fraction 1 is the fraction 0 one tap later.
+        for (u32 k = 1; successfull && k < RESAMPLER_TAPS / 2; k++)
+        {
+            successfull = (fabsf(filter->coefficients[0][RESAMPLER_TAPS / 2 - 1 - k] - filter->coefficients[0][RESAMPLER_TAPS / 2 - 1 + k]) < 1e-6f);
+        }
+        for (u32 k = 1; successfull && k < RESAMPLER_TAPS; k++)
+        {
+            f32 last = filter->coefficients[RESAMPLER_PHASES - 1][k] + filter->deltas[RESAMPLER_PHASES - 1][k];
+            successfull = (fabsf(last - filter->coefficients[0][k - 1]) < 1e-6f);
+        }
+    }
+
+    successfull = successfull &&
+        (get_resampler_cutoff(22050, 48000) == get_resampler_cutoff(44100, 48000)) &&
+        (get_resampler_cutoff(96000, 48000) == 0.5f * get_resampler_cutoff(44100, 48000)) &&
+        (get_resampler_step(96000, 48000) == (2ull << 32)) &&
+        (get_resampler_step(44100, 48000) == (44100ull << 32) / 48000);
+
+    free(filter);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_resampler_tones_test()
+{
+    printf("resampler tones: ");
+
+    struct { u32 rate; f64 frequency; } const tones[] =
+    {
+        { 22050, 1000.0 }, { 22050, 8000.0 },
+        { 44100, 1000.0 }, { 44100, 15000.0 },
+        { 96000, 1000.0 }, { 96000, 15000.0 },
+        { 32000, 440.0 },
+    };
+
+    bool successfull = true;
+    for (u32 i = 0; i < ARRAY_COUNT(tones); i++)
+    {
+        resampler_tone_result tone = measure_resampler_tone(tones[i].rate, tones[i].frequency);
+        bool is_good = (fabs(tone.gain - 1.0) < 0.01) && (tone.noise > 80.0);
+        if (!is_good)
+        {
+            printf("\n%u Hz, tone at %.0f Hz: gain %.4f, noise %.1f dB", tones[i].rate, tones[i].frequency, tone.gain, tone.noise);
+        }
+        successfull = successfull && is_good;
+    }
+
+    // @note: Tone the output can't have is taken out, not folded down to 18 kHz.
+    u32 const frame_count = 96000;
+    sound_sample_t *samples = make_resampler_test_tone(96000, 30000.0, 16000.0, frame_count);
+    wav_file_contents sound = { 96000, 2, samples, (u64) frame_count * 2 };
+
+    sound_mixer *mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    initialize_sound_mixer(mixer);
+
+    sound_sample_t *output = (sound_sample_t *) malloc(24000 * 2 * sizeof(sound_sample_t));
+    successfull = successfull && (play_sound(mixer, &sound, 1.0f, 0.0f, true).generation != 0);
+    mix_sound(mixer, output, 24000);
+
+    i32 peak = 0;
+    for (u32 i = 4096; i < 24000 * 2; i++)
+    {
+        if (abs(output[i]) > peak) peak = abs(output[i]);
+    }
+    successfull = successfull && (peak <= 2);
+
+    free(output);
+    free(mixer);
+    free(samples);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+bool run_resampler_voices_test()
+{
+    printf("resampler voices: ");
+
+    sound_mixer *mixer = (sound_mixer *) malloc(sizeof(sound_mixer));
+    initialize_sound_mixer(mixer);
+
+    // @note: Tenth of a second at 44.1 kHz is 4800 frames at 48 kHz, then the filter is flushed.
+    u32 const frame_count = 4410;
+    sound_sample_t *samples = (sound_sample_t *) malloc(frame_count * sizeof(sound_sample_t));
+    for (u32 i = 0; i < frame_count; i++)
+    {
+        samples[i] = 10000;
+    }
+    wav_file_contents sound = { 44100, 1, samples, frame_count };
+
+    sound_sample_t *output = (sound_sample_t *) malloc(8000 * 2 * sizeof(sound_sample_t));
+    sound_voice_id id = play_sound(mixer, &sound, 1.0f, -1.0f);
+    bool successfull = (id.generation != 0) && (mixer->filter_count == 1);
+
+    mix_sound(mixer, output, 4700);
+    successfull = successfull && is_sound_playing(mixer, id);
+
+    // @note: Constant comes out as it is, once the filter has the sound in all of its taps.
+    for (u32 i = 100; successfull && i < 4700; i++)
+    {
+        successfull = (abs(output[2 * i] - 10000) <= 1) && (output[2 * i + 1] == 0);
+    }
+
+    mix_sound(mixer, output, 600);
+    successfull = successfull && !is_sound_playing(mixer, id);
+    for (u32 i = 200; successfull && i < 600; i++)
+    {
+        successfull = (output[2 * i] == 0);
+    }
+
+    // @note: Upsampled rates share one filter, downsampled ones have a filter each, and there is room for a few of them.
+    u32 const shared_rates[] = { 8000, 11025, 22050, 32000, 44100 };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(shared_rates); i++)
+    {
+        sound.samples_per_second = (i32) shared_rates[i];
+        successfull = (play_sound(mixer, &sound).generation != 0);
+    }
+    successfull = successfull && (mixer->filter_count == 1);
+
+    u32 const other_rates[] = { 88200, 96000, 176400 };
+    for (u32 i = 0; successfull && i < ARRAY_COUNT(other_rates); i++)
+    {
+        sound.samples_per_second = (i32) other_rates[i];
+        successfull = (play_sound(mixer, &sound).generation != 0);
+    }
+    successfull = successfull && (mixer->filter_count == SOUND_MIXER_MAX_FILTERS);
+
+    sound.samples_per_second = 192000;
+    successfull = successfull && (play_sound(mixer, &sound).generation == 0);
+    sound.samples_per_second = 96000;
+    successfull = successfull && (play_sound(mixer, &sound).generation != 0);
+
+    // @note: Rates too high for the steps of the source arrays, and no rate at all.
+    initialize_sound_mixer(mixer);
+    sound.samples_per_second = 4 * 48000 + 1;
+    successfull = successfull && (play_sound(mixer, &sound).generation == 0);
+    sound.samples_per_second = 0;
+    successfull = successfull && (play_sound(mixer, &sound).generation == 0);
+    sound.samples_per_second = 48000;
+    successfull = successfull && (play_sound(mixer, &sound).generation != 0) && (mixer->filter_count == 0);
+
+    free(output);
+    free(samples);
+    free(mixer);
+
+    printf("%s\n", successfull ? "Ok" : "Fail");
+    return successfull;
+}
+
+
+test_stats run_resampler_tests()
+{
+    test_stats result = {};
+
+    record_test_result(&result, run_resampler_kernels_test());
+    record_test_result(&result, run_resampler_filter_test());
+    record_test_result(&result, run_resampler_tones_test());
+    record_test_result(&result, run_resampler_voices_test());
+
+    return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Project specific headers
+#include <defines.hpp>
+
+// Standard headers
+#include <stdio.h>
+
+
+struct test_stats
+{
+    uint32 successfull;
+    uint32 failed;
+};
+
+
+INLINE
+void record_test_result(test_stats *stats, bool successfull)
+{
+    if (successfull)
+    {
+        stats->successfull += 1;
+    }
+    else
+    {
+        stats->failed += 1;
+    }
+}
+
+
+INLINE
+void print_test_stats(char const *suite_name, test_stats stats)
+{
+    printf("%s:\n"
+           "Successfull tests: %d\n"
+           "Failed tests:      %d\n",
+           suite_name,
+           stats.successfull,
+           stats.failed);
+}
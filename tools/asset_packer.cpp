@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <os.hpp>
+#include <bitmap.hpp>
+#include <png.hpp>
+#include <wav.hpp>
+#include <asset_pack.hpp>
+
+
+void print_usage()
+{
+    printf("./asset_packer OUTPUT INPUT...                              \n"
+           "                                                            \n"
+           "    Decodes PNG and WAV files and writes them into one pack. \n"
+           "    Assets are named after their files, without directories.\n"
+           "                                                            \n"
+           "    -h --help    Prints this message.                       \n"
+           "                                                            \n"
+           );
+}
+
+
+char const *get_asset_name(char const *filepath)
+{
+    char const *result = filepath;
+    for (char const *c = filepath; *c; c++)
+    {
+        if (*c == '/' || *c == '\\') result = c + 1;
+    }
+    return result;
+}
+
+
+bool has_extension(char const *filepath, char const *extension)
+{
+    usize filepath_length = strlen(filepath);
+    usize extension_length = strlen(extension);
+
+    bool result = (filepath_length > extension_length) &&
+        (strcmp(filepath + filepath_length - extension_length, extension) == 0);
+    return result;
+}
+
+
+int main(int argc, char **argv)
+{
+    if ((argc == 2) && ((strcmp(argv[1], "-h") == 0) || (strcmp(argv[1], "--help") == 0)))
+    {
+        print_usage();
+        return 0;
+    }
+
+    if (argc < 3)
+    {
+        printf("You have to specify name of the output file and at least one input file\n");
+        return 1;
+    }
+
+    char const *output_filename = argv[1];
+    u32 source_count = (u32) (argc - 2);
+
+    asset_pack_source *sources = (asset_pack_source *) calloc(source_count, sizeof(asset_pack_source));
+
+    for (u32 i = 0; i < source_count; i++)
+    {
+        char const *filepath = argv[i + 2];
+        asset_pack_source *source = sources + i;
+
+        source->name = get_asset_name(filepath);
+        if (strlen(source->name) >= ASSET_PACK_NAME_SIZE)
+        {
+            printf("Name of '%s' is longer than %d characters.\n", filepath, ASSET_PACK_NAME_SIZE - 1);
+            return 1;
+        }
+
+        if (has_extension(filepath, ".png"))
+        {
+            source->type = ASSET_TYPE_BITMAP;
+            source->bitmap = load_png_file(filepath);
+            if (source->bitmap.pixels == NULL)
+            {
+                printf("Could not load '%s'.\n", filepath);
+                return 1;
+            }
+        }
+        else if (has_extension(filepath, ".wav"))
+        {
+            source->type = ASSET_TYPE_SOUND;
+            source->sound = Asuka::load_wav_file(filepath);
+            if (source->sound.samples == NULL)
+            {
+                printf("Could not load '%s'.\n", filepath);
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Do not know what '%s' is, only .png and .wav files go into the pack.\n", filepath);
+            return 1;
+        }
+    }
+
+    usize capacity = get_asset_pack_size(sources, source_count);
+    u8 *output = (u8 *) malloc(capacity);
+
+    usize size = write_asset_pack(sources, source_count, output, capacity);
+    if (size == 0)
+    {
+        printf("Could not write the pack, are there two assets with the same name?\n");
+        return 1;
+    }
+
+    FILE *output_file = fopen(output_filename, "wb");
+    if (output_file == NULL)
+    {
+        printf("Could not open '%s' for writing.\n", output_filename);
+        return 1;
+    }
+
+    usize written = fwrite(output, 1, size, output_file);
+    fclose(output_file);
+
+    if (written != size)
+    {
+        printf("Could not write '%s'.\n", output_filename);
+        return 1;
+    }
+
+    printf("%s: %u assets, %llu bytes\n", output_filename, source_count, (unsigned long long) size);
+    return 0;
+}
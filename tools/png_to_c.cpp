@@ -1,92 +1,214 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <os.hpp>
 #include <bitmap.hpp>
 #include <png.hpp>
+#include <lz4.hpp>
+
+
+/*
+    Decodes the PNG, compresses its pixels with LZ4, and writes three files
+    into the output directory, named after the input file:
+
+        NAME.lz       compressed pixels, embedded into the executable with
+                      INCBIN, so the compiler never sees them;
+        NAME.lz.inc   the same bytes as a C array, for MSVC, which has no
+                      assembler directive to embed a file;
+        NAME.cpp      Bitmap get_NAME_png(arena), which decompresses the
+                      pixels into the arena.
+
+    INCBIN path of the blob is the output directory joined with its name,
+    so it has to be relative to where the game is compiled from.
+*/
 
 
 void print_usage()
 {
-    printf("./png_to_c INPUT                         \n"
-           "                                         \n"
-           "    -h --help    Prints this message.    \n"
-           "                                         \n"
+    printf("./png_to_c INPUT [OUTPUT_DIRECTORY]                         \n"
+           "                                                            \n"
+           "    Writes NAME.lz, NAME.lz.inc and NAME.cpp into the output \n"
+           "    directory, which is 'data' by default.                  \n"
+           "                                                            \n"
+           "    -h --help    Prints this message.                       \n"
+           "                                                            \n"
            );
 }
 
-int main(int argc, char **argv)
+
+// @note: Name of the file without directories and extension, with everything but letters and digits replaced by '_'.
+bool get_identifier(char const *filepath, char *identifier, usize capacity)
 {
-    if (argc < 2)
+    char const *name = filepath;
+    for (char const *c = filepath; *c; c++)
     {
-        printf("You have to specify name of png file and output file\n");
-        return 1;
+        if (*c == '/' || *c == '\\') name = c + 1;
     }
 
-    if (argc > 2)
+    usize length = strlen(name);
+    char const *extension = strrchr(name, '.');
+    if (extension) length = (usize) (extension - name);
+
+    if (length == 0 || length + 1 > capacity) return false;
+
+    for (usize i = 0; i < length; i++)
     {
-        printf("Too many arguments!\n");
-        return 1;
+        char c = name[i];
+        bool is_alphanumeric = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        identifier[i] = is_alphanumeric ? c : '_';
     }
+    identifier[length] = 0;
+    return true;
+}
+
 
-    if ((strcmp(argv[1], "-h") == 0) || (strcmp(argv[1], "--help") == 0))
+bool write_file(char const *filepath, void const *data, usize size)
+{
+    FILE *file = fopen(filepath, "wb");
+    if (file == NULL)
+    {
+        printf("Could not open '%s' for writing.\n", filepath);
+        return false;
+    }
+
+    bool result = (fwrite(data, 1, size, file) == size);
+    fclose(file);
+
+    if (!result) printf("Could not write '%s'.\n", filepath);
+    return result;
+}
+
+
+// @note: Formats the whole array in memory, and writes it at once, instead of printing every byte.
+bool write_array_file(char const *filepath, char const *identifier, u8 const *data, usize size)
+{
+    char const *digits = "0123456789abcdef";
+    usize const bytes_per_line = 24;
+
+    usize capacity = 256 + size * 5 + (size / bytes_per_line + 1) * 5;
+    char *text = (char *) malloc(capacity);
+    if (text == NULL) return false;
+
+    usize length = (usize) snprintf(text, capacity, "GLOBAL u8 const png_lz4_%s[] =\n{", identifier);
+    for (usize i = 0; i < size; i++)
+    {
+        if (i % bytes_per_line == 0)
+        {
+            memcpy(text + length, "\n    ", 5);
+            length += 5;
+        }
+        text[length++] = '0';
+        text[length++] = 'x';
+        text[length++] = digits[data[i] >> 4];
+        text[length++] = digits[data[i] & 15];
+        text[length++] = ',';
+    }
+    length += (usize) snprintf(text + length, capacity - length, "\n};\n");
+
+    bool result = write_file(filepath, text, length);
+    free(text);
+    return result;
+}
+
+
+int main(int argc, char **argv)
+{
+    if ((argc == 2) && ((strcmp(argv[1], "-h") == 0) || (strcmp(argv[1], "--help") == 0)))
     {
         print_usage();
         return 0;
     }
 
-    char *filename = argv[1];
-    usize filename_length = strlen(filename);
-    if (filename_length < 4)
+    if (argc < 2)
     {
-        printf("Filename have to contain '.png' at the end, but it's too short.\n");
+        printf("You have to specify name of png file\n");
         return 1;
     }
 
-    char name[1024] = {};
-    usize name_length = filename_length - 4;
-
-    memcpy(name, filename, name_length);
-
-    name[name_length] = '.';
-    name[name_length + 1] = 'c';
-    name[name_length + 2] = 'p';
-    name[name_length + 3] = 'p';
+    if (argc > 3)
+    {
+        printf("Too many arguments!\n");
+        return 1;
+    }
 
-    Bitmap png = load_png_file(argv[1]);
-    ASSERT(png.pixels);
+    char const *input_filepath = argv[1];
+    char const *output_directory = (argc > 2) ? argv[2] : "data";
 
-    FILE *output_file = fopen(name, "wb");
+    char identifier[256] = {};
+    if (!get_identifier(input_filepath, identifier, sizeof(identifier)))
+    {
+        printf("Could not make a name out of '%s'.\n", input_filepath);
+        return 1;
+    }
 
-    fprintf(output_file, "GLOBAL_VARIABLE u32 png_pixels_%.*s_ [] = {", (int) name_length, name);
+    Bitmap png = load_png_file(input_filepath);
+    if (png.pixels == NULL)
+    {
+        printf("Could not load '%s'.\n", input_filepath);
+        return 1;
+    }
 
-    u8 *bytes = (u8 *) png.pixels;
-    for (usize idx = 0;
-        idx < png.size;
-        idx += 1)
+    usize capacity = get_lz4_compress_bound(png.size);
+    u8 *compressed = (u8 *) malloc(capacity);
+    usize compressed_size = lz4_compress((u8 const *) png.pixels, png.size, compressed, capacity);
+    if (compressed_size == 0)
     {
-        u8 value = *(bytes + idx);
-        fprintf(output_file, "%u,", value);
+        printf("Could not compress '%s'.\n", input_filepath);
+        return 1;
     }
 
-    fprintf(output_file,
-        "};\n"
+    char blob_filepath[1024] = {};
+    char array_filepath[1024] = {};
+    char code_filepath[1024] = {};
+    snprintf(blob_filepath, sizeof(blob_filepath), "%s/%s.lz", output_directory, identifier);
+    snprintf(array_filepath, sizeof(array_filepath), "%s/%s.lz.inc", output_directory, identifier);
+    snprintf(code_filepath, sizeof(code_filepath), "%s/%s.cpp", output_directory, identifier);
+
+    if (!write_file(blob_filepath, compressed, compressed_size)) return 1;
+    if (!write_array_file(array_filepath, identifier, compressed, compressed_size)) return 1;
+
+    char code[4096] = {};
+    int code_length = snprintf(code, sizeof(code),
+        "// @note: Generated by png_to_c from %s, %llu bytes of pixels compressed into %llu.\n"
+        "\n"
+        "#ifdef ASUKA_COMPILER_MICROSOFT\n"
+        "#include \"%s.lz.inc\"\n"
+        "#else\n"
+        "INCBIN(png_lz4_%s, \"%s\");\n"
+        "#endif // ASUKA_COMPILER_MICROSOFT\n"
         "\n"
-        "Bitmap get_%.*s_png()\n"
+        "Bitmap get_%s_png(memory::arena_allocator *arena)\n"
         "{\n"
         "    Bitmap result {};\n"
-        "    result.pixels = png_pixels_%.*s_;\n"
-        "    result.size = %llu;\n"
-        "    result.width = %u;\n"
-        "    result.height = %u;\n"
-        "    result.bytes_per_pixel = %u;\n"
-        "    \n"
+        "\n"
+        "    u8 *pixels = ALLOCATE_BUFFER(arena, u8, %llu);\n"
+        "    if (pixels && lz4_decompress(png_lz4_%s, %llu, pixels, %llu))\n"
+        "    {\n"
+        "        result.pixels = pixels;\n"
+        "        result.size = %llu;\n"
+        "        result.width = %u;\n"
+        "        result.height = %u;\n"
+        "        result.bytes_per_pixel = %u;\n"
+        "    }\n"
+        "\n"
         "    return result;\n"
         "}\n",
-            (int) name_length, (char *) name,
-            (int) name_length, (char *) name,
-            png.size, png.width, png.height, png.bytes_per_pixel
-        );
-
-    fclose(output_file);
+        input_filepath, (unsigned long long) png.size, (unsigned long long) compressed_size,
+        identifier,
+        identifier, blob_filepath,
+        identifier,
+        (unsigned long long) png.size,
+        identifier, (unsigned long long) compressed_size, (unsigned long long) png.size,
+        (unsigned long long) png.size, png.width, png.height, png.bytes_per_pixel);
+
+    if (code_length < 0 || code_length >= (int) sizeof(code)) return 1;
+    if (!write_file(code_filepath, code, (usize) code_length)) return 1;
+
+    printf("%s: %llu bytes -> %llu bytes (%s)\n", input_filepath,
+        (unsigned long long) png.size, (unsigned long long) compressed_size, code_filepath);
+
+    free(compressed);
+    free(png.pixels);
+    return 0;
 }